@@ -1,4 +1,4 @@
-#include "qc_expression_tree.h"
+#include "core/autogen_cursor/qc_expression_tree.h"
 #include <iostream>
 #include <memory>
 
@@ -51,7 +51,7 @@ void demonstrate_distributive_law() {
         ExpressionFactory::symbol(c), 
         ExpressionFactory::symbol(d)
     );
-    auto product = ExpressionFactory::multiply(sum_ab, sum_cd);
+    auto product = ExpressionFactory::multiply(std::move(sum_ab), std::move(sum_cd));
     
     std::cout << "Original expression: " << product->to_string() << std::endl;
     
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "expression.h"
+#include "simplifier.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace qc
+{
+
+    /**
+     * @brief Flattened, canonically ordered form of sums and products
+     *
+     * ADD, SUBTRACT and SUM trees become one SumExpression whose terms are
+     * not sums: numeric factors move into the coefficients, constants are
+     * folded into a single leading term, like terms are merged and zero
+     * terms dropped. MULTIPLY trees become one ProductExpression whose
+     * factors are not products, with numeric factors multiplied into a
+     * leading constant. Terms and factors are sorted by compare(); factors
+     * that do not commute keep their relative order after the commuting
+     * ones. A sum of one term is written as a product with its
+     * coefficient, and sums or products of one operand collapse to it, so
+     * equal expressions have one normal form whatever their association
+     * or operand order.
+     *
+     * Operators, operator products and commutators never commute; symbols,
+     * tensors and expressions commute unless they carry the property
+     * commutative=false.
+     */
+    class ACNormalizer
+    {
+    public:
+        static std::unique_ptr<Expression> normalize(const Expression &expr);
+
+        // Total order: node type, then constants by value, other leaves by
+        // name or text, and inner nodes by their children
+        static int compare(const Expression &a, const Expression &b);
+
+        static bool is_commutative(const Expression &expr);
+
+        // Value of a ScalarSymbol leaf
+        static bool constant_value(const Expression &expr, double &value);
+    };
+
+    /**
+     * @brief Pattern matching modulo associativity and commutativity
+     *
+     * Patterns are expressions in which a symbol named ?x matches any one
+     * subexpression, and a symbol named ?x* matches the remaining operands
+     * of the enclosing sum or product (as a sum or product of its own; 0
+     * or 1 if none remain). A wildcard used twice must match equal
+     * subexpressions. Pattern and subject are normalized first, so a match
+     * does not depend on the association or order of the operands, and a
+     * subject that is not a sum or product matches as a single operand.
+     * In sums, the coefficients of matched terms must be equal.
+     *
+     * The operands of a sum or product are matched in stages. Pattern
+     * operands without wildcards are looked up in the sorted subject
+     * operands, which form a multiset index. Operands whose wildcards
+     * occur nowhere else in the pattern cannot constrain each other and
+     * are assigned by maximum bipartite matching. Only operands sharing
+     * wildcards are matched by backtracking.
+     */
+    class ACMatcher
+    {
+    public:
+        using Bindings = std::map<std::string, std::shared_ptr<const Expression>>;
+
+        static bool is_wildcard(const Expression &expr);
+        static bool is_sequence_wildcard(const Expression &expr);
+
+        // True with the wildcard values in bindings if pattern matches subject
+        static bool match(const Expression &pattern, const Expression &subject, Bindings &bindings);
+
+        // Replacement with every bound wildcard replaced by its value
+        static std::unique_ptr<Expression> substitute(const Expression &replacement, const Bindings &bindings);
+
+        // Normalized replacement for a match of pattern at the root of expr,
+        // nullptr if there is none
+        static std::unique_ptr<Expression> rewrite(const Expression &expr, const Expression &pattern,
+                                                   const Expression &replacement);
+
+        // The rewrite as a Simplifier rule
+        static Simplifier::Rule rule(const Expression &pattern, const Expression &replacement);
+    };
+
+} // namespace qc
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "tensor.h"
+#include "contraction_term.h"
+#include "orbital_space.h"
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Positions of a tensor that the tensor is antisymmetric under
+     *
+     * All indices of a group live in the same orbital space, so only the
+     * strictly ordered block p_0 < p_1 < ... needs to be stored.
+     */
+    struct AntisymmetricGroup
+    {
+        std::vector<size_t> positions;
+        int space; // SpaceRegistry id
+
+        size_t size() const { return positions.size(); }
+    };
+
+    /**
+     * @brief Detection of antisymmetric index groups and packed-storage helpers
+     */
+    class AntisymmetryAnalysis
+    {
+    public:
+        // Groups of size >= 2 derived from the tensor symmetry. The property
+        // "antisymmetric_groups" ("0,1;2,3") overrides the automatic detection.
+        static std::vector<AntisymmetricGroup> groups(const Tensor &tensor);
+
+        // Group of `label` in `tensor`, or nullptr
+        static const AntisymmetricGroup *find_group(const std::vector<AntisymmetricGroup> &groups,
+                                                    const Tensor &tensor, const std::string &label);
+
+        // Number of strictly ordered k-tuples out of n: C(n, k)
+        static long packed_size(long n, size_t k);
+
+        // Offset of a strictly increasing tuple in the combinatorial number system
+        static long packed_offset(const std::vector<long> &sorted_values);
+
+        // Sort values in place; returns the permutation sign, 0 on repeated values
+        static int sort_with_sign(std::vector<long> &values);
+    };
+
+    /**
+     * @brief Loop nest with restricted bounds for one contraction term
+     *
+     * A loop with a non-empty `upper_label` runs over [0, upper_label) instead of
+     * the full orbital space.
+     */
+    struct RestrictedLoop
+    {
+        std::string label;
+        int space; // SpaceRegistry id
+        std::string upper_label;
+        bool summed;
+    };
+
+    class RestrictedSummation
+    {
+    public:
+        struct Plan
+        {
+            std::vector<RestrictedLoop> loops;
+            std::vector<std::vector<std::string>> external_groups; // unique output blocks
+            std::vector<std::vector<std::string>> summed_groups;   // restricted dummy sums
+            double prefactor;                                      // corrected prefactor
+            double iteration_fraction;                             // ~ restricted / full iterations
+        };
+
+        // Build the restricted loop nest. Summed indices are only restricted
+        // when every factor touching them carries them in one antisymmetric
+        // group and the number of such factors is even, so the summand is
+        // symmetric and vanishes on the diagonal.
+        static Plan plan(const ContractionTerm &term);
+
+        // Loop group containing `label`, or -1
+        static int loop_group_of(const Plan &plan, const std::string &label);
+    };
+
+} // namespace qc
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "contraction_term.h"
+#include "code_generator.h"
+#include "build_graph.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief One equation of a batch manifest
+     *
+     * Manifest lines are `<name> <source> [key=value ...]`; a line
+     * `default key=value ...` sets the options of the lines after it, and
+     * `#` starts a comment. Sources:
+     *
+     *   builtin:<set>[/<block>]           EquationLibrary::load_builtin
+     *   triples:connected|disconnected    PerturbativeTriplesGenerator
+     *   rdm:1|2                           RdmGenerator, intermediates first
+     */
+    struct BatchJob
+    {
+        std::string name;
+        std::string source;
+        std::string strategy = "direct"; // direct: fused loop nests; pairwise: binary contractions
+        int truncation = -1;             // most factors kept per term, -1 keeps all
+        std::string spin = "none";       // none | kramers (unique Kramers blocks)
+        std::string backend = "double";  // double | float
+        double memory = 0.0;             // bytes held while running; 0 = BatchOptions::job_memory
+        int line = 0;                    // manifest line, for diagnostics
+    };
+
+    /**
+     * @brief Options for BatchCompiler
+     */
+    struct BatchOptions
+    {
+        size_t threads = 0;             // worker slots; 0 = hardware concurrency
+        double memory_limit = 0.0;      // bytes held by running jobs at once; 0 = unlimited
+        double job_memory = 256.0e6;    // estimate for jobs without a manifest hint
+        std::string cache;              // BuildGraph cache file, loaded and saved by run(); empty = none
+    };
+
+    /**
+     * @brief Compiler phases, in the order each job runs them
+     */
+    enum class BatchPhase
+    {
+        DERIVE,
+        SIMPLIFY,
+        FACTORIZE,
+        GENERATE
+    };
+
+    constexpr size_t kNumBatchPhases = 4;
+
+    /**
+     * @brief Outcome of one job
+     */
+    struct BatchResult
+    {
+        std::string name;
+        bool ok = false;
+        std::string error;
+        std::string code; // kernels, without the preamble
+        size_t terms = 0; // after factorization
+        size_t kernels = 0;
+        std::array<double, kNumBatchPhases> seconds{};
+    };
+
+    /**
+     * @brief Counters of the last BatchCompiler::run
+     */
+    struct BatchStats
+    {
+        size_t jobs = 0;
+        size_t failed = 0;
+        size_t max_concurrent = 0; // jobs holding memory at once
+        size_t delayed = 0;        // admissions held back by the memory ceiling
+        size_t reused = 0;         // phases whose inputs and options were unchanged
+        bool cache_saved = false;
+        double peak_memory = 0.0;  // bytes held by running jobs
+        std::array<double, kNumBatchPhases> phase_seconds{}; // summed over jobs
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Compiles a manifest of equations on a shared pool of workers
+     *
+     * Each job runs its phases as separate tasks, so the phases of
+     * different equations interleave on the pool. A job reserves its
+     * memory estimate when its first phase starts and releases it after
+     * code generation. Jobs are admitted in manifest order while the
+     * reservations fit under the ceiling, and the phases of admitted jobs
+     * take precedence over admitting new ones; a job larger than the
+     * ceiling runs alone. Results, and the output built from them, are in
+     * manifest order whatever the schedule.
+     *
+     * The phases are nodes of a BuildGraph. Each phase node takes the
+     * previous phase and a RULE node holding the job options it reads:
+     * the source for derive, truncation and spin for simplify, strategy
+     * for factorize, backend for generate. With a cache file, a phase
+     * whose inputs and options are unchanged since the run that saved it
+     * is taken from the file. The cache is tied to the build that wrote
+     * it: the sources and generators are not part of the keys.
+     */
+    class BatchCompiler
+    {
+    private:
+        BatchOptions options_;
+        std::vector<BatchResult> results_;
+        BatchStats stats_;
+
+    public:
+        BatchCompiler(const BatchOptions &options = BatchOptions());
+
+        // False with "line N: ..." in error if the manifest is malformed
+        static bool parse_manifest(const std::string &text, std::vector<BatchJob> &jobs, std::string &error);
+
+        const BatchOptions &options() const { return options_; }
+        size_t slots() const;
+
+        // False if any job failed; the others still complete
+        bool run(const std::vector<BatchJob> &jobs);
+
+        const std::vector<BatchResult> &results() const { return results_; }
+        const BatchStats &stats() const { return stats_; }
+
+        // Generated source: preamble once, then every successful job
+        std::string output() const;
+
+        // Per-job and per-phase timing table
+        std::string summary() const;
+
+        // Single phases; false with a message in error on failure
+        static bool derive(const BatchJob &job, std::vector<ContractionTerm> &terms, std::string &error);
+        static bool simplify(const BatchJob &job, std::vector<ContractionTerm> &terms, std::string &error);
+        static bool factorize(const BatchJob &job, std::vector<ContractionTerm> &terms, std::string &error);
+        static bool generate(const BatchJob &job, const std::vector<ContractionTerm> &terms, BatchResult &result);
+
+        static CodeGenOptions codegen_options(const BatchJob &job);
+
+        // Options each phase reads, as the fingerprint of its RULE node
+        static std::string phase_options(const BatchJob &job, BatchPhase phase);
+
+        // "512M", "64G" or plain bytes; binary multiples
+        static bool parse_bytes(const std::string &text, double &bytes);
+
+        static const char *phase_name(BatchPhase phase);
+    };
+
+} // namespace qc
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "contraction_term.h"
+#include "code_generator.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Output of one BuildGraph node
+     */
+    struct BuildArtifact
+    {
+        std::vector<ContractionTerm> terms; // equations, derived terms, intermediates
+        std::string text;                   // rule fingerprints, generated kernels
+        std::string error;                  // set by a failed transform
+    };
+
+    /**
+     * @brief Counters of the last BuildGraph::build
+     */
+    struct BuildStats
+    {
+        size_t recomputed = 0;
+        size_t reused = 0;    // inputs unchanged, artifact taken from memory or the cache file
+        size_t unchanged = 0; // recomputed with the previous content, dependents not invalidated
+        size_t failed = 0;    // the transform or an input failed
+        std::vector<std::string> recomputed_nodes;
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Dependency graph from equations and rules to generated kernels
+     *
+     * Sources (equations, rule fingerprints) are hashed by content; every
+     * other node is a transform of its inputs and carries the hash of its
+     * inputs' contents as its key. build() walks the nodes in order and
+     * recomputes a node only if its key changed, so an edit reaches the
+     * nodes downstream of it and stops where a recomputed artifact has the
+     * same content as before. Transforms must be pure functions of their
+     * inputs: anything else they depend on (a rule's options, a code
+     * generator's settings) belongs in a rule node. Artifacts are hashed
+     * through the EquationLibrary encoding, which is exact, so an
+     * incremental build reproduces a full one bit for bit.
+     *
+     * A transform fails by setting the error of its artifact. A failed
+     * node is not built: it is retried by the next build, never cached,
+     * and its dependents fail with it.
+     *
+     * save() and load() persist keys and artifacts between runs; a program
+     * registers its nodes with the current sources, loads the cache,
+     * builds and saves again. build_node() builds one node whose inputs
+     * are built, so a scheduler can run the nodes of independent chains
+     * on different threads.
+     */
+    class BuildGraph
+    {
+    public:
+        enum class Kind
+        {
+            EQUATION,     // source terms
+            RULE,         // source fingerprint of a rewrite or generator setting
+            TERMS,        // derived terms
+            INTERMEDIATE, // extracted intermediates
+            KERNEL        // generated source
+        };
+
+        enum class Outcome
+        {
+            REUSED,     // key unchanged, artifact from memory or the cache file
+            RECOMPUTED, // transform run, new content
+            UNCHANGED,  // transform run, same content as before
+            FAILED
+        };
+
+        using Transform = std::function<BuildArtifact(const std::vector<const BuildArtifact *> &inputs)>;
+
+        struct Node
+        {
+            std::string name;
+            Kind kind;
+            std::vector<size_t> inputs; // preceding nodes; empty for a source
+            Transform transform;
+            BuildArtifact artifact;
+            std::uint64_t key = 0;  // hash of the input hashes; content hash for a source
+            std::uint64_t hash = 0; // content hash of the artifact
+            bool built = false;
+        };
+
+    private:
+        struct CacheEntry
+        {
+            Kind kind;
+            std::uint64_t key, hash;
+            std::string text;
+            std::vector<unsigned char> terms; // EquationLibrary blob
+        };
+
+        std::vector<Node> nodes_;
+        std::map<std::string, size_t> by_name_;
+        std::map<std::string, CacheEntry> cache_;
+        BuildStats stats_;
+
+        int add(const std::string &name, Kind kind, const std::vector<size_t> &inputs, const Transform &transform,
+                const BuildArtifact &artifact);
+        bool set_source(const std::string &name, Kind kind, const BuildArtifact &artifact);
+
+    public:
+        static constexpr std::uint32_t kVersion = 1;
+
+        // Sources; -1 if the name is taken
+        int add_equation(const std::string &name, const std::vector<ContractionTerm> &terms);
+        int add_rule(const std::string &name, const std::string &fingerprint);
+
+        // -1 if the name is taken, an input does not precede the node or kind is a source kind
+        int add_node(const std::string &name, Kind kind, const std::vector<size_t> &inputs,
+                     const Transform &transform);
+
+        // Replace a source; false if there is no such source
+        bool set_equation(const std::string &name, const std::vector<ContractionTerm> &terms);
+        bool set_rule(const std::string &name, const std::string &fingerprint);
+
+        // force discards every artifact, as a full rebuild
+        void build(bool force = false);
+
+        // Node i alone; its inputs must have been built. Distinct nodes may
+        // be built on different threads. stats() is left to build().
+        Outcome build_node(size_t i, bool force = false);
+
+        // Drop the artifact of a node nothing will read again; it is rebuilt
+        // or reloaded from the cache on the next build
+        void release(size_t i);
+
+        // Nodes reachable from `name`, itself included, in order
+        std::vector<size_t> affected(const std::string &name) const;
+
+        // Accessors
+        int find(const std::string &name) const; // -1 if absent
+        const Node &node(size_t i) const { return nodes_[i]; }
+        const BuildArtifact &artifact(size_t i) const { return nodes_[i].artifact; }
+        size_t size() const { return nodes_.size(); }
+        const BuildStats &stats() const { return stats_; }
+
+        // Cache file; load() keeps entries for nodes registered later
+        bool save(const std::string &path) const;
+        bool load(const std::string &path);
+
+        static std::uint64_t content_hash(const BuildArtifact &artifact);
+
+        // Transform concatenating the terms of all inputs into one fused kernel;
+        // the generator's options belong in a rule input
+        static Transform fused_kernel(const std::string &name, const CodeGenerator &codegen);
+    };
+
+} // namespace qc
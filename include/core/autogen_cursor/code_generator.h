@@ -0,0 +1,138 @@
+#pragma once
+
+#include "contraction_term.h"
+#include "antisymmetry.h"
+#include "implicit_tensor.h"
+#include "field_inference.h"
+#include "layout.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Options controlling emitted kernels
+     */
+    struct CodeGenOptions
+    {
+        bool exploit_antisymmetry = true; // restricted loops and packed storage
+        bool fixed_dimensions = false;    // bake known SpaceRegistry sizes into kernels
+        bool blas = false;                // planned GEMM steps as CBLAS calls
+        std::string scalar_type = "double";                // real and imaginary tensors
+        std::string complex_type = "std::complex<double>"; // complex tensors only
+        std::string index_type = "long";
+    };
+
+    /**
+     * @brief Caller-controlled loop bounds for CodeGenerator::generate_loops
+     */
+    struct LoopBounds
+    {
+        std::set<std::string> fixed;                                       // indices bound by enclosing code
+        std::map<std::string, std::pair<std::string, std::string>> ranges; // label -> [lower, upper)
+
+        // Output stored as a row-major block over all of its indices:
+        // label -> {origin, extent}
+        std::map<std::string, std::pair<std::string, std::string>> output_block;
+    };
+
+    /**
+     * @brief Emits C++ loop kernels for contraction terms
+     *
+     * Arguments and accumulators are typed by FieldInference: real and
+     * imaginary tensors are scalar_type arrays, the latter holding the
+     * imaginary part, and complex arithmetic is emitted only for terms
+     * with a complex factor. Powers of i fold into the prefactor.
+     */
+    class CodeGenerator
+    {
+    private:
+        CodeGenOptions options_;
+        std::map<std::string, ImplicitTensor> implicit_;
+
+    public:
+        CodeGenerator(const CodeGenOptions &options = CodeGenOptions());
+
+        const CodeGenOptions &options() const { return options_; }
+
+        // Factors named like an implicit tensor are computed inside the loop
+        // nest from its diagonals instead of being read from memory
+        void add_implicit(const ImplicitTensor &tensor);
+        const ImplicitTensor *find_implicit(const Tensor &tensor) const;
+
+        // Helper functions shared by all kernels (emit once per file)
+        std::string preamble() const;
+
+        // Kernel computing output += prefactor * prod(factors)
+        std::string generate(const std::string &name, const ContractionTerm &term) const;
+
+        // Loop nest and update statement only, for embedding in larger kernels
+        std::string generate_loops(const ContractionTerm &term, const LoopBounds &bounds,
+                                   size_t depth) const;
+
+        // Terms of one TermFusion group as a single kernel: every output
+        // element is accumulated in a register over all terms and written
+        // once. Terms that cannot be fused are emitted one after the other.
+        std::string generate_fused(const std::string &name, const std::vector<ContractionTerm> &terms) const;
+        std::string generate_fused_loops(const std::vector<ContractionTerm> &terms, const LoopBounds &bounds,
+                                         size_t depth) const;
+
+        // Kernel for one step of a LayoutPlan. With options().blas, a real
+        // dense GEMM step without explicit permutes is a single CBLAS call
+        // carrying the planned trans flags; any other step is a loop nest
+        // over the planned storage orders.
+        std::string generate_step(const std::string &name, const ContractionDag &dag, const LayoutPlan &plan,
+                                  const LayoutStep &step) const;
+
+        // Sets "field" on every output to the field of all terms writing it,
+        // so that separate kernels over one output agree on its type
+        static void annotate_outputs(std::vector<ContractionTerm> &terms);
+
+        // Number of stored elements of a tensor, as a C++ expression
+        std::string storage_size(const Tensor &tensor) const;
+
+        // Dimension parameter of an orbital space, e.g. "n_occ"
+        static std::string dimension_name(int space);
+
+        // Identifier for a tensor argument
+        static std::string variable_name(const Tensor &tensor);
+
+    private:
+        struct Access
+        {
+            std::string setup;  // statements preceding the update
+            std::string offset; // element offset expression
+            std::string sign;   // runtime sign expression, "" if none
+            int static_sign;    // sign known at generation time
+        };
+
+        struct Summand
+        {
+            std::string setup;            // packed-offset statements
+            std::string signs;            // runtime sign expression
+            std::string product;          // " * x[...]" per factor
+            std::string implicit_product; // hoisted implicit factors
+            double prefactor;             // including static signs of the factors
+            Field field;                  // of the whole summand
+        };
+
+        RestrictedSummation::Plan make_plan(const ContractionTerm &term) const;
+        std::string signature(const std::string &name, const std::vector<ContractionTerm> &terms) const;
+        bool hoists_implicit(const ContractionTerm &term, const RestrictedSummation::Plan &plan,
+                             const LoopBounds &bounds) const;
+        std::string generate_loops(const ContractionTerm &term, const LoopBounds &bounds, size_t depth,
+                                   Field target) const;
+        Summand summand(const ContractionTerm &term, const RestrictedSummation::Plan &plan, bool epilogue,
+                        const std::string &tag) const;
+        Access access(const Tensor &tensor, const RestrictedSummation::Plan &plan,
+                      const std::string &tag) const;
+        std::vector<AntisymmetricGroup> storage_groups(const Tensor &tensor) const;
+        const std::string &value_type(Field field) const;
+        std::string lift(const std::string &value, Field field, Field target) const;
+        static Field output_field(const std::vector<ContractionTerm> &terms);
+    };
+
+} // namespace qc
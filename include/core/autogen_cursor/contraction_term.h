@@ -0,0 +1,56 @@
+#pragma once
+
+#include "tensor.h"
+#include "index.h"
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief A single contraction term: output += prefactor * prod(factors)
+     *
+     * Indices of the factors that do not appear on the output are summed over.
+     */
+    class ContractionTerm
+    {
+    private:
+        Tensor output_;
+        std::vector<Tensor> factors_;
+        double prefactor_;
+
+    public:
+        ContractionTerm(const Tensor &output, const std::vector<Tensor> &factors = {},
+                        double prefactor = 1.0);
+
+        // Accessors
+        const Tensor &output() const { return output_; }
+        const std::vector<Tensor> &factors() const { return factors_; }
+        const Tensor &factor(size_t i) const { return factors_[i]; }
+        size_t num_factors() const { return factors_.size(); }
+        double prefactor() const { return prefactor_; }
+
+        // Modifiers
+        void add_factor(const Tensor &factor) { factors_.push_back(factor); }
+        void set_factor(size_t i, const Tensor &factor);
+        void remove_factor(size_t i);
+        void set_output(const Tensor &output) { output_ = output; }
+        void set_prefactor(double prefactor) { prefactor_ = prefactor; }
+        void multiply_prefactor(double factor) { prefactor_ *= factor; }
+
+        // Index classification
+        IndexSet external_indices() const;
+        IndexSet summed_indices() const;
+        IndexSet loop_indices() const; // external followed by summed
+        bool is_summed(const std::string &label) const;
+
+        // Cost model (SpaceRegistry sizes; -1 if a dimension is unknown)
+        double flop_count() const;           // single loop nest over all indices
+        double optimized_flop_count() const; // best pairwise contraction order
+
+        // String representation
+        std::string to_string() const;
+    };
+
+} // namespace qc
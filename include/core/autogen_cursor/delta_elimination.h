@@ -0,0 +1,38 @@
+#pragma once
+
+#include "contraction_term.h"
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Removes Kronecker deltas from contraction terms by index substitution
+     *
+     * A delta d_pq with q summed is dropped after renaming q to p in every
+     * factor; the surviving index is the one in the smaller of two nested
+     * spaces. A delta between disjoint spaces (occupied and virtual) makes
+     * the term vanish. Deltas that cannot be removed this way, such as one
+     * between two external indices, are left in place.
+     */
+    class KroneckerDeltaElimination
+    {
+    public:
+        enum class Result
+        {
+            UNCHANGED,
+            SIMPLIFIED,
+            VANISHED
+        };
+
+        static bool is_delta(const Tensor &tensor);
+
+        // Eliminates the deltas of one term in place; a vanished term has a
+        // zero prefactor
+        static Result apply(ContractionTerm &term);
+
+        // Eliminates the deltas of all terms and drops the vanished ones
+        static std::vector<ContractionTerm> apply(const std::vector<ContractionTerm> &terms);
+    };
+
+} // namespace qc
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "contraction_term.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Named list of term blocks, in evaluation order
+     */
+    struct EquationSet
+    {
+        std::string name;
+        std::vector<std::pair<std::string, std::vector<ContractionTerm>>> blocks;
+    };
+
+    /**
+     * @brief Read-only views into a serialized equation library
+     *
+     * Views hold a pointer into the blob and read records on access, so
+     * looking up a set costs a directory scan and no allocation. The blob
+     * must outlive its views; materialize() copies into owning objects.
+     */
+    class EquationBlobView
+    {
+    protected:
+        const unsigned char *blob_ = nullptr;
+        std::uint32_t offset_ = 0;
+
+        std::uint32_t u32(std::uint32_t at) const;
+        std::string_view string(std::uint32_t at) const; // record offset stored at `at`
+
+    public:
+        EquationBlobView() = default;
+        EquationBlobView(const unsigned char *blob, std::uint32_t offset) : blob_(blob), offset_(offset) {}
+
+        bool valid() const { return blob_ != nullptr; }
+    };
+
+    class TensorRecordView : public EquationBlobView
+    {
+    public:
+        using EquationBlobView::EquationBlobView;
+
+        std::string_view name() const;
+        size_t rank() const;
+        std::string_view label(size_t i) const;
+        std::string_view space(size_t i) const; // empty if the index has none
+        Tensor materialize() const;
+    };
+
+    class TermRecordView : public EquationBlobView
+    {
+    public:
+        using EquationBlobView::EquationBlobView;
+
+        double prefactor() const;
+        TensorRecordView output() const;
+        size_t num_factors() const;
+        TensorRecordView factor(size_t i) const;
+        ContractionTerm materialize() const;
+    };
+
+    class BlockRecordView : public EquationBlobView
+    {
+    public:
+        using EquationBlobView::EquationBlobView;
+
+        std::string_view name() const;
+        size_t num_terms() const;
+        TermRecordView term(size_t i) const;
+        std::vector<ContractionTerm> materialize() const;
+    };
+
+    class EquationSetView : public EquationBlobView
+    {
+    public:
+        using EquationBlobView::EquationBlobView;
+
+        std::string_view name() const;
+        size_t num_blocks() const;
+        BlockRecordView block(size_t i) const;
+        BlockRecordView block(std::string_view name) const; // invalid view if absent
+
+        // Spaces named by the indices, in first-use order. materialize()
+        // registers any that are unknown, so callers that materialize on
+        // several threads register these first.
+        std::vector<std::string> spaces() const;
+        EquationSet materialize() const;
+    };
+
+    /**
+     * @brief Binary equation library and the sets embedded at build time
+     *
+     * Layout (native byte order, offsets from the blob start):
+     *
+     *   header   "QCEQ", version, number of sets, offset of the set table
+     *   strings  length, bytes                          (deduplicated)
+     *   tensors  name, type, rank, properties, indices  (deduplicated)
+     *   factors  tensor offsets per term
+     *   terms    prefactor, output, factor count, factor list
+     *   blocks   name, term count, first term
+     *   sets     name, block count, first block
+     *
+     * With QC_BUILTIN_EQUATIONS on, the default except in cross builds,
+     * qc_equation_builder runs derive_builtin() with the library itself
+     * and embeds the blob, so load_builtin() does not re-derive anything.
+     * Without it, the first load_builtin() derives and serializes the sets
+     * once.
+     *
+     * The builtin sets are the (T) and CCSD density equations. The CCSD,
+     * EOM-CCSD and Lambda-CCSD amplitude equations are not included: the
+     * tree has no generator for them.
+     */
+    class EquationLibrary
+    {
+    public:
+        static constexpr std::uint32_t kVersion = 1;
+
+        static std::vector<unsigned char> serialize(const std::vector<EquationSet> &sets);
+
+        // Blob validation and lookup; invalid view if absent or malformed.
+        // is_valid() checks that every set, block, term, tensor and string
+        // record lies inside the blob, so views of a valid blob never read
+        // past its end. find() and names() validate on every call.
+        static bool is_valid(const unsigned char *blob, size_t size);
+        static EquationSetView find(const unsigned char *blob, size_t size, std::string_view name);
+        static std::vector<std::string> names(const unsigned char *blob, size_t size);
+
+        // Sets embedded in the binary
+        static EquationSetView load_builtin(std::string_view name);
+        static std::vector<std::string> builtin_names();
+
+        // Sets derived by the build: ccsd_t, ccsd_d1, ccsd_d2. There are no
+        // ccsd, eom_ccsd or lambda_ccsd amplitude sets.
+        static std::vector<EquationSet> derive_builtin();
+
+        // C++ source defining the embedded blob
+        static std::string to_source(const std::vector<unsigned char> &blob);
+    };
+
+} // namespace qc
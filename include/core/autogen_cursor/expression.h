@@ -131,13 +131,13 @@ namespace qc
     class OperatorExpression : public Expression
     {
     private:
-        std::unique_ptr<Operator> operator_;
+        std::unique_ptr<Operator> op_;
 
     public:
         OperatorExpression(const Operator &op);
         OperatorExpression(std::unique_ptr<Operator> op);
 
-        const Operator &operator_() const { return *operator_; }
+        const Operator &operator_() const { return *op_; }
 
         std::string to_string() const override;
         std::unique_ptr<Expression> clone() const override;
@@ -264,6 +264,25 @@ namespace qc
         std::size_t hash() const override;
     };
 
+    /**
+     * @brief Product expression (n-ary multiplication)
+     */
+    class ProductExpression : public Expression
+    {
+    public:
+        ProductExpression();
+        ProductExpression(std::vector<std::unique_ptr<Expression>> factors);
+
+        void add_factor(std::unique_ptr<Expression> factor);
+
+        size_t num_factors() const { return children_.size(); }
+
+        std::string to_string() const override;
+        std::unique_ptr<Expression> clone() const override;
+        std::unique_ptr<Expression> derivative(const Symbol &var) const override;
+        bool equals(const Expression &other) const override;
+    };
+
     /**
      * @brief Tensor contraction expression
      */
@@ -340,6 +359,7 @@ namespace qc
 
         // Aggregate operations
         std::unique_ptr<Expression> sum(const std::vector<std::unique_ptr<Expression>> &terms);
+        std::unique_ptr<Expression> product(std::vector<std::unique_ptr<Expression>> factors);
         std::unique_ptr<Expression> index_sum(std::unique_ptr<Expression> expr,
                                               const Index &sum_index);
 
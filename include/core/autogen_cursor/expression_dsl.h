@@ -0,0 +1,519 @@
+#pragma once
+
+#include "expression.h"
+#include "contraction_term.h"
+#include <array>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Embedded expression-template language for tensor equations
+     *
+     * Indices are empty objects whose type carries their space and label,
+     * and a tensor called with indices yields a node whose type carries
+     * the index structure:
+     *
+     *   using namespace qc::dsl;
+     *   constexpr Occupied<'i'> i;  constexpr Occupied<'j'> j;
+     *   constexpr Virtual<'a'> a;   constexpr Virtual<'b'> b;
+     *   const TensorHandle<4> r2("r2"), t2("t2"), v("v");
+     *
+     *   auto terms = equation(r2(i, j, a, b), v(a, b, i, j) + 0.5 * t2(i, j, c, d) * v(c, d, a, b));
+     *   auto expr = expression(t2(i, j, a, b) * v(a, b, i, j));
+     *
+     * Wrong tensor ranks, an index appearing more than twice in a product,
+     * one label used for two spaces, summation indices reused across the
+     * factors of a product, and sums or equations whose sides have
+     * different free indices do not compile. equation() expands products
+     * of sums and writes the ContractionTerms in one pass into storage
+     * sized from the expression type; expression() builds the Expression
+     * tree bottom-up without cloning. Nodes hold a pointer to the name of
+     * their TensorHandle, which must outlive them.
+     */
+    namespace dsl
+    {
+
+        struct IndexKey
+        {
+            Index::Type type;
+            char label;
+            int number;
+        };
+
+        constexpr bool same_label(const IndexKey &a, const IndexKey &b)
+        {
+            return a.label == b.label && a.number == b.number;
+        }
+
+        /**
+         * @brief Index of a space, labelled Label followed by Number if nonzero
+         */
+        template <Index::Type T, char Label, int Number = 0>
+        struct Idx
+        {
+            static_assert(Number >= 0, "index numbers must be non-negative");
+
+            static constexpr IndexKey key{T, Label, Number};
+
+            // Built once per index type
+            static const Index &index()
+            {
+                static const Index idx(Number ? std::string(1, Label) + std::to_string(Number) : std::string(1, Label), T);
+                return idx;
+            }
+        };
+
+        template <char Label, int Number = 0>
+        using Occupied = Idx<Index::Type::OCCUPIED, Label, Number>;
+        template <char Label, int Number = 0>
+        using Virtual = Idx<Index::Type::VIRTUAL, Label, Number>;
+        template <char Label, int Number = 0>
+        using General = Idx<Index::Type::GENERAL, Label, Number>;
+
+        template <typename T>
+        struct is_index : std::false_type
+        {
+        };
+        template <Index::Type T, char Label, int Number>
+        struct is_index<Idx<T, Label, Number>> : std::true_type
+        {
+        };
+
+        template <typename... Is>
+        struct IndexList
+        {
+            static constexpr size_t size = sizeof...(Is);
+            static constexpr std::array<IndexKey, sizeof...(Is)> keys{{Is::key...}};
+
+            static IndexSet index_set() { return IndexSet(std::vector<Index>{Is::index()...}); }
+        };
+
+        namespace detail
+        {
+            template <typename L>
+            constexpr size_t count(const IndexKey &key)
+            {
+                size_t n = 0;
+                for (size_t i = 0; i < L::size; ++i)
+                    n += same_label(L::keys[i], key);
+                return n;
+            }
+
+            template <typename L>
+            constexpr size_t max_count()
+            {
+                size_t n = 0;
+                for (size_t i = 0; i < L::size; ++i)
+                    n = count<L>(L::keys[i]) > n ? count<L>(L::keys[i]) : n;
+                return n;
+            }
+
+            // Every label names a single space
+            template <typename L>
+            constexpr bool consistent()
+            {
+                for (size_t i = 0; i < L::size; ++i)
+                {
+                    for (size_t j = i + 1; j < L::size; ++j)
+                    {
+                        if (same_label(L::keys[i], L::keys[j]) && L::keys[i].type != L::keys[j].type)
+                            return false;
+                    }
+                }
+                return true;
+            }
+
+            template <typename A, typename B>
+            constexpr bool disjoint()
+            {
+                for (size_t i = 0; i < A::size; ++i)
+                {
+                    if (count<B>(A::keys[i]))
+                        return false;
+                }
+                return true;
+            }
+
+            // Equal as sets of (label, space); both lists are free of repeats
+            template <typename A, typename B>
+            constexpr bool same_set()
+            {
+                if (A::size != B::size)
+                    return false;
+                for (size_t i = 0; i < A::size; ++i)
+                {
+                    bool found = false;
+                    for (size_t j = 0; j < B::size; ++j)
+                        found = found || (same_label(A::keys[i], B::keys[j]) && A::keys[i].type == B::keys[j].type);
+                    if (!found)
+                        return false;
+                }
+                return true;
+            }
+
+            enum class Filter
+            {
+                SINGLE,   // labels occurring once
+                REPEATED, // first occurrence of labels occurring more than once
+                UNIQUE    // first occurrence of every label
+            };
+
+            template <size_t N>
+            struct Selection
+            {
+                std::array<size_t, N> positions{};
+                size_t size = 0;
+            };
+
+            template <typename L, Filter F>
+            constexpr Selection<L::size> select()
+            {
+                Selection<L::size> result{};
+                for (size_t i = 0; i < L::size; ++i)
+                {
+                    bool first = true;
+                    for (size_t j = 0; j < i; ++j)
+                        first = first && !same_label(L::keys[j], L::keys[i]);
+                    size_t n = count<L>(L::keys[i]);
+                    bool keep = F == Filter::SINGLE ? n == 1 : (F == Filter::REPEATED ? n > 1 && first : first);
+                    if (keep)
+                        result.positions[result.size++] = i;
+                }
+                return result;
+            }
+
+            template <typename L, Filter F, typename Sequence>
+            struct SelectImpl;
+
+            template <typename... Is, Filter F, size_t... K>
+            struct SelectImpl<IndexList<Is...>, F, std::index_sequence<K...>>
+            {
+                static constexpr auto selection = select<IndexList<Is...>, F>();
+                using type = IndexList<std::tuple_element_t<selection.positions[K], std::tuple<Is...>>...>;
+            };
+
+            template <typename L, Filter F>
+            using Select = typename SelectImpl<L, F, std::make_index_sequence<select<L, F>().size>>::type;
+
+            template <typename... Ls>
+            struct ConcatImpl
+            {
+                using type = IndexList<>;
+            };
+
+            template <typename... Is>
+            struct ConcatImpl<IndexList<Is...>>
+            {
+                using type = IndexList<Is...>;
+            };
+
+            template <typename... As, typename... Bs, typename... Rest>
+            struct ConcatImpl<IndexList<As...>, IndexList<Bs...>, Rest...>
+            {
+                using type = typename ConcatImpl<IndexList<As..., Bs...>, Rest...>::type;
+            };
+
+            template <typename... Ls>
+            using Concat = typename ConcatImpl<Ls...>::type;
+
+            constexpr size_t max(size_t a, size_t b) { return a > b ? a : b; }
+        }
+
+        /**
+         * @brief Base of all expression nodes
+         *
+         * Every node D provides the index lists D::Free (uncontracted, in
+         * order of appearance) and D::Bound (summed inside D), the term
+         * count and the most factors of a term after expansion, emit() for
+         * equation() and build() for expression().
+         */
+        template <typename D>
+        struct Node
+        {
+            const D &self() const { return static_cast<const D &>(*this); }
+
+            // A sum flattens its operands into one SumExpression
+            void append(SumExpression &sum, double coefficient) const
+            {
+                sum.add_term(self().build(), coefficient);
+            }
+        };
+
+        /**
+         * @brief A tensor with its indices
+         */
+        template <typename... Is>
+        class TensorRef : public Node<TensorRef<Is...>>
+        {
+        private:
+            using All = IndexList<Is...>;
+
+            const std::string *name_;
+            Tensor::Type type_;
+
+            static_assert(detail::consistent<All>(), "an index label is used for two different spaces");
+            static_assert(detail::max_count<All>() <= 2, "an index appears more than twice in a tensor");
+
+        public:
+            using Free = detail::Select<All, detail::Filter::SINGLE>;
+            using Bound = detail::Select<All, detail::Filter::REPEATED>;
+            static constexpr size_t num_terms = 1;
+            static constexpr size_t max_factors = 1;
+
+            TensorRef(const std::string &name, Tensor::Type type) : name_(&name), type_(type) {}
+
+            Tensor tensor() const { return Tensor(*name_, All::index_set(), type_); }
+
+            template <typename Sink>
+            void emit(double prefactor, std::vector<Tensor> &factors, Sink &&sink) const
+            {
+                factors.push_back(tensor());
+                sink(prefactor, factors);
+                factors.pop_back();
+            }
+
+            std::unique_ptr<Expression> build() const
+            {
+                return std::make_unique<TensorExpression>(std::make_unique<Tensor>(tensor()));
+            }
+        };
+
+        /**
+         * @brief A named tensor of fixed rank; calling it with indices makes a TensorRef
+         */
+        template <size_t N>
+        class TensorHandle
+        {
+        private:
+            std::string name_;
+            Tensor::Type type_;
+
+        public:
+            explicit TensorHandle(const std::string &name, Tensor::Type type = Tensor::Type::GENERAL)
+                : name_(name), type_(type) {}
+
+            const std::string &name() const { return name_; }
+            Tensor::Type type() const { return type_; }
+
+            template <typename... Is>
+            auto operator()(Is...) const
+            {
+                static_assert(std::conjunction<is_index<Is>...>::value, "tensor arguments must be dsl indices");
+                static_assert(sizeof...(Is) == N, "tensor called with the wrong number of indices");
+                return TensorRef<Is...>(name_, type_);
+            }
+        };
+
+        /**
+         * @brief Constant times an expression
+         */
+        template <typename A>
+        class Scaled : public Node<Scaled<A>>
+        {
+        private:
+            double coefficient_;
+            A operand_;
+
+        public:
+            using Free = typename A::Free;
+            using Bound = typename A::Bound;
+            static constexpr size_t num_terms = A::num_terms;
+            static constexpr size_t max_factors = A::max_factors;
+
+            Scaled(double coefficient, const A &operand) : coefficient_(coefficient), operand_(operand) {}
+
+            double coefficient() const { return coefficient_; }
+            const A &operand() const { return operand_; }
+
+            template <typename Sink>
+            void emit(double prefactor, std::vector<Tensor> &factors, Sink &&sink) const
+            {
+                operand_.emit(prefactor * coefficient_, factors, sink);
+            }
+
+            std::unique_ptr<Expression> build() const
+            {
+                return ExpressionFactory::multiply(ExpressionFactory::constant(coefficient_), operand_.build());
+            }
+
+            void append(SumExpression &sum, double coefficient) const
+            {
+                operand_.append(sum, coefficient * coefficient_);
+            }
+        };
+
+        /**
+         * @brief Product of two expressions, summed over their shared indices
+         */
+        template <typename A, typename B>
+        class Product : public Node<Product<A, B>>
+        {
+        private:
+            using Joined = detail::Concat<typename A::Free, typename B::Free>;
+
+            A left_;
+            B right_;
+
+            static_assert(detail::consistent<detail::Concat<Joined, typename A::Bound, typename B::Bound>>(),
+                          "an index label is used for two different spaces");
+            static_assert(detail::max_count<Joined>() <= 2, "an index appears more than twice in a product");
+            static_assert(detail::disjoint<typename A::Bound, detail::Concat<typename B::Free, typename B::Bound>>() &&
+                              detail::disjoint<typename B::Bound, typename A::Free>(),
+                          "a summation index is reused in another factor of a product");
+
+        public:
+            using Contracted = detail::Select<Joined, detail::Filter::REPEATED>;
+            using Free = detail::Select<Joined, detail::Filter::SINGLE>;
+            using Bound = detail::Concat<typename A::Bound, typename B::Bound, Contracted>;
+            static constexpr size_t num_terms = A::num_terms * B::num_terms;
+            static constexpr size_t max_factors = A::max_factors + B::max_factors;
+
+            Product(const A &left, const B &right) : left_(left), right_(right) {}
+
+            template <typename Sink>
+            void emit(double prefactor, std::vector<Tensor> &factors, Sink &&sink) const
+            {
+                left_.emit(prefactor, factors, [&](double p, std::vector<Tensor> &f)
+                           { right_.emit(p, f, sink); });
+            }
+
+            std::unique_ptr<Expression> build() const
+            {
+                if constexpr (Contracted::size > 0)
+                    return ExpressionFactory::contract(left_.build(), right_.build(), Contracted::index_set());
+                else
+                    return ExpressionFactory::multiply(left_.build(), right_.build());
+            }
+        };
+
+        /**
+         * @brief Sum of two expressions with the same free indices
+         */
+        template <typename A, typename B>
+        class Sum : public Node<Sum<A, B>>
+        {
+        private:
+            A left_;
+            B right_;
+
+            static_assert(detail::same_set<typename A::Free, typename B::Free>(),
+                          "the terms of a sum have different free indices");
+
+        public:
+            using Free = typename A::Free;
+            using Bound = detail::Select<detail::Concat<typename A::Bound, typename B::Bound>, detail::Filter::UNIQUE>;
+            static constexpr size_t num_terms = A::num_terms + B::num_terms;
+            static constexpr size_t max_factors = detail::max(A::max_factors, B::max_factors);
+
+            Sum(const A &left, const B &right) : left_(left), right_(right) {}
+
+            template <typename Sink>
+            void emit(double prefactor, std::vector<Tensor> &factors, Sink &&sink) const
+            {
+                left_.emit(prefactor, factors, sink);
+                right_.emit(prefactor, factors, sink);
+            }
+
+            std::unique_ptr<Expression> build() const
+            {
+                auto sum = std::make_unique<SumExpression>();
+                append(*sum, 1.0);
+                return sum;
+            }
+
+            void append(SumExpression &sum, double coefficient) const
+            {
+                left_.append(sum, coefficient);
+                right_.append(sum, coefficient);
+            }
+        };
+
+        template <typename A, typename B>
+        Product<A, B> operator*(const Node<A> &left, const Node<B> &right)
+        {
+            return Product<A, B>(left.self(), right.self());
+        }
+
+        template <typename A>
+        Scaled<A> operator*(double coefficient, const Node<A> &operand)
+        {
+            return Scaled<A>(coefficient, operand.self());
+        }
+
+        template <typename A>
+        Scaled<A> operator*(const Node<A> &operand, double coefficient)
+        {
+            return Scaled<A>(coefficient, operand.self());
+        }
+
+        template <typename A>
+        Scaled<A> operator*(double coefficient, const Scaled<A> &operand)
+        {
+            return Scaled<A>(coefficient * operand.coefficient(), operand.operand());
+        }
+
+        template <typename A>
+        Scaled<A> operator-(const Node<A> &operand)
+        {
+            return Scaled<A>(-1.0, operand.self());
+        }
+
+        template <typename A, typename B>
+        Sum<A, B> operator+(const Node<A> &left, const Node<B> &right)
+        {
+            return Sum<A, B>(left.self(), right.self());
+        }
+
+        template <typename A, typename B>
+        Sum<A, Scaled<B>> operator-(const Node<A> &left, const Node<B> &right)
+        {
+            return Sum<A, Scaled<B>>(left.self(), Scaled<B>(-1.0, right.self()));
+        }
+
+        /**
+         * @brief Appends output += rhs to terms, one term per product of the expansion
+         */
+        template <typename... Ls, typename R>
+        void equation(std::vector<ContractionTerm> &terms, const TensorRef<Ls...> &lhs, const Node<R> &rhs)
+        {
+            using Output = IndexList<Ls...>;
+            static_assert(detail::max_count<Output>() == (Output::size ? 1 : 0), "an output index is repeated");
+            static_assert(detail::same_set<Output, typename R::Free>(),
+                          "the free indices of the right-hand side differ from the output indices");
+            static_assert(detail::disjoint<Output, typename R::Bound>(), "an output index is also summed over");
+
+            const Tensor output = lhs.tensor();
+            std::vector<Tensor> factors;
+            factors.reserve(R::max_factors);
+            terms.reserve(terms.size() + R::num_terms);
+            rhs.self().emit(1.0, factors, [&](double prefactor, const std::vector<Tensor> &f)
+                            { terms.emplace_back(output, f, prefactor); });
+        }
+
+        template <typename... Ls, typename R>
+        std::vector<ContractionTerm> equation(const TensorRef<Ls...> &lhs, const Node<R> &rhs)
+        {
+            std::vector<ContractionTerm> terms;
+            equation(terms, lhs, rhs);
+            return terms;
+        }
+
+        /**
+         * @brief The Expression tree of e; sums are flattened into one SumExpression
+         */
+        template <typename E>
+        std::unique_ptr<Expression> expression(const Node<E> &e)
+        {
+            return e.self().build();
+        }
+
+    } // namespace dsl
+
+} // namespace qc
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "expression.h"
+#include "contraction_term.h"
+#include "operator.h"
+
+namespace qc
+{
+
+    /**
+     * @brief Number field of a tensor or expression
+     *
+     * IMAGINARY values are stored as their imaginary part, so real and
+     * imaginary tensors both use real arithmetic.
+     */
+    enum class Field
+    {
+        REAL,
+        IMAGINARY,
+        COMPLEX
+    };
+
+    /**
+     * @brief Field of a contraction term
+     *
+     * The term is sign * (i if imaginary_unit) * prefactor * the product
+     * of the stored factors, with imaginary factors read as their
+     * imaginary parts. The sign collects i * i = -1 and conj(i x) = -i x
+     * over conjugated imaginary factors.
+     */
+    struct TermField
+    {
+        Field field = Field::REAL;
+        int sign = 1;
+        bool imaginary_unit = false;
+    };
+
+    /**
+     * @brief Real / imaginary / complex inference over tensors and expressions
+     *
+     * Tensors and operators declare their field with the property "field"
+     * ("real", "imaginary" or "complex"); without it they are real.
+     * Products follow real * x = x, i * i = real and complex * x =
+     * complex; sums of different fields are complex. A hermitian conjugate
+     * keeps the field of its operator.
+     */
+    class FieldInference
+    {
+    public:
+        static Field of(const Tensor &tensor);
+        static Field of(const Operator &op);
+        static Field of(const Symbol &symbol);
+        static Field of(const Expression &expr);
+        static TermField of(const ContractionTerm &term);
+
+        static void set(Tensor &tensor, Field field);
+        static void set(Operator &op, Field field);
+
+        // Writes "field" on every node of the tree
+        static void annotate(Expression &expr);
+
+        static Field product(Field a, Field b);
+        static Field sum(Field a, Field b);
+
+        static const char *name(Field field); // "real", "imaginary", "complex"
+        static Field parse(const std::string &name); // unknown names are real
+    };
+
+} // namespace qc
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "expression.h"
+#include <memory>
+
+namespace qc
+{
+
+    /**
+     * @brief Arithmetic operations to evaluate an expression tree as written
+     *
+     * An n-term sum costs n - 1 additions plus one multiplication per
+     * coefficient other than +-1; an n-factor product costs n - 1
+     * multiplications, a factor of -1 none. Other inner nodes cost one
+     * operation each.
+     */
+    struct OperationCount
+    {
+        size_t multiplications = 0;
+        size_t additions = 0; // subtractions included
+        size_t other = 0;     // divisions, powers, contractions, commutators, ...
+
+        size_t total() const { return multiplications + additions + other; }
+    };
+
+    /**
+     * @brief Counters of the last HornerFactorization::apply
+     */
+    struct HornerStats
+    {
+        OperationCount before;
+        OperationCount after;
+        size_t factorizations = 0; // factors pulled out of a sum
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Greedy multivariate Horner factorization of sums
+     *
+     * Every sum, innermost first, is factored by pulling out the factor
+     * that occurs in the most terms (symbols before numeric coefficients
+     * on ties), a*x + b*x*y + c -> x*(a + b*y) + c, and recursing into
+     * the quotient and the remaining terms. A numeric coefficient shared
+     * by several terms counts as a factor, so 0.5*a + 0.5*b becomes
+     * 0.5*(a + b). Integer powers up to x^16 count as repeated factors, so
+     * a*x^3 + b*x^2 + c*x becomes x*(c + x*(b + a*x)), and equal factors
+     * left in a product are written back as a power. A factorization is
+     * kept only if it lowers the operation count of the sum, so the pass
+     * stops when pulling out another factor would not save operations. The
+     * result is in ACNormalizer form; terms that do not commute are left
+     * as they are.
+     */
+    class HornerFactorization
+    {
+    private:
+        HornerStats stats_;
+
+    public:
+        std::unique_ptr<Expression> apply(const Expression &expr);
+
+        const HornerStats &stats() const { return stats_; }
+
+        static OperationCount count(const Expression &expr);
+    };
+
+} // namespace qc
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "tensor.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief A tensor whose elements are computed on demand from diagonals
+     *
+     * Elements have the form
+     *
+     *   D(p_1, ..., p_n) = shift + sum_k sign_k e_{space_k}[p_k]
+     *
+     * optionally inverted. The energy denominator
+     * 1 / (e_i + e_j - e_a - e_b) of an amplitude update is the common case.
+     * Consumers evaluate the element inside their own loop instead of
+     * reading a stored array of the size of the amplitudes.
+     */
+    class ImplicitTensor
+    {
+    public:
+        struct DiagonalTerm
+        {
+            size_t position; // index slot of the tensor
+            int space;       // SpaceRegistry id selecting the diagonal
+            double sign;
+        };
+
+    private:
+        Tensor tensor_;
+        std::vector<DiagonalTerm> terms_;
+        double shift_;
+        bool reciprocal_;
+
+    public:
+        ImplicitTensor(const Tensor &tensor, const std::vector<DiagonalTerm> &terms,
+                       double shift = 0.0, bool reciprocal = false);
+
+        // Occupied slots enter with +1, all others with -1
+        static ImplicitTensor denominator(const Tensor &tensor, bool reciprocal = true, double shift = 0.0);
+
+        // Accessors
+        const Tensor &tensor() const { return tensor_; }
+        const std::string &name() const { return tensor_.symbol().name(); }
+        const std::vector<DiagonalTerm> &terms() const { return terms_; }
+        double shift() const { return shift_; }
+        bool reciprocal() const { return reciprocal_; }
+
+        // Diagonal vectors read by the element, as variable names ("e_occ", ...)
+        static std::string source_name(int space);
+        std::vector<std::string> sources() const;
+        std::vector<int> source_spaces() const;
+
+        // C++ expression of the element with the slots bound to `labels`
+        std::string element_expression(const std::vector<std::string> &labels) const;
+
+        // Numeric element; `diagonals` maps a space id to its diagonal. NaN
+        // if a diagonal of the element is missing or a slot has no value.
+        double element(const std::vector<long> &values, const std::map<int, const double *> &diagonals) const;
+    };
+
+} // namespace qc
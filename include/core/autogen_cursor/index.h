@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../index_notation/index_attributes.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -14,6 +15,8 @@ namespace qc
     class Index
     {
     public:
+        using Attribute = MetaWaveCompiler::index_notation::IndexAttribute;
+
         enum class Type
         {
             OCCUPIED, // occupied orbital indices (i, j, k, ...)
@@ -36,6 +39,8 @@ namespace qc
         int range_start_;
         int range_end_;
         Symmetry symmetry_;
+        int space_id_ = -1; // SpaceRegistry id, -1 derives the space from type_
+        Attribute attributes_ = Attribute::none;
 
     public:
         Index(const std::string &label, Type type = Type::GENERAL,
@@ -48,10 +53,26 @@ namespace qc
         int range_start() const { return range_start_; }
         int range_end() const { return range_end_; }
         Symmetry symmetry() const { return symmetry_; }
+        int space_id() const { return space_id_; }
+        Attribute attributes() const { return attributes_; }
 
         // Setters
         void set_range(int start, int end);
         void set_symmetry(Symmetry sym) { symmetry_ = sym; }
+        void set_space_id(int space_id) { space_id_ = space_id; }
+        void set_attributes(Attribute attributes) { attributes_ = attributes; }
+
+        // Kramers partner of a spinor index: barred (time-reversed) or
+        // unbarred; an index with neither runs over both
+        bool is_barred() const { return MetaWaveCompiler::index_notation::is_barred(attributes_); }
+        bool is_unbarred() const { return MetaWaveCompiler::index_notation::is_unbarred(attributes_); }
+        void set_barred(bool barred)
+        {
+            const auto kramers = static_cast<std::uint64_t>(Attribute::is_barred) |
+                                 static_cast<std::uint64_t>(Attribute::is_unbarred);
+            const auto bit = static_cast<std::uint64_t>(barred ? Attribute::is_barred : Attribute::is_unbarred);
+            attributes_ = static_cast<Attribute>((static_cast<std::uint64_t>(attributes_) & ~kramers) | bit);
+        }
 
         // Type checking
         bool is_occupied() const { return type_ == Type::OCCUPIED; }
@@ -142,6 +163,9 @@ namespace qc
         Index spin(const std::string &label);
         Index spatial(const std::string &label, int range_end = -1);
 
+        // Index in a named space of the global SpaceRegistry
+        Index in_space(const std::string &label, const std::string &space);
+
         // Create sets of indices
         IndexSet occupied_set(const std::vector<std::string> &labels);
         IndexSet virtual_set(const std::vector<std::string> &labels);
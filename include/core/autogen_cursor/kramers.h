@@ -0,0 +1,62 @@
+#pragma once
+
+#include "tensor.h"
+#include "contraction_term.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Kramers-pair (barred / unbarred) reduction of spinor equations
+     *
+     * In a Kramers-restricted spinor basis every spinor p has a partner
+     * p-bar = K p under the time-reversal operator K, with K p-bar = -p.
+     * A tensor of a time-even operator over such a basis obeys
+     *
+     *   T[m] = (-1)^|m| conj(T[~m])
+     *
+     * where m marks the barred positions and ~m flips every bar. Of the
+     * 2^n bar patterns of a rank-n tensor only the 2^(n-1) with an
+     * unbarred first index are stored; the others are read from their
+     * partner with the sign and a complex conjugation.
+     *
+     * Tensors opt in with the property "time_reversal" = "symmetric".
+     * Expanded factors carry "kramers_block" ("ub" for T[p q-bar]) and,
+     * when read through the relation, "conjugate" = "true".
+     */
+    class KramersSymmetry
+    {
+    public:
+        static bool is_symmetric(const Tensor &tensor);
+
+        // Bit k set when index k is barred
+        static std::uint64_t pattern(const Tensor &tensor);
+        static std::string block_label(std::uint64_t pattern, size_t rank); // "ub"
+
+        // Unique blocks keep their first index unbarred
+        static bool is_canonical(std::uint64_t pattern) { return (pattern & 1) == 0; }
+        static size_t num_unique_blocks(size_t rank) { return rank == 0 ? 1 : size_t(1) << (rank - 1); }
+
+        // The stored block holding `tensor`: its indices have every bar
+        // flipped when `tensor` is not canonical, the sign is returned and
+        // the conjugation toggled. Non-symmetric tensors come back as they are.
+        static Tensor canonical(const Tensor &tensor, int &sign);
+
+        // Name a numeric block is bound under: "t2[uubb]", or the tensor
+        // name for tensors without a Kramers block
+        static std::string storage_name(const Tensor &tensor);
+        static std::string storage_name(const std::string &name, const std::string &block);
+
+        // One term per bar assignment of the indices that have none,
+        // restricted to the unique output blocks when the output is
+        // time-reversal symmetric. Every symmetric factor is replaced by
+        // its stored block, and terms with a Kronecker delta between a
+        // barred and an unbarred index are dropped.
+        static std::vector<ContractionTerm> expand(const ContractionTerm &term);
+        static std::vector<ContractionTerm> expand(const std::vector<ContractionTerm> &terms);
+    };
+
+} // namespace qc
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "contraction_term.h"
+#include "code_generator.h"
+#include "implicit_tensor.h"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Exponential sum 1/x ~ sum_k w_k exp(-t_k x) on [x_min, x_max]
+     */
+    struct LaplaceQuadrature
+    {
+        std::vector<double> points;  // t_k
+        std::vector<double> weights; // w_k
+        double x_min = 0.0, x_max = 0.0;
+        double error = 0.0; // max |1 - x sum_k w_k exp(-t_k x)| over the range
+
+        size_t size() const { return points.size(); }
+        double operator()(double x) const;
+    };
+
+    /**
+     * @brief Options for the Laplace rewrite of energy denominators
+     */
+    struct LaplaceOptions
+    {
+        std::string space = "laplace"; // orbital space of the quadrature index, sized by the rule;
+                                       // taken as space_2, ... when sized for another quadrature
+        std::string label = "z";
+        bool negative = true;     // D < 0, as for ImplicitTensor::denominator (e_i + e_j - e_a - e_b)
+        bool require_gain = true; // rewrite only when the cost model confirms a lower flop count
+        bool openmp = true;       // quadrature points in parallel
+    };
+
+    /**
+     * @brief Laplace factorization of a reciprocal denominator
+     *
+     * For D = shift + sum_k s_k e[p_k] of one sign,
+     *
+     *   1/D = -sum_z w_z exp(t_z D)   (D < 0),
+     *
+     * which factorizes into one exponential per index. apply() replaces
+     * the denominator factor of a term by
+     *
+     *   laplace_<space>_w(z, p_0) * prod_{k > 0} laplace_<space>(z, p_k)
+     *
+     * with the weight and exp(t_z shift) carried by the first factor, and
+     * z summed over the quadrature. The remaining contraction no longer
+     * couples all indices at once, so e.g. the DF-MP2 energy drops from
+     * o^2 v^2 N_aux to n_z o v N_aux^2. A space must enter the denominator
+     * with a single sign.
+     */
+    class LaplaceFactorization
+    {
+    private:
+        ImplicitTensor denominator_;
+        LaplaceQuadrature quadrature_;
+        LaplaceOptions options_;
+
+        struct Step
+        {
+            ContractionTerm term;
+            double flops;
+        };
+
+        // Pairwise contraction order of one quadrature point, z fixed
+        std::vector<Step> steps(const ContractionTerm &rewritten, const Tensor &output) const;
+        // Contractions of `remaining` into `output` in the best pairwise order
+        static void pairwise(std::vector<Tensor> remaining, const Tensor &output, double prefactor, int &count,
+                             std::vector<Step> &result);
+        Tensor slice(const Tensor &factor) const;
+        int sign_of(int space) const; // 0 if the space is absent or has both signs
+
+    public:
+        LaplaceFactorization(const ImplicitTensor &denominator, const LaplaceQuadrature &quadrature,
+                             const LaplaceOptions &options = LaplaceOptions());
+
+        const LaplaceQuadrature &quadrature() const { return quadrature_; }
+        const LaplaceOptions &options() const { return options_; } // space as registered
+
+        // Minimax fit with n points. The one-point fit (Lawson reweighting,
+        // then Remez exchange) is continued point by point, each Remez
+        // exchange seeded from the previous equioscillating fit, so the
+        // error does not grow with n.
+        static LaplaceQuadrature minimax(size_t n, double x_min, double x_max);
+
+        // Fewest points reaching `tolerance`, at most max_points, in one pass
+        // of the same continuation. Stops early once another point no longer
+        // lowers the error, which rounding bounds near 1e-13.
+        static LaplaceQuadrature fit(double x_min, double x_max, double tolerance, size_t max_points = 24);
+
+        // Range of |D| over the diagonals (space id -> values); {-1, -1} if D changes sign
+        static std::pair<double, double> spectral_range(const ImplicitTensor &denominator,
+                                                        const std::map<int, std::vector<double>> &diagonals);
+
+        // Returns false if the term has no reciprocal denominator factor, a
+        // space enters with both signs, or the gain is not confirmed
+        bool apply(ContractionTerm &term) const;
+        std::vector<ContractionTerm> apply(const std::vector<ContractionTerm> &terms) const;
+
+        // n_z times the pairwise cost of one quadrature point; -1 if a size is unknown
+        double flop_count(const ContractionTerm &rewritten) const;
+
+        // Cost of the term as written, denominator included, in its best
+        // pairwise order: what apply() must beat; -1 if a size is unknown
+        static double direct_flop_count(const ContractionTerm &term);
+
+        // Elements of a factor introduced by apply, z-major
+        std::vector<double> factor(const Tensor &tensor, const std::map<int, std::vector<double>> &diagonals) const;
+
+        // Kernel over quadrature points with per-thread intermediates; the
+        // caller provides <vector> and <algorithm>
+        std::string generate(const std::string &name, const ContractionTerm &rewritten,
+                             const CodeGenerator &codegen) const;
+    };
+
+} // namespace qc
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "contraction_term.h"
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief DAG of binary contractions over named tensors
+     *
+     * Nodes are kept in topological order: inputs first, then each
+     * contraction after its operands.
+     */
+    class ContractionDag
+    {
+    public:
+        struct Node
+        {
+            Tensor tensor;               // logical index order
+            std::vector<size_t> inputs;  // operands; empty for an input tensor
+            std::vector<size_t> consumers;
+            double prefactor;
+            bool intermediate;           // produced and consumed inside the DAG
+        };
+
+    private:
+        std::vector<Node> nodes_;
+
+    public:
+        // One input node per use, so that its labels match the consumer
+        size_t add_input(const Tensor &tensor);
+        size_t add_contraction(const Tensor &output, const std::vector<size_t> &inputs,
+                               double prefactor = 1.0, bool intermediate = true);
+
+        // Each term contracted pairwise along TensorContraction::optimize_contraction
+        static ContractionDag from_terms(const std::vector<ContractionTerm> &terms);
+
+        // Accessors
+        const std::vector<Node> &nodes() const { return nodes_; }
+        const Node &node(size_t i) const { return nodes_[i]; }
+        size_t size() const { return nodes_.size(); }
+    };
+
+    /**
+     * @brief Storage order of one operand of a contraction step
+     */
+    struct OperandLayout
+    {
+        std::vector<std::string> storage;  // labels in memory order
+        bool transpose = false;            // GEMM trans flag
+        std::vector<size_t> permutation;   // explicit permute, required[d] = storage[permutation[d]]; empty if folded
+    };
+
+    /**
+     * @brief Execution form of one DAG node
+     */
+    struct LayoutStep
+    {
+        enum class Kind
+        {
+            GEMM, // C(m,n) = A(m,k) B(k,n) up to trans flags
+            LOOP, // strided loops: batch or trace indices, any layout
+            COPY  // single operand, accumulated with a permutation
+        };
+
+        size_t node;
+        Kind kind;
+        OperandLayout a, b, c;
+        bool swap_operands = false; // C stored as (n,m): compute C^T = B^T A^T
+        std::vector<std::string> m, n, k;
+        double transposed_bytes = 0.0;
+    };
+
+    /**
+     * @brief Layout assignment for a whole DAG
+     */
+    struct LayoutPlan
+    {
+        std::vector<std::vector<std::string>> storage; // per node
+        std::vector<LayoutStep> steps;
+        double transposed_bytes = 0.0;
+        double naive_transposed_bytes = 0.0; // every operand permuted into logical GEMM order
+    };
+
+    /**
+     * @brief Symbolic layout propagation for contraction DAGs
+     *
+     * Input and output tensors keep their physical order. The storage order
+     * of each intermediate is chosen, in topological order, to minimize the
+     * bytes its producer and its consumers would have to transpose. A GEMM
+     * operand whose storage is a concatenation of its two index groups
+     * needs only a trans flag; any other order costs an explicit permute.
+     * TaskGraphRuntime allocates intermediates in the planned order and
+     * CodeGenerator::generate_step emits the trans flags of each GEMM step.
+     */
+    class LayoutPropagation
+    {
+    public:
+        static LayoutPlan plan(const ContractionDag &dag);
+
+        // Memory order of Tensor::transpose views: the logical slot held by
+        // each memory dimension, and the labels in that order
+        static std::vector<size_t> storage_layout(const Tensor &tensor);
+        static std::vector<std::string> physical_order(const Tensor &tensor);
+
+        // The tensor with its indices in memory order
+        static Tensor storage_view(const Tensor &tensor);
+
+        // The tensor stored in the given label order, as a "layout" view
+        static Tensor with_storage(const Tensor &tensor, const std::vector<std::string> &storage);
+
+        // Contraction of one DAG node with every operand and the result in
+        // their planned storage order
+        static ContractionTerm planned_term(const ContractionDag &dag, const LayoutPlan &plan, size_t node);
+    };
+
+} // namespace qc
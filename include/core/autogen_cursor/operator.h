@@ -185,9 +185,9 @@ namespace qc
     {
     public:
         // Second quantization operators
-        static Operator creation(const Index &p, Algebra algebra = Algebra::FERMION);
-        static Operator annihilation(const Index &p, Algebra algebra = Algebra::FERMION);
-        static Operator number(const Index &p, Algebra algebra = Algebra::FERMION);
+        static Operator creation(const Index &p, Operator::Algebra algebra = Operator::Algebra::FERMION);
+        static Operator annihilation(const Index &p, Operator::Algebra algebra = Operator::Algebra::FERMION);
+        static Operator number(const Index &p, Operator::Algebra algebra = Operator::Algebra::FERMION);
 
         // Many-body operators
         static OperatorProduct one_body_operator(const Tensor &h,
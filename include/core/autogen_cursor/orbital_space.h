@@ -0,0 +1,78 @@
+#pragma once
+
+#include "index.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <set>
+#include <shared_mutex>
+
+namespace qc
+{
+
+    /**
+     * @brief A named orbital space with its dimension
+     */
+    struct OrbitalSpace
+    {
+        int id;
+        std::string name;
+        long size;  // -1 if unknown
+        int parent; // enclosing space, -1 for a root space
+    };
+
+    /**
+     * @brief Registry of orbital spaces shared by indices, cost model and code generator
+     *
+     * The default registry holds general (gen), occupied (occ), virtual (vir),
+     * core (core ⊂ occ), active (active ⊂ gen) and auxiliary (aux) spaces.
+     * Occupied and virtual spaces are disjoint, as are all orbital spaces
+     * and the auxiliary basis.
+     *
+     * Lookups take a shared lock and registration an exclusive one, so
+     * workers may register spaces while others resolve indices. Spaces are
+     * returned by value, as a later registration may move the storage.
+     */
+    class SpaceRegistry
+    {
+    private:
+        std::vector<OrbitalSpace> spaces_;
+        std::unordered_map<std::string, int> by_name_;
+        std::set<std::pair<int, int>> disjoint_;
+        mutable std::shared_mutex mutex_;
+
+        // Unlocked helpers; callers hold mutex_
+        int find(const std::string &name) const;
+        bool contains(int sub, int super) const;
+
+    public:
+        SpaceRegistry();
+
+        // Process-wide registry
+        static SpaceRegistry &global();
+
+        // Space management. Registering an existing name returns its id and
+        // never changes a known size: -1 if `size` conflicts with it.
+        int register_space(const std::string &name, long size = -1, const std::string &parent = "");
+        void set_size(const std::string &name, long size);
+        void set_disjoint(const std::string &a, const std::string &b);
+
+        // Lookup
+        int id(const std::string &name) const; // -1 if unknown
+        OrbitalSpace space(int id) const;
+        std::string name(int id) const;
+        long size(int id) const;
+        size_t num_spaces() const;
+
+        // Relations
+        bool is_subspace(int sub, int super) const;
+        bool are_disjoint(int a, int b) const;
+        int intersection(int a, int b) const; // the smaller of two nested spaces, else -1
+
+        // Index resolution
+        int space_of(const Index &idx) const;
+        long dimension(const Index &idx) const;
+        int default_space(Index::Type type) const;
+    };
+
+} // namespace qc
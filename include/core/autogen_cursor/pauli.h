@@ -0,0 +1,181 @@
+#pragma once
+
+#include "operator.h"
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Pauli string i^phase * P_0 P_1 ... P_{n-1} in symplectic form
+     *
+     * Qubit q carries I, X, Z or Y for the bit pairs (x, z) = (0, 0),
+     * (1, 0), (0, 1), (1, 1), packed 64 qubits per word. Products and
+     * commutation checks are word-wise XOR, AND and popcount.
+     */
+    class PauliString
+    {
+    private:
+        size_t n_qubits_;
+        std::vector<std::uint64_t> bits_; // x words, then z words
+        int phase_;                       // power of i, 0..3
+
+    public:
+        explicit PauliString(size_t n_qubits = 0);
+
+        // "XIZY": qubit 0 first; any other character is I
+        static PauliString from_string(const std::string &letters);
+
+        // Accessors
+        size_t num_qubits() const { return n_qubits_; }
+        size_t num_words() const { return bits_.size() / 2; }
+        const std::uint64_t *x_words() const { return bits_.data(); }
+        const std::uint64_t *z_words() const { return bits_.data() + num_words(); }
+        int phase() const { return phase_; }
+        std::complex<double> phase_factor() const;
+        char letter(size_t qubit) const; // 'I', 'X', 'Y' or 'Z'
+        size_t weight() const;           // non-identity qubits
+
+        // Modifiers
+        void set(size_t qubit, char letter);
+        void set_phase(int phase) { phase_ = ((phase % 4) + 4) % 4; }
+
+        // Algebra
+        PauliString operator*(const PauliString &other) const;
+        bool commutes_with(const PauliString &other) const;
+        bool qubitwise_commutes_with(const PauliString &other) const;
+
+        // Comparison ignores the phase and pads the shorter string with I:
+        // equal strings merge in a QubitOperator
+        bool same_letters(const PauliString &other) const;
+        bool operator==(const PauliString &other) const;
+        std::size_t hash() const; // letters only
+
+        std::string to_string() const; // "XIZY", phase omitted
+    };
+
+    struct PauliStringHash
+    {
+        std::size_t operator()(const PauliString &p) const { return p.hash(); }
+    };
+
+    struct PauliLettersEqual
+    {
+        bool operator()(const PauliString &a, const PauliString &b) const { return a.same_letters(b); }
+    };
+
+    /**
+     * @brief Linear combination of Pauli strings with complex coefficients
+     *
+     * Terms are keyed by their letters through a hash map, so identical
+     * strings merge on insertion; the phase of an inserted string is folded
+     * into its coefficient.
+     */
+    class QubitOperator
+    {
+    public:
+        using Terms = std::unordered_map<PauliString, std::complex<double>, PauliStringHash, PauliLettersEqual>;
+
+    private:
+        size_t n_qubits_;
+        Terms terms_;
+
+    public:
+        explicit QubitOperator(size_t n_qubits = 0);
+        QubitOperator(const PauliString &string, std::complex<double> coefficient = 1.0);
+
+        static QubitOperator identity(size_t n_qubits, std::complex<double> coefficient = 1.0);
+
+        // Accessors
+        size_t num_qubits() const { return n_qubits_; }
+        size_t size() const { return terms_.size(); }
+        const Terms &terms() const { return terms_; }
+        std::complex<double> coefficient(const PauliString &string) const; // c with c * string a term
+        double norm() const; // sum of |coefficient|
+
+        // Modifiers
+        void add(const PauliString &string, std::complex<double> coefficient);
+        void reserve(size_t terms) { terms_.reserve(terms); }
+        void simplify(double tolerance = 1e-12); // drops negligible terms
+
+        // Algebra
+        QubitOperator &operator+=(const QubitOperator &other);
+        QubitOperator &operator-=(const QubitOperator &other);
+        QubitOperator &operator*=(std::complex<double> scalar);
+        QubitOperator operator+(const QubitOperator &other) const;
+        QubitOperator operator-(const QubitOperator &other) const;
+        QubitOperator operator*(const QubitOperator &other) const;
+        QubitOperator operator*(std::complex<double> scalar) const;
+        QubitOperator adjoint() const;
+
+        std::string to_string() const;
+    };
+
+    /**
+     * @brief Fermion-to-qubit encodings of second-quantized operators
+     *
+     * Every encoding writes a_j^dagger = 1/2 (c_j - i d_j) with the Majorana
+     * strings
+     *
+     *   c_j = X_{U(j)} Z_{P(j)},   d_j = Y_j X_{U(j) \ j} Z_{(P(j) ^ O(j)) \ j},
+     *
+     * where the update set U(j) holds the qubits storing occupation j, the
+     * parity set P(j) the qubits whose parity gives the modes below j and
+     * the occupation set O(j) those whose parity gives mode j itself.
+     * Jordan-Wigner, parity and Bravyi-Kitaev (Fenwick tree) encodings
+     * differ only in these sets.
+     *
+     * Fermionic operators name their mode by a numeric index label or the
+     * "mode" property. Spin operators from OperatorFactory act on the qubit
+     * given by their "qubit" property.
+     */
+    class QubitMapping
+    {
+    public:
+        enum class Encoding
+        {
+            JORDAN_WIGNER,
+            PARITY,
+            BRAVYI_KITAEV
+        };
+
+    private:
+        Encoding encoding_;
+        size_t n_qubits_;
+        std::vector<QubitOperator> creation_, annihilation_; // per mode
+
+    public:
+        QubitMapping(Encoding encoding, size_t n_modes);
+
+        Encoding encoding() const { return encoding_; }
+        size_t num_qubits() const { return n_qubits_; }
+
+        // Index sets of mode j (qubits in ascending order)
+        std::vector<size_t> update_set(size_t j) const;
+        std::vector<size_t> parity_set(size_t j) const;
+        std::vector<size_t> occupation_set(size_t j) const;
+
+        const QubitOperator &creation(size_t mode) const { return creation_[mode]; }
+        const QubitOperator &annihilation(size_t mode) const { return annihilation_[mode]; }
+
+        // Mode of a fermionic operator, qubit of a spin operator; -1 if unknown
+        static int mode_of(const Operator &op);
+        static int qubit_of(const Operator &op);
+
+        // False if an operator is neither fermionic nor a spin operator, or
+        // its mode lies outside the mapping
+        bool map(const OperatorProduct &product, QubitOperator &result) const;
+
+        // Sum of all products, merged in one hash map; terms are split across
+        // OpenMP threads when available
+        bool map(const std::vector<OperatorProduct> &products, QubitOperator &result) const;
+
+    private:
+        bool map_operator(const Operator &op, QubitOperator &result) const;
+    };
+
+} // namespace qc
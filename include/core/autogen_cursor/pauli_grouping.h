@@ -0,0 +1,70 @@
+#pragma once
+
+#include "pauli.h"
+#include <vector>
+
+namespace qc
+{
+
+    enum class PauliCommutation
+    {
+        QUBITWISE, // one tensor-product basis measures the whole group
+        FULL       // needs a Clifford rotation per group
+    };
+
+    enum class ColoringStrategy
+    {
+        LARGEST_FIRST, // most conflicts first, then smallest free group
+        DSATUR         // most distinct neighbouring groups first
+    };
+
+    /**
+     * @brief Options for PauliGrouping
+     */
+    struct GroupingOptions
+    {
+        PauliCommutation relation = PauliCommutation::QUBITWISE;
+        ColoringStrategy strategy = ColoringStrategy::DSATUR;
+        size_t threads = 0; // 0 = OpenMP default
+    };
+
+    /**
+     * @brief Partitions Pauli strings into mutually commuting groups
+     *
+     * Groups are colour classes of a greedy colouring of the conflict graph,
+     * whose edges join strings that do not commute under the chosen
+     * relation. The graph is never stored: strings are copied into packed
+     * x and z word arrays and edges are recomputed from them, with the scans
+     * over all strings vectorized and split across OpenMP threads. A
+     * qubitwise group is summarized by the letter it fixes on every qubit,
+     * so testing a string against a group costs a few words regardless of
+     * its size.
+     *
+     * Strings are sorted by the qubits they touch and scanned in tiles of
+     * 64 rows; a tile whose strings share no qubit with the current string
+     * is skipped, since disjoint strings commute. Degree counts and DSATUR
+     * updates therefore cost O(n * t) edge tests, where t is the number of
+     * rows in the tiles overlapping each string: O(n^2) for strings that
+     * all overlap, close to linear for local Hamiltonians. DSATUR also
+     * scans the n / 64 tile maxima per step to pick the next string.
+     */
+    class PauliGrouping
+    {
+    public:
+        // True if a and b cannot share a group
+        static bool conflicts(const PauliString &a, const PauliString &b, PauliCommutation relation);
+
+        // Groups of indices into strings, each group in ascending order
+        static std::vector<std::vector<size_t>> partition(const std::vector<PauliString> &strings,
+                                                          const GroupingOptions &options = GroupingOptions());
+
+        // Terms of op split into one operator per group
+        static std::vector<QubitOperator> partition(const QubitOperator &op,
+                                                    const GroupingOptions &options = GroupingOptions());
+
+        // Every string in exactly one group, no conflicts inside a group
+        static bool is_valid(const std::vector<PauliString> &strings,
+                             const std::vector<std::vector<size_t>> &groups, PauliCommutation relation);
+    };
+
+} // namespace qc
@@ -1,11 +1,40 @@
 #pragma once
 
-#include "core/symbol.h"
-#include "core/index.h"
-#include "core/tensor.h"
-#include "core/operator.h"
-#include "core/expression.h"
-#include "simplification/simplifier.h"
+#include "symbol.h"
+#include "index.h"
+#include "tensor.h"
+#include "operator.h"
+#include "expression.h"
+#include "simplifier.h"
+#include "orbital_space.h"
+#include "contraction_term.h"
+#include "delta_elimination.h"
+#include "term_fusion.h"
+#include "antisymmetry.h"
+#include "implicit_tensor.h"
+#include "layout.h"
+#include "code_generator.h"
+#include "triples_generator.h"
+#include "pauli.h"
+#include "pauli_grouping.h"
+#include "wigner.h"
+#include "ucc.h"
+#include "kramers.h"
+#include "field_inference.h"
+#include "rdm_generator.h"
+#include "laplace.h"
+#include "equation_library.h"
+#include "build_graph.h"
+#include "batch_compiler.h"
+#include "expression_dsl.h"
+#include "ac_matching.h"
+#include "horner.h"
+#include "../numeric/complex_tensor.h"
+#include "../numeric/evaluator.h"
+#include "../numeric/transpose.h"
+#include "../numeric/numa.h"
+#include "../numeric/kramers_tensor.h"
+#include "../numeric/task_graph.h"
 
 namespace qc
 {
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "contraction_term.h"
+#include "code_generator.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Options for the CCSD density-matrix generator
+     */
+    struct RdmOptions
+    {
+        bool hermitian = true;           // (D + D^T) / 2, partner blocks folded into the unique ones
+        bool share_intermediates = true; // pairwise intermediates used by two or more terms
+    };
+
+    /**
+     * @brief Equations of one density matrix, block by block
+     *
+     * Intermediates are listed in dependency order and must be evaluated
+     * before the blocks. Each block is a sum of terms into the same
+     * output tensor.
+     */
+    struct RdmEquations
+    {
+        std::vector<ContractionTerm> intermediates;
+        std::vector<std::pair<std::string, std::vector<ContractionTerm>>> blocks; // "ooov" -> terms
+    };
+
+    /**
+     * @brief Spin-orbital CCSD one- and two-particle density matrices
+     *
+     *   D1_pq   = <0| (1 + L) e^-T p+ q e^T |0>
+     *   D2_pqrs = <0| (1 + L) e^-T p+ q+ s r e^T |0>
+     *
+     * with T = T1 + T2 and L = L1 + L2 stored as t1(i,a), t2(i,j,a,b),
+     * l1(i,a) and l2(i,j,a,b), derived by Wick contraction over the Fermi
+     * vacuum: every T must connect to the density operator, which bounds
+     * the expansion of e^-T O e^T.
+     *
+     * Only symmetry-unique blocks are emitted. D2 is antisymmetric in
+     * (pq) and in (rs), so within each pair occupied precedes virtual and
+     * same-space pairs are stored packed (property "antisymmetric_groups").
+     * With the hermitian option the response densities are symmetrized,
+     * D_pqrs = D_rspq, and the partner blocks (vo, ovoo, vvoo, vvov) are
+     * folded into oo/ov/vv and oooo, ooov, oovv, ovov, ovvv, vvvv.
+     *
+     * Reference contributions carry the occupied identity delta(i,j) as a
+     * factor; it is bound as an n_occ x n_occ identity.
+     */
+    class RdmGenerator
+    {
+    private:
+        RdmOptions options_;
+        CodeGenerator codegen_;
+
+    public:
+        RdmGenerator(const RdmOptions &options = RdmOptions(),
+                     const CodeGenOptions &codegen_options = CodeGenOptions());
+
+        // order 1 or 2; other orders give empty equations
+        RdmEquations equations(int order) const;
+
+        // Unique occupied / virtual block labels, e.g. {"oo", "ov", "vv"}
+        static std::vector<std::string> unique_blocks(int order, bool hermitian);
+
+        // Output tensor of a block, "D1_ov"(i,a) or "D2_ooov"(i,j,k,a)
+        static Tensor block_tensor(const std::string &block);
+
+        // One kernel per intermediate (name_I1, ...) and per block (name_oo, ...)
+        std::string generate(const std::string &name, int order) const;
+    };
+
+} // namespace qc
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../core/expression.h"
+#include "expression.h"
 #include <memory>
 #include <vector>
 #include <functional>
@@ -34,7 +34,7 @@ namespace qc
     private:
         std::unordered_map<RuleType, std::vector<Rule>> rules_;
         bool enable_trace_;
-        std::vector<std::string> trace_log_;
+        mutable std::vector<std::string> trace_log_;
 
     public:
         Simplifier(bool enable_trace = false);
@@ -108,7 +108,8 @@ namespace qc
         // Basic distributive law: (a+b)*(c+d) = ac + ad + bc + bd
         static std::unique_ptr<Expression> distribute_multiplication(const Expression &expr);
 
-        // Reverse distributive: ax + bx = (a+b)*x
+        // Reverse distributive: ax + by + cx = (a+c)*x + by, one factor per
+        // call; HornerFactorization factors whole sums for evaluation
         static std::unique_ptr<Expression> factor_common_terms(const Expression &expr);
 
         // Distributive over subtraction: a*(b-c) = ab - ac
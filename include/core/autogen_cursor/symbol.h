@@ -21,7 +21,7 @@ namespace qc
             COMPLEX
         };
 
-    private:
+    protected:
         std::string name_;
         Type type_;
         std::unordered_map<std::string, std::string> properties_;
@@ -67,6 +67,7 @@ namespace qc
         void set_property(const std::string &key, const std::string &value);
         std::string get_property(const std::string &key) const;
         bool has_property(const std::string &key) const;
+        const std::unordered_map<std::string, std::string> &properties() const { return properties_; }
 
         // Type checking
         bool is_symmetric() const { return type_ == Type::SYMMETRIC; }
@@ -162,7 +163,11 @@ namespace qc
 
         static Tensor contract(const Tensor &A, const Tensor &B,
                                const IndexSet &contracted_indices);
-        static ContractionPath optimize_contraction(const std::vector<Tensor> &tensors);
+        // Pairwise order minimizing flops plus the size of the intermediates.
+        // Indices of `output` stay live until the last contraction. Exact
+        // for up to 10 tensors, greedy beyond; cost_estimate counts flops.
+        static ContractionPath optimize_contraction(const std::vector<Tensor> &tensors,
+                                                    const IndexSet &output = IndexSet());
         static double estimate_contraction_cost(const Tensor &A, const Tensor &B,
                                                 const IndexSet &contracted_indices);
     };
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "contraction_term.h"
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Groups contraction terms that accumulate into the same output
+     *
+     * Terms with the same output tensor, index order, layout and packed
+     * storage share their external loops, so a group can be evaluated in
+     * one pass over the output instead of one pass per term. A term only
+     * joins an earlier group when no term in between reads its output or
+     * writes one of its inputs, so the grouped sequence computes the same
+     * result as the original one.
+     */
+    class TermFusion
+    {
+    public:
+        // Same output tensor, index order, layout and antisymmetric groups
+        static bool fusable(const ContractionTerm &a, const ContractionTerm &b);
+
+        // Groups in order of their first term; terms keep their relative order
+        static std::vector<std::vector<ContractionTerm>> group(const std::vector<ContractionTerm> &terms);
+    };
+
+} // namespace qc
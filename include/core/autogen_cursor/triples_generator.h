@@ -0,0 +1,67 @@
+#pragma once
+
+#include "contraction_term.h"
+#include "code_generator.h"
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Options for the (T) kernel generator
+     */
+    struct TriplesOptions
+    {
+        long virtual_tile = 16; // edge of the virtual tiles; W and V take 6 tile^3 blocks each per thread
+        bool openmp = true;     // dynamic scheduling over triples
+    };
+
+    /**
+     * @brief Generator for the closed-shell perturbative triples (T) energy
+     *
+     * For each unique occupied triple i >= j >= k the kernel builds the
+     * virtual blocks W_ijk^abc (connected) and V_ijk^abc (disconnected),
+     *
+     *   W = P [ sum_f (ia|fb) t_kj^cf - sum_m (ia|mj) t_mk^bc ]
+     *   V = P [ 1/2 (ia|jb) t_k^c + 1/2 t_ij^ab f_kc ]
+     *
+     * with P the six simultaneous permutations of (ia), (jb), (kc), and
+     * accumulates
+     *
+     *   E(T) = 1/3 sum_{i>=j>=k} w_ijk sum_abc (W + V) Z,
+     *   Z = (4 W_abc + W_bca + W_cab - 2 W_cba - 2 W_acb - 2 W_bac) / D_ijk^abc,
+     *
+     * where w_ijk = 6 for distinct and 3 for two equal indices; i = j = k
+     * gives Z = 0 and is skipped.
+     *
+     * The virtuals run over cubic tiles of virtual_tile. For each unique
+     * tile triple, W and V are built for its distinct orderings only: at
+     * most six tile^3 blocks each, which hold every W element that Z reads
+     * for those blocks. Each element is still computed once.
+     */
+    class PerturbativeTriplesGenerator
+    {
+    private:
+        TriplesOptions options_;
+        CodeGenerator codegen_;
+
+    public:
+        PerturbativeTriplesGenerator(const TriplesOptions &options = TriplesOptions(),
+                                     const CodeGenOptions &codegen_options = CodeGenOptions());
+
+        // Per-triple contributions, with i, j, k fixed by the enclosing loop
+        std::vector<ContractionTerm> connected_terms() const;
+        std::vector<ContractionTerm> disconnected_terms() const;
+
+        // Multiplicity of the unique triple i >= j >= k
+        static double triple_weight(long i, long j, long k);
+
+        // Full (T) kernel:
+        // void name(const double *t1, const double *t2, const double *g_ovvv,
+        //           const double *g_ovoo, const double *g_ovov, const double *f_ov,
+        //           const double *e_occ, const double *e_vir, [n_occ, n_vir,] double *energy)
+        std::string generate(const std::string &name) const;
+    };
+
+} // namespace qc
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "pauli.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Options for UnitaryCoupledCluster
+     */
+    struct UccOptions
+    {
+        int max_order = 4;         // nested commutators per exponential
+        double tolerance = 1e-10;  // stop once a whole order is estimated below this (1-norm)
+        double drop = 1e-12;       // discard commutator pieces and strings below this
+        int trotter_steps = 0;     // 0: one exponential e^A; n: (prod_k e^(A_k / n))^n
+    };
+
+    /**
+     * @brief Counters of the last UnitaryCoupledCluster::transform
+     */
+    struct UccStats
+    {
+        size_t commutators = 0; // piece-generator commutators evaluated
+        size_t screened = 0;    // skipped for disjoint modes
+        size_t negligible = 0;  // skipped by the magnitude estimate
+        int orders = 0;         // deepest nested commutator reached
+    };
+
+    /**
+     * @brief Similarity transform e^(-A) H e^A for A = T - T^dagger
+     *
+     * Every excitation t * a^+...a of T becomes one anti-Hermitian
+     * generator A_k = tau_k - tau_k^dagger in the qubit space of a
+     * QubitMapping, and H is expanded in the Hadamard series
+     *
+     *   H + [H, A] + 1/2! [[H, A], A] + ...
+     *
+     * truncated at max_order or once the next order is estimated below the
+     * tolerance, using ||[X, A]|| <= 2 ||X|| ||A|| on coefficient 1-norms.
+     * The series is carried as pieces tagged with the fermionic modes they
+     * touch: products with an even number of fermion operators on disjoint
+     * modes commute, so a piece and a generator whose mode bitsets do not
+     * intersect are skipped with a few word ANDs. With Trotter steps the
+     * factors e^(A_k / n) are applied one after another.
+     */
+    class UnitaryCoupledCluster
+    {
+    public:
+        using ModeSet = std::vector<std::uint64_t>;
+
+    private:
+        struct Generator
+        {
+            ModeSet modes;
+            QubitOperator op;
+            double norm; // coefficient 1-norm
+        };
+
+        QubitMapping mapping_;
+        UccOptions options_;
+        std::vector<Generator> generators_;
+        UccStats stats_;
+
+    public:
+        UnitaryCoupledCluster(const QubitMapping &mapping, const UccOptions &options = UccOptions());
+
+        // False if the excitation cannot be mapped; Hermitian excitations
+        // give A = 0 and are skipped
+        bool add_excitation(const OperatorProduct &excitation);
+        size_t num_generators() const { return generators_.size(); }
+
+        const UccOptions &options() const { return options_; }
+        const UccStats &stats() const { return stats_; }
+
+        // e^(-A) H e^A for H given as second-quantized terms
+        bool transform(const std::vector<OperatorProduct> &hamiltonian, QubitOperator &result);
+
+        // [a, b]: only anticommuting string pairs contribute, 2 P Q each
+        static QubitOperator commutator(const QubitOperator &a, const QubitOperator &b);
+
+        // Modes touched by a product; all modes if it has odd fermion parity
+        ModeSet modes_of(const OperatorProduct &product) const;
+
+    private:
+        using Pieces = std::map<ModeSet, QubitOperator>;
+
+        // pieces <- e^(-sum of generators) pieces e^(sum of generators)
+        void expand(Pieces &pieces, const std::vector<const Generator *> &generators, double scale);
+    };
+
+} // namespace qc
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Exact value of a recoupling coefficient
+     *
+     * Stored as sign * n * prod_k p_k^(e_k / 2) over the primes
+     * p_k = 2, 3, 5, ..., with n an integer coprime to every listed prime,
+     * so that equal coefficients have equal representations.
+     */
+    class RecouplingValue
+    {
+    private:
+        int sign_ = 0;                       // -1, 0 or 1
+        std::vector<std::uint32_t> integer_; // n in 32-bit limbs, least significant first
+        std::vector<int> exponents_;         // e_k
+        double value_ = 0.0;
+
+        friend class WignerSymbols;
+
+    public:
+        double value() const { return value_; }
+        int sign() const { return sign_; }
+        bool is_zero() const { return sign_ == 0; }
+
+        // value^2 = numerator / denominator in lowest terms, as decimal strings
+        std::string squared_numerator() const;
+        std::string squared_denominator() const;
+
+        bool operator==(const RecouplingValue &other) const;
+        std::string to_string() const; // "-sqrt(2/15)"
+    };
+
+    /**
+     * @brief Wigner 3j, 6j and 9j symbols with a shared, thread-safe cache
+     *
+     * Angular momenta are passed doubled (two_j = 2j, two_m = 2m) so that
+     * half-integers are exact. Symbols are evaluated from the Racah
+     * formulas over prime-factorized factorials with an exact integer sum,
+     * and the 9j from its expansion in 6j symbols.
+     *
+     * Each symbol is cached under the canonical representative of its
+     * symmetry class: the least arrangement of the Regge square for the
+     * 72 symmetries of the 3j, of the 3x4 Bargmann array for the 144 of
+     * the 6j, and of the 3x3 array for the 72 of the 9j. Lookups take a
+     * shared lock; only insertions are exclusive.
+     */
+    class WignerSymbols
+    {
+    public:
+        using Key = std::array<int, 13>; // symbol kind, then its canonical array
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &key) const;
+        };
+
+    private:
+        std::unordered_map<Key, RecouplingValue, KeyHash> cache_;
+        mutable std::shared_mutex mutex_;
+        std::atomic<size_t> hits_{0}, misses_{0};
+
+    public:
+        WignerSymbols() = default;
+        WignerSymbols(const WignerSymbols &) = delete;
+        WignerSymbols &operator=(const WignerSymbols &) = delete;
+
+        // Process-wide instance
+        static WignerSymbols &global();
+
+        // Zero when a selection rule fails
+        double three_j(int two_j1, int two_j2, int two_j3, int two_m1, int two_m2, int two_m3);
+        double six_j(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5, int two_j6);
+        double nine_j(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5, int two_j6, int two_j7,
+                      int two_j8, int two_j9);
+
+        RecouplingValue three_j_exact(int two_j1, int two_j2, int two_j3, int two_m1, int two_m2, int two_m3);
+        RecouplingValue six_j_exact(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5, int two_j6);
+        RecouplingValue nine_j_exact(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5, int two_j6,
+                                     int two_j7, int two_j8, int two_j9);
+
+        // Batches, split across OpenMP threads when available
+        std::vector<double> three_j(const std::vector<std::array<int, 6>> &arguments);
+        std::vector<double> six_j(const std::vector<std::array<int, 6>> &arguments);
+        std::vector<double> nine_j(const std::vector<std::array<int, 9>> &arguments);
+
+        // <j1 m1 j2 m2 | J M>
+        double clebsch_gordan(int two_j1, int two_m1, int two_j2, int two_m2, int two_J, int two_M);
+
+        // <j m + step | J_step | j m> for step = +1 or -1
+        static double ladder_element(int two_j, int two_m, int step);
+
+        // Cache
+        size_t cache_size() const;
+        size_t hits() const { return hits_; }
+        size_t misses() const { return misses_; }
+        void clear();
+
+    private:
+        RecouplingValue lookup(const Key &key);
+        RecouplingValue compute(const Key &key);
+    };
+
+} // namespace qc
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "dense_tensor.h"
+#include "../autogen_cursor/field_inference.h"
+#include <complex>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Tensor over a number field, held as real arrays
+     *
+     * A real tensor holds its real part only, an imaginary one its
+     * imaginary part only, and a complex one both, so that contractions
+     * over them are real contractions of the parts.
+     */
+    class ComplexTensor
+    {
+    private:
+        Field field_ = Field::REAL;
+        std::vector<long> shape_;
+        DenseTensor real_, imag_;
+
+    public:
+        ComplexTensor() = default;
+        explicit ComplexTensor(const std::vector<long> &shape, Field field = Field::COMPLEX);
+
+        Field field() const { return field_; }
+        const std::vector<long> &shape() const { return shape_; }
+        bool has_real() const { return field_ != Field::IMAGINARY; }
+        bool has_imag() const { return field_ != Field::REAL; }
+
+        // Parts; absent parts are empty
+        DenseTensor &real() { return real_; }
+        DenseTensor &imag() { return imag_; }
+        const DenseTensor &real() const { return real_; }
+        const DenseTensor &imag() const { return imag_; }
+
+        std::complex<double> operator()(const std::vector<long> &index) const;
+        void set(const std::vector<long> &index, std::complex<double> value); // drops parts the field lacks
+        void fill(std::complex<double> value);
+    };
+
+} // namespace qc
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Allocator that default-initializes, leaving doubles unwritten
+     *
+     * Pages of a fresh allocation are then first touched, and so placed,
+     * by whichever thread writes them first.
+     */
+    template <typename T>
+    struct UninitializedAllocator : std::allocator<T>
+    {
+        template <typename U>
+        struct rebind
+        {
+            using other = UninitializedAllocator<U>;
+        };
+
+        UninitializedAllocator() = default;
+        template <typename U>
+        UninitializedAllocator(const UninitializedAllocator<U> &) {}
+
+        template <typename U>
+        void construct(U *p) { ::new (static_cast<void *>(p)) U; }
+        template <typename U, typename... Args>
+        void construct(U *p, Args &&...args) { ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+    };
+
+    /**
+     * @brief Dense row-major tensor of doubles used by the numeric backend
+     */
+    class DenseTensor
+    {
+    private:
+        std::vector<long> shape_;
+        std::vector<long> strides_;
+        std::vector<double, UninitializedAllocator<double>> data_;
+
+    public:
+        DenseTensor() = default;
+        explicit DenseTensor(const std::vector<long> &shape, double value = 0.0);
+
+        // Elements are left unwritten; see NumaPlacement for placing them
+        static DenseTensor uninitialized(const std::vector<long> &shape);
+
+        // Accessors
+        const std::vector<long> &shape() const { return shape_; }
+        const std::vector<long> &strides() const { return strides_; }
+        long extent(size_t dim) const { return shape_[dim]; }
+        size_t rank() const { return shape_.size(); }
+        long size() const { return static_cast<long>(data_.size()); }
+        double *data() { return data_.data(); }
+        const double *data() const { return data_.data(); }
+
+        // Element access
+        long offset(const std::vector<long> &index) const;
+        double &operator()(const std::vector<long> &index) { return data_[offset(index)]; }
+        double operator()(const std::vector<long> &index) const { return data_[offset(index)]; }
+
+        void fill(double value);
+    };
+
+} // namespace qc
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "dense_tensor.h"
+#include "complex_tensor.h"
+#include "numa.h"
+#include "../autogen_cursor/contraction_term.h"
+#include "../autogen_cursor/implicit_tensor.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Reference evaluator of contraction terms over dense tensors
+     *
+     * Factors are looked up by tensor name, Kramers blocks by their
+     * KramersSymmetry::storage_name. Bound tensors, the output included,
+     * hold their dimensions in memory order, so a view with a "layout"
+     * property is read and written through its storage order. Factors
+     * registered as implicit tensors are computed from their diagonals:
+     * when they depend on output indices only they scale each accumulated
+     * output element once, otherwise they are evaluated in the summation
+     * loop. No array is ever allocated for them.
+     */
+    class Evaluator
+    {
+    private:
+        std::map<std::string, const DenseTensor *> inputs_;
+        std::map<std::string, const ComplexTensor *> complex_inputs_;
+        std::map<std::string, ImplicitTensor> implicit_;
+        std::map<int, const double *> diagonals_;
+        NumaPolicy placement_ = NumaPolicy::LOCAL;
+
+    public:
+        // Inputs are referenced, not copied
+        void bind(const std::string &name, const DenseTensor &tensor);
+        void bind(const std::string &name, const ComplexTensor &tensor);
+        void add_implicit(const ImplicitTensor &tensor);
+        void set_diagonal(int space, const DenseTensor &diagonal);
+
+        // Placement of the outputs; threaded sweeps then run each block of
+        // output elements on the domain holding it
+        void set_placement(NumaPolicy policy) { placement_ = policy; }
+        NumaPolicy placement() const { return placement_; }
+
+        bool is_bound(const std::string &name) const;
+        const ImplicitTensor *find_implicit(const std::string &name) const;
+
+        // output += prefactor * prod(factors); false if a factor or a diagonal
+        // of an implicit factor is unbound, or the extents of an index
+        // disagree. The output elements are split across `threads` OpenMP
+        // threads when available.
+        bool evaluate(const ContractionTerm &term, DenseTensor &output, size_t threads = 1) const;
+
+        // Terms accumulating into the same output, summed per output element
+        // so that the output is read and written once for the whole group
+        bool evaluate(const std::vector<ContractionTerm> &terms, DenseTensor &output, size_t threads = 1) const;
+
+        // Terms over complex or imaginary factors, as real contractions of
+        // their parts: a term over real factors runs the real kernel alone,
+        // and a summation over two complex factors takes three real
+        // contractions (ac, bd, (a + b)(c + d)) instead of four. False if a
+        // part of the result has no place in the output.
+        bool evaluate(const ContractionTerm &term, ComplexTensor &output, size_t threads = 1) const;
+
+    private:
+        struct PreparedTerm;
+        // A non-null parts[f] is read for factor f instead of its bound tensor
+        bool prepare(const ContractionTerm &term, const DenseTensor &output, PreparedTerm &prepared,
+                     const std::vector<const DenseTensor *> *parts = nullptr) const;
+        void run(const std::vector<PreparedTerm> &prepared, DenseTensor &output, size_t threads) const;
+        double contribution(const PreparedTerm &prepared, const std::vector<long> &ext_values,
+                            std::vector<long> &sum_values) const;
+    };
+
+} // namespace qc
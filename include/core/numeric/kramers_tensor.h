@@ -0,0 +1,55 @@
+#pragma once
+
+#include "complex_tensor.h"
+#include "evaluator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Time-reversal-symmetric tensor stored as its unique Kramers blocks
+     *
+     * Each dimension runs over Kramers pairs; the full spinor tensor has
+     * twice the extent, unbarred spinors first. Only the blocks with an
+     * unbarred first index are held (see KramersSymmetry), half of the
+     * full tensor, as complex blocks; the others are the conjugated
+     * partners with the sign of the relation.
+     */
+    class KramersTensor
+    {
+    private:
+        std::vector<long> shape_;         // Kramers pairs per dimension
+        std::vector<ComplexTensor> blocks_; // block b holds bar pattern 2b
+
+        bool in_range(std::uint64_t pattern) const { return rank() >= 64 || pattern >> rank() == 0; }
+
+    public:
+        KramersTensor() = default;
+        explicit KramersTensor(const std::vector<long> &shape);
+
+        // Unique blocks of a spinor tensor; false if an extent is odd
+        static bool from_spinor(const ComplexTensor &spinor, KramersTensor &result);
+        ComplexTensor to_spinor() const;
+
+        const std::vector<long> &shape() const { return shape_; }
+        size_t rank() const { return shape_.size(); }
+        size_t num_blocks() const { return blocks_.size(); }
+        long size() const; // stored elements
+
+        // Stored block of a canonical pattern (first index unbarred);
+        // nullptr for other patterns and bits beyond the rank
+        ComplexTensor *block(std::uint64_t pattern);
+        const ComplexTensor *block(std::uint64_t pattern) const;
+
+        // Element of any block, read from the stored partner when needed;
+        // NaN for bits beyond the rank
+        std::complex<double> element(const std::vector<long> &index, std::uint64_t pattern) const;
+
+        // Binds every block under its KramersSymmetry::storage_name
+        void bind(Evaluator &evaluator, const std::string &name) const;
+    };
+
+} // namespace qc
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "dense_tensor.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief NUMA domains and their CPUs, read from /sys/devices/system/node
+     *
+     * Machines without that interface are reported as one domain holding
+     * every CPU.
+     */
+    class NumaTopology
+    {
+    private:
+        std::vector<std::vector<int>> cpus_; // per domain
+
+    public:
+        NumaTopology();
+
+        static const NumaTopology &system();
+
+        size_t num_nodes() const { return cpus_.size(); }
+        const std::vector<int> &cpus(size_t node) const { return cpus_[node]; }
+        int node_of_cpu(int cpu) const; // -1 if unknown
+
+        // "0-3,8-11" -> {0, 1, 2, 3, 8, 9, 10, 11}
+        static std::vector<int> parse_cpu_list(const std::string &list);
+    };
+
+    /**
+     * @brief Page placement policies for large tensors
+     */
+    enum class NumaPolicy
+    {
+        LOCAL,       // first touch by the allocating thread
+        INTERLEAVED, // page p on domain p mod n
+        PARTITIONED  // domain d holds the d-th contiguous block of pages
+    };
+
+    /**
+     * @brief Placement counters, accumulated over all NumaPlacement calls
+     */
+    struct NumaStats
+    {
+        size_t allocations = 0;
+        size_t pinned_threads = 0;
+        size_t failed_pins = 0;
+        std::vector<double> bytes_per_node; // placed bytes by owning domain
+    };
+
+    /**
+     * @brief First-touch NUMA placement and domain-aware parallel loops
+     *
+     * Placement needs no NUMA library: pages of an unwritten allocation are
+     * first written by threads pinned to the owning domain. parallel_for
+     * splits loops over such an array along the same page ownership, so
+     * every chunk is processed by threads on the domain that holds it.
+     */
+    class NumaPlacement
+    {
+    public:
+        // Tensor whose pages are placed by `policy` and filled with `value`
+        static DenseTensor allocate(const std::vector<long> &shape, NumaPolicy policy, double value = 0.0);
+        static void place(double *data, long size, NumaPolicy policy, double value = 0.0);
+
+        // Domain owning element `index` of an array placed with `policy`;
+        // LOCAL reports the domain of the calling thread
+        static size_t owner(const double *data, long size, long index, NumaPolicy policy);
+
+        // body(begin, end) over [0, size), with each chunk run on the domain
+        // owning it; `threads` are spread evenly over the domains
+        static void parallel_for(const double *data, long size, NumaPolicy policy, size_t threads,
+                                 const std::function<void(long, long)> &body);
+
+        // Restricts the calling thread to the CPUs of `node`
+        static bool pin_current_thread(size_t node);
+
+        // Pages of [data, data + size) resident on each domain, as reported
+        // by the kernel; empty where unsupported
+        static std::vector<long> resident_pages(const double *data, long size);
+
+        static NumaStats stats();
+        static void reset_stats();
+    };
+
+} // namespace qc
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "dense_tensor.h"
+#include "evaluator.h"
+#include "numa.h"
+#include "../autogen_cursor/layout.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Options for TaskGraphRuntime
+     */
+    struct RuntimeOptions
+    {
+        size_t threads = 0;              // worker slots; 0 = hardware concurrency
+        double memory_limit = 0.0;       // bytes of live intermediates; 0 = unlimited
+        double flops_per_thread = 1.0e7; // work that justifies one more thread in a task
+        NumaPolicy placement = NumaPolicy::LOCAL; // intermediates and intra-task sweeps
+        bool pin_threads = false;        // worker w runs on NUMA domain w mod n
+    };
+
+    /**
+     * @brief Counters of the last TaskGraphRuntime::run
+     */
+    struct RuntimeStats
+    {
+        size_t tasks = 0;
+        size_t max_concurrent = 0;   // tasks in flight at once
+        size_t delayed = 0;          // tasks held back by the memory ceiling
+        double peak_memory = 0.0;    // bytes of live intermediates
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Executes a ContractionDag on a pool of worker threads
+     *
+     * Every contraction node is a task, ready once its operands exist.
+     * Ready tasks are started in order of their critical path (the largest
+     * flop count from the task to any sink) and each gets a thread budget
+     * proportional to its own flops, so that small contractions run side by
+     * side instead of each occupying the whole machine. Intermediates are
+     * allocated when their producer starts and released after their last
+     * consumer; a task whose intermediate would exceed the memory ceiling
+     * is delayed until enough has been released. Each intermediate is
+     * stored in the order chosen by LayoutPropagation::plan and every task
+     * addresses it through that order. Tasks accumulating into
+     * the same output never run concurrently. With a NUMA placement,
+     * intermediates are spread over the domains and each task processes
+     * every block of its output on the domain that holds it.
+     */
+    class TaskGraphRuntime
+    {
+    private:
+        RuntimeOptions options_;
+        Evaluator evaluator_; // implicit tensors and diagonals shared by all tasks
+        std::map<std::string, const DenseTensor *> inputs_;
+        std::map<std::string, DenseTensor *> outputs_;
+        RuntimeStats stats_;
+
+    public:
+        TaskGraphRuntime(const RuntimeOptions &options = RuntimeOptions());
+
+        // Tensors are referenced, not copied; outputs are accumulated into
+        void bind_input(const std::string &name, const DenseTensor &tensor);
+        void bind_output(const std::string &name, DenseTensor &tensor);
+        Evaluator &evaluator() { return evaluator_; }
+
+        const RuntimeOptions &options() const { return options_; }
+        const RuntimeStats &stats() const { return stats_; }
+        size_t slots() const;
+
+        // Scheduling model; extents come from the bound inputs
+        std::vector<double> task_flops(const ContractionDag &dag) const;
+        std::vector<double> critical_path(const ContractionDag &dag) const;
+        size_t thread_budget(double flops) const;
+
+        // False if a tensor is unbound, extents disagree or a task fails
+        bool run(const ContractionDag &dag);
+
+    private:
+        std::vector<std::map<std::string, long>> node_extents(const ContractionDag &dag) const;
+    };
+
+} // namespace qc
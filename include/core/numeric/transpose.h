@@ -0,0 +1,61 @@
+#pragma once
+
+#include "dense_tensor.h"
+#include <memory>
+#include <vector>
+
+namespace qc
+{
+
+    /**
+     * @brief Precomputed execution form of one tensor permutation
+     *
+     * Input dimensions that stay adjacent and in order are fused first, so
+     * that every permutation reduces to one of three kernels. The common
+     * rank-4 CC permutations all land on ROWS or BLOCKED this way, e.g.
+     * (1,0,2,3) and (0,2,1,3) copy rows, (2,3,0,1) is one 2D transpose and
+     * (0,1,3,2), (1,0,3,2) are batches of 2D transposes.
+     */
+    struct TransposePlan
+    {
+        enum class Kind
+        {
+            COPY,   // identity after fusion
+            ROWS,   // innermost dimension kept: contiguous row copies
+            BLOCKED // innermost dimension moves: cache-oblivious 2D tiles
+        };
+
+        Kind kind;
+        std::vector<long> shape;        // fused input extents
+        std::vector<size_t> permutation; // output dimension d is fused input dimension permutation[d]
+        std::vector<long> in_strides;    // fused input strides
+        std::vector<long> out_strides;   // output stride of each fused input dimension
+        long size;                       // number of elements
+    };
+
+    /**
+     * @brief Dense tensor transposition, out = alpha * permute(in) + beta * out
+     *
+     * Output dimension d is input dimension permutation[d]. Plans are cached
+     * per shape and permutation; the batch and tile loops are split across
+     * OpenMP threads when available.
+     */
+    class TensorTranspose
+    {
+    public:
+        static std::shared_ptr<const TransposePlan> plan(const std::vector<long> &shape,
+                                                         const std::vector<size_t> &permutation);
+        static void execute(const TransposePlan &plan, const double *in, double *out,
+                            double alpha = 1.0, double beta = 0.0);
+
+        // Plans and executes; false if `permutation` is not a permutation of the dimensions
+        static bool transpose(const double *in, double *out, const std::vector<long> &shape,
+                              const std::vector<size_t> &permutation, double alpha = 1.0, double beta = 0.0);
+        static DenseTensor transpose(const DenseTensor &in, const std::vector<size_t> &permutation);
+
+        // Plan cache
+        static size_t cache_size();
+        static void clear_cache();
+    };
+
+} // namespace qc
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "singleton.h"
+
+namespace MetaWaveCompiler
+{
+    namespace util
+    {
+
+        /// Number of per-thread shards of counters and histograms.
+        constexpr size_t kMetricShards = 16;
+
+        /// Shard of the calling thread; threads are assigned round-robin.
+        size_t metricShard();
+
+        /// Monotonic counter. Every thread increments its own cache line,
+        /// value() sums the shards.
+        class Counter
+        {
+        public:
+            void inc(std::uint64_t n = 1)
+            {
+                shards[metricShard()].value.fetch_add(n, std::memory_order_relaxed);
+            }
+            std::uint64_t value() const;
+
+        private:
+            struct alignas(64) Shard
+            {
+                std::atomic<std::uint64_t> value{0};
+            };
+            std::array<Shard, kMetricShards> shards;
+        };
+
+        /// Value that can go up and down, such as a queue depth.
+        class Gauge
+        {
+        public:
+            void set(double value) { current.store(value, std::memory_order_relaxed); }
+            void add(double delta);
+            double value() const { return current.load(std::memory_order_relaxed); }
+
+        private:
+            std::atomic<double> current{0.0};
+        };
+
+        /// Log-linear histogram of non-negative integers (nanoseconds for
+        /// latencies), in the manner of HdrHistogram: every power of two is
+        /// split into 16 linear buckets, so quantiles carry at most 1/16
+        /// relative error. Values up to 2^48 are resolved; larger ones land
+        /// in the last bucket.
+        class Histogram
+        {
+        public:
+            static constexpr int kSubBits = 4;
+            static constexpr size_t kSubBuckets = size_t(1) << kSubBits;
+            static constexpr size_t kBuckets = (48 - kSubBits + 1) * kSubBuckets;
+            static constexpr size_t kShards = 8;
+
+            void record(std::uint64_t value);
+
+            std::uint64_t count() const;
+            std::uint64_t sum() const;
+            std::uint64_t max() const;
+
+            /// Upper bound of the bucket holding quantile q, capped at max().
+            std::uint64_t quantile(double q) const;
+
+            static size_t bucketOf(std::uint64_t value);
+            static std::uint64_t bucketUpper(size_t bucket);
+
+        private:
+            struct alignas(64) Shard
+            {
+                std::atomic<std::uint64_t> buckets[kBuckets]{};
+                std::atomic<std::uint64_t> count{0}, sum{0}, max{0};
+            };
+            std::array<Shard, kShards> shards;
+
+            std::array<std::uint64_t, kBuckets> merged() const;
+        };
+
+        /// Records the nanoseconds from construction to destruction.
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(Histogram &histogram)
+                : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+            ~ScopedTimer();
+
+        private:
+            Histogram &histogram;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        /// Process-wide metrics, exported in the Prometheus text format.
+        ///
+        /// Metrics are created on first use and live as long as the
+        /// process; callers keep the returned reference, typically in a
+        /// function-local static, so the hot path never touches the
+        /// registry. A series is a name plus an optional label string such
+        /// as `cache="wigner"`. Histograms are exported as summaries in
+        /// seconds, with quantiles 0.5, 0.9, 0.99 and 0.999.
+        class MetricsRegistry
+        {
+            SINGLETON(MetricsRegistry)
+
+        public:
+            ~MetricsRegistry();
+
+            Counter &counter(const std::string &name, const std::string &help, const std::string &labels = "");
+            Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+            Histogram &histogram(const std::string &name, const std::string &help, const std::string &labels = "");
+
+            std::string exportText() const;
+
+            /// Writes through a temporary file and a rename, so readers
+            /// never see a partial export.
+            bool writeText(const std::string &path) const;
+
+            /// Answers every connection on 127.0.0.1:port with the export
+            /// from a background thread. Returns the bound port (port 0
+            /// picks a free one), or -1.
+            int serve(int port);
+            void stopServing();
+
+        private:
+            enum class Type
+            {
+                Counter,
+                Gauge,
+                Histogram
+            };
+
+            struct Family
+            {
+                Type type;
+                std::string help;
+                std::map<std::string, std::unique_ptr<Counter>> counters; // by labels
+                std::map<std::string, std::unique_ptr<Gauge>> gauges;
+                std::map<std::string, std::unique_ptr<Histogram>> histograms;
+            };
+
+            mutable std::mutex registryMutex;
+            std::map<std::string, Family> families;
+
+            std::thread server;
+            std::atomic<bool> serving{false};
+            int listenFd = -1;
+
+            Family &family(const std::string &name, const std::string &help, Type type);
+        };
+
+        /// The process-wide registry.
+        inline MetricsRegistry &metrics() { return MetricsRegistry::getMetricsRegistry(); }
+
+    } // namespace util
+} // namespace MetaWaveCompiler
@@ -103,7 +103,7 @@ namespace MetaWaveCompiler
         template <typename T>
         inline Datatype type()
         {
-            taco_ierror << "Unsupported type";
+            metawave_ierror << "Unsupported type";
             return Int32;
         }
 
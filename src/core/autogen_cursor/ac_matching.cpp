@@ -0,0 +1,674 @@
+#include "core/autogen_cursor/ac_matching.h"
+#include <algorithm>
+#include <functional>
+
+namespace qc
+{
+
+    namespace
+    {
+        struct Term
+        {
+            double coefficient;
+            std::unique_ptr<Expression> expr;
+        };
+
+        const SumExpression *as_sum(const Expression &expr)
+        {
+            return expr.type() == Expression::Type::SUM ? dynamic_cast<const SumExpression *>(&expr) : nullptr;
+        }
+
+        bool is_sum_like(const Expression &expr)
+        {
+            return (expr.type() == Expression::Type::ADD && expr.is_binary()) ||
+                   (expr.type() == Expression::Type::SUBTRACT && expr.is_binary()) || as_sum(expr);
+        }
+
+        int compare_text(const std::string &a, const std::string &b)
+        {
+            return a < b ? -1 : (b < a ? 1 : 0);
+        }
+
+        int compare_value(double a, double b)
+        {
+            return a < b ? -1 : (b < a ? 1 : 0);
+        }
+
+        bool less(const std::unique_ptr<Expression> &a, const std::unique_ptr<Expression> &b)
+        {
+            return ACNormalizer::compare(*a, *b) < 0;
+        }
+
+        // Product of numeric * commuting * ordered, collapsed where possible
+        std::unique_ptr<Expression> make_product(double numeric, std::vector<std::unique_ptr<Expression>> commuting,
+                                                 std::vector<std::unique_ptr<Expression>> ordered)
+        {
+            if (numeric == 0.0)
+                return ExpressionFactory::zero();
+
+            std::stable_sort(commuting.begin(), commuting.end(), less);
+            std::vector<std::unique_ptr<Expression>> factors;
+            factors.reserve(commuting.size() + ordered.size() + 1);
+            if (numeric != 1.0)
+                factors.push_back(ExpressionFactory::constant(numeric));
+            for (auto &factor : commuting)
+                factors.push_back(std::move(factor));
+            for (auto &factor : ordered)
+                factors.push_back(std::move(factor));
+
+            if (factors.empty())
+                return ExpressionFactory::one();
+            if (factors.size() == 1)
+                return std::move(factors[0]);
+            return ExpressionFactory::product(std::move(factors));
+        }
+
+        // Adds a normalized factor, splicing products and scaled terms
+        void push_factor(std::unique_ptr<Expression> factor, double &numeric,
+                         std::vector<std::unique_ptr<Expression>> &commuting,
+                         std::vector<std::unique_ptr<Expression>> &ordered)
+        {
+            double value;
+            if (ACNormalizer::constant_value(*factor, value))
+            {
+                numeric *= value;
+            }
+            else if (factor->type() == Expression::Type::MULTIPLY)
+            {
+                for (size_t i = 0; i < factor->num_children(); ++i)
+                    push_factor(factor->child(i).clone(), numeric, commuting, ordered);
+            }
+            else if (ACNormalizer::is_commutative(*factor))
+            {
+                commuting.push_back(std::move(factor));
+            }
+            else
+            {
+                ordered.push_back(std::move(factor));
+            }
+        }
+
+        void collect_factors(const Expression &expr, double &numeric,
+                             std::vector<std::unique_ptr<Expression>> &commuting,
+                             std::vector<std::unique_ptr<Expression>> &ordered)
+        {
+            if (expr.type() == Expression::Type::MULTIPLY)
+            {
+                for (size_t i = 0; i < expr.num_children(); ++i)
+                    collect_factors(expr.child(i), numeric, commuting, ordered);
+                return;
+            }
+            push_factor(ACNormalizer::normalize(expr), numeric, commuting, ordered);
+        }
+
+        // Splits the leading constant of a normalized product off a term
+        void add_term(std::unique_ptr<Expression> term, double coefficient, std::vector<Term> &terms, double &constant)
+        {
+            double value;
+            if (ACNormalizer::constant_value(*term, value))
+            {
+                constant += coefficient * value;
+                return;
+            }
+            if (term->type() == Expression::Type::MULTIPLY && term->num_children() > 1 &&
+                ACNormalizer::constant_value(term->child(0), value))
+            {
+                std::vector<std::unique_ptr<Expression>> rest;
+                for (size_t i = 1; i < term->num_children(); ++i)
+                    rest.push_back(term->child(i).clone());
+                coefficient *= value;
+                term = rest.size() == 1 ? std::move(rest[0]) : ExpressionFactory::product(std::move(rest));
+            }
+            terms.push_back(Term{coefficient, std::move(term)});
+        }
+
+        void collect_terms(const Expression &expr, double coefficient, std::vector<Term> &terms, double &constant)
+        {
+            if (expr.type() == Expression::Type::ADD && expr.is_binary())
+            {
+                collect_terms(expr.child(0), coefficient, terms, constant);
+                collect_terms(expr.child(1), coefficient, terms, constant);
+            }
+            else if (expr.type() == Expression::Type::SUBTRACT && expr.is_binary())
+            {
+                collect_terms(expr.child(0), coefficient, terms, constant);
+                collect_terms(expr.child(1), -coefficient, terms, constant);
+            }
+            else if (const auto *sum = as_sum(expr))
+            {
+                for (size_t i = 0; i < sum->num_terms(); ++i)
+                    collect_terms(sum->child(i), coefficient * sum->coefficient(i), terms, constant);
+            }
+            else
+            {
+                auto term = ACNormalizer::normalize(expr);
+                if (const auto *inner = as_sum(*term))
+                {
+                    for (size_t i = 0; i < inner->num_terms(); ++i)
+                        add_term(inner->child(i).clone(), coefficient * inner->coefficient(i), terms, constant);
+                }
+                else
+                {
+                    add_term(std::move(term), coefficient, terms, constant);
+                }
+            }
+        }
+
+        std::unique_ptr<Expression> normalize_sum(const Expression &expr)
+        {
+            std::vector<Term> terms;
+            double constant = 0.0;
+            collect_terms(expr, 1.0, terms, constant);
+
+            std::stable_sort(terms.begin(), terms.end(), [](const Term &a, const Term &b)
+                             { return ACNormalizer::compare(*a.expr, *b.expr) < 0; });
+
+            std::vector<Term> merged;
+            merged.reserve(terms.size() + 1);
+            if (constant != 0.0)
+                merged.push_back(Term{1.0, ExpressionFactory::constant(constant)});
+            for (auto &term : terms)
+            {
+                if (!merged.empty() && ACNormalizer::compare(*merged.back().expr, *term.expr) == 0)
+                    merged.back().coefficient += term.coefficient;
+                else
+                    merged.push_back(std::move(term));
+            }
+            merged.erase(std::remove_if(merged.begin(), merged.end(), [](const Term &term)
+                                        { return term.coefficient == 0.0; }),
+                         merged.end());
+
+            if (merged.empty())
+                return ExpressionFactory::zero();
+            if (merged.size() == 1)
+            {
+                double numeric = 1.0;
+                std::vector<std::unique_ptr<Expression>> commuting, ordered;
+                push_factor(std::move(merged[0].expr), numeric, commuting, ordered);
+                return make_product(numeric * merged[0].coefficient, std::move(commuting), std::move(ordered));
+            }
+
+            auto result = std::make_unique<SumExpression>();
+            for (auto &term : merged)
+                result->add_term(std::move(term.expr), term.coefficient);
+            return std::move(result);
+        }
+
+        std::unique_ptr<Expression> normalize_product(const Expression &expr)
+        {
+            double numeric = 1.0;
+            std::vector<std::unique_ptr<Expression>> commuting, ordered;
+            collect_factors(expr, numeric, commuting, ordered);
+            return make_product(numeric, std::move(commuting), std::move(ordered));
+        }
+
+        std::string wildcard_name(const Expression &expr)
+        {
+            return static_cast<const SymbolExpression &>(expr).symbol().name();
+        }
+
+        void count_wildcards(const Expression &expr, std::map<std::string, int> &counts)
+        {
+            if (ACMatcher::is_wildcard(expr))
+            {
+                ++counts[wildcard_name(expr)];
+                return;
+            }
+            for (size_t i = 0; i < expr.num_children(); ++i)
+                count_wildcards(expr.child(i), counts);
+        }
+
+        bool has_wildcards(const Expression &expr)
+        {
+            if (ACMatcher::is_wildcard(expr))
+                return true;
+            for (size_t i = 0; i < expr.num_children(); ++i)
+            {
+                if (has_wildcards(expr.child(i)))
+                    return true;
+            }
+            return false;
+        }
+
+        using Bindings = ACMatcher::Bindings;
+        using Continuation = std::function<bool(Bindings &)>;
+
+        struct Operand
+        {
+            double coefficient;
+            const Expression *expr;
+        };
+
+        // One match of a normalized pattern; wildcard counts span the whole pattern
+        class Matcher
+        {
+        private:
+            std::map<std::string, int> occurrences_;
+
+            struct Operands
+            {
+                bool sum;
+                std::vector<Operand> pattern;
+                std::vector<Operand> subject;
+                std::vector<bool> used;
+                std::vector<size_t> shared;      // pattern operands matched by backtracking
+                std::vector<size_t> independent; // pattern operands matched by bipartite matching
+                const Expression *rest = nullptr;
+            };
+
+            static std::vector<Operand> operands(const Expression &expr, bool sum)
+            {
+                std::vector<Operand> result;
+                const auto *s = as_sum(expr);
+                bool same = sum ? s != nullptr : expr.type() == Expression::Type::MULTIPLY;
+                if (!same)
+                {
+                    result.push_back(Operand{1.0, &expr});
+                    return result;
+                }
+                for (size_t i = 0; i < expr.num_children(); ++i)
+                    result.push_back(Operand{s ? s->coefficient(i) : 1.0, &expr.child(i)});
+                return result;
+            }
+
+            bool independent(const Expression &expr, const Bindings &bindings) const
+            {
+                std::map<std::string, int> counts;
+                count_wildcards(expr, counts);
+                for (const auto &count : counts)
+                {
+                    if (!bindings.count(count.first) && occurrences_.at(count.first) > 1)
+                        return false;
+                }
+                return true;
+            }
+
+            bool children(const Expression &p, const Expression &s, size_t i, Bindings &bindings,
+                          const Continuation &next)
+            {
+                if (i == p.num_children())
+                    return next(bindings);
+                return node(p.child(i), s.child(i), bindings, [&](Bindings &b)
+                            { return children(p, s, i + 1, b, next); });
+            }
+
+            bool bind(const std::string &name, std::unique_ptr<Expression> value, Bindings &bindings,
+                      const Continuation &next)
+            {
+                auto it = bindings.find(name);
+                if (it != bindings.end())
+                    return ACNormalizer::compare(*it->second, *value) == 0 && next(bindings);
+                bindings[name] = std::shared_ptr<const Expression>(std::move(value));
+                if (next(bindings))
+                    return true;
+                bindings.erase(name);
+                return false;
+            }
+
+            bool shared(Operands &ops, size_t j, Bindings &bindings, const Continuation &next)
+            {
+                if (j == ops.shared.size())
+                    return assign(ops, bindings, next);
+
+                const Operand &p = ops.pattern[ops.shared[j]];
+                const Operand *tried = nullptr;
+                for (size_t s = 0; s < ops.subject.size(); ++s)
+                {
+                    const Operand &candidate = ops.subject[s];
+                    if (ops.used[s] || candidate.coefficient != p.coefficient)
+                        continue;
+                    // Equal operands of the multiset are interchangeable
+                    if (tried && ACNormalizer::compare(*tried->expr, *candidate.expr) == 0)
+                        continue;
+                    tried = &candidate;
+
+                    ops.used[s] = true;
+                    bool matched = node(*p.expr, *candidate.expr, bindings, [&](Bindings &b)
+                                        { return shared(ops, j + 1, b, next); });
+                    ops.used[s] = false;
+                    if (matched)
+                        return true;
+                }
+                return false;
+            }
+
+            // Kuhn's augmenting paths over the compatibility graph
+            static bool augment(size_t p, const std::vector<std::vector<size_t>> &edges,
+                                std::vector<int> &owner, std::vector<bool> &visited)
+            {
+                for (size_t s : edges[p])
+                {
+                    if (visited[s])
+                        continue;
+                    visited[s] = true;
+                    if (owner[s] < 0 || augment(static_cast<size_t>(owner[s]), edges, owner, visited))
+                    {
+                        owner[s] = static_cast<int>(p);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool assign(Operands &ops, Bindings &bindings, const Continuation &next)
+            {
+                const auto accept = [](Bindings &)
+                { return true; };
+
+                std::vector<std::vector<size_t>> edges(ops.independent.size());
+                for (size_t i = 0; i < ops.independent.size(); ++i)
+                {
+                    const Operand &p = ops.pattern[ops.independent[i]];
+                    for (size_t s = 0; s < ops.subject.size(); ++s)
+                    {
+                        if (ops.used[s] || ops.subject[s].coefficient != p.coefficient)
+                            continue;
+                        Bindings trial = bindings;
+                        if (node(*p.expr, *ops.subject[s].expr, trial, accept))
+                            edges[i].push_back(s);
+                    }
+                }
+
+                std::vector<int> owner(ops.subject.size(), -1);
+                for (size_t i = 0; i < ops.independent.size(); ++i)
+                {
+                    std::vector<bool> visited(ops.subject.size(), false);
+                    if (!augment(i, edges, owner, visited))
+                        return false;
+                }
+
+                Bindings saved = bindings;
+                std::vector<bool> used = ops.used;
+                for (size_t s = 0; s < owner.size(); ++s)
+                {
+                    if (owner[s] < 0)
+                        continue;
+                    ops.used[s] = true;
+                    node(*ops.pattern[ops.independent[owner[s]]].expr, *ops.subject[s].expr, bindings, accept);
+                }
+
+                bool matched = rest(ops, bindings, next);
+                if (!matched)
+                {
+                    bindings = saved;
+                    ops.used = used;
+                }
+                return matched;
+            }
+
+            bool rest(Operands &ops, Bindings &bindings, const Continuation &next)
+            {
+                if (!ops.rest)
+                    return next(bindings);
+
+                std::unique_ptr<Expression> value;
+                if (ops.sum)
+                {
+                    auto sum = std::make_unique<SumExpression>();
+                    for (size_t s = 0; s < ops.subject.size(); ++s)
+                    {
+                        if (!ops.used[s])
+                            sum->add_term(ops.subject[s].expr->clone(), ops.subject[s].coefficient);
+                    }
+                    value = ACNormalizer::normalize(*sum);
+                }
+                else
+                {
+                    std::vector<std::unique_ptr<Expression>> factors;
+                    for (size_t s = 0; s < ops.subject.size(); ++s)
+                    {
+                        if (!ops.used[s])
+                            factors.push_back(ops.subject[s].expr->clone());
+                    }
+                    value = ACNormalizer::normalize(*ExpressionFactory::product(std::move(factors)));
+                }
+                return bind(wildcard_name(*ops.rest), std::move(value), bindings, next);
+            }
+
+            bool commutative(const Expression &p, const Expression &s, Bindings &bindings, const Continuation &next)
+            {
+                Operands ops;
+                ops.sum = as_sum(p) != nullptr;
+                ops.subject = operands(s, ops.sum);
+                ops.used.assign(ops.subject.size(), false);
+
+                std::vector<Operand> open;
+                for (const Operand &operand : operands(p, ops.sum))
+                {
+                    if (ACMatcher::is_sequence_wildcard(*operand.expr))
+                    {
+                        if (ops.rest || operand.coefficient != 1.0)
+                            return false;
+                        ops.rest = operand.expr;
+                    }
+                    else if (!has_wildcards(*operand.expr))
+                    {
+                        // Multiset lookup among the sorted subject operands
+                        auto first = std::lower_bound(ops.subject.begin(), ops.subject.end(), operand,
+                                                      [](const Operand &a, const Operand &b)
+                                                      { return ACNormalizer::compare(*a.expr, *b.expr) < 0; });
+                        bool found = false;
+                        for (auto it = first; it != ops.subject.end() && !found &&
+                                              ACNormalizer::compare(*it->expr, *operand.expr) == 0;
+                             ++it)
+                        {
+                            size_t s = static_cast<size_t>(it - ops.subject.begin());
+                            if (!ops.used[s] && it->coefficient == operand.coefficient)
+                                found = ops.used[s] = true;
+                        }
+                        if (!found)
+                            return false;
+                    }
+                    else
+                    {
+                        open.push_back(operand);
+                    }
+                }
+
+                size_t remaining = static_cast<size_t>(std::count(ops.used.begin(), ops.used.end(), false));
+                if (ops.rest ? open.size() > remaining : open.size() != remaining)
+                    return false;
+
+                // A rest bound elsewhere depends on the choice of every operand
+                bool rest_shared = ops.rest && !independent(*ops.rest, bindings);
+                ops.pattern = open;
+                for (size_t i = 0; i < open.size(); ++i)
+                {
+                    if (!rest_shared && independent(*open[i].expr, bindings))
+                        ops.independent.push_back(i);
+                    else
+                        ops.shared.push_back(i);
+                }
+                return shared(ops, 0, bindings, next);
+            }
+
+        public:
+            explicit Matcher(const Expression &pattern) { count_wildcards(pattern, occurrences_); }
+
+            bool node(const Expression &p, const Expression &s, Bindings &bindings, const Continuation &next)
+            {
+                if (ACMatcher::is_wildcard(p))
+                    return bind(wildcard_name(p), s.clone(), bindings, next);
+
+                if (as_sum(p) || (p.type() == Expression::Type::MULTIPLY && ACNormalizer::is_commutative(p) &&
+                                  ACNormalizer::is_commutative(s)))
+                    return commutative(p, s, bindings, next);
+
+                if (p.type() != s.type() || p.num_children() != s.num_children())
+                    return false;
+                if (p.is_leaf())
+                    return ACNormalizer::compare(p, s) == 0 && next(bindings);
+                return children(p, s, 0, bindings, next);
+            }
+        };
+    }
+
+    // ACNormalizer implementation
+    std::unique_ptr<Expression> ACNormalizer::normalize(const Expression &expr)
+    {
+        if (is_sum_like(expr))
+            return normalize_sum(expr);
+        if (expr.type() == Expression::Type::MULTIPLY)
+            return normalize_product(expr);
+
+        auto result = expr.clone();
+        for (size_t i = 0; i < expr.num_children(); ++i)
+            result->set_child(i, normalize(expr.child(i)));
+        return result;
+    }
+
+    int ACNormalizer::compare(const Expression &a, const Expression &b)
+    {
+        if (a.type() != b.type())
+            return a.type() < b.type() ? -1 : 1;
+
+        switch (a.type())
+        {
+        case Expression::Type::SYMBOL:
+        {
+            double u, v;
+            bool cu = constant_value(a, u), cv = constant_value(b, v);
+            if (cu != cv)
+                return cu ? -1 : 1;
+            if (cu)
+                return compare_value(u, v);
+            const Symbol &x = static_cast<const SymbolExpression &>(a).symbol();
+            const Symbol &y = static_cast<const SymbolExpression &>(b).symbol();
+            if (x.name() != y.name())
+                return compare_text(x.name(), y.name());
+            return compare_value(static_cast<int>(x.type()), static_cast<int>(y.type()));
+        }
+        case Expression::Type::TENSOR:
+        case Expression::Type::OPERATOR:
+        case Expression::Type::OPERATOR_PRODUCT:
+            return compare_text(a.to_string(), b.to_string());
+        default:
+            break;
+        }
+
+        if (a.num_children() != b.num_children())
+            return a.num_children() < b.num_children() ? -1 : 1;
+        const auto *sa = as_sum(a);
+        const auto *sb = as_sum(b);
+        for (size_t i = 0; i < a.num_children(); ++i)
+        {
+            int c = compare(a.child(i), b.child(i));
+            if (c != 0)
+                return c;
+            if (sa && sb && sa->coefficient(i) != sb->coefficient(i))
+                return compare_value(sa->coefficient(i), sb->coefficient(i));
+        }
+
+        // Nodes with data besides their children
+        switch (a.type())
+        {
+        case Expression::Type::CONTRACT:
+        case Expression::Type::DERIVATIVE:
+        case Expression::Type::INTEGRAL:
+        case Expression::Type::FUNCTION_CALL:
+            return compare_text(a.to_string(), b.to_string());
+        case Expression::Type::SUM:
+            return sa && sb ? 0 : compare_text(a.to_string(), b.to_string());
+        default:
+            return a.is_leaf() ? compare_text(a.to_string(), b.to_string()) : 0;
+        }
+    }
+
+    bool ACNormalizer::is_commutative(const Expression &expr)
+    {
+        switch (expr.type())
+        {
+        case Expression::Type::OPERATOR:
+        case Expression::Type::OPERATOR_PRODUCT:
+        case Expression::Type::COMMUTATOR:
+        case Expression::Type::ANTICOMMUTATOR:
+            return false;
+        case Expression::Type::SYMBOL:
+            if (static_cast<const SymbolExpression &>(expr).symbol().get_property("commutative") == "false")
+                return false;
+            break;
+        case Expression::Type::TENSOR:
+            if (static_cast<const TensorExpression &>(expr).tensor().get_property("commutative") == "false")
+                return false;
+            break;
+        default:
+            break;
+        }
+        if (expr.get_property("commutative") == "false")
+            return false;
+
+        for (size_t i = 0; i < expr.num_children(); ++i)
+        {
+            if (!is_commutative(expr.child(i)))
+                return false;
+        }
+        return true;
+    }
+
+    bool ACNormalizer::constant_value(const Expression &expr, double &value)
+    {
+        if (expr.type() != Expression::Type::SYMBOL)
+            return false;
+        auto *scalar = dynamic_cast<const ScalarSymbol *>(&static_cast<const SymbolExpression &>(expr).symbol());
+        if (!scalar)
+            return false;
+        value = scalar->value();
+        return true;
+    }
+
+    // ACMatcher implementation
+    bool ACMatcher::is_wildcard(const Expression &expr)
+    {
+        if (expr.type() != Expression::Type::SYMBOL)
+            return false;
+        const std::string &name = static_cast<const SymbolExpression &>(expr).symbol().name();
+        return name.size() > 1 && name[0] == '?';
+    }
+
+    bool ACMatcher::is_sequence_wildcard(const Expression &expr)
+    {
+        return is_wildcard(expr) && wildcard_name(expr).back() == '*' && wildcard_name(expr).size() > 2;
+    }
+
+    bool ACMatcher::match(const Expression &pattern, const Expression &subject, Bindings &bindings)
+    {
+        auto p = ACNormalizer::normalize(pattern);
+        auto s = ACNormalizer::normalize(subject);
+        Matcher matcher(*p);
+        return matcher.node(*p, *s, bindings, [](Bindings &)
+                            { return true; });
+    }
+
+    std::unique_ptr<Expression> ACMatcher::substitute(const Expression &replacement, const Bindings &bindings)
+    {
+        if (is_wildcard(replacement))
+        {
+            auto it = bindings.find(wildcard_name(replacement));
+            if (it != bindings.end())
+                return it->second->clone();
+        }
+
+        auto result = replacement.clone();
+        for (size_t i = 0; i < replacement.num_children(); ++i)
+            result->set_child(i, substitute(replacement.child(i), bindings));
+        return result;
+    }
+
+    std::unique_ptr<Expression> ACMatcher::rewrite(const Expression &expr, const Expression &pattern,
+                                                   const Expression &replacement)
+    {
+        Bindings bindings;
+        if (!match(pattern, expr, bindings))
+            return nullptr;
+        return ACNormalizer::normalize(*substitute(replacement, bindings));
+    }
+
+    Simplifier::Rule ACMatcher::rule(const Expression &pattern, const Expression &replacement)
+    {
+        std::shared_ptr<const Expression> p = ACNormalizer::normalize(pattern);
+        std::shared_ptr<const Expression> r = replacement.clone();
+        return [p, r](const Expression &expr)
+        { return rewrite(expr, *p, *r); };
+    }
+
+} // namespace qc
@@ -0,0 +1,324 @@
+#include "core/autogen_cursor/antisymmetry.h"
+#include "core/autogen_cursor/layout.h"
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        std::vector<AntisymmetricGroup> parse_group_property(const Tensor &tensor)
+        {
+            // Format: "0,1;2,3"
+            std::vector<AntisymmetricGroup> result;
+            std::istringstream groups(tensor.get_property("antisymmetric_groups"));
+            std::string group_str;
+            while (std::getline(groups, group_str, ';'))
+            {
+                AntisymmetricGroup group;
+                std::istringstream positions(group_str);
+                std::string pos_str;
+                while (std::getline(positions, pos_str, ','))
+                {
+                    size_t pos = std::stoul(pos_str);
+                    if (pos < tensor.actual_rank())
+                        group.positions.push_back(pos);
+                }
+                if (group.size() >= 2)
+                {
+                    group.space = SpaceRegistry::global().space_of(tensor.indices()[group.positions[0]]);
+                    result.push_back(group);
+                }
+            }
+            return result;
+        }
+
+        void split_by_space(const Tensor &tensor, size_t begin, size_t end,
+                            bool flagged_only, std::vector<AntisymmetricGroup> &result)
+        {
+            // Runs of consecutive indices in the same space form a group
+            const auto &registry = SpaceRegistry::global();
+            size_t pos = begin;
+            while (pos < end)
+            {
+                const Index &first = tensor.indices()[pos];
+                int space = registry.space_of(first);
+                size_t run_end = pos + 1;
+                while (run_end < end && registry.space_of(tensor.indices()[run_end]) == space &&
+                       (!flagged_only || tensor.indices()[run_end].is_antisymmetric()))
+                {
+                    ++run_end;
+                }
+                if (run_end - pos >= 2 && (!flagged_only || first.is_antisymmetric()))
+                {
+                    AntisymmetricGroup group;
+                    group.space = space;
+                    for (size_t p = pos; p < run_end; ++p)
+                        group.positions.push_back(p);
+                    result.push_back(group);
+                }
+                pos = run_end;
+            }
+        }
+
+        double factorial(size_t k)
+        {
+            double result = 1.0;
+            for (size_t i = 2; i <= k; ++i)
+                result *= static_cast<double>(i);
+            return result;
+        }
+    }
+
+    // AntisymmetryAnalysis implementation
+    std::vector<AntisymmetricGroup> AntisymmetryAnalysis::groups(const Tensor &tensor)
+    {
+        // Groups of a transposed view are those of its storage, relabelled
+        if (!tensor.get_property("layout").empty())
+        {
+            auto layout = LayoutPropagation::storage_layout(tensor);
+            auto result = groups(LayoutPropagation::storage_view(tensor));
+            for (auto &group : result)
+            {
+                for (auto &pos : group.positions)
+                    pos = layout[pos];
+            }
+            return result;
+        }
+
+        if (tensor.has_property("antisymmetric_groups"))
+        {
+            return parse_group_property(tensor);
+        }
+
+        std::vector<AntisymmetricGroup> result;
+        size_t rank = tensor.actual_rank();
+        if (tensor.is_antisymmetric())
+        {
+            // Even rank: upper (creation) and lower (annihilation) halves are
+            // antisymmetrized separately, e.g. t_ij^ab -> {i,j}, {a,b}
+            if (rank % 2 == 0 && rank > 2)
+            {
+                split_by_space(tensor, 0, rank / 2, false, result);
+                split_by_space(tensor, rank / 2, rank, false, result);
+            }
+            else
+            {
+                split_by_space(tensor, 0, rank, false, result);
+            }
+        }
+        else if (tensor.has_antisymmetric_indices())
+        {
+            split_by_space(tensor, 0, rank, true, result);
+        }
+        return result;
+    }
+
+    const AntisymmetricGroup *AntisymmetryAnalysis::find_group(const std::vector<AntisymmetricGroup> &groups,
+                                                               const Tensor &tensor, const std::string &label)
+    {
+        for (const auto &group : groups)
+        {
+            for (size_t pos : group.positions)
+            {
+                if (tensor.indices()[pos].label() == label)
+                    return &group;
+            }
+        }
+        return nullptr;
+    }
+
+    long AntisymmetryAnalysis::packed_size(long n, size_t k)
+    {
+        if (n < static_cast<long>(k))
+            return 0;
+        long result = 1;
+        for (size_t i = 0; i < k; ++i)
+        {
+            result = result * (n - static_cast<long>(i)) / static_cast<long>(i + 1);
+        }
+        return result;
+    }
+
+    long AntisymmetryAnalysis::packed_offset(const std::vector<long> &sorted_values)
+    {
+        long offset = 0;
+        for (size_t m = 0; m < sorted_values.size(); ++m)
+        {
+            offset += packed_size(sorted_values[m], m + 1);
+        }
+        return offset;
+    }
+
+    int AntisymmetryAnalysis::sort_with_sign(std::vector<long> &values)
+    {
+        int sign = 1;
+        for (size_t i = 1; i < values.size(); ++i)
+        {
+            for (size_t j = i; j > 0 && values[j - 1] >= values[j]; --j)
+            {
+                if (values[j - 1] == values[j])
+                    return 0;
+                std::swap(values[j - 1], values[j]);
+                sign = -sign;
+            }
+        }
+        return sign;
+    }
+
+    // RestrictedSummation implementation
+    RestrictedSummation::Plan RestrictedSummation::plan(const ContractionTerm &term)
+    {
+        Plan result;
+        result.prefactor = term.prefactor();
+        result.iteration_fraction = 1.0;
+
+        // Output blocks: only the strictly ordered block is computed
+        for (const auto &group : AntisymmetryAnalysis::groups(term.output()))
+        {
+            std::vector<std::string> labels;
+            for (size_t pos : group.positions)
+                labels.push_back(term.output().indices()[pos].label());
+            result.external_groups.push_back(labels);
+        }
+
+        std::vector<std::vector<AntisymmetricGroup>> factor_groups;
+        for (const auto &factor : term.factors())
+            factor_groups.push_back(AntisymmetryAnalysis::groups(factor));
+
+        // Labels of `group` in `factor` that are summed over
+        auto summed_labels_of = [&term](const Tensor &factor, const AntisymmetricGroup &group)
+        {
+            std::vector<std::string> labels;
+            for (size_t pos : group.positions)
+            {
+                const auto &label = factor.indices()[pos].label();
+                if (term.is_summed(label))
+                    labels.push_back(label);
+            }
+            return labels;
+        };
+
+        std::set<std::string> restricted;
+        for (size_t f = 0; f < term.num_factors(); ++f)
+        {
+            for (const auto &group : factor_groups[f])
+            {
+                std::vector<std::string> candidate;
+                for (const auto &label : summed_labels_of(term.factor(f), group))
+                {
+                    if (!restricted.count(label))
+                        candidate.push_back(label);
+                }
+
+                // Shrink the candidate until every factor touching it holds it
+                // in a single antisymmetric group
+                bool stable = false;
+                int touching = 0;
+                while (candidate.size() >= 2 && !stable)
+                {
+                    stable = true;
+                    touching = 0;
+                    for (size_t g = 0; g < term.num_factors() && stable; ++g)
+                    {
+                        const auto &other = term.factor(g);
+                        auto labels = other.indices().get_labels();
+                        bool touches = std::any_of(candidate.begin(), candidate.end(),
+                                                   [&labels](const std::string &l)
+                                                   { return labels.count(l) > 0; });
+                        if (!touches)
+                            continue;
+                        ++touching;
+
+                        const auto *other_group = AntisymmetryAnalysis::find_group(
+                            factor_groups[g], other, candidate[0]);
+                        std::vector<std::string> kept;
+                        if (other_group)
+                        {
+                            auto in_group = summed_labels_of(other, *other_group);
+                            for (const auto &label : candidate)
+                            {
+                                if (std::find(in_group.begin(), in_group.end(), label) != in_group.end())
+                                    kept.push_back(label);
+                            }
+                        }
+                        if (kept.size() != candidate.size())
+                        {
+                            candidate = kept;
+                            stable = false;
+                        }
+                    }
+                }
+
+                if (candidate.size() >= 2 && touching % 2 == 0)
+                {
+                    for (const auto &label : candidate)
+                        restricted.insert(label);
+                    result.summed_groups.push_back(candidate);
+                }
+            }
+        }
+
+        // Each unordered tuple of a restricted dummy group stands for k! ordered ones
+        for (const auto &group : result.summed_groups)
+            result.prefactor *= factorial(group.size());
+        for (const auto &group : result.external_groups)
+            result.iteration_fraction /= factorial(group.size());
+        for (const auto &group : result.summed_groups)
+            result.iteration_fraction /= factorial(group.size());
+
+        // Loop nest: externals then summed. A group l_0 < l_1 < ... is emitted
+        // outermost-last so that each loop is bounded by the enclosing one.
+        const auto &registry = SpaceRegistry::global();
+        auto emit = [&result, &registry](const IndexSet &indices, const std::vector<std::vector<std::string>> &groups,
+                              bool summed)
+        {
+            std::set<std::string> emitted;
+            for (const auto &idx : indices)
+            {
+                if (emitted.count(idx->label()))
+                    continue;
+                const std::vector<std::string> *owner = nullptr;
+                for (const auto &group : groups)
+                {
+                    if (std::find(group.begin(), group.end(), idx->label()) != group.end())
+                        owner = &group;
+                }
+                if (!owner)
+                {
+                    result.loops.push_back({idx->label(), registry.space_of(*idx), "", summed});
+                    emitted.insert(idx->label());
+                    continue;
+                }
+                for (size_t m = owner->size(); m-- > 0;)
+                {
+                    std::string upper = (m + 1 < owner->size()) ? (*owner)[m + 1] : "";
+                    result.loops.push_back({(*owner)[m], registry.space_of(*idx), upper, summed});
+                    emitted.insert((*owner)[m]);
+                }
+            }
+        };
+        emit(term.external_indices(), result.external_groups, false);
+        emit(term.summed_indices(), result.summed_groups, true);
+
+        return result;
+    }
+
+    int RestrictedSummation::loop_group_of(const Plan &plan, const std::string &label)
+    {
+        int id = 0;
+        for (const auto *groups : {&plan.external_groups, &plan.summed_groups})
+        {
+            for (const auto &group : *groups)
+            {
+                if (std::find(group.begin(), group.end(), label) != group.end())
+                    return id;
+                ++id;
+            }
+        }
+        return -1;
+    }
+
+} // namespace qc
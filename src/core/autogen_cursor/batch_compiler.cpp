@@ -0,0 +1,651 @@
+#include "core/autogen_cursor/batch_compiler.h"
+#include "core/autogen_cursor/delta_elimination.h"
+#include "core/autogen_cursor/equation_library.h"
+#include "core/autogen_cursor/kramers.h"
+#include "core/autogen_cursor/layout.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/autogen_cursor/rdm_generator.h"
+#include "core/autogen_cursor/term_fusion.h"
+#include "core/autogen_cursor/triples_generator.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace qc
+{
+
+    namespace
+    {
+        bool is_identifier(const std::string &name)
+        {
+            if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+                return false;
+            return std::all_of(name.begin(), name.end(), [](char c)
+                               { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+        }
+
+        bool set_option(BatchJob &job, const std::string &key, const std::string &value, std::string &error)
+        {
+            if (key == "strategy" && (value == "direct" || value == "pairwise"))
+                job.strategy = value;
+            else if (key == "spin" && (value == "none" || value == "kramers"))
+                job.spin = value;
+            else if (key == "backend" && (value == "double" || value == "float"))
+                job.backend = value;
+            else if (key == "truncation")
+            {
+                std::istringstream iss(value);
+                if (!(iss >> job.truncation) || !iss.eof() || job.truncation < -1)
+                {
+                    error = "invalid truncation '" + value + "'";
+                    return false;
+                }
+            }
+            else if (key == "memory")
+            {
+                if (!BatchCompiler::parse_bytes(value, job.memory))
+                {
+                    error = "invalid memory '" + value + "'";
+                    return false;
+                }
+            }
+            else
+            {
+                error = "unknown option '" + key + "=" + value + "'";
+                return false;
+            }
+            return true;
+        }
+
+        double seconds_since(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // Terms typed by field and grouped into one kernel per output
+        std::vector<std::vector<ContractionTerm>> kernel_groups(const std::vector<ContractionTerm> &terms)
+        {
+            std::vector<ContractionTerm> typed = terms;
+            CodeGenerator::annotate_outputs(typed);
+            return TermFusion::group(typed);
+        }
+
+        // Phase nodes of one job; every phase reads the previous one and its options
+        std::array<int, kNumBatchPhases> add_job(BuildGraph &graph, const BatchJob &job)
+        {
+            std::array<int, kNumBatchPhases> nodes;
+            nodes.fill(-1);
+            int previous = -1;
+            for (size_t p = 0; p < kNumBatchPhases; ++p)
+            {
+                const BatchPhase phase = static_cast<BatchPhase>(p);
+                const std::string name = job.name + "/" + BatchCompiler::phase_name(phase);
+                int rule = graph.add_rule(name + "/options", BatchCompiler::phase_options(job, phase));
+                if (rule < 0)
+                    return nodes;
+                std::vector<size_t> inputs;
+                if (previous >= 0)
+                    inputs.push_back(static_cast<size_t>(previous));
+                inputs.push_back(static_cast<size_t>(rule));
+
+                BuildGraph::Kind kind = BuildGraph::Kind::TERMS;
+                BuildGraph::Transform transform;
+                switch (phase)
+                {
+                case BatchPhase::DERIVE:
+                    transform = [job](const std::vector<const BuildArtifact *> &)
+                    {
+                        BuildArtifact artifact;
+                        BatchCompiler::derive(job, artifact.terms, artifact.error);
+                        return artifact;
+                    };
+                    break;
+                case BatchPhase::SIMPLIFY:
+                    transform = [job](const std::vector<const BuildArtifact *> &inputs)
+                    {
+                        BuildArtifact artifact;
+                        artifact.terms = inputs[0]->terms;
+                        BatchCompiler::simplify(job, artifact.terms, artifact.error);
+                        return artifact;
+                    };
+                    break;
+                case BatchPhase::FACTORIZE:
+                    kind = BuildGraph::Kind::INTERMEDIATE;
+                    transform = [job](const std::vector<const BuildArtifact *> &inputs)
+                    {
+                        BuildArtifact artifact;
+                        artifact.terms = inputs[0]->terms;
+                        BatchCompiler::factorize(job, artifact.terms, artifact.error);
+                        return artifact;
+                    };
+                    break;
+                case BatchPhase::GENERATE:
+                    kind = BuildGraph::Kind::KERNEL;
+                    transform = [job](const std::vector<const BuildArtifact *> &inputs)
+                    {
+                        BuildArtifact artifact;
+                        BatchResult result;
+                        if (BatchCompiler::generate(job, inputs[0]->terms, result))
+                            artifact.text = result.code;
+                        else
+                            artifact.error = result.error;
+                        return artifact;
+                    };
+                    break;
+                }
+                previous = graph.add_node(name, kind, inputs, transform);
+                if (previous < 0)
+                    return nodes;
+                nodes[p] = previous;
+            }
+            return nodes;
+        }
+    }
+
+    // BatchCompiler implementation
+    BatchCompiler::BatchCompiler(const BatchOptions &options) : options_(options) {}
+
+    size_t BatchCompiler::slots() const
+    {
+        if (options_.threads > 0)
+            return options_.threads;
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    bool BatchCompiler::parse_bytes(const std::string &text, double &bytes)
+    {
+        std::istringstream iss(text);
+        double value = 0.0;
+        std::string suffix;
+        if (!(iss >> value) || value < 0.0)
+            return false;
+        iss >> suffix;
+        const std::string units = "KMGT";
+        if (suffix.empty())
+            bytes = value;
+        else if (suffix.size() == 1 && units.find(suffix[0]) != std::string::npos)
+            bytes = value * std::pow(1024.0, static_cast<double>(units.find(suffix[0]) + 1));
+        else
+            return false;
+        return true;
+    }
+
+    const char *BatchCompiler::phase_name(BatchPhase phase)
+    {
+        switch (phase)
+        {
+        case BatchPhase::DERIVE:
+            return "derive";
+        case BatchPhase::SIMPLIFY:
+            return "simplify";
+        case BatchPhase::FACTORIZE:
+            return "factorize";
+        case BatchPhase::GENERATE:
+            return "generate";
+        }
+        return "";
+    }
+
+    bool BatchCompiler::parse_manifest(const std::string &text, std::vector<BatchJob> &jobs, std::string &error)
+    {
+        jobs.clear();
+        BatchJob defaults;
+        std::set<std::string> names;
+        std::istringstream lines(text);
+        std::string line;
+        for (int number = 1; std::getline(lines, line); ++number)
+        {
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::vector<std::string> fields;
+            for (std::string word; words >> word;)
+                fields.push_back(word);
+            if (fields.empty())
+                continue;
+
+            const bool is_default = fields[0] == "default";
+            if (!is_default && fields.size() < 2)
+            {
+                error = "line " + std::to_string(number) + ": expected '<name> <source> [key=value ...]'";
+                return false;
+            }
+
+            BatchJob job = defaults;
+            job.line = number;
+            size_t first_option = is_default ? 1 : 2;
+            if (!is_default)
+            {
+                job.name = fields[0];
+                job.source = fields[1];
+                if (!is_identifier(job.name) || !names.insert(job.name).second)
+                {
+                    error = "line " + std::to_string(number) + ": '" + job.name +
+                            "' is not a new identifier";
+                    return false;
+                }
+            }
+            for (size_t f = first_option; f < fields.size(); ++f)
+            {
+                size_t eq = fields[f].find('=');
+                std::string message;
+                if (eq == std::string::npos)
+                    message = "expected key=value, got '" + fields[f] + "'";
+                else
+                    set_option(job, fields[f].substr(0, eq), fields[f].substr(eq + 1), message);
+                if (!message.empty())
+                {
+                    error = "line " + std::to_string(number) + ": " + message;
+                    return false;
+                }
+            }
+
+            if (is_default)
+                defaults = job;
+            else
+                jobs.push_back(job);
+        }
+        return true;
+    }
+
+    bool BatchCompiler::derive(const BatchJob &job, std::vector<ContractionTerm> &terms, std::string &error)
+    {
+        terms.clear();
+        size_t colon = job.source.find(':');
+        std::string kind = job.source.substr(0, colon);
+        std::string what = colon == std::string::npos ? "" : job.source.substr(colon + 1);
+
+        if (kind == "builtin")
+        {
+            size_t slash = what.find('/');
+            EquationSetView set = EquationLibrary::load_builtin(what.substr(0, slash));
+            if (!set.valid())
+            {
+                error = "no builtin equation set '" + what.substr(0, slash) + "'";
+                return false;
+            }
+            if (slash != std::string::npos)
+            {
+                BlockRecordView block = set.block(what.substr(slash + 1));
+                if (!block.valid())
+                {
+                    error = "no block '" + what.substr(slash + 1) + "' in '" + what.substr(0, slash) + "'";
+                    return false;
+                }
+                terms = block.materialize();
+                return true;
+            }
+            for (size_t b = 0; b < set.num_blocks(); ++b)
+            {
+                std::vector<ContractionTerm> block = set.block(b).materialize();
+                terms.insert(terms.end(), block.begin(), block.end());
+            }
+            return true;
+        }
+        if (kind == "triples" && (what == "connected" || what == "disconnected"))
+        {
+            PerturbativeTriplesGenerator generator;
+            terms = what == "connected" ? generator.connected_terms() : generator.disconnected_terms();
+            return true;
+        }
+        if (kind == "rdm" && (what == "1" || what == "2"))
+        {
+            RdmEquations equations = RdmGenerator().equations(what == "1" ? 1 : 2);
+            terms = equations.intermediates;
+            for (const auto &block : equations.blocks)
+                terms.insert(terms.end(), block.second.begin(), block.second.end());
+            return true;
+        }
+        error = "unknown source '" + job.source + "'";
+        return false;
+    }
+
+    bool BatchCompiler::simplify(const BatchJob &job, std::vector<ContractionTerm> &terms, std::string &)
+    {
+        if (job.truncation >= 0)
+        {
+            terms.erase(std::remove_if(terms.begin(), terms.end(), [&job](const ContractionTerm &term)
+                                       { return term.num_factors() > static_cast<size_t>(job.truncation); }),
+                        terms.end());
+        }
+        if (job.spin == "kramers")
+            terms = KramersSymmetry::expand(terms);
+        terms = KroneckerDeltaElimination::apply(terms);
+        return true;
+    }
+
+    bool BatchCompiler::factorize(const BatchJob &job, std::vector<ContractionTerm> &terms, std::string &)
+    {
+        if (job.strategy != "pairwise")
+            return true;
+
+        // One term per contraction of the DAG; intermediates precede their consumers
+        ContractionDag dag = ContractionDag::from_terms(terms);
+        std::vector<ContractionTerm> binary;
+        for (const auto &node : dag.nodes())
+        {
+            if (node.inputs.empty())
+                continue;
+            std::vector<Tensor> factors;
+            for (size_t input : node.inputs)
+                factors.push_back(dag.node(input).tensor);
+            binary.emplace_back(node.tensor, factors, node.prefactor);
+        }
+        terms = binary;
+        return true;
+    }
+
+    bool BatchCompiler::generate(const BatchJob &job, const std::vector<ContractionTerm> &terms, BatchResult &result)
+    {
+        CodeGenerator codegen(codegen_options(job));
+        auto groups = kernel_groups(terms);
+        std::ostringstream oss;
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+            std::string name = groups.size() == 1 ? job.name : job.name + "_" + std::to_string(g);
+            oss << codegen.generate_fused(name, groups[g]) << "\n";
+        }
+        result.code = oss.str();
+        result.terms = terms.size();
+        result.kernels = groups.size();
+        return true;
+    }
+
+    CodeGenOptions BatchCompiler::codegen_options(const BatchJob &job)
+    {
+        CodeGenOptions options;
+        if (job.backend == "float")
+        {
+            options.scalar_type = "float";
+            options.complex_type = "std::complex<float>";
+        }
+        return options;
+    }
+
+    std::string BatchCompiler::phase_options(const BatchJob &job, BatchPhase phase)
+    {
+        switch (phase)
+        {
+        case BatchPhase::DERIVE:
+            return "source=" + job.source;
+        case BatchPhase::SIMPLIFY:
+            return "truncation=" + std::to_string(job.truncation) + " spin=" + job.spin;
+        case BatchPhase::FACTORIZE:
+            return "strategy=" + job.strategy;
+        case BatchPhase::GENERATE:
+            return "backend=" + job.backend;
+        }
+        return "";
+    }
+
+    bool BatchCompiler::run(const std::vector<BatchJob> &jobs)
+    {
+        auto &registry = MetaWaveCompiler::util::metrics();
+        std::array<MetaWaveCompiler::util::Histogram *, kNumBatchPhases> phase_latency;
+        for (size_t p = 0; p < kNumBatchPhases; ++p)
+        {
+            phase_latency[p] = &registry.histogram("qc_batch_phase_seconds", "Latency of one compiler phase of a job",
+                                                   std::string("phase=\"") + phase_name(static_cast<BatchPhase>(p)) + "\"");
+        }
+        static auto &ready_tasks = registry.gauge("qc_batch_ready_tasks", "Phases waiting for a worker");
+        static auto &held_memory = registry.gauge("qc_batch_held_bytes", "Memory reserved by running jobs");
+        static auto &finished_ok = registry.counter("qc_batch_jobs_total", "Jobs completed", "status=\"ok\"");
+        static auto &finished_failed = registry.counter("qc_batch_jobs_total", "Jobs completed", "status=\"failed\"");
+
+        auto start = std::chrono::steady_clock::now();
+        const size_t n = jobs.size();
+        stats_ = BatchStats();
+        stats_.jobs = n;
+        results_.assign(n, BatchResult());
+        for (size_t j = 0; j < n; ++j)
+            results_[j].name = jobs[j].name;
+
+        // Spaces named by builtin sets are registered up front, so their
+        // ids do not depend on the order in which workers materialize them
+        auto &spaces = SpaceRegistry::global();
+        for (const auto &job : jobs)
+        {
+            if (job.source.compare(0, 8, "builtin:") != 0)
+                continue;
+            std::string what = job.source.substr(8);
+            EquationSetView set = EquationLibrary::load_builtin(what.substr(0, what.find('/')));
+            if (!set.valid())
+                continue; // reported by derive()
+            for (const auto &space : set.spaces())
+            {
+                if (spaces.id(space) < 0)
+                    spaces.register_space(space);
+            }
+        }
+
+        // One chain of phase nodes per job; a missing or stale cache file
+        // leaves every phase to be recomputed
+        BuildGraph graph;
+        std::vector<std::array<int, kNumBatchPhases>> nodes(n);
+        for (size_t j = 0; j < n; ++j)
+            nodes[j] = add_job(graph, jobs[j]);
+        if (!options_.cache.empty())
+            graph.load(options_.cache);
+
+        std::vector<double> bytes(n);
+        for (size_t j = 0; j < n; ++j)
+            bytes[j] = jobs[j].memory > 0.0 ? jobs[j].memory : options_.job_memory;
+
+        // Worker pool; a task is one phase of one job, and the phases of a
+        // job never overlap, so workers only touch their own job's nodes
+        struct Task
+        {
+            size_t job;
+            size_t phase;
+        };
+        std::mutex mutex;
+        std::condition_variable work_available, work_done;
+        std::deque<Task> tasks;
+        std::vector<std::pair<Task, bool>> finished;
+        bool stop = false;
+        std::atomic<size_t> reused{0};
+
+        auto execute = [&](const Task &task)
+        {
+            BatchResult &result = results_[task.job];
+            auto phase_start = std::chrono::steady_clock::now();
+            const int node = nodes[task.job][task.phase];
+            bool ok = false;
+            if (node < 0)
+            {
+                result.error = "job name '" + jobs[task.job].name + "' is not unique";
+            }
+            else
+            {
+                BuildGraph::Outcome outcome = graph.build_node(static_cast<size_t>(node));
+                reused += outcome == BuildGraph::Outcome::REUSED;
+                ok = outcome != BuildGraph::Outcome::FAILED;
+                if (!ok)
+                    result.error = graph.artifact(node).error;
+            }
+            if (ok && static_cast<BatchPhase>(task.phase) == BatchPhase::GENERATE)
+            {
+                const auto &factorized = graph.artifact(nodes[task.job][task.phase - 1]).terms;
+                result.code = graph.artifact(node).text;
+                result.terms = factorized.size();
+                result.kernels = kernel_groups(factorized).size();
+            }
+            result.seconds[task.phase] = seconds_since(phase_start);
+            phase_latency[task.phase]->record(static_cast<std::uint64_t>(result.seconds[task.phase] * 1.0e9));
+            if (!ok)
+                result.error = std::string(phase_name(static_cast<BatchPhase>(task.phase))) + ": " + result.error;
+            return ok;
+        };
+
+        size_t n_workers = slots();
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < n_workers; ++w)
+        {
+            workers.emplace_back([&]()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true)
+                {
+                    work_available.wait(lock, [&]() { return stop || !tasks.empty(); });
+                    if (tasks.empty())
+                        return;
+                    Task task = tasks.front();
+                    tasks.pop_front();
+                    lock.unlock();
+                    bool ok = execute(task);
+                    lock.lock();
+                    finished.push_back({task, ok});
+                    work_done.notify_one();
+                }
+            });
+        }
+
+        // Continuing phases by manifest order, then admissions while slots remain
+        std::vector<Task> ready;
+        size_t free_slots = n_workers, admitted = 0, holding = 0, completed = 0;
+        double held_bytes = 0.0;
+        bool delayed = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (completed < n)
+        {
+            std::sort(ready.begin(), ready.end(), [](const Task &x, const Task &y) { return x.job < y.job; });
+            while (!ready.empty() && free_slots > 0)
+            {
+                tasks.push_back(ready.front());
+                ready.erase(ready.begin());
+                --free_slots;
+                work_available.notify_one();
+            }
+            while (admitted < n && free_slots > 0)
+            {
+                bool fits = options_.memory_limit <= 0.0 || holding == 0 ||
+                            held_bytes + bytes[admitted] <= options_.memory_limit;
+                if (!fits)
+                {
+                    if (!delayed)
+                        ++stats_.delayed;
+                    delayed = true;
+                    break;
+                }
+                delayed = false;
+                held_bytes += bytes[admitted];
+                ++holding;
+                stats_.peak_memory = std::max(stats_.peak_memory, held_bytes);
+                stats_.max_concurrent = std::max(stats_.max_concurrent, holding);
+                tasks.push_back({admitted++, 0});
+                --free_slots;
+                work_available.notify_one();
+            }
+
+            ready_tasks.set(static_cast<double>(ready.size()));
+            held_memory.set(held_bytes);
+
+            work_done.wait(lock, [&]() { return !finished.empty(); });
+            for (const auto &done : finished)
+            {
+                const Task &task = done.first;
+                ++free_slots;
+                if (done.second && task.phase + 1 < kNumBatchPhases)
+                {
+                    ready.push_back({task.job, task.phase + 1});
+                    continue;
+                }
+                results_[task.job].ok = done.second;
+                (done.second ? finished_ok : finished_failed).inc();
+                if (options_.cache.empty())
+                {
+                    for (int node : nodes[task.job])
+                    {
+                        if (node >= 0)
+                            graph.release(static_cast<size_t>(node));
+                    }
+                }
+                held_bytes -= bytes[task.job];
+                --holding;
+                ++completed;
+            }
+            finished.clear();
+        }
+
+        stop = true;
+        work_available.notify_all();
+        lock.unlock();
+        for (auto &worker : workers)
+            worker.join();
+        ready_tasks.set(0.0);
+        held_memory.set(0.0);
+        stats_.reused = reused;
+        if (!options_.cache.empty())
+            stats_.cache_saved = graph.save(options_.cache);
+
+        for (const auto &result : results_)
+        {
+            stats_.failed += result.ok ? 0 : 1;
+            for (size_t p = 0; p < kNumBatchPhases; ++p)
+                stats_.phase_seconds[p] += result.seconds[p];
+        }
+        stats_.seconds = seconds_since(start);
+        return stats_.failed == 0;
+    }
+
+    std::string BatchCompiler::output() const
+    {
+        std::ostringstream oss;
+        oss << CodeGenerator().preamble() << "\n";
+        for (const auto &result : results_)
+        {
+            if (!result.ok)
+                continue;
+            oss << "// " << result.name << "\n"
+                << result.code;
+        }
+        return oss.str();
+    }
+
+    std::string BatchCompiler::summary() const
+    {
+        std::ostringstream oss;
+        size_t width = 8;
+        for (const auto &result : results_)
+            width = std::max(width, result.name.size() + 2);
+
+        oss << std::left << std::setw(static_cast<int>(width)) << "job" << std::right << std::setw(8) << "terms"
+            << std::setw(9) << "kernels";
+        for (size_t p = 0; p < kNumBatchPhases; ++p)
+            oss << std::setw(11) << phase_name(static_cast<BatchPhase>(p));
+        oss << "  status\n";
+
+        oss << std::fixed << std::setprecision(3);
+        for (const auto &result : results_)
+        {
+            oss << std::left << std::setw(static_cast<int>(width)) << result.name << std::right << std::setw(8)
+                << result.terms << std::setw(9) << result.kernels;
+            for (size_t p = 0; p < kNumBatchPhases; ++p)
+                oss << std::setw(11) << result.seconds[p];
+            oss << "  " << (result.ok ? "ok" : result.error) << "\n";
+        }
+
+        oss << std::left << std::setw(static_cast<int>(width + 17)) << "total (s)" << std::right;
+        for (size_t p = 0; p < kNumBatchPhases; ++p)
+            oss << std::setw(11) << stats_.phase_seconds[p];
+        oss << "\n"
+            << stats_.jobs << " jobs, " << stats_.failed << " failed, " << stats_.seconds << " s on " << slots()
+            << " slots; at most " << stats_.max_concurrent << " jobs holding " << std::setprecision(1)
+            << stats_.peak_memory / (1024.0 * 1024.0) << " MiB, " << stats_.delayed << " admissions delayed\n";
+        if (!options_.cache.empty())
+            oss << stats_.reused << " of " << stats_.jobs * kNumBatchPhases << " phases reused from "
+                << options_.cache << "\n";
+        return oss.str();
+    }
+
+} // namespace qc
@@ -0,0 +1,412 @@
+#include "core/autogen_cursor/build_graph.h"
+#include "core/autogen_cursor/equation_library.h"
+#include "util/metrics.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace qc
+{
+
+    namespace
+    {
+        const char kMagic[4] = {'Q', 'C', 'B', 'G'};
+
+        // FNV-1a, stable across runs and platforms of the same byte order
+        std::uint64_t fnv(const void *data, size_t size, std::uint64_t h = 14695981039346656037ull)
+        {
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                h ^= bytes[i];
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        template <typename T>
+        std::uint64_t fnv_value(const T &value, std::uint64_t h)
+        {
+            return fnv(&value, sizeof(value), h);
+        }
+
+        std::vector<unsigned char> encode(const std::string &name, const std::vector<ContractionTerm> &terms)
+        {
+            return EquationLibrary::serialize({EquationSet{name, {{"terms", terms}}}});
+        }
+
+        bool is_source(BuildGraph::Kind kind)
+        {
+            return kind == BuildGraph::Kind::EQUATION || kind == BuildGraph::Kind::RULE;
+        }
+
+        void write_u32(std::ostream &out, std::uint32_t value) { out.write(reinterpret_cast<const char *>(&value), 4); }
+        void write_u64(std::ostream &out, std::uint64_t value) { out.write(reinterpret_cast<const char *>(&value), 8); }
+
+        void write_bytes(std::ostream &out, const void *data, size_t size)
+        {
+            write_u64(out, size);
+            out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        }
+
+        // Bounds-checked reader over a loaded file
+        class Reader
+        {
+        private:
+            const std::vector<char> &data_;
+            size_t at_ = 0;
+            bool ok_ = true;
+
+        public:
+            explicit Reader(const std::vector<char> &data) : data_(data) {}
+
+            bool ok() const { return ok_; }
+            bool done() const { return at_ == data_.size(); }
+
+            void read(void *out, size_t size)
+            {
+                if (!ok_ || data_.size() - at_ < size)
+                {
+                    ok_ = false;
+                    return;
+                }
+                std::memcpy(out, data_.data() + at_, size);
+                at_ += size;
+            }
+
+            std::uint32_t u32()
+            {
+                std::uint32_t value = 0;
+                read(&value, 4);
+                return value;
+            }
+
+            std::uint64_t u64()
+            {
+                std::uint64_t value = 0;
+                read(&value, 8);
+                return value;
+            }
+
+            std::string string()
+            {
+                std::uint64_t size = u64();
+                if (!ok_ || data_.size() - at_ < size)
+                {
+                    ok_ = false;
+                    return "";
+                }
+                std::string result(data_.data() + at_, size);
+                at_ += size;
+                return result;
+            }
+        };
+    }
+
+    // BuildGraph implementation
+    int BuildGraph::add(const std::string &name, Kind kind, const std::vector<size_t> &inputs,
+                        const Transform &transform, const BuildArtifact &artifact)
+    {
+        if (by_name_.count(name))
+            return -1;
+        for (size_t input : inputs)
+        {
+            if (input >= nodes_.size())
+                return -1;
+        }
+
+        Node node;
+        node.name = name;
+        node.kind = kind;
+        node.inputs = inputs;
+        node.transform = transform;
+        if (is_source(kind))
+        {
+            node.artifact = artifact;
+            node.hash = node.key = content_hash(artifact);
+            node.built = true;
+        }
+        by_name_[name] = nodes_.size();
+        nodes_.push_back(std::move(node));
+        return static_cast<int>(nodes_.size() - 1);
+    }
+
+    int BuildGraph::add_equation(const std::string &name, const std::vector<ContractionTerm> &terms)
+    {
+        BuildArtifact artifact;
+        artifact.terms = terms;
+        return add(name, Kind::EQUATION, {}, Transform(), artifact);
+    }
+
+    int BuildGraph::add_rule(const std::string &name, const std::string &fingerprint)
+    {
+        BuildArtifact artifact;
+        artifact.text = fingerprint;
+        return add(name, Kind::RULE, {}, Transform(), artifact);
+    }
+
+    int BuildGraph::add_node(const std::string &name, Kind kind, const std::vector<size_t> &inputs,
+                             const Transform &transform)
+    {
+        if (is_source(kind) || !transform)
+            return -1;
+        return add(name, kind, inputs, transform, BuildArtifact());
+    }
+
+    bool BuildGraph::set_source(const std::string &name, Kind kind, const BuildArtifact &artifact)
+    {
+        int i = find(name);
+        if (i < 0 || nodes_[i].kind != kind)
+            return false;
+        nodes_[i].artifact = artifact;
+        nodes_[i].hash = nodes_[i].key = content_hash(artifact);
+        return true;
+    }
+
+    bool BuildGraph::set_equation(const std::string &name, const std::vector<ContractionTerm> &terms)
+    {
+        BuildArtifact artifact;
+        artifact.terms = terms;
+        return set_source(name, Kind::EQUATION, artifact);
+    }
+
+    bool BuildGraph::set_rule(const std::string &name, const std::string &fingerprint)
+    {
+        BuildArtifact artifact;
+        artifact.text = fingerprint;
+        return set_source(name, Kind::RULE, artifact);
+    }
+
+    void BuildGraph::build(bool force)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stats_ = BuildStats();
+
+        for (size_t i = 0; i < nodes_.size(); ++i)
+        {
+            if (is_source(nodes_[i].kind))
+                continue;
+            switch (build_node(i, force))
+            {
+            case Outcome::REUSED:
+                ++stats_.reused;
+                break;
+            case Outcome::UNCHANGED:
+                ++stats_.unchanged;
+                [[fallthrough]];
+            case Outcome::RECOMPUTED:
+                ++stats_.recomputed;
+                stats_.recomputed_nodes.push_back(nodes_[i].name);
+                break;
+            case Outcome::FAILED:
+                ++stats_.failed;
+                break;
+            }
+        }
+
+        stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    BuildGraph::Outcome BuildGraph::build_node(size_t i, bool force)
+    {
+        auto &registry = MetaWaveCompiler::util::metrics();
+        const char *help = "Build graph nodes by outcome";
+        static auto &reused = registry.counter("qc_build_graph_nodes_total", help, "result=\"reused\"");
+        static auto &recomputed = registry.counter("qc_build_graph_nodes_total", help, "result=\"recomputed\"");
+        static auto &unchanged = registry.counter("qc_build_graph_nodes_total", help, "result=\"unchanged\"");
+        static auto &failed = registry.counter("qc_build_graph_nodes_total", help, "result=\"failed\"");
+
+        Node &node = nodes_[i];
+        if (is_source(node.kind))
+            return Outcome::REUSED;
+
+        std::uint64_t key = fnv(node.name.data(), node.name.size());
+        key = fnv_value(static_cast<std::uint32_t>(node.kind), key);
+        for (size_t input : node.inputs)
+        {
+            if (!nodes_[input].built)
+            {
+                node.artifact = BuildArtifact();
+                node.artifact.error = "input '" + nodes_[input].name + "' failed";
+                node.built = false;
+                failed.inc();
+                return Outcome::FAILED;
+            }
+            key = fnv_value(nodes_[input].hash, key);
+        }
+
+        bool had = node.built;
+        std::uint64_t previous = node.hash;
+        if (!force && node.built && node.key == key)
+        {
+            reused.inc();
+            return Outcome::REUSED;
+        }
+        if (!node.built)
+        {
+            auto cached = cache_.find(node.name);
+            if (cached != cache_.end() && cached->second.kind == node.kind)
+            {
+                const CacheEntry &entry = cached->second;
+                if (!force && entry.key == key)
+                {
+                    node.artifact = BuildArtifact();
+                    node.artifact.text = entry.text;
+                    node.artifact.terms = EquationLibrary::find(entry.terms.data(), entry.terms.size(), node.name)
+                                              .block(0)
+                                              .materialize();
+                    node.key = key;
+                    node.hash = entry.hash;
+                    node.built = true;
+                    reused.inc();
+                    return Outcome::REUSED;
+                }
+                had = true;
+                previous = entry.hash;
+            }
+        }
+
+        std::vector<const BuildArtifact *> inputs;
+        for (size_t input : node.inputs)
+            inputs.push_back(&nodes_[input].artifact);
+        node.artifact = node.transform(inputs);
+        if (!node.artifact.error.empty())
+        {
+            node.built = false;
+            failed.inc();
+            return Outcome::FAILED;
+        }
+        node.key = key;
+        node.hash = content_hash(node.artifact);
+        node.built = true;
+        recomputed.inc();
+        if (had && node.hash == previous)
+        {
+            unchanged.inc();
+            return Outcome::UNCHANGED;
+        }
+        return Outcome::RECOMPUTED;
+    }
+
+    void BuildGraph::release(size_t i)
+    {
+        if (i >= nodes_.size() || is_source(nodes_[i].kind))
+            return;
+        nodes_[i].artifact = BuildArtifact();
+        nodes_[i].built = false;
+    }
+
+    std::vector<size_t> BuildGraph::affected(const std::string &name) const
+    {
+        std::vector<size_t> result;
+        int root = find(name);
+        if (root < 0)
+            return result;
+
+        std::vector<bool> reached(nodes_.size(), false);
+        reached[root] = true;
+        for (size_t i = root; i < nodes_.size(); ++i)
+        {
+            for (size_t input : nodes_[i].inputs)
+                reached[i] = reached[i] || reached[input];
+            if (reached[i])
+                result.push_back(i);
+        }
+        return result;
+    }
+
+    int BuildGraph::find(const std::string &name) const
+    {
+        auto it = by_name_.find(name);
+        return it == by_name_.end() ? -1 : static_cast<int>(it->second);
+    }
+
+    bool BuildGraph::save(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+            return false;
+
+        std::map<std::string, CacheEntry> entries = cache_;
+        for (const auto &node : nodes_)
+        {
+            if (is_source(node.kind) || !node.built)
+                continue;
+            entries[node.name] = CacheEntry{node.kind, node.key, node.hash, node.artifact.text,
+                                            encode(node.name, node.artifact.terms)};
+        }
+
+        out.write(kMagic, 4);
+        write_u32(out, kVersion);
+        write_u64(out, entries.size());
+        for (const auto &entry : entries)
+        {
+            write_bytes(out, entry.first.data(), entry.first.size());
+            write_u32(out, static_cast<std::uint32_t>(entry.second.kind));
+            write_u64(out, entry.second.key);
+            write_u64(out, entry.second.hash);
+            write_bytes(out, entry.second.text.data(), entry.second.text.size());
+            write_bytes(out, entry.second.terms.data(), entry.second.terms.size());
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool BuildGraph::load(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        Reader reader(data);
+        char magic[4] = {};
+        reader.read(magic, 4);
+        if (!reader.ok() || std::memcmp(magic, kMagic, 4) != 0 || reader.u32() != kVersion)
+            return false;
+
+        std::map<std::string, CacheEntry> entries;
+        std::uint64_t count = reader.u64();
+        for (std::uint64_t e = 0; e < count && reader.ok(); ++e)
+        {
+            std::string name = reader.string();
+            CacheEntry entry;
+            entry.kind = static_cast<Kind>(reader.u32());
+            entry.key = reader.u64();
+            entry.hash = reader.u64();
+            entry.text = reader.string();
+            std::string terms = reader.string();
+            entry.terms.assign(terms.begin(), terms.end());
+            if (reader.ok() && !EquationLibrary::find(entry.terms.data(), entry.terms.size(), name).valid())
+                return false;
+            entries[name] = std::move(entry);
+        }
+        if (!reader.ok() || !reader.done())
+            return false;
+
+        cache_ = std::move(entries);
+        return true;
+    }
+
+    std::uint64_t BuildGraph::content_hash(const BuildArtifact &artifact)
+    {
+        std::vector<unsigned char> terms = encode("", artifact.terms);
+        std::uint64_t h = fnv(terms.data(), terms.size());
+        h = fnv_value(static_cast<std::uint64_t>(artifact.text.size()), h);
+        return fnv(artifact.text.data(), artifact.text.size(), h);
+    }
+
+    BuildGraph::Transform BuildGraph::fused_kernel(const std::string &name, const CodeGenerator &codegen)
+    {
+        return [name, codegen](const std::vector<const BuildArtifact *> &inputs)
+        {
+            std::vector<ContractionTerm> terms;
+            for (const auto *input : inputs)
+                terms.insert(terms.end(), input->terms.begin(), input->terms.end());
+            BuildArtifact artifact;
+            artifact.text = codegen.generate_fused(name, terms);
+            return artifact;
+        };
+    }
+
+} // namespace qc
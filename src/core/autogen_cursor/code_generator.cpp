@@ -0,0 +1,698 @@
+#include "core/autogen_cursor/code_generator.h"
+#include "core/autogen_cursor/delta_elimination.h"
+#include "core/autogen_cursor/layout.h"
+#include "core/autogen_cursor/term_fusion.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        std::string indent(size_t depth)
+        {
+            return std::string(4 * depth, ' ');
+        }
+
+        std::string format_double(double value)
+        {
+            std::ostringstream oss;
+            oss.precision(17);
+            oss << value;
+            std::string result = oss.str();
+            if (result.find_first_of(".e") == std::string::npos)
+                result += ".0";
+            return result;
+        }
+
+        // Loop headers of `plan` in nest order; `which` selects all loops (-1),
+        // external loops (0) or summed loops (1). Advances `depth` per loop.
+        void emit_loop_headers(std::ostream &oss, const RestrictedSummation::Plan &plan, const LoopBounds &bounds,
+                               int which, const std::string &index_type, size_t &depth)
+        {
+            for (const auto &loop : plan.loops)
+            {
+                if (bounds.fixed.count(loop.label) || (which >= 0 && loop.summed != (which == 1)))
+                    continue;
+                std::string lower = "0";
+                std::string upper = loop.upper_label.empty() ? CodeGenerator::dimension_name(loop.space)
+                                                             : loop.upper_label;
+                auto range = bounds.ranges.find(loop.label);
+                if (range != bounds.ranges.end())
+                {
+                    lower = range->second.first;
+                    upper = range->second.second;
+                }
+                oss << indent(depth) << "for (" << index_type << " " << loop.label << " = " << lower << "; "
+                    << loop.label << " < " << upper << "; ++" << loop.label << ")\n";
+                ++depth;
+            }
+        }
+
+        // Offset of the output element in the block of LoopBounds::output_block
+        std::string block_offset(const Tensor &output, const LoopBounds &bounds)
+        {
+            std::string offset;
+            for (const auto &idx : output.indices())
+            {
+                const auto &block = bounds.output_block.at(idx->label());
+                std::string value = "(" + idx->label() + " - " + block.first + ")";
+                offset = offset.empty() ? value : "(" + offset + ") * " + block.second + " + " + value;
+            }
+            return offset.empty() ? "0" : offset;
+        }
+
+        void emit_statements(std::ostream &oss, const std::string &statements, size_t depth)
+        {
+            std::istringstream lines(statements);
+            std::string line;
+            while (std::getline(lines, line))
+                oss << indent(depth) << line << "\n";
+        }
+
+        // Parity of the permutation sorting `ranks` into ascending order
+        int permutation_sign(std::vector<int> ranks)
+        {
+            int sign = 1;
+            for (size_t i = 0; i < ranks.size(); ++i)
+            {
+                for (size_t j = i + 1; j < ranks.size(); ++j)
+                {
+                    if (ranks[i] > ranks[j])
+                        sign = -sign;
+                }
+            }
+            return sign;
+        }
+    }
+
+    CodeGenerator::CodeGenerator(const CodeGenOptions &options) : options_(options) {}
+
+    void CodeGenerator::add_implicit(const ImplicitTensor &tensor)
+    {
+        implicit_.erase(tensor.name());
+        implicit_.emplace(tensor.name(), tensor);
+    }
+
+    const ImplicitTensor *CodeGenerator::find_implicit(const Tensor &tensor) const
+    {
+        auto it = implicit_.find(tensor.symbol().name());
+        return it == implicit_.end() ? nullptr : &it->second;
+    }
+
+    std::string CodeGenerator::dimension_name(int space)
+    {
+        const auto &registry = SpaceRegistry::global();
+        if (space < 0 || space >= static_cast<int>(registry.num_spaces()))
+            return "n_gen";
+        return "n_" + registry.name(space);
+    }
+
+    std::string CodeGenerator::variable_name(const Tensor &tensor)
+    {
+        std::string name;
+        for (char c : tensor.symbol().name())
+        {
+            name += (std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+        }
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+            name = "t_" + name;
+        return name;
+    }
+
+    std::string CodeGenerator::preamble() const
+    {
+        const std::string &I = options_.index_type;
+        std::ostringstream oss;
+        oss << "#include <complex>\n" << (options_.blas ? "#include <cblas.h>\n\n" : "\n")
+            << "// Binomial coefficient C(n, k) for packed antisymmetric storage\n"
+            << "static inline " << I << " qc_binom(" << I << " n, int k)\n"
+            << "{\n"
+            << "    if (n < k)\n"
+            << "        return 0;\n"
+            << "    " << I << " r = 1;\n"
+            << "    for (int i = 0; i < k; ++i)\n"
+            << "        r = r * (n - i) / (i + 1);\n"
+            << "    return r;\n"
+            << "}\n\n"
+            << "// Sort an index tuple, returning its packed offset and permutation sign (0 if repeated)\n"
+            << "static inline " << I << " qc_pack(" << I << " *v, int k, int *sign)\n"
+            << "{\n"
+            << "    *sign = 1;\n"
+            << "    for (int i = 1; i < k; ++i)\n"
+            << "        for (int j = i; j > 0 && v[j - 1] >= v[j]; --j)\n"
+            << "        {\n"
+            << "            if (v[j - 1] == v[j])\n"
+            << "            {\n"
+            << "                *sign = 0;\n"
+            << "                return 0;\n"
+            << "            }\n"
+            << "            " << I << " t = v[j];\n"
+            << "            v[j] = v[j - 1];\n"
+            << "            v[j - 1] = t;\n"
+            << "            *sign = -*sign;\n"
+            << "        }\n"
+            << "    " << I << " offset = 0;\n"
+            << "    for (int m = 0; m < k; ++m)\n"
+            << "        offset += qc_binom(v[m], m + 1);\n"
+            << "    return offset;\n"
+            << "}\n";
+        return oss.str();
+    }
+
+    std::vector<AntisymmetricGroup> CodeGenerator::storage_groups(const Tensor &tensor) const
+    {
+        if (!options_.exploit_antisymmetry)
+            return {};
+        return AntisymmetryAnalysis::groups(tensor);
+    }
+
+    std::string CodeGenerator::storage_size(const Tensor &view) const
+    {
+        Tensor tensor = LayoutPropagation::storage_view(view);
+        auto groups = storage_groups(tensor);
+        std::vector<std::string> extents;
+        for (size_t pos = 0; pos < tensor.actual_rank(); ++pos)
+        {
+            const Index &idx = tensor.indices()[pos];
+            const AntisymmetricGroup *group = AntisymmetryAnalysis::find_group(groups, tensor, idx.label());
+            if (!group)
+            {
+                extents.push_back(dimension_name(SpaceRegistry::global().space_of(idx)));
+            }
+            else if (group->positions[0] == pos)
+            {
+                extents.push_back("qc_binom(" + dimension_name(group->space) + ", " +
+                                  std::to_string(group->size()) + ")");
+            }
+        }
+        if (extents.empty())
+            return "1";
+        std::string result = extents[0];
+        for (size_t i = 1; i < extents.size(); ++i)
+            result += " * " + extents[i];
+        return result;
+    }
+
+    CodeGenerator::Access CodeGenerator::access(const Tensor &view, const RestrictedSummation::Plan &plan,
+                                                const std::string &tag) const
+    {
+        // Offsets follow memory order, so transposed views cost no copy
+        Tensor tensor = LayoutPropagation::storage_view(view);
+        Access result;
+        result.static_sign = 1;
+        auto groups = storage_groups(tensor);
+        std::vector<std::string> signs;
+
+        // Row-major over slots; a slot is one index or one packed group
+        std::string offset;
+        for (size_t pos = 0; pos < tensor.actual_rank(); ++pos)
+        {
+            const Index &idx = tensor.indices()[pos];
+            const AntisymmetricGroup *group = AntisymmetryAnalysis::find_group(groups, tensor, idx.label());
+            std::string extent, value;
+            if (!group)
+            {
+                extent = dimension_name(SpaceRegistry::global().space_of(idx));
+                value = idx.label();
+            }
+            else if (group->positions[0] != pos)
+            {
+                continue;
+            }
+            else
+            {
+                extent = "qc_binom(" + dimension_name(group->space) + ", " + std::to_string(group->size()) + ")";
+
+                std::vector<std::string> labels;
+                for (size_t p : group->positions)
+                    labels.push_back(tensor.indices()[p].label());
+
+                // The order is known statically when the whole group runs in
+                // one restricted loop group
+                int loop_group = RestrictedSummation::loop_group_of(plan, labels[0]);
+                const std::vector<std::string> *ordered = nullptr;
+                if (loop_group >= 0)
+                {
+                    size_t n_ext = plan.external_groups.size();
+                    ordered = static_cast<size_t>(loop_group) < n_ext
+                                  ? &plan.external_groups[loop_group]
+                                  : &plan.summed_groups[loop_group - n_ext];
+                    for (const auto &label : labels)
+                    {
+                        if (std::find(ordered->begin(), ordered->end(), label) == ordered->end())
+                        {
+                            ordered = nullptr;
+                            break;
+                        }
+                    }
+                }
+
+                if (ordered && ordered->size() == labels.size())
+                {
+                    std::vector<int> ranks;
+                    for (const auto &label : labels)
+                        ranks.push_back(static_cast<int>(std::find(ordered->begin(), ordered->end(), label) -
+                                                         ordered->begin()));
+                    result.static_sign *= permutation_sign(ranks);
+                    for (size_t m = 0; m < ordered->size(); ++m)
+                    {
+                        std::string term = (m == 0) ? (*ordered)[0]
+                                                    : "qc_binom(" + (*ordered)[m] + ", " + std::to_string(m + 1) + ")";
+                        value += (m == 0 ? "" : " + ") + term;
+                    }
+                }
+                else
+                {
+                    std::string var = tag + "_" + std::to_string(pos);
+                    std::string tuple;
+                    for (size_t m = 0; m < labels.size(); ++m)
+                        tuple += (m ? ", " : "") + labels[m];
+                    result.setup += options_.index_type + " " + var + "_v[] = {" + tuple + "}; int " + var + "_s; " +
+                                    options_.index_type + " " + var + " = qc_pack(" + var + "_v, " +
+                                    std::to_string(labels.size()) + ", &" + var + "_s);\n";
+                    signs.push_back(var + "_s");
+                    value = var;
+                }
+            }
+
+            offset = offset.empty() ? "(" + value + ")" : "(" + offset + ") * " + extent + " + (" + value + ")";
+        }
+
+        result.offset = offset.empty() ? "0" : offset;
+        for (const auto &s : signs)
+            result.sign += (result.sign.empty() ? "" : " * ") + s;
+        return result;
+    }
+
+    const std::string &CodeGenerator::value_type(Field field) const
+    {
+        return field == Field::COMPLEX ? options_.complex_type : options_.scalar_type;
+    }
+
+    std::string CodeGenerator::lift(const std::string &value, Field field, Field target) const
+    {
+        // An imaginary value is held as its imaginary part
+        if (field == Field::IMAGINARY && target == Field::COMPLEX)
+            return options_.complex_type + "(0.0, " + value + ")";
+        return value;
+    }
+
+    Field CodeGenerator::output_field(const std::vector<ContractionTerm> &terms)
+    {
+        if (terms.empty())
+            return Field::REAL;
+        const Tensor &output = terms[0].output();
+        Field result = output.has_property("field") ? FieldInference::of(output)
+                                                    : FieldInference::of(terms[0]).field;
+        for (const auto &term : terms)
+            result = FieldInference::sum(result, FieldInference::of(term).field);
+        return result;
+    }
+
+    void CodeGenerator::annotate_outputs(std::vector<ContractionTerm> &terms)
+    {
+        std::map<std::string, Field> fields;
+        for (const auto &term : terms)
+        {
+            const std::string name = variable_name(term.output());
+            auto it = fields.find(name);
+            if (it == fields.end())
+                fields[name] = output_field({term});
+            else
+                it->second = FieldInference::sum(it->second, FieldInference::of(term).field);
+        }
+        for (auto &term : terms)
+        {
+            Tensor output = term.output();
+            FieldInference::set(output, fields[variable_name(output)]);
+            term.set_output(output);
+        }
+    }
+
+    RestrictedSummation::Plan CodeGenerator::make_plan(const ContractionTerm &term) const
+    {
+        if (options_.exploit_antisymmetry)
+            return RestrictedSummation::plan(term);
+
+        RestrictedSummation::Plan plan{};
+        plan.prefactor = term.prefactor();
+        plan.iteration_fraction = 1.0;
+        for (const auto &idx : term.loop_indices())
+            plan.loops.push_back({idx->label(), SpaceRegistry::global().space_of(*idx), "",
+                                  term.is_summed(idx->label())});
+        return plan;
+    }
+
+    std::string CodeGenerator::signature(const std::string &name, const std::vector<ContractionTerm> &terms) const
+    {
+        // Arguments: output first, then distinct inputs, then dimensions
+        std::ostringstream oss;
+        std::string out_name = variable_name(terms[0].output());
+        oss << "void " << name << "(" << value_type(output_field(terms)) << " *" << out_name;
+        std::set<std::string> args = {out_name};
+        const auto &registry = SpaceRegistry::global();
+        std::map<std::string, long> dims;
+        for (const auto &term : terms)
+        {
+            for (const auto &factor : term.factors())
+            {
+                // Implicit factors read their diagonals instead of a stored tensor
+                const ImplicitTensor *implicit = find_implicit(factor);
+                std::vector<std::string> vars = implicit ? implicit->sources()
+                                                         : std::vector<std::string>{variable_name(factor)};
+                const std::string &type = implicit ? options_.scalar_type : value_type(FieldInference::of(factor));
+                for (const auto &var : vars)
+                {
+                    if (args.insert(var).second)
+                        oss << ", const " << type << " *" << var;
+                }
+            }
+            for (const auto &loop : make_plan(term).loops)
+                dims[dimension_name(loop.space)] = options_.fixed_dimensions ? registry.size(loop.space) : -1;
+        }
+
+        // Dimensions are parameters unless their registry size is baked in
+        for (const auto &dim : dims)
+        {
+            if (dim.second < 0)
+                oss << ", " << options_.index_type << " " << dim.first;
+        }
+        oss << ")\n{\n";
+        for (const auto &dim : dims)
+        {
+            if (dim.second >= 0)
+                oss << indent(1) << "constexpr " << options_.index_type << " " << dim.first << " = " << dim.second << ";\n";
+        }
+        return oss.str();
+    }
+
+    std::string CodeGenerator::generate(const std::string &name, const ContractionTerm &input) const
+    {
+        // Deltas would become full-size loops; substitute them away first
+        ContractionTerm term = input;
+        bool vanished = KroneckerDeltaElimination::apply(term) == KroneckerDeltaElimination::Result::VANISHED;
+
+        std::ostringstream oss;
+        oss << signature(name, {term});
+        if (!vanished)
+            oss << generate_loops(term, LoopBounds(), 1, output_field({term}));
+        oss << "}\n";
+        return oss.str();
+    }
+
+    std::string CodeGenerator::generate_fused(const std::string &name, const std::vector<ContractionTerm> &inputs) const
+    {
+        std::vector<ContractionTerm> terms;
+        for (const auto &input : inputs)
+        {
+            ContractionTerm term = input;
+            if (KroneckerDeltaElimination::apply(term) != KroneckerDeltaElimination::Result::VANISHED)
+                terms.push_back(term);
+        }
+        if (terms.empty())
+            return inputs.empty() ? "" : generate(name, inputs[0]);
+
+        std::ostringstream oss;
+        oss << signature(name, terms);
+        oss << generate_fused_loops(terms, LoopBounds(), 1);
+        oss << "}\n";
+        return oss.str();
+    }
+
+    std::string CodeGenerator::generate_step(const std::string &name, const ContractionDag &dag,
+                                             const LayoutPlan &plan, const LayoutStep &step) const
+    {
+        ContractionTerm term = LayoutPropagation::planned_term(dag, plan, step.node);
+        std::string gemm = options_.scalar_type == "double" ? "cblas_dgemm"
+                           : options_.scalar_type == "float" ? "cblas_sgemm"
+                                                             : "";
+        bool folded = step.kind == LayoutStep::Kind::GEMM && step.a.permutation.empty() &&
+                      step.b.permutation.empty() && step.c.permutation.empty();
+        bool dense = output_field({term}) == Field::REAL && storage_groups(term.output()).empty();
+        for (const auto &factor : term.factors())
+        {
+            dense = dense && !find_implicit(factor) && !KroneckerDeltaElimination::is_delta(factor) &&
+                    FieldInference::of(factor) == Field::REAL && storage_groups(factor).empty();
+        }
+        if (!options_.blas || gemm.empty() || !folded || !dense || term.num_factors() != 2)
+            return generate(name, term);
+
+        // Row-major extents of the index groups
+        std::map<std::string, int> spaces;
+        for (const auto &tensor : {term.output(), term.factors()[0], term.factors()[1]})
+        {
+            for (const auto &idx : tensor.indices())
+                spaces[idx->label()] = SpaceRegistry::global().space_of(*idx);
+        }
+        auto extent = [&](const std::vector<std::string> &labels)
+        {
+            std::string result;
+            for (const auto &label : labels)
+                result += (result.empty() ? "" : " * ") + dimension_name(spaces[label]);
+            return result.empty() ? std::string("1") : result;
+        };
+        std::string m = extent(step.m), n = extent(step.n), k = extent(step.k);
+        std::string lda = step.a.transpose ? m : k;
+        std::string ldb = step.b.transpose ? k : n;
+        auto flag = [](bool transpose) { return transpose ? "CblasTrans" : "CblasNoTrans"; };
+
+        // A C stored as (n,m) is computed as C^T = op(B)^T op(A)^T
+        std::string a = variable_name(term.factors()[0]), b = variable_name(term.factors()[1]);
+        std::ostringstream oss;
+        oss << signature(name, {term});
+        oss << indent(1) << gemm << "(CblasRowMajor, ";
+        if (step.swap_operands)
+        {
+            oss << flag(!step.b.transpose) << ", " << flag(!step.a.transpose) << ", " << n << ", " << m << ", " << k
+                << ", " << format_double(term.prefactor()) << ", " << b << ", " << ldb << ", " << a << ", " << lda
+                << ", 1.0, " << variable_name(term.output()) << ", " << m << ");\n";
+        }
+        else
+        {
+            oss << flag(step.a.transpose) << ", " << flag(step.b.transpose) << ", " << m << ", " << n << ", " << k
+                << ", " << format_double(term.prefactor()) << ", " << a << ", " << lda << ", " << b << ", " << ldb
+                << ", 1.0, " << variable_name(term.output()) << ", " << n << ");\n";
+        }
+        oss << "}\n";
+        return oss.str();
+    }
+
+    bool CodeGenerator::hoists_implicit(const ContractionTerm &term, const RestrictedSummation::Plan &plan,
+                                        const LoopBounds &bounds) const
+    {
+        // Implicit factors over external indices only are applied once per
+        // output element, after the summation, instead of in the inner loop
+        bool any = false;
+        for (const auto &factor : term.factors())
+        {
+            if (!find_implicit(factor))
+                continue;
+            any = true;
+            for (const auto &idx : factor.indices())
+            {
+                if (term.is_summed(idx->label()) && !bounds.fixed.count(idx->label()))
+                    return false;
+            }
+        }
+        return any && std::any_of(plan.loops.begin(), plan.loops.end(),
+                                  [&bounds](const RestrictedLoop &loop)
+                                  { return loop.summed && !bounds.fixed.count(loop.label); });
+    }
+
+    CodeGenerator::Summand CodeGenerator::summand(const ContractionTerm &term, const RestrictedSummation::Plan &plan,
+                                                  bool epilogue, const std::string &tag) const
+    {
+        // Static permutation signs and powers of i fold into the prefactor
+        TermField field = FieldInference::of(term);
+        Summand result;
+        result.prefactor = plan.prefactor * field.sign;
+        result.field = field.field;
+        for (size_t f = 0; f < term.num_factors(); ++f)
+        {
+            const ImplicitTensor *implicit = find_implicit(term.factor(f));
+            if (implicit)
+            {
+                std::vector<std::string> labels;
+                for (const auto &idx : term.factor(f).indices())
+                    labels.push_back(idx->label());
+                (epilogue ? result.implicit_product : result.product) += " * " + implicit->element_expression(labels);
+                continue;
+            }
+            Access in = access(term.factor(f), plan, tag + "f" + std::to_string(f));
+            result.prefactor *= in.static_sign;
+            result.setup += in.setup;
+            if (!in.sign.empty())
+                result.signs += (result.signs.empty() ? "" : " * ") + in.sign;
+            std::string element = variable_name(term.factor(f)) + "[" + in.offset + "]";
+            if (FieldInference::of(term.factor(f)) == Field::COMPLEX && term.factor(f).get_property("conjugate") == "true")
+                element = "std::conj(" + element + ")";
+            result.product += " * " + element;
+        }
+        if (field.field == Field::COMPLEX)
+        {
+            // std::complex has no int operands
+            if (field.imaginary_unit)
+                result.product += " * " + options_.complex_type + "(0.0, 1.0)";
+            if (!result.signs.empty())
+                result.signs = "double(" + result.signs + ")";
+        }
+        return result;
+    }
+
+    std::string CodeGenerator::generate_loops(const ContractionTerm &term, const LoopBounds &bounds,
+                                              size_t depth) const
+    {
+        return generate_loops(term, bounds, depth, output_field({term}));
+    }
+
+    std::string CodeGenerator::generate_loops(const ContractionTerm &input, const LoopBounds &bounds, size_t depth,
+                                              Field target) const
+    {
+        ContractionTerm term = input;
+        if (KroneckerDeltaElimination::apply(term) == KroneckerDeltaElimination::Result::VANISHED)
+            return "";
+        RestrictedSummation::Plan plan = make_plan(term);
+        bool epilogue = hoists_implicit(term, plan, bounds);
+
+        std::ostringstream oss;
+        size_t body_depth = depth;
+        emit_loop_headers(oss, plan, bounds, epilogue ? 0 : -1, options_.index_type, body_depth);
+        if (body_depth == depth)
+            ++body_depth;
+        oss << indent(body_depth - 1) << "{\n";
+
+        Access out = access(term.output(), plan, "o");
+        if (!bounds.output_block.empty())
+            out.offset = block_offset(term.output(), bounds);
+        Summand s = summand(term, plan, epilogue, "");
+        double prefactor = s.prefactor * out.static_sign;
+        std::string update = variable_name(term.output()) + "[" + out.offset + "] += ";
+
+        if (!epilogue)
+        {
+            std::string signs = s.signs;
+            if (!out.sign.empty())
+                signs = out.sign + (signs.empty() ? "" : " * " + signs);
+            emit_statements(oss, out.setup + s.setup, body_depth);
+            oss << indent(body_depth) << update
+                << lift(format_double(prefactor) + (signs.empty() ? "" : " * " + signs) + s.product, s.field, target)
+                << ";\n";
+            oss << indent(body_depth - 1) << "}\n";
+            return oss.str();
+        }
+
+        oss << indent(body_depth) << value_type(s.field) << " acc = 0.0;\n";
+        size_t inner_depth = body_depth;
+        emit_loop_headers(oss, plan, bounds, 1, options_.index_type, inner_depth);
+        oss << indent(inner_depth - 1) << "{\n";
+        emit_statements(oss, s.setup, inner_depth);
+        std::string value = s.signs.empty() ? s.product.substr(3) : s.signs + s.product;
+        oss << indent(inner_depth) << "acc += " << value << ";\n";
+        oss << indent(inner_depth - 1) << "}\n";
+        emit_statements(oss, out.setup, body_depth);
+        oss << indent(body_depth) << update
+            << lift(format_double(prefactor) + (out.sign.empty() ? "" : " * " + out.sign) + s.implicit_product +
+                        " * acc",
+                    s.field, target)
+            << ";\n";
+        oss << indent(body_depth - 1) << "}\n";
+        return oss.str();
+    }
+
+    std::string CodeGenerator::generate_fused_loops(const std::vector<ContractionTerm> &inputs,
+                                                    const LoopBounds &bounds, size_t depth) const
+    {
+        std::vector<ContractionTerm> terms;
+        for (const auto &input : inputs)
+        {
+            ContractionTerm term = input;
+            if (KroneckerDeltaElimination::apply(term) != KroneckerDeltaElimination::Result::VANISHED)
+                terms.push_back(term);
+        }
+        // One output type for all terms, whether they fuse or not
+        Field target = output_field(terms);
+        bool fusable = terms.size() > 1;
+        for (size_t t = 1; t < terms.size() && fusable; ++t)
+            fusable = TermFusion::fusable(terms[0], terms[t]);
+        if (!fusable)
+        {
+            std::string result;
+            for (const auto &term : terms)
+                result += generate_loops(term, bounds, depth, target);
+            return result;
+        }
+
+        // External loops depend on the output alone, so all terms share them;
+        // each term adds its own summation into one register accumulator
+        RestrictedSummation::Plan outer = make_plan(terms[0]);
+        std::ostringstream oss;
+        size_t body_depth = depth;
+        emit_loop_headers(oss, outer, bounds, 0, options_.index_type, body_depth);
+        if (body_depth == depth)
+            ++body_depth;
+        oss << indent(body_depth - 1) << "{\n";
+        oss << indent(body_depth) << value_type(target) << " acc = 0.0;\n";
+
+        for (size_t t = 0; t < terms.size(); ++t)
+        {
+            const ContractionTerm &term = terms[t];
+            RestrictedSummation::Plan plan = make_plan(term);
+            bool epilogue = hoists_implicit(term, plan, bounds);
+            Summand s = summand(term, plan, epilogue, "t" + std::to_string(t));
+            std::string value = format_double(s.prefactor) + (s.signs.empty() ? "" : " * " + s.signs) + s.product;
+
+            bool summed = std::any_of(plan.loops.begin(), plan.loops.end(),
+                                      [&bounds](const RestrictedLoop &loop)
+                                      { return loop.summed && !bounds.fixed.count(loop.label); });
+            if (!summed)
+            {
+                emit_statements(oss, s.setup, body_depth);
+                oss << indent(body_depth) << "acc += " << lift(value, s.field, target) << ";\n";
+                continue;
+            }
+
+            // Hoisted implicit factors need a per-term partial sum
+            std::string accumulator = epilogue ? "sum" : "acc";
+            size_t loop_depth = body_depth;
+            if (epilogue)
+            {
+                oss << indent(body_depth) << "{\n";
+                ++loop_depth;
+                oss << indent(loop_depth) << value_type(s.field) << " sum = 0.0;\n";
+                value = s.signs.empty() ? s.product.substr(3) : s.signs + s.product;
+            }
+            size_t inner_depth = loop_depth;
+            emit_loop_headers(oss, plan, bounds, 1, options_.index_type, inner_depth);
+            oss << indent(inner_depth - 1) << "{\n";
+            emit_statements(oss, s.setup, inner_depth);
+            oss << indent(inner_depth) << accumulator << " += " << (epilogue ? value : lift(value, s.field, target))
+                << ";\n";
+            oss << indent(inner_depth - 1) << "}\n";
+            if (epilogue)
+            {
+                oss << indent(loop_depth) << "acc += "
+                    << lift(format_double(s.prefactor) + s.implicit_product + " * sum", s.field, target) << ";\n";
+                oss << indent(body_depth) << "}\n";
+            }
+        }
+
+        Access out = access(terms[0].output(), outer, "o");
+        if (!bounds.output_block.empty())
+            out.offset = block_offset(terms[0].output(), bounds);
+        emit_statements(oss, out.setup, body_depth);
+        oss << indent(body_depth) << variable_name(terms[0].output()) << "[" << out.offset << "] += ";
+        if (out.static_sign != 1)
+            oss << format_double(out.static_sign) << " * ";
+        if (!out.sign.empty())
+            oss << (target == Field::COMPLEX ? "double(" + out.sign + ")" : out.sign) << " * ";
+        oss << "acc;\n";
+        oss << indent(body_depth - 1) << "}\n";
+        return oss.str();
+    }
+
+} // namespace qc
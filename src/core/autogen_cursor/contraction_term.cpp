@@ -0,0 +1,103 @@
+#include "core/autogen_cursor/contraction_term.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include <sstream>
+#include <set>
+
+namespace qc
+{
+
+    ContractionTerm::ContractionTerm(const Tensor &output, const std::vector<Tensor> &factors,
+                                     double prefactor)
+        : output_(output), factors_(factors), prefactor_(prefactor) {}
+
+    void ContractionTerm::set_factor(size_t i, const Tensor &factor)
+    {
+        if (i < factors_.size())
+        {
+            factors_[i] = factor;
+        }
+    }
+
+    void ContractionTerm::remove_factor(size_t i)
+    {
+        if (i < factors_.size())
+        {
+            factors_.erase(factors_.begin() + i);
+        }
+    }
+
+    IndexSet ContractionTerm::external_indices() const
+    {
+        return output_.indices();
+    }
+
+    IndexSet ContractionTerm::summed_indices() const
+    {
+        // Summed indices in order of first appearance
+        IndexSet result;
+        std::set<std::string> seen = output_.indices().get_labels();
+        for (const auto &factor : factors_)
+        {
+            for (const auto &idx : factor.indices())
+            {
+                if (seen.insert(idx->label()).second)
+                {
+                    result.add_index(*idx);
+                }
+            }
+        }
+        return result;
+    }
+
+    IndexSet ContractionTerm::loop_indices() const
+    {
+        return external_indices() + summed_indices();
+    }
+
+    bool ContractionTerm::is_summed(const std::string &label) const
+    {
+        if (output_.indices().get_labels().count(label))
+            return false;
+        for (const auto &factor : factors_)
+        {
+            if (factor.indices().get_labels().count(label))
+                return true;
+        }
+        return false;
+    }
+
+    double ContractionTerm::flop_count() const
+    {
+        const auto &registry = SpaceRegistry::global();
+        double flops = 2.0 * static_cast<double>(factors_.size() > 1 ? factors_.size() - 1 : 1);
+        for (const auto &idx : loop_indices())
+        {
+            long dim = registry.dimension(*idx);
+            if (dim < 0)
+                return -1.0;
+            flops *= static_cast<double>(dim);
+        }
+        return flops;
+    }
+
+    double ContractionTerm::optimized_flop_count() const
+    {
+        if (factors_.size() < 3)
+            return flop_count();
+
+        auto path = TensorContraction::optimize_contraction(factors_, output_.indices());
+        return path.cost_estimate;
+    }
+
+    std::string ContractionTerm::to_string() const
+    {
+        std::ostringstream oss;
+        oss << output_.to_string() << " += " << prefactor_;
+        for (const auto &factor : factors_)
+        {
+            oss << " * " << factor.to_string();
+        }
+        return oss.str();
+    }
+
+} // namespace qc
@@ -0,0 +1,139 @@
+#include "core/autogen_cursor/delta_elimination.h"
+#include "core/autogen_cursor/orbital_space.h"
+
+namespace qc
+{
+
+    namespace
+    {
+        Tensor substitute(const Tensor &tensor, const std::string &from, const Index &to)
+        {
+            IndexSet indices;
+            bool changed = false;
+            for (const auto &idx : tensor.indices())
+            {
+                if (idx->label() == from)
+                {
+                    indices.add_index(to);
+                    changed = true;
+                }
+                else
+                {
+                    indices.add_index(*idx);
+                }
+            }
+            if (!changed)
+                return tensor;
+            Tensor result(tensor);
+            result.set_indices(indices);
+            return result;
+        }
+
+        // Number of factors other than `skip` carrying `label`
+        size_t occurrences(const ContractionTerm &term, const std::string &label, size_t skip)
+        {
+            size_t count = 0;
+            for (size_t f = 0; f < term.num_factors(); ++f)
+            {
+                if (f != skip && term.factor(f).indices().get_labels().count(label))
+                    ++count;
+            }
+            return count;
+        }
+    }
+
+    bool KroneckerDeltaElimination::is_delta(const Tensor &tensor)
+    {
+        return tensor.actual_rank() == 2 &&
+               (tensor.get_property("kronecker_delta") == "true" || tensor.symbol().name() == "delta");
+    }
+
+    KroneckerDeltaElimination::Result KroneckerDeltaElimination::apply(ContractionTerm &term)
+    {
+        const auto &registry = SpaceRegistry::global();
+        Result result = Result::UNCHANGED;
+
+        size_t f = 0;
+        while (f < term.num_factors())
+        {
+            const Tensor &delta = term.factor(f);
+            if (!is_delta(delta))
+            {
+                ++f;
+                continue;
+            }
+
+            Index p = delta.indices()[0];
+            Index q = delta.indices()[1];
+            int p_space = registry.space_of(p);
+            int q_space = registry.space_of(q);
+            if (registry.are_disjoint(p_space, q_space))
+            {
+                term.set_prefactor(0.0);
+                return Result::VANISHED;
+            }
+
+            if (p.label() == q.label())
+            {
+                // d_pp is one for every p; summed over p alone it is the dimension
+                if (term.is_summed(p.label()) && occurrences(term, p.label(), f) == 0)
+                {
+                    long dim = registry.dimension(p);
+                    if (dim < 0)
+                    {
+                        ++f;
+                        continue;
+                    }
+                    term.multiply_prefactor(static_cast<double>(dim));
+                }
+                term.remove_factor(f);
+                result = Result::SIMPLIFIED;
+                continue;
+            }
+
+            // Eliminate a summed index; the survivor must span the common space
+            int common = registry.intersection(p_space, q_space);
+            bool p_summed = term.is_summed(p.label());
+            bool q_summed = term.is_summed(q.label());
+            const Index *keep = nullptr;
+            const Index *drop = nullptr;
+            if (q_summed && common == p_space)
+            {
+                keep = &p;
+                drop = &q;
+            }
+            else if (p_summed && common == q_space)
+            {
+                keep = &q;
+                drop = &p;
+            }
+            if (!keep)
+            {
+                ++f;
+                continue;
+            }
+
+            Index survivor = *keep;
+            std::string dropped = drop->label();
+            term.remove_factor(f);
+            for (size_t g = 0; g < term.num_factors(); ++g)
+                term.set_factor(g, substitute(term.factor(g), dropped, survivor));
+            result = Result::SIMPLIFIED;
+            f = 0;
+        }
+        return result;
+    }
+
+    std::vector<ContractionTerm> KroneckerDeltaElimination::apply(const std::vector<ContractionTerm> &terms)
+    {
+        std::vector<ContractionTerm> result;
+        for (const auto &term : terms)
+        {
+            ContractionTerm copy = term;
+            if (apply(copy) != Result::VANISHED)
+                result.push_back(copy);
+        }
+        return result;
+    }
+
+} // namespace qc
@@ -0,0 +1,577 @@
+#include "core/autogen_cursor/equation_library.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/autogen_cursor/rdm_generator.h"
+#include "core/autogen_cursor/triples_generator.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace qc
+{
+
+    // Defined by the build in builtin_equations.cpp, written by qc_equation_builder
+    extern const unsigned char qc_builtin_equations[];
+    extern const std::size_t qc_builtin_equations_size;
+
+    namespace
+    {
+        const char kMagic[4] = {'Q', 'C', 'E', 'Q'};
+        const std::uint32_t kNone = 0xffffffffu;
+        const std::uint32_t kHeaderSize = 16;
+        const std::uint32_t kIndexSize = 32;
+        const std::uint32_t kTermSize = 20;
+        const std::uint32_t kBlockSize = 12;
+        const std::uint32_t kSetSize = 12;
+
+        void put(std::vector<unsigned char> &out, std::uint32_t value)
+        {
+            unsigned char bytes[4];
+            std::memcpy(bytes, &value, 4);
+            out.insert(out.end(), bytes, bytes + 4);
+        }
+
+        void put(std::vector<unsigned char> &out, double value)
+        {
+            unsigned char bytes[8];
+            std::memcpy(bytes, &value, 8);
+            out.insert(out.end(), bytes, bytes + 8);
+        }
+
+        std::uint32_t read_u32(const unsigned char *blob, std::uint32_t at)
+        {
+            std::uint32_t value;
+            std::memcpy(&value, blob + at, 4);
+            return value;
+        }
+
+        // count records of `length` bytes at `at` lie inside the blob
+        bool fits(size_t size, std::uint32_t at, std::uint32_t length, std::uint32_t count = 1)
+        {
+            return static_cast<std::uint64_t>(at) + static_cast<std::uint64_t>(length) * count <= size;
+        }
+
+        bool string_valid(const unsigned char *blob, size_t size, std::uint32_t at)
+        {
+            return fits(size, at, 4) && fits(size, at + 4, read_u32(blob, at));
+        }
+
+        bool tensor_valid(const unsigned char *blob, size_t size, std::uint32_t at)
+        {
+            if (!fits(size, at, 16))
+                return false;
+            const std::uint32_t rank = read_u32(blob, at + 8), num_properties = read_u32(blob, at + 12);
+            if (!fits(size, at + 16, 8, num_properties) || !fits(size, at + 16 + 8 * num_properties, kIndexSize, rank) ||
+                !string_valid(blob, size, read_u32(blob, at)))
+                return false;
+            for (std::uint32_t p = 0; p < 2 * num_properties; ++p)
+            {
+                if (!string_valid(blob, size, read_u32(blob, at + 16 + 4 * p)))
+                    return false;
+            }
+            for (std::uint32_t i = 0; i < rank; ++i)
+            {
+                const std::uint32_t index = at + 16 + 8 * num_properties + kIndexSize * i;
+                const std::uint32_t space = read_u32(blob, index + 12);
+                if (!string_valid(blob, size, read_u32(blob, index)) ||
+                    (space != kNone && !string_valid(blob, size, space)))
+                    return false;
+            }
+            return true;
+        }
+
+        std::vector<std::pair<std::string, std::string>> sorted_properties(const Tensor &tensor)
+        {
+            std::vector<std::pair<std::string, std::string>> result(tensor.properties().begin(),
+                                                                    tensor.properties().end());
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        std::string space_name(const Index &idx)
+        {
+            const auto &registry = SpaceRegistry::global();
+            if (idx.space_id() < 0 || idx.space_id() >= static_cast<int>(registry.num_spaces()))
+                return "";
+            return registry.name(idx.space_id());
+        }
+
+        // Lookups in a blob that has passed is_valid()
+        EquationSetView find_set(const unsigned char *blob, std::string_view name)
+        {
+            const std::uint32_t num_sets = read_u32(blob, 8), sets = read_u32(blob, 12);
+            for (std::uint32_t s = 0; s < num_sets; ++s)
+            {
+                EquationSetView view(blob, sets + kSetSize * s);
+                if (view.name() == name)
+                    return view;
+            }
+            return EquationSetView();
+        }
+
+        std::vector<std::string> set_names(const unsigned char *blob)
+        {
+            std::vector<std::string> result;
+            const std::uint32_t num_sets = read_u32(blob, 8), sets = read_u32(blob, 12);
+            for (std::uint32_t s = 0; s < num_sets; ++s)
+                result.emplace_back(EquationSetView(blob, sets + kSetSize * s).name());
+            return result;
+        }
+
+        // The embedded blob, validated once. Builds configured without
+        // QC_BUILTIN_EQUATIONS embed none and derive the sets at first use.
+        const unsigned char *builtin_blob()
+        {
+            const bool embedded = qc_builtin_equations_size > 0;
+            static const std::vector<unsigned char> derived =
+                embedded ? std::vector<unsigned char>() : EquationLibrary::serialize(EquationLibrary::derive_builtin());
+            const unsigned char *blob = embedded ? qc_builtin_equations : derived.data();
+            static const bool valid = EquationLibrary::is_valid(blob, embedded ? qc_builtin_equations_size : derived.size());
+            return valid ? blob : nullptr;
+        }
+
+        // Offsets of deduplicated strings and tensor records
+        class Pools
+        {
+        private:
+            std::map<std::string, std::uint32_t> strings_;
+            std::vector<std::string> string_order_;
+            std::map<std::vector<unsigned char>, std::uint32_t> tensors_;
+            std::vector<const std::vector<unsigned char> *> tensor_order_;
+            std::uint32_t strings_end_ = kHeaderSize, tensors_end_ = 0;
+
+        public:
+            void add_string(const std::string &s)
+            {
+                if (strings_.emplace(s, strings_end_).second)
+                {
+                    string_order_.push_back(s);
+                    strings_end_ += 4 + static_cast<std::uint32_t>(s.size());
+                }
+            }
+
+            void add_strings(const Tensor &tensor)
+            {
+                add_string(tensor.symbol().name());
+                for (const auto &entry : sorted_properties(tensor))
+                {
+                    add_string(entry.first);
+                    add_string(entry.second);
+                }
+                for (const auto &idx : tensor.indices())
+                {
+                    add_string(idx->label());
+                    std::string space = space_name(*idx);
+                    if (!space.empty())
+                        add_string(space);
+                }
+            }
+
+            std::uint32_t string(const std::string &s) const { return strings_.at(s); }
+            std::uint32_t strings_end() const { return strings_end_; }
+
+            // Strings must be complete before the first tensor
+            std::uint32_t tensor(const Tensor &tensor)
+            {
+                std::vector<unsigned char> record;
+                auto properties = sorted_properties(tensor);
+                put(record, string(tensor.symbol().name()));
+                put(record, static_cast<std::uint32_t>(tensor.type()));
+                put(record, static_cast<std::uint32_t>(tensor.actual_rank()));
+                put(record, static_cast<std::uint32_t>(properties.size()));
+                for (const auto &entry : properties)
+                {
+                    put(record, string(entry.first));
+                    put(record, string(entry.second));
+                }
+                for (const auto &idx : tensor.indices())
+                {
+                    std::string space = space_name(*idx);
+                    auto attributes = static_cast<std::uint64_t>(idx->attributes());
+                    put(record, string(idx->label()));
+                    put(record, static_cast<std::uint32_t>(idx->type()));
+                    put(record, static_cast<std::uint32_t>(idx->symmetry()));
+                    put(record, space.empty() ? kNone : string(space));
+                    put(record, static_cast<std::uint32_t>(idx->range_start()));
+                    put(record, static_cast<std::uint32_t>(idx->range_end()));
+                    put(record, static_cast<std::uint32_t>(attributes & 0xffffffffu));
+                    put(record, static_cast<std::uint32_t>(attributes >> 32));
+                }
+                if (tensors_end_ == 0)
+                    tensors_end_ = strings_end_;
+                auto inserted = tensors_.emplace(record, tensors_end_);
+                if (inserted.second)
+                {
+                    tensor_order_.push_back(&inserted.first->first);
+                    tensors_end_ += static_cast<std::uint32_t>(record.size());
+                }
+                return inserted.first->second;
+            }
+
+            std::uint32_t tensors_end() const { return tensors_end_ ? tensors_end_ : strings_end_; }
+
+            void write(std::vector<unsigned char> &out) const
+            {
+                for (const auto &s : string_order_)
+                {
+                    put(out, static_cast<std::uint32_t>(s.size()));
+                    out.insert(out.end(), s.begin(), s.end());
+                }
+                for (const auto *record : tensor_order_)
+                    out.insert(out.end(), record->begin(), record->end());
+            }
+        };
+    }
+
+    // EquationBlobView implementation
+    std::uint32_t EquationBlobView::u32(std::uint32_t at) const
+    {
+        return read_u32(blob_, at);
+    }
+
+    std::string_view EquationBlobView::string(std::uint32_t at) const
+    {
+        std::uint32_t record = u32(at);
+        return std::string_view(reinterpret_cast<const char *>(blob_ + record + 4), read_u32(blob_, record));
+    }
+
+    // TensorRecordView implementation
+    std::string_view TensorRecordView::name() const { return string(offset_); }
+
+    size_t TensorRecordView::rank() const { return u32(offset_ + 8); }
+
+    std::string_view TensorRecordView::label(size_t i) const
+    {
+        return string(offset_ + 16 + 8 * u32(offset_ + 12) + kIndexSize * static_cast<std::uint32_t>(i));
+    }
+
+    std::string_view TensorRecordView::space(size_t i) const
+    {
+        const std::uint32_t at = offset_ + 16 + 8 * u32(offset_ + 12) + kIndexSize * static_cast<std::uint32_t>(i);
+        return u32(at + 12) == kNone ? std::string_view() : string(at + 12);
+    }
+
+    Tensor TensorRecordView::materialize() const
+    {
+        auto &registry = SpaceRegistry::global();
+        const std::uint32_t num_properties = u32(offset_ + 12);
+        std::vector<Index> indices;
+        for (std::uint32_t i = 0; i < rank(); ++i)
+        {
+            const std::uint32_t at = offset_ + 16 + 8 * num_properties + kIndexSize * i;
+            Index idx(std::string(string(at)), static_cast<Index::Type>(u32(at + 4)),
+                      static_cast<int>(u32(at + 16)), static_cast<int>(u32(at + 20)),
+                      static_cast<Index::Symmetry>(u32(at + 8)));
+            if (u32(at + 12) != kNone)
+            {
+                std::string space(string(at + 12));
+                int id = registry.id(space);
+                idx.set_space_id(id >= 0 ? id : registry.register_space(space));
+            }
+            std::uint64_t attributes = u32(at + 24) | static_cast<std::uint64_t>(u32(at + 28)) << 32;
+            idx.set_attributes(static_cast<Index::Attribute>(attributes));
+            indices.push_back(idx);
+        }
+        Tensor result(std::string(name()), IndexSet(indices), static_cast<Tensor::Type>(u32(offset_ + 4)));
+        for (std::uint32_t p = 0; p < num_properties; ++p)
+            result.set_property(std::string(string(offset_ + 16 + 8 * p)), std::string(string(offset_ + 20 + 8 * p)));
+        return result;
+    }
+
+    // TermRecordView implementation
+    double TermRecordView::prefactor() const
+    {
+        double value;
+        std::memcpy(&value, blob_ + offset_, 8);
+        return value;
+    }
+
+    TensorRecordView TermRecordView::output() const { return TensorRecordView(blob_, u32(offset_ + 8)); }
+
+    size_t TermRecordView::num_factors() const { return u32(offset_ + 12); }
+
+    TensorRecordView TermRecordView::factor(size_t i) const
+    {
+        return TensorRecordView(blob_, u32(u32(offset_ + 16) + 4 * static_cast<std::uint32_t>(i)));
+    }
+
+    ContractionTerm TermRecordView::materialize() const
+    {
+        std::vector<Tensor> factors;
+        for (size_t f = 0; f < num_factors(); ++f)
+            factors.push_back(factor(f).materialize());
+        return ContractionTerm(output().materialize(), factors, prefactor());
+    }
+
+    // BlockRecordView implementation
+    std::string_view BlockRecordView::name() const { return string(offset_); }
+
+    size_t BlockRecordView::num_terms() const { return u32(offset_ + 4); }
+
+    TermRecordView BlockRecordView::term(size_t i) const
+    {
+        return TermRecordView(blob_, u32(offset_ + 8) + kTermSize * static_cast<std::uint32_t>(i));
+    }
+
+    std::vector<ContractionTerm> BlockRecordView::materialize() const
+    {
+        std::vector<ContractionTerm> result;
+        for (size_t t = 0; t < num_terms(); ++t)
+            result.push_back(term(t).materialize());
+        return result;
+    }
+
+    // EquationSetView implementation
+    std::string_view EquationSetView::name() const { return string(offset_); }
+
+    size_t EquationSetView::num_blocks() const { return u32(offset_ + 4); }
+
+    BlockRecordView EquationSetView::block(size_t i) const
+    {
+        return BlockRecordView(blob_, u32(offset_ + 8) + kBlockSize * static_cast<std::uint32_t>(i));
+    }
+
+    BlockRecordView EquationSetView::block(std::string_view name) const
+    {
+        for (size_t b = 0; b < num_blocks(); ++b)
+        {
+            if (block(b).name() == name)
+                return block(b);
+        }
+        return BlockRecordView();
+    }
+
+    std::vector<std::string> EquationSetView::spaces() const
+    {
+        std::vector<std::string> result;
+        auto add = [&result](const TensorRecordView &tensor)
+        {
+            for (size_t i = 0; i < tensor.rank(); ++i)
+            {
+                std::string space(tensor.space(i));
+                if (!space.empty() && std::find(result.begin(), result.end(), space) == result.end())
+                    result.push_back(space);
+            }
+        };
+        for (size_t b = 0; b < num_blocks(); ++b)
+        {
+            for (size_t t = 0; t < block(b).num_terms(); ++t)
+            {
+                TermRecordView term = block(b).term(t);
+                add(term.output());
+                for (size_t f = 0; f < term.num_factors(); ++f)
+                    add(term.factor(f));
+            }
+        }
+        return result;
+    }
+
+    EquationSet EquationSetView::materialize() const
+    {
+        EquationSet result;
+        result.name = std::string(name());
+        for (size_t b = 0; b < num_blocks(); ++b)
+            result.blocks.emplace_back(std::string(block(b).name()), block(b).materialize());
+        return result;
+    }
+
+    // EquationLibrary implementation
+    std::vector<unsigned char> EquationLibrary::serialize(const std::vector<EquationSet> &sets)
+    {
+        Pools pools;
+        for (const auto &set : sets)
+        {
+            pools.add_string(set.name);
+            for (const auto &block : set.blocks)
+            {
+                pools.add_string(block.first);
+                for (const auto &term : block.second)
+                {
+                    pools.add_strings(term.output());
+                    for (const auto &factor : term.factors())
+                        pools.add_strings(factor);
+                }
+            }
+        }
+
+        // Tensor records, then factor lists, terms, blocks and sets
+        std::vector<std::pair<std::uint32_t, std::vector<std::uint32_t>>> terms; // output, factors
+        for (const auto &set : sets)
+        {
+            for (const auto &block : set.blocks)
+            {
+                for (const auto &term : block.second)
+                {
+                    std::vector<std::uint32_t> factors;
+                    for (const auto &factor : term.factors())
+                        factors.push_back(pools.tensor(factor));
+                    terms.emplace_back(pools.tensor(term.output()), factors);
+                }
+            }
+        }
+
+        std::vector<unsigned char> factor_lists;
+        std::vector<std::uint32_t> factor_offsets;
+        const std::uint32_t factors_begin = pools.tensors_end();
+        for (const auto &term : terms)
+        {
+            factor_offsets.push_back(factors_begin + static_cast<std::uint32_t>(factor_lists.size()));
+            for (std::uint32_t offset : term.second)
+                put(factor_lists, offset);
+        }
+        const std::uint32_t terms_begin = factors_begin + static_cast<std::uint32_t>(factor_lists.size());
+        const std::uint32_t blocks_begin = terms_begin + kTermSize * static_cast<std::uint32_t>(terms.size());
+        std::uint32_t num_blocks = 0;
+        for (const auto &set : sets)
+            num_blocks += static_cast<std::uint32_t>(set.blocks.size());
+        const std::uint32_t sets_begin = blocks_begin + kBlockSize * num_blocks;
+
+        std::vector<unsigned char> out(kMagic, kMagic + 4);
+        put(out, kVersion);
+        put(out, static_cast<std::uint32_t>(sets.size()));
+        put(out, sets_begin);
+        pools.write(out);
+        out.insert(out.end(), factor_lists.begin(), factor_lists.end());
+
+        size_t t = 0;
+        for (const auto &set : sets)
+        {
+            for (const auto &block : set.blocks)
+            {
+                for (const auto &term : block.second)
+                {
+                    put(out, term.prefactor());
+                    put(out, terms[t].first);
+                    put(out, static_cast<std::uint32_t>(terms[t].second.size()));
+                    put(out, factor_offsets[t]);
+                    ++t;
+                }
+            }
+        }
+        std::uint32_t first_term = terms_begin;
+        for (const auto &set : sets)
+        {
+            for (const auto &block : set.blocks)
+            {
+                put(out, pools.string(block.first));
+                put(out, static_cast<std::uint32_t>(block.second.size()));
+                put(out, first_term);
+                first_term += kTermSize * static_cast<std::uint32_t>(block.second.size());
+            }
+        }
+        std::uint32_t first_block = blocks_begin;
+        for (const auto &set : sets)
+        {
+            put(out, pools.string(set.name));
+            put(out, static_cast<std::uint32_t>(set.blocks.size()));
+            put(out, first_block);
+            first_block += kBlockSize * static_cast<std::uint32_t>(set.blocks.size());
+        }
+        return out;
+    }
+
+    bool EquationLibrary::is_valid(const unsigned char *blob, size_t size)
+    {
+        // Offsets are 32-bit, so every checked end below also fits in 32 bits
+        if (!blob || size < kHeaderSize || size > kNone || std::memcmp(blob, kMagic, 4) != 0 ||
+            read_u32(blob, 4) != kVersion)
+            return false;
+        const std::uint32_t num_sets = read_u32(blob, 8), sets = read_u32(blob, 12);
+        if (!fits(size, sets, kSetSize, num_sets))
+            return false;
+        for (std::uint32_t s = 0; s < num_sets; ++s)
+        {
+            const std::uint32_t set = sets + kSetSize * s;
+            const std::uint32_t num_blocks = read_u32(blob, set + 4), blocks = read_u32(blob, set + 8);
+            if (!string_valid(blob, size, read_u32(blob, set)) || !fits(size, blocks, kBlockSize, num_blocks))
+                return false;
+            for (std::uint32_t b = 0; b < num_blocks; ++b)
+            {
+                const std::uint32_t block = blocks + kBlockSize * b;
+                const std::uint32_t num_terms = read_u32(blob, block + 4), terms = read_u32(blob, block + 8);
+                if (!string_valid(blob, size, read_u32(blob, block)) || !fits(size, terms, kTermSize, num_terms))
+                    return false;
+                for (std::uint32_t t = 0; t < num_terms; ++t)
+                {
+                    const std::uint32_t term = terms + kTermSize * t;
+                    const std::uint32_t num_factors = read_u32(blob, term + 12), factors = read_u32(blob, term + 16);
+                    if (!tensor_valid(blob, size, read_u32(blob, term + 8)) || !fits(size, factors, 4, num_factors))
+                        return false;
+                    for (std::uint32_t f = 0; f < num_factors; ++f)
+                    {
+                        if (!tensor_valid(blob, size, read_u32(blob, factors + 4 * f)))
+                            return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    EquationSetView EquationLibrary::find(const unsigned char *blob, size_t size, std::string_view name)
+    {
+        return is_valid(blob, size) ? find_set(blob, name) : EquationSetView();
+    }
+
+    std::vector<std::string> EquationLibrary::names(const unsigned char *blob, size_t size)
+    {
+        return is_valid(blob, size) ? set_names(blob) : std::vector<std::string>();
+    }
+
+    EquationSetView EquationLibrary::load_builtin(std::string_view name)
+    {
+        const unsigned char *blob = builtin_blob();
+        return blob ? find_set(blob, name) : EquationSetView();
+    }
+
+    std::vector<std::string> EquationLibrary::builtin_names()
+    {
+        const unsigned char *blob = builtin_blob();
+        return blob ? set_names(blob) : std::vector<std::string>();
+    }
+
+    std::vector<EquationSet> EquationLibrary::derive_builtin()
+    {
+        std::vector<EquationSet> result;
+
+        PerturbativeTriplesGenerator triples;
+        result.push_back({"ccsd_t", {{"connected", triples.connected_terms()},
+                                     {"disconnected", triples.disconnected_terms()}}});
+
+        RdmGenerator rdm;
+        for (int order = 1; order <= 2; ++order)
+        {
+            RdmEquations equations = rdm.equations(order);
+            EquationSet set;
+            set.name = "ccsd_d" + std::to_string(order);
+            for (const auto &intermediate : equations.intermediates)
+                set.blocks.emplace_back(intermediate.output().symbol().name(),
+                                        std::vector<ContractionTerm>{intermediate});
+            set.blocks.insert(set.blocks.end(), equations.blocks.begin(), equations.blocks.end());
+            result.push_back(set);
+        }
+        return result;
+    }
+
+    std::string EquationLibrary::to_source(const std::vector<unsigned char> &blob)
+    {
+        std::ostringstream oss;
+        oss << "// Generated by qc_equation_builder; do not edit.\n"
+            << "#include <cstddef>\n\n"
+            << "namespace qc\n{\n"
+            << "    alignas(8) extern const unsigned char qc_builtin_equations[] = {";
+        for (size_t i = 0; i < blob.size(); ++i)
+        {
+            oss << (i % 16 == 0 ? "\n        " : " ") << "0x" << std::hex << std::setw(2) << std::setfill('0')
+                << static_cast<unsigned>(blob[i]) << ",";
+        }
+        if (blob.empty())
+            oss << "0";
+        oss << std::dec << "\n    };\n"
+            << "    extern const std::size_t qc_builtin_equations_size = " << blob.size() << ";\n"
+            << "}\n";
+        return oss.str();
+    }
+
+} // namespace qc
@@ -1,4 +1,4 @@
-#include "core/expression.h"
+#include "core/autogen_cursor/expression.h"
 #include <sstream>
 #include <functional>
 
@@ -95,6 +95,66 @@ namespace qc
         return symbol_->hash();
     }
 
+    // TensorExpression implementation
+    TensorExpression::TensorExpression(const Tensor &tensor)
+        : Expression(Type::TENSOR), tensor_(tensor.clone()) {}
+
+    TensorExpression::TensorExpression(std::unique_ptr<Tensor> tensor)
+        : Expression(Type::TENSOR), tensor_(std::move(tensor)) {}
+
+    std::string TensorExpression::to_string() const
+    {
+        return tensor_->to_string();
+    }
+
+    std::unique_ptr<Expression> TensorExpression::clone() const
+    {
+        return std::make_unique<TensorExpression>(*tensor_);
+    }
+
+    bool TensorExpression::equals(const Expression &other) const
+    {
+        if (other.type() != Type::TENSOR)
+            return false;
+        auto *other_tensor = dynamic_cast<const TensorExpression *>(&other);
+        return other_tensor && *tensor_ == other_tensor->tensor();
+    }
+
+    std::size_t TensorExpression::hash() const
+    {
+        return tensor_->hash();
+    }
+
+    // OperatorExpression implementation
+    OperatorExpression::OperatorExpression(const Operator &op)
+        : Expression(Type::OPERATOR), op_(op.clone()) {}
+
+    OperatorExpression::OperatorExpression(std::unique_ptr<Operator> op)
+        : Expression(Type::OPERATOR), op_(std::move(op)) {}
+
+    std::string OperatorExpression::to_string() const
+    {
+        return op_->to_string();
+    }
+
+    std::unique_ptr<Expression> OperatorExpression::clone() const
+    {
+        return std::make_unique<OperatorExpression>(*op_);
+    }
+
+    bool OperatorExpression::equals(const Expression &other) const
+    {
+        if (other.type() != Type::OPERATOR)
+            return false;
+        auto *other_op = dynamic_cast<const OperatorExpression *>(&other);
+        return other_op && *op_ == other_op->operator_();
+    }
+
+    std::size_t OperatorExpression::hash() const
+    {
+        return op_->hash();
+    }
+
     // BinaryOpExpression implementation
     BinaryOpExpression::BinaryOpExpression(Type type, std::unique_ptr<Expression> left,
                                            std::unique_ptr<Expression> right)
@@ -352,6 +412,122 @@ namespace qc
         return seed;
     }
 
+    // ProductExpression implementation
+    ProductExpression::ProductExpression() : Expression(Type::MULTIPLY) {}
+
+    ProductExpression::ProductExpression(std::vector<std::unique_ptr<Expression>> factors)
+        : Expression(Type::MULTIPLY)
+    {
+        for (auto &factor : factors)
+        {
+            add_child(std::move(factor));
+        }
+    }
+
+    void ProductExpression::add_factor(std::unique_ptr<Expression> factor)
+    {
+        add_child(std::move(factor));
+    }
+
+    std::string ProductExpression::to_string() const
+    {
+        if (children_.empty())
+            return "1";
+
+        std::ostringstream oss;
+        for (size_t i = 0; i < children_.size(); ++i)
+        {
+            if (i > 0)
+            {
+                oss << " * ";
+            }
+            Type type = children_[i]->type();
+            bool parens = type == Type::ADD || type == Type::SUBTRACT || type == Type::SUM;
+            if (parens)
+                oss << "(";
+            oss << children_[i]->to_string();
+            if (parens)
+                oss << ")";
+        }
+        return oss.str();
+    }
+
+    std::unique_ptr<Expression> ProductExpression::clone() const
+    {
+        auto result = std::make_unique<ProductExpression>();
+        for (const auto &child : children_)
+        {
+            result->add_factor(child->clone());
+        }
+        return std::move(result);
+    }
+
+    std::unique_ptr<Expression> ProductExpression::derivative(const Symbol &var) const
+    {
+        // Product rule: one term per differentiated factor
+        auto result = std::make_unique<SumExpression>();
+        for (size_t i = 0; i < children_.size(); ++i)
+        {
+            auto term = std::make_unique<ProductExpression>();
+            for (size_t j = 0; j < children_.size(); ++j)
+            {
+                term->add_factor(i == j ? children_[j]->derivative(var) : children_[j]->clone());
+            }
+            result->add_term(std::move(term));
+        }
+        return std::move(result);
+    }
+
+    bool ProductExpression::equals(const Expression &other) const
+    {
+        // Any MULTIPLY node with equal factors, binary ones included
+        if (other.type() != Type::MULTIPLY || other.num_children() != children_.size())
+            return false;
+
+        for (size_t i = 0; i < children_.size(); ++i)
+        {
+            if (!children_[i]->equals(other.child(i)))
+                return false;
+        }
+        return true;
+    }
+
+    // ContractionExpression implementation
+    ContractionExpression::ContractionExpression(std::unique_ptr<Expression> A, std::unique_ptr<Expression> B,
+                                                 const IndexSet &contracted_indices)
+        : Expression(Type::CONTRACT), contracted_indices_(contracted_indices)
+    {
+        add_child(std::move(A));
+        add_child(std::move(B));
+    }
+
+    std::string ContractionExpression::to_string() const
+    {
+        return "contract_{" + contracted_indices_.to_string() + "}(" + A().to_string() + ", " + B().to_string() + ")";
+    }
+
+    std::unique_ptr<Expression> ContractionExpression::clone() const
+    {
+        return std::make_unique<ContractionExpression>(A().clone(), B().clone(), contracted_indices_);
+    }
+
+    bool ContractionExpression::equals(const Expression &other) const
+    {
+        if (other.type() != Type::CONTRACT)
+            return false;
+        auto *other_contract = dynamic_cast<const ContractionExpression *>(&other);
+        return other_contract && A().equals(other_contract->A()) && B().equals(other_contract->B()) &&
+               contracted_indices_.get_labels() == other_contract->contracted_indices().get_labels();
+    }
+
+    std::size_t ContractionExpression::hash() const
+    {
+        std::size_t seed = Expression::hash();
+        for (const auto &idx : contracted_indices_)
+            seed ^= idx->hash() + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+
     // ExpressionFactory implementation
     namespace ExpressionFactory
     {
@@ -361,6 +537,16 @@ namespace qc
             return std::make_unique<SymbolExpression>(sym);
         }
 
+        std::unique_ptr<Expression> tensor(const Tensor &tensor)
+        {
+            return std::make_unique<TensorExpression>(tensor);
+        }
+
+        std::unique_ptr<Expression> operator_(const Operator &op)
+        {
+            return std::make_unique<OperatorExpression>(op);
+        }
+
         std::unique_ptr<Expression> add(std::unique_ptr<Expression> left,
                                         std::unique_ptr<Expression> right)
         {
@@ -402,6 +588,12 @@ namespace qc
             return std::make_unique<CommutatorExpression>(std::move(A), std::move(B));
         }
 
+        std::unique_ptr<Expression> contract(std::unique_ptr<Expression> A, std::unique_ptr<Expression> B,
+                                             const IndexSet &contracted_indices)
+        {
+            return std::make_unique<ContractionExpression>(std::move(A), std::move(B), contracted_indices);
+        }
+
         std::unique_ptr<Expression> sum(const std::vector<std::unique_ptr<Expression>> &terms)
         {
             auto result = std::make_unique<SumExpression>();
@@ -412,6 +604,11 @@ namespace qc
             return std::move(result);
         }
 
+        std::unique_ptr<Expression> product(std::vector<std::unique_ptr<Expression>> factors)
+        {
+            return std::make_unique<ProductExpression>(std::move(factors));
+        }
+
         std::unique_ptr<Expression> zero()
         {
             return symbol(ScalarSymbol("0", 0.0));
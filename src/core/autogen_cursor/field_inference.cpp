@@ -0,0 +1,157 @@
+#include "core/autogen_cursor/field_inference.h"
+
+namespace qc
+{
+
+    // FieldInference implementation
+    const char *FieldInference::name(Field field)
+    {
+        switch (field)
+        {
+        case Field::IMAGINARY:
+            return "imaginary";
+        case Field::COMPLEX:
+            return "complex";
+        default:
+            return "real";
+        }
+    }
+
+    Field FieldInference::parse(const std::string &name)
+    {
+        if (name == "imaginary")
+            return Field::IMAGINARY;
+        if (name == "complex")
+            return Field::COMPLEX;
+        return Field::REAL;
+    }
+
+    Field FieldInference::product(Field a, Field b)
+    {
+        if (a == Field::COMPLEX || b == Field::COMPLEX)
+            return Field::COMPLEX;
+        return a == b ? Field::REAL : Field::IMAGINARY;
+    }
+
+    Field FieldInference::sum(Field a, Field b)
+    {
+        return a == b ? a : Field::COMPLEX;
+    }
+
+    Field FieldInference::of(const Tensor &tensor)
+    {
+        return parse(tensor.get_property("field"));
+    }
+
+    Field FieldInference::of(const Operator &op)
+    {
+        return parse(op.get_property("field"));
+    }
+
+    Field FieldInference::of(const Symbol &symbol)
+    {
+        auto *complex = dynamic_cast<const ComplexSymbol *>(&symbol);
+        if (!complex || complex->imag() == 0.0)
+            return Field::REAL;
+        return complex->real() == 0.0 ? Field::IMAGINARY : Field::COMPLEX;
+    }
+
+    void FieldInference::set(Tensor &tensor, Field field)
+    {
+        tensor.set_property("field", name(field));
+    }
+
+    void FieldInference::set(Operator &op, Field field)
+    {
+        op.set_property("field", name(field));
+    }
+
+    Field FieldInference::of(const Expression &expr)
+    {
+        switch (expr.type())
+        {
+        case Expression::Type::SYMBOL:
+            return of(static_cast<const SymbolExpression &>(expr).symbol());
+        case Expression::Type::TENSOR:
+            return of(static_cast<const TensorExpression &>(expr).tensor());
+        case Expression::Type::OPERATOR:
+            return of(static_cast<const OperatorExpression &>(expr).operator_());
+        case Expression::Type::OPERATOR_PRODUCT:
+        {
+            Field result = Field::REAL;
+            for (const auto &op : static_cast<const OperatorProductExpression &>(expr).product().operators())
+                result = product(result, of(op));
+            return result;
+        }
+        case Expression::Type::MULTIPLY:
+        case Expression::Type::DIVIDE: // 1 / (i x) = -i / x
+        case Expression::Type::CONTRACT:
+        case Expression::Type::COMMUTATOR:
+        case Expression::Type::ANTICOMMUTATOR:
+        {
+            Field result = Field::REAL;
+            for (size_t i = 0; i < expr.num_children(); ++i)
+                result = product(result, of(expr.child(i)));
+            return result;
+        }
+        case Expression::Type::POWER:
+        {
+            bool real = true;
+            for (size_t i = 0; i < expr.num_children(); ++i)
+                real = real && of(expr.child(i)) == Field::REAL;
+            return real ? Field::REAL : Field::COMPLEX;
+        }
+        case Expression::Type::FUNCTION_CALL:
+        {
+            for (size_t i = 0; i < expr.num_children(); ++i)
+            {
+                if (of(expr.child(i)) != Field::REAL)
+                    return Field::COMPLEX;
+            }
+            return Field::REAL;
+        }
+        default:
+        {
+            // Sums, index sums, derivatives and integrals keep a common field
+            if (expr.num_children() == 0)
+                return Field::REAL;
+            Field result = of(expr.child(0));
+            for (size_t i = 1; i < expr.num_children(); ++i)
+                result = sum(result, of(expr.child(i)));
+            return result;
+        }
+        }
+    }
+
+    TermField FieldInference::of(const ContractionTerm &term)
+    {
+        TermField result;
+        int imaginary = 0;
+        for (const auto &factor : term.factors())
+        {
+            Field field = of(factor);
+            if (field == Field::COMPLEX)
+                result.field = Field::COMPLEX;
+            else if (field == Field::IMAGINARY)
+            {
+                ++imaginary;
+                if (factor.get_property("conjugate") == "true")
+                    result.sign = -result.sign;
+            }
+        }
+        if (imaginary % 4 >= 2)
+            result.sign = -result.sign;
+        result.imaginary_unit = imaginary % 2;
+        if (result.field != Field::COMPLEX && result.imaginary_unit)
+            result.field = Field::IMAGINARY;
+        return result;
+    }
+
+    void FieldInference::annotate(Expression &expr)
+    {
+        for (size_t i = 0; i < expr.num_children(); ++i)
+            annotate(expr.child(i));
+        expr.set_property("field", name(of(expr)));
+    }
+
+} // namespace qc
@@ -0,0 +1,259 @@
+#include "core/autogen_cursor/horner.h"
+#include "core/autogen_cursor/ac_matching.h"
+#include "util/metrics.h"
+#include <chrono>
+#include <cmath>
+#include <map>
+
+namespace qc
+{
+
+    namespace
+    {
+        // coefficient * prod(factors); the coefficient is +-1 unless the term is opaque
+        struct Monomial
+        {
+            double coefficient;
+            std::vector<std::unique_ptr<Expression>> factors;
+            bool opaque; // does not commute, factors = {term}
+        };
+
+        std::unique_ptr<Expression> factor_sum(std::vector<Monomial> monomials, size_t &factorizations);
+
+        bool is_minus_one(const Expression &expr)
+        {
+            double value;
+            return ACNormalizer::constant_value(expr, value) && value == -1.0;
+        }
+
+        // Integer powers up to this exponent are split into repeated factors
+        const int kMaxExpandedPower = 16;
+
+        // x^k as k factors x, so that x can be pulled out of x^k
+        void push_factor(std::vector<std::unique_ptr<Expression>> &factors, std::unique_ptr<Expression> factor)
+        {
+            double exponent;
+            if (factor->type() == Expression::Type::POWER && factor->num_children() == 2 &&
+                ACNormalizer::constant_value(factor->child(1), exponent) && exponent >= 2.0 &&
+                exponent <= kMaxExpandedPower && exponent == std::floor(exponent))
+            {
+                for (int k = 0; k < static_cast<int>(exponent); ++k)
+                    factors.push_back(factor->child(0).clone());
+                return;
+            }
+            factors.push_back(std::move(factor));
+        }
+
+        // Runs of equal factors are written back as powers
+        std::unique_ptr<Expression> product_of(const Monomial &monomial)
+        {
+            std::vector<std::unique_ptr<Expression>> factors;
+            for (size_t i = 0; i < monomial.factors.size();)
+            {
+                size_t run = 1;
+                while (i + run < monomial.factors.size() &&
+                       ACNormalizer::compare(*monomial.factors[i + run], *monomial.factors[i]) == 0)
+                    ++run;
+                if (run == 1)
+                    factors.push_back(monomial.factors[i]->clone());
+                else
+                    factors.push_back(ExpressionFactory::power(monomial.factors[i]->clone(),
+                                                               ExpressionFactory::constant(static_cast<double>(run))));
+                i += run;
+            }
+            if (factors.empty())
+                return ExpressionFactory::one();
+            if (factors.size() == 1)
+                return std::move(factors[0]);
+            return ExpressionFactory::product(std::move(factors));
+        }
+
+        std::unique_ptr<Expression> sum_of(const std::vector<Monomial> &monomials)
+        {
+            auto sum = std::make_unique<SumExpression>();
+            for (const auto &monomial : monomials)
+                sum->add_term(product_of(monomial), monomial.coefficient);
+            return ACNormalizer::normalize(*sum);
+        }
+
+        std::unique_ptr<Expression> horner(const Expression &expr, size_t &factorizations)
+        {
+            if (expr.is_leaf())
+                return expr.clone();
+
+            const auto *sum = dynamic_cast<const SumExpression *>(&expr);
+            if (!sum)
+            {
+                auto result = expr.clone();
+                for (size_t i = 0; i < expr.num_children(); ++i)
+                    result->set_child(i, horner(expr.child(i), factorizations));
+                return ACNormalizer::normalize(*result);
+            }
+
+            std::vector<Monomial> monomials;
+            for (size_t t = 0; t < sum->num_terms(); ++t)
+            {
+                auto term = horner(sum->child(t), factorizations);
+                Monomial monomial{sum->coefficient(t), {}, !ACNormalizer::is_commutative(*term)};
+                if (monomial.opaque)
+                {
+                    monomial.factors.push_back(std::move(term));
+                }
+                else if (term->type() == Expression::Type::MULTIPLY)
+                {
+                    for (size_t i = 0; i < term->num_children(); ++i)
+                        push_factor(monomial.factors, term->child(i).clone());
+                }
+                else
+                {
+                    push_factor(monomial.factors, std::move(term));
+                }
+                if (!monomial.opaque && std::fabs(monomial.coefficient) != 1.0)
+                {
+                    monomial.factors.push_back(ExpressionFactory::constant(std::fabs(monomial.coefficient)));
+                    monomial.coefficient = monomial.coefficient < 0.0 ? -1.0 : 1.0;
+                }
+                monomials.push_back(std::move(monomial));
+            }
+            return factor_sum(std::move(monomials), factorizations);
+        }
+
+        std::unique_ptr<Expression> factor_sum(std::vector<Monomial> monomials, size_t &factorizations)
+        {
+            auto plain = sum_of(monomials);
+            if (monomials.size() < 2)
+                return plain;
+
+            // Terms containing each factor
+            auto canonical = [](const Expression *a, const Expression *b)
+            { return ACNormalizer::compare(*a, *b) < 0; };
+            std::map<const Expression *, std::vector<size_t>, decltype(canonical)> terms_with(canonical);
+            for (size_t t = 0; t < monomials.size(); ++t)
+            {
+                if (monomials[t].opaque)
+                    continue;
+                for (const auto &factor : monomials[t].factors)
+                {
+                    auto &terms = terms_with[factor.get()];
+                    if (terms.empty() || terms.back() != t)
+                        terms.push_back(t);
+                }
+            }
+
+            const Expression *common = nullptr;
+            size_t best = 1;
+            bool best_numeric = false;
+            for (const auto &entry : terms_with)
+            {
+                double value;
+                bool numeric = ACNormalizer::constant_value(*entry.first, value);
+                if (entry.second.size() > best || (entry.second.size() == best && common && best_numeric && !numeric))
+                {
+                    common = entry.first;
+                    best = entry.second.size();
+                    best_numeric = numeric;
+                }
+            }
+            if (!common)
+                return plain;
+
+            std::vector<Monomial> quotients, rest;
+            std::vector<bool> sharing(monomials.size(), false);
+            for (size_t t : terms_with[common])
+                sharing[t] = true;
+            for (size_t t = 0; t < monomials.size(); ++t)
+            {
+                Monomial monomial{monomials[t].coefficient, {}, monomials[t].opaque};
+                bool removed = !sharing[t];
+                for (auto &factor : monomials[t].factors)
+                {
+                    if (!removed && ACNormalizer::compare(*factor, *common) == 0)
+                        removed = true;
+                    else
+                        monomial.factors.push_back(factor->clone());
+                }
+                (sharing[t] ? quotients : rest).push_back(std::move(monomial));
+            }
+
+            size_t nested = 0;
+            auto factored = std::make_unique<SumExpression>();
+            std::vector<std::unique_ptr<Expression>> pulled;
+            pulled.push_back(common->clone());
+            pulled.push_back(factor_sum(std::move(quotients), nested));
+            factored->add_term(ExpressionFactory::product(std::move(pulled)));
+            if (!rest.empty())
+                factored->add_term(factor_sum(std::move(rest), nested));
+            auto candidate = ACNormalizer::normalize(*factored);
+
+            if (HornerFactorization::count(*candidate).total() >= HornerFactorization::count(*plain).total())
+                return plain;
+            factorizations += nested + 1;
+            return candidate;
+        }
+    }
+
+    // HornerFactorization implementation
+    std::unique_ptr<Expression> HornerFactorization::apply(const Expression &expr)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stats_ = HornerStats();
+        stats_.before = count(expr);
+
+        auto result = horner(*ACNormalizer::normalize(expr), stats_.factorizations);
+
+        stats_.after = count(*result);
+        stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto &registry = MetaWaveCompiler::util::metrics();
+        const char *help = "Operations of expressions passed through Horner factorization";
+        registry.counter("qc_horner_operations_total", help, "stage=\"before\"").inc(stats_.before.total());
+        registry.counter("qc_horner_operations_total", help, "stage=\"after\"").inc(stats_.after.total());
+        return result;
+    }
+
+    OperationCount HornerFactorization::count(const Expression &expr)
+    {
+        OperationCount result;
+        for (size_t i = 0; i < expr.num_children(); ++i)
+        {
+            OperationCount child = count(expr.child(i));
+            result.multiplications += child.multiplications;
+            result.additions += child.additions;
+            result.other += child.other;
+        }
+        if (expr.is_leaf())
+            return result;
+
+        if (const auto *sum = dynamic_cast<const SumExpression *>(&expr))
+        {
+            result.additions += sum->num_terms() - 1;
+            for (size_t t = 0; t < sum->num_terms(); ++t)
+            {
+                if (std::fabs(sum->coefficient(t)) != 1.0)
+                    ++result.multiplications;
+            }
+            return result;
+        }
+
+        switch (expr.type())
+        {
+        case Expression::Type::ADD:
+        case Expression::Type::SUBTRACT:
+            result.additions += expr.num_children() - 1;
+            break;
+        case Expression::Type::MULTIPLY:
+            result.multiplications += expr.num_children() - 1;
+            for (size_t i = 0; i < expr.num_children(); ++i)
+            {
+                if (is_minus_one(expr.child(i)))
+                    --result.multiplications;
+            }
+            break;
+        default:
+            ++result.other;
+            break;
+        }
+        return result;
+    }
+
+} // namespace qc
@@ -0,0 +1,102 @@
+#include "core/autogen_cursor/implicit_tensor.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace qc
+{
+
+    ImplicitTensor::ImplicitTensor(const Tensor &tensor, const std::vector<DiagonalTerm> &terms,
+                                   double shift, bool reciprocal)
+        : tensor_(tensor), terms_(terms), shift_(shift), reciprocal_(reciprocal) {}
+
+    ImplicitTensor ImplicitTensor::denominator(const Tensor &tensor, bool reciprocal, double shift)
+    {
+        const auto &registry = SpaceRegistry::global();
+        int occ = registry.id("occ");
+        std::vector<DiagonalTerm> terms;
+        for (size_t pos = 0; pos < tensor.actual_rank(); ++pos)
+        {
+            int space = registry.space_of(tensor.indices()[pos]);
+            double sign = registry.is_subspace(space, occ) ? 1.0 : -1.0;
+            terms.push_back({pos, space, sign});
+        }
+        return ImplicitTensor(tensor, terms, shift, reciprocal);
+    }
+
+    std::string ImplicitTensor::source_name(int space)
+    {
+        const auto &registry = SpaceRegistry::global();
+        if (space < 0 || space >= static_cast<int>(registry.num_spaces()))
+            return "e_gen";
+        return "e_" + registry.name(space);
+    }
+
+    std::vector<int> ImplicitTensor::source_spaces() const
+    {
+        std::vector<int> result;
+        for (const auto &term : terms_)
+        {
+            if (std::find(result.begin(), result.end(), term.space) == result.end())
+                result.push_back(term.space);
+        }
+        return result;
+    }
+
+    std::vector<std::string> ImplicitTensor::sources() const
+    {
+        std::vector<std::string> result;
+        for (int space : source_spaces())
+            result.push_back(source_name(space));
+        return result;
+    }
+
+    std::string ImplicitTensor::element_expression(const std::vector<std::string> &labels) const
+    {
+        std::ostringstream oss;
+        oss.precision(17);
+        bool first = true;
+        if (shift_ != 0.0)
+        {
+            oss << shift_;
+            first = false;
+        }
+        for (const auto &term : terms_)
+        {
+            if (term.position >= labels.size())
+                continue;
+            std::string value = source_name(term.space) + "[" + labels[term.position] + "]";
+            if (std::fabs(term.sign) != 1.0)
+            {
+                std::ostringstream coefficient;
+                coefficient.precision(17);
+                coefficient << std::fabs(term.sign);
+                value = coefficient.str() + " * " + value;
+            }
+            if (first)
+                oss << (term.sign < 0 ? "-" : "") << value;
+            else
+                oss << (term.sign < 0 ? " - " : " + ") << value;
+            first = false;
+        }
+        std::string sum = first ? "0.0" : oss.str();
+        return reciprocal_ ? "(1.0 / (" + sum + "))" : "(" + sum + ")";
+    }
+
+    double ImplicitTensor::element(const std::vector<long> &values,
+                                   const std::map<int, const double *> &diagonals) const
+    {
+        double sum = shift_;
+        for (const auto &term : terms_)
+        {
+            auto diagonal = diagonals.find(term.space);
+            if (diagonal == diagonals.end() || !diagonal->second || term.position >= values.size())
+                return std::numeric_limits<double>::quiet_NaN();
+            sum += term.sign * diagonal->second[values[term.position]];
+        }
+        return reciprocal_ ? 1.0 / sum : sum;
+    }
+
+} // namespace qc
@@ -0,0 +1,220 @@
+#include "core/autogen_cursor/index.h"
+#include <functional>
+
+namespace qc
+{
+
+    // Index implementation
+    Index::Index(const std::string &label, Type type, int range_start, int range_end, Symmetry symmetry)
+        : label_(label), type_(type), range_start_(range_start), range_end_(range_end), symmetry_(symmetry) {}
+
+    void Index::set_range(int start, int end)
+    {
+        range_start_ = start;
+        range_end_ = end;
+    }
+
+    bool Index::operator==(const Index &other) const
+    {
+        return label_ == other.label_ && type_ == other.type_;
+    }
+
+    bool Index::operator!=(const Index &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool Index::operator<(const Index &other) const
+    {
+        if (label_ != other.label_)
+            return label_ < other.label_;
+        return type_ < other.type_;
+    }
+
+    std::string Index::to_string() const
+    {
+        return label_;
+    }
+
+    std::size_t Index::hash() const
+    {
+        std::size_t h1 = std::hash<std::string>{}(label_);
+        std::size_t h2 = std::hash<int>{}(static_cast<int>(type_));
+        return h1 ^ (h2 << 1);
+    }
+
+    std::unique_ptr<Index> Index::clone() const
+    {
+        return std::make_unique<Index>(*this);
+    }
+
+    // IndexSet implementation
+    IndexSet::IndexSet(const std::vector<Index> &indices)
+    {
+        for (const auto &idx : indices)
+            add_index(idx);
+    }
+
+    IndexSet::IndexSet(const IndexSet &other)
+    {
+        for (const auto &idx : other.indices_)
+            add_index(*idx);
+    }
+
+    IndexSet &IndexSet::operator=(const IndexSet &other)
+    {
+        if (this != &other)
+        {
+            indices_.clear();
+            for (const auto &idx : other.indices_)
+                add_index(*idx);
+        }
+        return *this;
+    }
+
+    void IndexSet::add_index(const Index &idx)
+    {
+        indices_.push_back(idx.clone());
+    }
+
+    void IndexSet::add_index(std::unique_ptr<Index> idx)
+    {
+        indices_.push_back(std::move(idx));
+    }
+
+    IndexSet IndexSet::operator+(const IndexSet &other) const
+    {
+        IndexSet result(*this);
+        for (const auto &idx : other.indices_)
+            result.add_index(*idx);
+        return result;
+    }
+
+    bool IndexSet::contains(const Index &idx) const
+    {
+        for (const auto &own : indices_)
+        {
+            if (*own == idx)
+                return true;
+        }
+        return false;
+    }
+
+    std::set<std::string> IndexSet::get_labels() const
+    {
+        std::set<std::string> labels;
+        for (const auto &idx : indices_)
+            labels.insert(idx->label());
+        return labels;
+    }
+
+    IndexSet IndexSet::find_common(const IndexSet &other) const
+    {
+        IndexSet common;
+        for (const auto &idx : indices_)
+        {
+            if (other.contains(*idx) && !common.contains(*idx))
+                common.add_index(*idx);
+        }
+        return common;
+    }
+
+    IndexSet IndexSet::find_unique() const
+    {
+        IndexSet unique;
+        for (const auto &idx : indices_)
+        {
+            if (!unique.contains(*idx))
+                unique.add_index(*idx);
+        }
+        return unique;
+    }
+
+    bool IndexSet::has_repeated_indices() const
+    {
+        return find_unique().size() != size();
+    }
+
+    std::vector<std::pair<size_t, size_t>> IndexSet::find_symmetric_pairs() const
+    {
+        // Adjacent slots that share a symmetry and an orbital space
+        std::vector<std::pair<size_t, size_t>> pairs;
+        for (size_t i = 0; i + 1 < indices_.size(); ++i)
+        {
+            const Index &a = *indices_[i];
+            const Index &b = *indices_[i + 1];
+            if (a.symmetry() != Index::Symmetry::NONE && a.symmetry() == b.symmetry() && a.type() == b.type())
+                pairs.emplace_back(i, i + 1);
+        }
+        return pairs;
+    }
+
+    std::string IndexSet::to_string() const
+    {
+        std::string result;
+        for (size_t i = 0; i < indices_.size(); ++i)
+            result += (i ? "," : "") + indices_[i]->to_string();
+        return result;
+    }
+
+    std::unique_ptr<IndexSet> IndexSet::clone() const
+    {
+        return std::make_unique<IndexSet>(*this);
+    }
+
+    // IndexFactory implementation
+    namespace IndexFactory
+    {
+
+        Index occupied(const std::string &label, int range_end)
+        {
+            return Index(label, Index::Type::OCCUPIED, 0, range_end);
+        }
+
+        Index virtual_orbital(const std::string &label, int range_end)
+        {
+            return Index(label, Index::Type::VIRTUAL, 0, range_end);
+        }
+
+        Index general(const std::string &label, int range_end)
+        {
+            return Index(label, Index::Type::GENERAL, 0, range_end);
+        }
+
+        Index spin(const std::string &label)
+        {
+            return Index(label, Index::Type::SPIN, 0, 2);
+        }
+
+        Index spatial(const std::string &label, int range_end)
+        {
+            return Index(label, Index::Type::SPATIAL, 0, range_end);
+        }
+
+        IndexSet occupied_set(const std::vector<std::string> &labels)
+        {
+            IndexSet result;
+            for (const auto &label : labels)
+                result.add_index(occupied(label));
+            return result;
+        }
+
+        IndexSet virtual_set(const std::vector<std::string> &labels)
+        {
+            IndexSet result;
+            for (const auto &label : labels)
+                result.add_index(virtual_orbital(label));
+            return result;
+        }
+
+        IndexSet general_set(const std::vector<std::string> &labels)
+        {
+            IndexSet result;
+            for (const auto &label : labels)
+                result.add_index(general(label));
+            return result;
+        }
+
+    } // namespace IndexFactory
+
+} // namespace qc
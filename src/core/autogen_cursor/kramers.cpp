@@ -0,0 +1,164 @@
+#include "core/autogen_cursor/kramers.h"
+#include "core/autogen_cursor/delta_elimination.h"
+#include <map>
+
+namespace qc
+{
+
+    namespace
+    {
+        // Bar of every index label: 0 unbarred, 1 barred
+        Tensor with_bars(const Tensor &tensor, const std::map<std::string, int> &bars)
+        {
+            IndexSet indices(tensor.indices());
+            for (size_t i = 0; i < indices.size(); ++i)
+                indices[i].set_barred(bars.at(indices[i].label()) == 1);
+            Tensor result(tensor);
+            result.set_indices(indices);
+            return result;
+        }
+
+        int parity(std::uint64_t pattern)
+        {
+            int bits = 0;
+            for (; pattern; pattern &= pattern - 1)
+                ++bits;
+            return bits % 2 ? -1 : 1;
+        }
+    }
+
+    // KramersSymmetry implementation
+    bool KramersSymmetry::is_symmetric(const Tensor &tensor)
+    {
+        return tensor.get_property("time_reversal") == "symmetric";
+    }
+
+    std::uint64_t KramersSymmetry::pattern(const Tensor &tensor)
+    {
+        std::uint64_t result = 0;
+        for (size_t i = 0; i < tensor.actual_rank() && i < 64; ++i)
+        {
+            if (tensor.indices()[i].is_barred())
+                result |= std::uint64_t(1) << i;
+        }
+        return result;
+    }
+
+    std::string KramersSymmetry::block_label(std::uint64_t pattern, size_t rank)
+    {
+        std::string result(rank, 'u');
+        for (size_t i = 0; i < rank && i < 64; ++i)
+        {
+            if (pattern >> i & 1)
+                result[i] = 'b';
+        }
+        return result;
+    }
+
+    Tensor KramersSymmetry::canonical(const Tensor &tensor, int &sign)
+    {
+        sign = 1;
+        const std::uint64_t m = pattern(tensor);
+        if (!is_symmetric(tensor) || is_canonical(m))
+            return tensor;
+
+        // T[m] = (-1)^|m| conj(T[~m])
+        IndexSet indices(tensor.indices());
+        for (size_t i = 0; i < indices.size(); ++i)
+            indices[i].set_barred(!indices[i].is_barred());
+        Tensor result(tensor);
+        result.set_indices(indices);
+        result.set_property("conjugate", tensor.get_property("conjugate") == "true" ? "false" : "true");
+        if (tensor.has_property("kramers_block"))
+            result.set_property("kramers_block", block_label(pattern(result), result.actual_rank()));
+        sign = parity(m);
+        return result;
+    }
+
+    std::string KramersSymmetry::storage_name(const Tensor &tensor)
+    {
+        return storage_name(tensor.symbol().name(), tensor.get_property("kramers_block"));
+    }
+
+    std::string KramersSymmetry::storage_name(const std::string &name, const std::string &block)
+    {
+        return block.empty() ? name : name + "[" + block + "]";
+    }
+
+    std::vector<ContractionTerm> KramersSymmetry::expand(const ContractionTerm &term)
+    {
+        // Labels with a bar keep it, the others are enumerated
+        std::map<std::string, int> bars;
+        std::vector<std::string> free_labels;
+        auto collect = [&](const Tensor &tensor)
+        {
+            for (const auto &idx : tensor.indices())
+            {
+                auto it = bars.find(idx->label());
+                int bar = idx->is_barred() ? 1 : idx->is_unbarred() ? 0 : -1;
+                if (it == bars.end())
+                    bars[idx->label()] = bar;
+                else if (it->second < 0)
+                    it->second = bar;
+            }
+        };
+        collect(term.output());
+        for (const auto &factor : term.factors())
+            collect(factor);
+        for (const auto &entry : bars)
+        {
+            if (entry.second < 0)
+                free_labels.push_back(entry.first);
+        }
+        if (free_labels.size() >= 63)
+            return {term};
+
+        std::vector<ContractionTerm> result;
+        for (std::uint64_t assignment = 0; assignment < (std::uint64_t(1) << free_labels.size()); ++assignment)
+        {
+            for (size_t l = 0; l < free_labels.size(); ++l)
+                bars[free_labels[l]] = static_cast<int>(assignment >> l & 1);
+
+            Tensor output = with_bars(term.output(), bars);
+            if (is_symmetric(output) && !is_canonical(pattern(output)))
+                continue;
+            if (output.actual_rank() > 0)
+                output.set_property("kramers_block", block_label(pattern(output), output.actual_rank()));
+
+            double prefactor = term.prefactor();
+            std::vector<Tensor> factors;
+            bool vanished = false;
+            for (const auto &factor : term.factors())
+            {
+                Tensor barred = with_bars(factor, bars);
+                if (KroneckerDeltaElimination::is_delta(barred) &&
+                    barred.indices()[0].is_barred() != barred.indices()[1].is_barred())
+                {
+                    vanished = true;
+                    break;
+                }
+                int sign = 1;
+                Tensor stored = canonical(barred, sign);
+                if (stored.actual_rank() > 0)
+                    stored.set_property("kramers_block", block_label(pattern(stored), stored.actual_rank()));
+                prefactor *= sign;
+                factors.push_back(stored);
+            }
+            if (!vanished)
+                result.emplace_back(output, factors, prefactor);
+        }
+        return result;
+    }
+
+    std::vector<ContractionTerm> KramersSymmetry::expand(const std::vector<ContractionTerm> &terms)
+    {
+        std::vector<ContractionTerm> result;
+        for (const auto &term : terms)
+        {
+            auto expanded = expand(term);
+            result.insert(result.end(), expanded.begin(), expanded.end());
+        }
+        return result;
+    }
+
+} // namespace qc
@@ -0,0 +1,845 @@
+#include "core/autogen_cursor/laplace.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        // Parameters p = (log w_0, ..., log w_{n-1}, log t_0, ..., log t_{n-1})
+        // of 1/y ~ sum_k w_k exp(-t_k y) on [1, R]
+
+        double residual(const std::vector<double> &p, double y)
+        {
+            const size_t n = p.size() / 2;
+            double sum = 0.0;
+            for (size_t k = 0; k < n; ++k)
+                sum += std::exp(p[k] - std::exp(p[n + k]) * y);
+            return 1.0 - y * sum;
+        }
+
+        void gradient(const std::vector<double> &p, double y, std::vector<double> &g)
+        {
+            const size_t n = p.size() / 2;
+            g.assign(2 * n, 0.0);
+            for (size_t k = 0; k < n; ++k)
+            {
+                double t = std::exp(p[n + k]);
+                double term = y * std::exp(p[k] - t * y);
+                g[k] = -term;
+                g[n + k] = term * t * y;
+            }
+        }
+
+        double max_error(const std::vector<double> &p, const std::vector<double> &grid)
+        {
+            double result = 0.0;
+            for (double y : grid)
+                result = std::max(result, std::abs(residual(p, y)));
+            return result;
+        }
+
+        std::vector<double> log_grid(double R, size_t m)
+        {
+            std::vector<double> grid(m);
+            for (size_t j = 0; j < m; ++j)
+                grid[j] = m > 1 ? std::pow(R, static_cast<double>(j) / (m - 1)) : 1.0;
+            return grid;
+        }
+
+        // Dense solve with partial pivoting; false if singular
+        bool solve(std::vector<double> &A, std::vector<double> &b, size_t n)
+        {
+            for (size_t c = 0; c < n; ++c)
+            {
+                size_t pivot = c;
+                for (size_t r = c + 1; r < n; ++r)
+                {
+                    if (std::abs(A[r * n + c]) > std::abs(A[pivot * n + c]))
+                        pivot = r;
+                }
+                if (std::abs(A[pivot * n + c]) < 1e-300)
+                    return false;
+                if (pivot != c)
+                {
+                    for (size_t k = 0; k < n; ++k)
+                        std::swap(A[c * n + k], A[pivot * n + k]);
+                    std::swap(b[c], b[pivot]);
+                }
+                for (size_t r = c + 1; r < n; ++r)
+                {
+                    double f = A[r * n + c] / A[c * n + c];
+                    for (size_t k = c; k < n; ++k)
+                        A[r * n + k] -= f * A[c * n + k];
+                    b[r] -= f * b[c];
+                }
+            }
+            for (size_t c = n; c-- > 0;)
+            {
+                for (size_t k = c + 1; k < n; ++k)
+                    b[c] -= A[c * n + k] * b[k];
+                b[c] /= A[c * n + c];
+            }
+            return true;
+        }
+
+        // One term with t = w = 1 / sqrt(R)
+        std::vector<double> initial_guess(double R)
+        {
+            double s = -0.5 * std::log(R);
+            return {s, s};
+        }
+
+        // Lawson reweighting of damped Gauss-Newton least squares
+        void lawson(std::vector<double> &p, const std::vector<double> &grid, size_t iterations)
+        {
+            const size_t m = grid.size(), n2 = p.size();
+            std::vector<double> c(m, 1.0 / m), g;
+            std::vector<double> best = p;
+            double best_error = max_error(p, grid);
+            double lambda = 1e-3;
+            for (size_t it = 0; it < iterations; ++it)
+            {
+                auto weighted = [&](const std::vector<double> &q)
+                {
+                    double s = 0.0;
+                    for (size_t j = 0; j < m; ++j)
+                    {
+                        double r = residual(q, grid[j]);
+                        s += c[j] * r * r;
+                    }
+                    return s;
+                };
+                for (int inner = 0; inner < 3; ++inner)
+                {
+                    std::vector<double> JtJ(n2 * n2, 0.0), Jtr(n2, 0.0);
+                    for (size_t j = 0; j < m; ++j)
+                    {
+                        double r = residual(p, grid[j]);
+                        gradient(p, grid[j], g);
+                        for (size_t a = 0; a < n2; ++a)
+                        {
+                            Jtr[a] += c[j] * g[a] * r;
+                            for (size_t b = 0; b < n2; ++b)
+                                JtJ[a * n2 + b] += c[j] * g[a] * g[b];
+                        }
+                    }
+                    double current = weighted(p);
+                    bool accepted = false;
+                    for (int attempt = 0; attempt < 12 && !accepted; ++attempt)
+                    {
+                        std::vector<double> A = JtJ, step(n2);
+                        for (size_t a = 0; a < n2; ++a)
+                        {
+                            A[a * n2 + a] += lambda * (JtJ[a * n2 + a] + 1e-12);
+                            step[a] = -Jtr[a];
+                        }
+                        if (solve(A, step, n2))
+                        {
+                            std::vector<double> trial = p;
+                            for (size_t a = 0; a < n2; ++a)
+                                trial[a] += std::max(-2.0, std::min(2.0, step[a]));
+                            if (weighted(trial) < current)
+                            {
+                                p = trial;
+                                lambda = std::max(lambda / 3.0, 1e-12);
+                                accepted = true;
+                                continue;
+                            }
+                        }
+                        lambda *= 4.0;
+                    }
+                }
+
+                double total = 0.0;
+                for (size_t j = 0; j < m; ++j)
+                {
+                    c[j] *= std::abs(residual(p, grid[j])) + 1e-300;
+                    total += c[j];
+                }
+                for (auto &x : c)
+                    x /= total;
+
+                double error = max_error(p, grid);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            p = best;
+        }
+
+        // Alternating extrema of the residual, one per sign run
+        std::vector<double> extrema(const std::vector<double> &p, const std::vector<double> &grid)
+        {
+            std::vector<double> points;
+            std::vector<double> values;
+            for (double y : grid)
+            {
+                double r = residual(p, y);
+                if (!values.empty() && (r > 0) == (values.back() > 0))
+                {
+                    if (std::abs(r) > std::abs(values.back()))
+                    {
+                        values.back() = r;
+                        points.back() = y;
+                    }
+                }
+                else
+                {
+                    values.push_back(r);
+                    points.push_back(y);
+                }
+            }
+            // Too many runs: drop the smaller end until 2n + 1 remain
+            const size_t want = p.size() + 1;
+            while (points.size() > want)
+            {
+                if (std::abs(values.front()) < std::abs(values.back()))
+                {
+                    points.erase(points.begin());
+                    values.erase(values.begin());
+                }
+                else
+                {
+                    points.pop_back();
+                    values.pop_back();
+                }
+            }
+            return points;
+        }
+
+        // Reference points for a Remez step: the alternation points found
+        // so far, resampled evenly in log y onto `count` points
+        std::vector<double> resample(const std::vector<double> &y, size_t count)
+        {
+            std::vector<double> result(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                double x = static_cast<double>(j) * (y.size() - 1) / (count - 1);
+                size_t k = std::min(static_cast<size_t>(x), y.size() - 2);
+                double f = x - k;
+                result[j] = std::exp((1.0 - f) * std::log(y[k]) + f * std::log(y[k + 1]));
+            }
+            return result;
+        }
+
+        // Remez exchange: r(y_m) = (-1)^m E on 2n + 1 reference points, solved
+        // by Newton, repeated until the error levels out. The first step uses
+        // `start` when given; a reference with the wrong number of extrema is
+        // resampled from the extrema there are.
+        void remez(std::vector<double> &p, const std::vector<double> &grid, size_t exchanges,
+                   const std::vector<double> &start = {})
+        {
+            const size_t n2 = p.size();
+            std::vector<double> best = p, g;
+            double best_error = max_error(p, grid);
+            size_t stalled = 0;
+            for (size_t it = 0; it < exchanges; ++it)
+            {
+                std::vector<double> y = it == 0 && !start.empty() ? start : extrema(p, grid);
+                if (y.size() != n2 + 1)
+                    y = resample(y.size() >= 2 ? y : std::vector<double>{grid.front(), grid.back()}, n2 + 1);
+                double sign = residual(p, y[0]) > 0 ? 1.0 : -1.0;
+                double E = 0.0;
+                for (size_t m = 0; m < y.size(); ++m)
+                    E += std::abs(residual(p, y[m]));
+                E /= y.size();
+
+                std::vector<double> q = p;
+                bool converged = false;
+                for (int newton = 0; newton < 30; ++newton)
+                {
+                    const size_t dim = n2 + 1;
+                    std::vector<double> A(dim * dim), f(dim);
+                    double norm = 0.0;
+                    for (size_t m = 0; m < dim; ++m)
+                    {
+                        double alt = (m % 2 ? -sign : sign);
+                        f[m] = -(residual(q, y[m]) - alt * E);
+                        norm += f[m] * f[m];
+                        gradient(q, y[m], g);
+                        for (size_t a = 0; a < n2; ++a)
+                            A[m * dim + a] = g[a];
+                        A[m * dim + n2] = -alt;
+                    }
+                    // Residuals are sums of O(1) terms: 1e-14 is rounding
+                    if (std::sqrt(norm) < std::max(1e-14, 1e-6 * std::abs(E)))
+                    {
+                        converged = true;
+                        break;
+                    }
+                    if (!solve(A, f, dim))
+                        break;
+                    double scale = 1.0;
+                    for (size_t a = 0; a <= n2; ++a)
+                        scale = std::min(scale, 1.0 / std::max(1.0, std::abs(f[a])));
+                    for (size_t a = 0; a < n2; ++a)
+                        q[a] += scale * f[a];
+                    E += scale * f[n2];
+                }
+                double error = max_error(q, grid);
+                if (!converged && error >= best_error)
+                    break;
+                p = q;
+                if (error < best_error * (1.0 - 1e-6))
+                    stalled = 0;
+                else if (++stalled == 3)
+                    break;
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            p = best;
+        }
+
+        // Seed for n terms from an m-term fit: log t and log w of the terms,
+        // ordered by t, resampled onto n evenly spaced positions with the
+        // ends extrapolated; the weights shrink with the spacing
+        std::vector<double> seed(const std::vector<double> &p, size_t n)
+        {
+            const size_t m = p.size() / 2;
+            std::vector<std::pair<double, double>> terms; // (log t, log w)
+            for (size_t k = 0; k < m; ++k)
+                terms.push_back({p[m + k], p[k]});
+            std::sort(terms.begin(), terms.end());
+            std::vector<double> q(2 * n);
+            for (size_t j = 0; j < n; ++j)
+            {
+                if (m == 1)
+                {
+                    q[n + j] = terms[0].first + 2.0 * ((j + 0.5) / n - 0.5);
+                    q[j] = terms[0].second - std::log(static_cast<double>(n));
+                    continue;
+                }
+                double x = (j + 0.5) * m / n - 0.5;
+                size_t k = std::min(m - 2, static_cast<size_t>(std::max(0.0, std::floor(x))));
+                double f = x - k;
+                q[n + j] = terms[k].first + f * (terms[k + 1].first - terms[k].first);
+                q[j] = terms[k].second + f * (terms[k + 1].second - terms[k].second) +
+                       std::log(static_cast<double>(m) / n);
+            }
+            return q;
+        }
+
+        // Minimax fit with one more term, continued from the converged one:
+        // Remez from the resampled terms, else from each term of p split in
+        // two. Never worse than p with a term split exactly, so the error
+        // does not grow with n.
+        std::vector<double> add_term(const std::vector<double> &p, double R)
+        {
+            const size_t m = p.size() / 2, n = m + 1;
+            std::vector<double> fine = log_grid(R, 200 * n + 1000);
+            const std::vector<double> start = extrema(p, fine);
+            const double previous = max_error(p, fine);
+            std::vector<double> best;
+            double best_error = previous;
+            for (size_t candidate = 0; candidate <= m; ++candidate)
+            {
+                std::vector<double> q;
+                if (candidate == 0)
+                    q = seed(p, n);
+                else
+                {
+                    // Term j becomes two terms of half the weight at t e^(-+0.2)
+                    size_t j = candidate - 1;
+                    q.assign(p.begin(), p.begin() + m);
+                    q[j] -= std::log(2.0);
+                    q.push_back(q[j]);
+                    q.insert(q.end(), p.begin() + m, p.end());
+                    q.push_back(q[n + j] + 0.2);
+                    q[n + j] -= 0.2;
+                }
+                remez(q, fine, 100, start);
+                double error = max_error(q, fine);
+                if (error < best_error)
+                {
+                    best = q;
+                    best_error = error;
+                }
+                if (!best.empty() && extrema(best, fine).size() == 2 * n + 1)
+                    break;
+            }
+            if (!best.empty())
+                return best;
+            best.assign(p.begin(), p.begin() + m);
+            best[0] -= std::log(2.0);
+            best.push_back(best[0]);
+            best.insert(best.end(), p.begin() + m, p.end());
+            best.push_back(p[m]);
+            return best;
+        }
+
+        // One-term fit on [1, R], the start of every continuation in n
+        std::vector<double> first_term(double R)
+        {
+            std::vector<double> p = initial_guess(R);
+            lawson(p, log_grid(R, 240), 60);
+            remez(p, log_grid(R, 1200), 40);
+            return p;
+        }
+
+        // Rescaled from [1, R] to [x_min, x_max]: 1/x = (1/x_min) (1/y) with y = x / x_min
+        LaplaceQuadrature rescale(const std::vector<double> &p, double x_min, double x_max, double R)
+        {
+            const size_t n = p.size() / 2;
+            LaplaceQuadrature result;
+            result.x_min = x_min;
+            result.x_max = x_max;
+            for (size_t k = 0; k < n; ++k)
+            {
+                result.weights.push_back(std::exp(p[k]) / x_min);
+                result.points.push_back(std::exp(p[n + k]) / x_min);
+            }
+            result.error = max_error(p, log_grid(R, 1000 * n + 4000));
+            return result;
+        }
+
+        std::string factor_name(int space, bool weighted)
+        {
+            return "laplace_" + SpaceRegistry::global().name(space) + (weighted ? "_w" : "");
+        }
+
+        std::string indent(size_t depth)
+        {
+            return std::string(4 * depth, ' ');
+        }
+    }
+
+    // LaplaceQuadrature implementation
+    double LaplaceQuadrature::operator()(double x) const
+    {
+        double sum = 0.0;
+        for (size_t k = 0; k < points.size(); ++k)
+            sum += weights[k] * std::exp(-points[k] * x);
+        return sum;
+    }
+
+    // LaplaceFactorization implementation
+    LaplaceFactorization::LaplaceFactorization(const ImplicitTensor &denominator, const LaplaceQuadrature &quadrature,
+                                               const LaplaceOptions &options)
+        : denominator_(denominator), quadrature_(quadrature), options_(options)
+    {
+        // A space sized for another quadrature is left alone: this one
+        // takes the first free name space_2, space_3, ...
+        auto &registry = SpaceRegistry::global();
+        const long points = static_cast<long>(quadrature_.size());
+        std::string name = options_.space;
+        for (int k = 2; registry.register_space(name, points) < 0; ++k)
+            name = options_.space + "_" + std::to_string(k);
+        options_.space = name;
+    }
+
+    LaplaceQuadrature LaplaceFactorization::minimax(size_t n, double x_min, double x_max)
+    {
+        if (n == 0 || x_min <= 0.0 || x_max < x_min)
+            return LaplaceQuadrature();
+
+        const double R = std::max(x_max / x_min, 1.0 + 1e-12);
+        std::vector<double> p = first_term(R);
+        for (size_t m = 2; m <= n; ++m)
+            p = add_term(p, R);
+        return rescale(p, x_min, x_max, R);
+    }
+
+    LaplaceQuadrature LaplaceFactorization::fit(double x_min, double x_max, double tolerance, size_t max_points)
+    {
+        if (max_points == 0 || x_min <= 0.0 || x_max < x_min)
+            return LaplaceQuadrature();
+
+        // One continuation over n; rounding bounds the error near 1e-13,
+        // so stop once another point no longer lowers it
+        const double R = std::max(x_max / x_min, 1.0 + 1e-12);
+        std::vector<double> p = first_term(R);
+        LaplaceQuadrature result = rescale(p, x_min, x_max, R);
+        while (result.error > tolerance && result.size() < max_points)
+        {
+            std::vector<double> q = add_term(p, R);
+            LaplaceQuadrature next = rescale(q, x_min, x_max, R);
+            if (next.error >= result.error)
+                break;
+            p = q;
+            result = next;
+        }
+        return result;
+    }
+
+    std::pair<double, double> LaplaceFactorization::spectral_range(const ImplicitTensor &denominator,
+                                                                    const std::map<int, std::vector<double>> &diagonals)
+    {
+        double low = denominator.shift(), high = denominator.shift();
+        for (const auto &term : denominator.terms())
+        {
+            auto it = diagonals.find(term.space);
+            if (it == diagonals.end() || it->second.empty())
+                return {-1.0, -1.0};
+            auto range = std::minmax_element(it->second.begin(), it->second.end());
+            double a = term.sign * *range.first, b = term.sign * *range.second;
+            low += std::min(a, b);
+            high += std::max(a, b);
+        }
+        if (high < 0.0)
+            return {-high, -low};
+        if (low > 0.0)
+            return {low, high};
+        return {-1.0, -1.0};
+    }
+
+    int LaplaceFactorization::sign_of(int space) const
+    {
+        int sign = 0;
+        for (const auto &term : denominator_.terms())
+        {
+            if (term.space != space)
+                continue;
+            int s = term.sign > 0 ? 1 : -1;
+            if (sign != 0 && s != sign)
+                return 0;
+            sign = s;
+        }
+        return sign;
+    }
+
+    bool LaplaceFactorization::apply(ContractionTerm &term) const
+    {
+        if (!denominator_.reciprocal() || quadrature_.size() == 0)
+            return false;
+        size_t f = 0;
+        while (f < term.num_factors() && term.factor(f).symbol().name() != denominator_.name())
+            ++f;
+        if (f == term.num_factors())
+            return false;
+        if (term.output().indices().get_labels().count(options_.label))
+            return false;
+        for (const auto &factor : term.factors())
+        {
+            if (factor.indices().get_labels().count(options_.label))
+                return false;
+        }
+
+        const Tensor denominator = term.factor(f);
+        ContractionTerm result = term;
+        result.remove_factor(f);
+        Index z = IndexFactory::in_space(options_.label, options_.space);
+        for (size_t k = 0; k < denominator_.terms().size(); ++k)
+        {
+            const auto &diagonal = denominator_.terms()[k];
+            if (sign_of(diagonal.space) == 0 || diagonal.position >= denominator.actual_rank())
+                return false;
+            result.add_factor(Tensor(factor_name(diagonal.space, k == 0),
+                                     IndexSet(std::vector<Index>{z, denominator.indices()[diagonal.position]})));
+        }
+        if (options_.negative)
+            result.multiply_prefactor(-1.0);
+
+        if (options_.require_gain)
+        {
+            double before = direct_flop_count(term);
+            double after = flop_count(result);
+            if (before < 0 || after < 0 || after >= before)
+                return false;
+        }
+        term = result;
+        return true;
+    }
+
+    std::vector<ContractionTerm> LaplaceFactorization::apply(const std::vector<ContractionTerm> &terms) const
+    {
+        std::vector<ContractionTerm> result = terms;
+        for (auto &term : result)
+            apply(term);
+        return result;
+    }
+
+    Tensor LaplaceFactorization::slice(const Tensor &factor) const
+    {
+        std::vector<Index> indices;
+        for (const auto &idx : factor.indices())
+        {
+            if (idx->label() != options_.label)
+                indices.push_back(*idx);
+        }
+        return Tensor(factor.symbol().name() + "_" + options_.label, IndexSet(indices));
+    }
+
+    std::vector<LaplaceFactorization::Step> LaplaceFactorization::steps(const ContractionTerm &rewritten,
+                                                                        const Tensor &output) const
+    {
+        // Exponentials scale the smallest tensor sharing their index, so the
+        // pairwise order sees them as already applied
+        std::vector<Tensor> tensors, exponentials;
+        for (const auto &factor : rewritten.factors())
+        {
+            if (factor.indices().get_labels().count(options_.label))
+                exponentials.push_back(slice(factor));
+            else
+                tensors.push_back(factor);
+        }
+
+        const auto &registry = SpaceRegistry::global();
+        auto size_of = [&registry](const Tensor &tensor)
+        {
+            double size = 1.0;
+            for (const auto &idx : tensor.indices())
+                size *= static_cast<double>(std::max(registry.dimension(*idx), 1L));
+            return size;
+        };
+
+        std::vector<Step> result;
+        std::vector<std::vector<Tensor>> scaling(tensors.size());
+        std::vector<Tensor> unhosted;
+        for (const auto &exponential : exponentials)
+        {
+            const std::string &label = exponential.indices()[0].label();
+            size_t host = tensors.size();
+            for (size_t t = 0; t < tensors.size(); ++t)
+            {
+                if (tensors[t].indices().get_labels().count(label) &&
+                    (host == tensors.size() || size_of(tensors[t]) < size_of(tensors[host])))
+                    host = t;
+            }
+            if (host == tensors.size())
+                unhosted.push_back(exponential);
+            else
+                scaling[host].push_back(exponential);
+        }
+
+        int count = 0;
+        std::vector<Tensor> remaining;
+        for (size_t t = 0; t < tensors.size(); ++t)
+        {
+            if (scaling[t].empty())
+            {
+                remaining.push_back(tensors[t]);
+                continue;
+            }
+            Tensor scaled("laplace_x" + std::to_string(count++), tensors[t].indices());
+            std::vector<Tensor> factors = {tensors[t]};
+            factors.insert(factors.end(), scaling[t].begin(), scaling[t].end());
+            ContractionTerm term(scaled, factors, 1.0);
+            result.push_back({term, term.flop_count()});
+            remaining.push_back(scaled);
+        }
+        remaining.insert(remaining.end(), unhosted.begin(), unhosted.end());
+        pairwise(remaining, output, rewritten.prefactor(), count, result);
+        return result;
+    }
+
+    void LaplaceFactorization::pairwise(std::vector<Tensor> remaining, const Tensor &output, double prefactor,
+                                        int &count, std::vector<Step> &result)
+    {
+        if (remaining.size() == 1)
+        {
+            ContractionTerm term(output, remaining, prefactor);
+            result.push_back({term, term.flop_count()});
+            return;
+        }
+
+        const std::set<std::string> output_labels = output.indices().get_labels();
+        auto path = TensorContraction::optimize_contraction(remaining, output.indices());
+        for (const auto &pair : path.tensor_pairs)
+        {
+            const Tensor A = remaining[pair.first], B = remaining[pair.second];
+            bool last = remaining.size() == 2;
+            IndexSet kept;
+            std::set<std::string> seen;
+            for (const auto *indices : {&A.indices(), &B.indices()})
+            {
+                for (const auto &idx : *indices)
+                {
+                    if (!seen.insert(idx->label()).second)
+                        continue;
+                    bool needed = output_labels.count(idx->label()) > 0;
+                    for (size_t k = 0; k < remaining.size() && !needed; ++k)
+                    {
+                        if (k != pair.first && k != pair.second &&
+                            remaining[k].indices().get_labels().count(idx->label()))
+                            needed = true;
+                    }
+                    if (needed)
+                        kept.add_index(*idx);
+                }
+            }
+            Tensor out = last ? output : Tensor("laplace_x" + std::to_string(count++), kept);
+            ContractionTerm term(out, {A, B}, last ? prefactor : 1.0);
+            result.push_back({term, term.flop_count()});
+            remaining.erase(remaining.begin() + pair.second);
+            remaining.erase(remaining.begin() + pair.first);
+            remaining.push_back(out);
+        }
+    }
+
+    double LaplaceFactorization::direct_flop_count(const ContractionTerm &term)
+    {
+        std::vector<Step> direct;
+        int count = 0;
+        pairwise(term.factors(), term.output(), term.prefactor(), count, direct);
+        double flops = 0.0;
+        for (const auto &step : direct)
+        {
+            if (step.flops < 0)
+                return -1.0;
+            flops += step.flops;
+        }
+        return flops;
+    }
+
+    double LaplaceFactorization::flop_count(const ContractionTerm &rewritten) const
+    {
+        double flops = 0.0;
+        for (const auto &step : steps(rewritten, rewritten.output()))
+        {
+            if (step.flops < 0)
+                return -1.0;
+            flops += step.flops;
+        }
+        return flops * static_cast<double>(quadrature_.size());
+    }
+
+    std::vector<double> LaplaceFactorization::factor(const Tensor &tensor,
+                                                     const std::map<int, std::vector<double>> &diagonals) const
+    {
+        const std::string prefix = "laplace_";
+        std::string space = tensor.symbol().name();
+        if (space.compare(0, prefix.size(), prefix) != 0)
+            return {};
+        space = space.substr(prefix.size());
+        bool weighted = space.size() > 2 && space.compare(space.size() - 2, 2, "_w") == 0;
+        if (weighted)
+            space.resize(space.size() - 2);
+
+        int id = SpaceRegistry::global().id(space);
+        int sign = sign_of(id);
+        auto it = diagonals.find(id);
+        if (sign == 0 || it == diagonals.end())
+            return {};
+
+        // (D < 0) 1/D = -sum_z w_z exp(t_z D); (D > 0) 1/D = sum_z w_z exp(-t_z D)
+        const double direction = options_.negative ? 1.0 : -1.0;
+        const std::vector<double> &e = it->second;
+        std::vector<double> result(quadrature_.size() * e.size());
+        for (size_t z = 0; z < quadrature_.size(); ++z)
+        {
+            double t = direction * quadrature_.points[z];
+            double scale = weighted ? quadrature_.weights[z] * std::exp(t * denominator_.shift()) : 1.0;
+            for (size_t p = 0; p < e.size(); ++p)
+                result[z * e.size() + p] = scale * std::exp(t * sign * e[p]);
+        }
+        return result;
+    }
+
+    std::string LaplaceFactorization::generate(const std::string &name, const ContractionTerm &rewritten,
+                                               const CodeGenerator &codegen) const
+    {
+        const auto &registry = SpaceRegistry::global();
+        const CodeGenOptions &cg = codegen.options();
+        const std::string &S = cg.scalar_type;
+        const std::string &N = cg.index_type;
+        const std::string &z = options_.label;
+
+        const Tensor &output = rewritten.output();
+        const std::string out = CodeGenerator::variable_name(output);
+        Tensor local(out + "_local", output.indices());
+        if (output.has_property("antisymmetric_groups"))
+            local.set_property("antisymmetric_groups", output.get_property("antisymmetric_groups"));
+        std::vector<Step> body = steps(rewritten, local);
+
+        // Arguments: output, inputs, dimensions
+        std::ostringstream oss;
+        oss << "void " << name << "(" << S << " *" << out;
+        std::set<std::string> args = {out};
+        std::map<std::string, long> dims;
+        auto add_dims = [&](const Tensor &tensor)
+        {
+            for (const auto &idx : tensor.indices())
+            {
+                int space = registry.space_of(*idx);
+                dims[CodeGenerator::dimension_name(space)] = cg.fixed_dimensions ? registry.size(space) : -1;
+            }
+        };
+        add_dims(output);
+        for (const auto &factor : rewritten.factors())
+        {
+            std::string var = CodeGenerator::variable_name(factor);
+            if (args.insert(var).second)
+                oss << ", const " << S << " *" << var;
+            add_dims(factor);
+        }
+        for (const auto &dim : dims)
+        {
+            if (dim.second < 0)
+                oss << ", " << N << " " << dim.first;
+        }
+        oss << ")\n{\n";
+        for (const auto &dim : dims)
+        {
+            if (dim.second >= 0)
+                oss << indent(1) << "constexpr " << N << " " << dim.first << " = " << dim.second << ";\n";
+        }
+
+        // Per-thread accumulator and intermediates
+        if (options_.openmp)
+            oss << "#pragma omp parallel\n";
+        oss << indent(1) << "{\n"
+            << indent(2) << "std::vector<" << S << "> " << out << "_buffer(" << codegen.storage_size(local)
+            << ", 0.0);\n"
+            << indent(2) << S << " *" << CodeGenerator::variable_name(local) << " = " << out << "_buffer.data();\n";
+        std::vector<Tensor> intermediates;
+        for (const auto &step : body)
+        {
+            if (step.term.output().symbol().name() != local.symbol().name())
+                intermediates.push_back(step.term.output());
+        }
+        for (const auto &x : intermediates)
+        {
+            std::string var = CodeGenerator::variable_name(x);
+            oss << indent(2) << "std::vector<" << S << "> " << var << "_buffer(" << codegen.storage_size(x) << ");\n"
+                << indent(2) << S << " *" << var << " = " << var << "_buffer.data();\n";
+        }
+
+        int z_space = registry.id(options_.space);
+        if (options_.openmp)
+            oss << "#pragma omp for schedule(dynamic)\n";
+        oss << indent(2) << "for (" << N << " " << z << " = 0; " << z << " < "
+            << CodeGenerator::dimension_name(z_space) << "; ++" << z << ")\n"
+            << indent(2) << "{\n";
+        std::set<std::string> sliced;
+        for (const auto &factor : rewritten.factors())
+        {
+            if (!factor.indices().get_labels().count(z))
+                continue;
+            std::string var = CodeGenerator::variable_name(factor);
+            if (!sliced.insert(var).second)
+                continue;
+            Tensor part = slice(factor);
+            oss << indent(3) << "const " << S << " *" << CodeGenerator::variable_name(part) << " = " << var
+                << " + " << z << " * " << codegen.storage_size(part) << ";\n";
+        }
+        for (const auto &x : intermediates)
+        {
+            std::string var = CodeGenerator::variable_name(x);
+            oss << indent(3) << "std::fill(" << var << ", " << var << " + " << codegen.storage_size(x)
+                << ", 0.0);\n";
+        }
+        for (const auto &step : body)
+            oss << codegen.generate_loops(step.term, LoopBounds(), 3);
+        oss << indent(2) << "}\n";
+
+        if (options_.openmp)
+            oss << "#pragma omp critical\n";
+        oss << indent(2) << "for (" << N << " x = 0; x < " << codegen.storage_size(local) << "; ++x)\n"
+            << indent(3) << out << "[x] += " << CodeGenerator::variable_name(local) << "[x];\n"
+            << indent(1) << "}\n"
+            << "}\n";
+        return oss.str();
+    }
+
+} // namespace qc
@@ -0,0 +1,600 @@
+#include "core/autogen_cursor/layout.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        using Labels = std::vector<std::string>;
+
+        const long kUnknownExtent = 64; // assumed extent of a space without a registered size
+        const double kElementBytes = 8.0;
+
+        Labels logical_order(const Tensor &tensor)
+        {
+            Labels labels;
+            for (const auto &idx : tensor.indices())
+                labels.push_back(idx->label());
+            return labels;
+        }
+
+        Labels subsequence(const Labels &order, const std::set<std::string> &group)
+        {
+            Labels result;
+            for (const auto &label : order)
+            {
+                if (group.count(label))
+                    result.push_back(label);
+            }
+            return result;
+        }
+
+        Labels concat(const Labels &a, const Labels &b)
+        {
+            Labels result = a;
+            result.insert(result.end(), b.begin(), b.end());
+            return result;
+        }
+
+        // 0 if storage is g1 followed by g2, 1 if g2 followed by g1, -1 otherwise
+        int block_order(const Labels &storage, const Labels &g1, const Labels &g2)
+        {
+            if (storage == concat(g1, g2))
+                return 0;
+            if (storage == concat(g2, g1))
+                return 1;
+            return -1;
+        }
+
+        std::vector<size_t> permutation_from(const Labels &storage, const Labels &required)
+        {
+            std::vector<size_t> result;
+            for (const auto &label : required)
+                result.push_back(static_cast<size_t>(std::find(storage.begin(), storage.end(), label) - storage.begin()));
+            return result;
+        }
+
+        // Index groups of C = A * B; `gemm` is false with batch, trace or broadcast indices
+        struct Groups
+        {
+            std::set<std::string> m, n, k;
+            bool gemm = true;
+        };
+
+        Groups classify(const Labels &a, const Labels &b, const Labels &c)
+        {
+            Groups groups;
+            std::set<std::string> in_a(a.begin(), a.end()), in_b(b.begin(), b.end()), in_c(c.begin(), c.end());
+            for (const auto &label : in_a)
+            {
+                if (in_b.count(label) && in_c.count(label))
+                    groups.gemm = false;
+                else if (in_b.count(label))
+                    groups.k.insert(label);
+                else if (in_c.count(label))
+                    groups.m.insert(label);
+                else
+                    groups.gemm = false;
+            }
+            for (const auto &label : in_b)
+            {
+                if (in_a.count(label))
+                    continue;
+                if (in_c.count(label))
+                    groups.n.insert(label);
+                else
+                    groups.gemm = false;
+            }
+            for (const auto &label : in_c)
+            {
+                if (!in_a.count(label) && !in_b.count(label))
+                    groups.gemm = false;
+            }
+            if (a.size() != in_a.size() || b.size() != in_b.size() || c.size() != in_c.size())
+                groups.gemm = false; // repeated labels (diagonals)
+            return groups;
+        }
+
+        struct GemmChoice
+        {
+            double cost = std::numeric_limits<double>::max();
+            Labels m, n, k;
+        };
+
+        class Planner
+        {
+        private:
+            const ContractionDag &dag_;
+            std::map<std::string, long> extents_;
+            std::vector<Labels> storage_; // empty: not decided yet
+            std::vector<bool> decided_;
+
+        public:
+            explicit Planner(const ContractionDag &dag) : dag_(dag), storage_(dag.size()), decided_(dag.size(), false)
+            {
+                const auto &registry = SpaceRegistry::global();
+                for (const auto &node : dag.nodes())
+                {
+                    for (const auto &idx : node.tensor.indices())
+                    {
+                        long dim = registry.dimension(*idx);
+                        extents_[idx->label()] = dim < 0 ? kUnknownExtent : dim;
+                    }
+                }
+            }
+
+            double bytes(const Labels &labels) const
+            {
+                double result = kElementBytes;
+                for (const auto &label : labels)
+                {
+                    auto it = extents_.find(label);
+                    result *= static_cast<double>(it == extents_.end() ? kUnknownExtent : it->second);
+                }
+                return result;
+            }
+
+            const Labels *storage_of(size_t node) const
+            {
+                return decided_[node] ? &storage_[node] : nullptr;
+            }
+
+            void decide(size_t node, const Labels &storage)
+            {
+                storage_[node] = storage;
+                decided_[node] = true;
+            }
+
+            const Labels &storage(size_t node) const { return storage_[node]; }
+
+            // Cheapest group orders for C = A * B; undecided operands are free
+            GemmChoice best_gemm(const Groups &groups, const Labels *sa, const Labels *sb, const Labels *sc,
+                                 const Labels &la, const Labels &lb) const
+            {
+                std::set<Labels> m_orders, n_orders, k_orders;
+                for (const Labels *order : {sa, sc})
+                {
+                    if (order)
+                        m_orders.insert(subsequence(*order, groups.m));
+                }
+                for (const Labels *order : {sb, sc})
+                {
+                    if (order)
+                        n_orders.insert(subsequence(*order, groups.n));
+                }
+                for (const Labels *order : {sa, sb})
+                {
+                    if (order)
+                        k_orders.insert(subsequence(*order, groups.k));
+                }
+                m_orders.insert(subsequence(la, groups.m));
+                n_orders.insert(subsequence(lb, groups.n));
+                k_orders.insert(subsequence(la, groups.k));
+
+                GemmChoice best;
+                for (const auto &m : m_orders)
+                {
+                    for (const auto &n : n_orders)
+                    {
+                        for (const auto &k : k_orders)
+                        {
+                            double cost = 0.0;
+                            if (sa && block_order(*sa, m, k) < 0)
+                                cost += bytes(*sa);
+                            if (sb && block_order(*sb, k, n) < 0)
+                                cost += bytes(*sb);
+                            if (sc && block_order(*sc, m, n) < 0)
+                                cost += bytes(*sc);
+                            if (cost < best.cost)
+                            {
+                                best.cost = cost;
+                                best.m = m;
+                                best.n = n;
+                                best.k = k;
+                            }
+                        }
+                    }
+                }
+                return best;
+            }
+
+            // Bytes transposed by a node's step with the current decisions
+            double step_cost(size_t node) const
+            {
+                const auto &n = dag_.node(node);
+                if (n.inputs.size() == 1)
+                {
+                    const Labels *sa = storage_of(n.inputs[0]);
+                    const Labels *sc = storage_of(node);
+                    return (sa && sc && *sa != *sc) ? bytes(*sa) : 0.0;
+                }
+                if (n.inputs.size() != 2)
+                    return 0.0;
+
+                Labels la = logical_order(dag_.node(n.inputs[0]).tensor);
+                Labels lb = logical_order(dag_.node(n.inputs[1]).tensor);
+                Labels lc = logical_order(n.tensor);
+                Groups groups = classify(la, lb, lc);
+                if (!groups.gemm)
+                    return 0.0;
+                return best_gemm(groups, storage_of(n.inputs[0]), storage_of(n.inputs[1]), storage_of(node), la, lb)
+                    .cost;
+            }
+
+            // Layouts of `node` that some adjacent step consumes or produces natively
+            std::vector<Labels> candidates(size_t node) const
+            {
+                std::vector<Labels> result;
+                auto add = [&result](const Labels &layout)
+                {
+                    if (std::find(result.begin(), result.end(), layout) == result.end())
+                        result.push_back(layout);
+                };
+                Labels own = logical_order(dag_.node(node).tensor);
+                add(own);
+
+                auto add_blocks = [&](const std::set<std::string> &g1, const std::set<std::string> &g2,
+                                      const std::vector<const Labels *> &orders)
+                {
+                    for (const Labels *order : orders)
+                    {
+                        if (!order)
+                            continue;
+                        Labels b1 = subsequence(*order, g1), b2 = subsequence(*order, g2);
+                        if (b1.size() + b2.size() != own.size())
+                        {
+                            // The other operand holds only one group; take the other from `own`
+                            if (b1.empty())
+                                b1 = subsequence(own, g1);
+                            if (b2.empty())
+                                b2 = subsequence(own, g2);
+                        }
+                        add(concat(b1, b2));
+                        add(concat(b2, b1));
+                    }
+                };
+
+                // Producer side
+                const auto &n = dag_.node(node);
+                if (n.inputs.size() == 1)
+                {
+                    if (const Labels *sa = storage_of(n.inputs[0]))
+                        add(*sa);
+                }
+                else if (n.inputs.size() == 2)
+                {
+                    Labels la = logical_order(dag_.node(n.inputs[0]).tensor);
+                    Labels lb = logical_order(dag_.node(n.inputs[1]).tensor);
+                    Groups groups = classify(la, lb, own);
+                    if (groups.gemm)
+                        add_blocks(groups.m, groups.n, {storage_of(n.inputs[0]), storage_of(n.inputs[1]), &own});
+                }
+
+                // Consumer side
+                for (size_t consumer : n.consumers)
+                {
+                    const auto &c = dag_.node(consumer);
+                    if (c.inputs.size() == 1)
+                    {
+                        if (const Labels *sc = storage_of(consumer))
+                            add(*sc);
+                        continue;
+                    }
+                    if (c.inputs.size() != 2)
+                        continue;
+                    size_t other = c.inputs[0] == node ? c.inputs[1] : c.inputs[0];
+                    Labels la = logical_order(dag_.node(c.inputs[0]).tensor);
+                    Labels lb = logical_order(dag_.node(c.inputs[1]).tensor);
+                    Labels lc = logical_order(c.tensor);
+                    Groups groups = classify(la, lb, lc);
+                    if (!groups.gemm)
+                        continue;
+                    bool is_a = c.inputs[0] == node;
+                    const auto &outer = is_a ? groups.m : groups.n;
+                    add_blocks(outer, groups.k, {storage_of(other), storage_of(consumer), &own});
+                }
+                return result;
+            }
+        };
+    }
+
+    // ContractionDag implementation
+    size_t ContractionDag::add_input(const Tensor &tensor)
+    {
+        nodes_.push_back({tensor, {}, {}, 1.0, false});
+        return nodes_.size() - 1;
+    }
+
+    size_t ContractionDag::add_contraction(const Tensor &output, const std::vector<size_t> &inputs,
+                                           double prefactor, bool intermediate)
+    {
+        size_t id = nodes_.size();
+        nodes_.push_back({output, inputs, {}, prefactor, intermediate});
+        for (size_t input : inputs)
+            nodes_[input].consumers.push_back(id);
+        return id;
+    }
+
+    ContractionDag ContractionDag::from_terms(const std::vector<ContractionTerm> &terms)
+    {
+        ContractionDag dag;
+        int intermediate_count = 0;
+        for (const auto &term : terms)
+        {
+            if (term.num_factors() == 0)
+                continue;
+
+            std::vector<size_t> work;
+            std::vector<Tensor> tensors = term.factors();
+            for (const auto &factor : tensors)
+                work.push_back(dag.add_input(factor));
+            if (tensors.size() == 1)
+            {
+                dag.add_contraction(term.output(), work, term.prefactor(), false);
+                continue;
+            }
+
+            auto path = TensorContraction::optimize_contraction(tensors, term.output().indices());
+            std::set<std::string> output_labels = term.output().indices().get_labels();
+            for (size_t s = 0; s < path.tensor_pairs.size(); ++s)
+            {
+                size_t i = path.tensor_pairs[s].first;
+                size_t j = path.tensor_pairs[s].second;
+                bool last = s + 1 == path.tensor_pairs.size();
+
+                size_t id;
+                if (last)
+                {
+                    id = dag.add_contraction(term.output(), {work[i], work[j]}, term.prefactor(), false);
+                }
+                else
+                {
+                    // Kept: labels still needed by another operand or the output
+                    IndexSet kept;
+                    std::set<std::string> seen;
+                    for (size_t operand : {i, j})
+                    {
+                        for (const auto &idx : tensors[operand].indices())
+                        {
+                            if (!seen.insert(idx->label()).second)
+                                continue;
+                            bool needed = output_labels.count(idx->label()) > 0;
+                            for (size_t k = 0; k < tensors.size() && !needed; ++k)
+                            {
+                                if (k != i && k != j && tensors[k].indices().get_labels().count(idx->label()))
+                                    needed = true;
+                            }
+                            if (needed)
+                                kept.add_index(*idx);
+                        }
+                    }
+                    Tensor intermediate("I" + std::to_string(intermediate_count++), kept);
+                    id = dag.add_contraction(intermediate, {work[i], work[j]}, 1.0, true);
+                    tensors.push_back(intermediate);
+                }
+                work.erase(work.begin() + j);
+                work.erase(work.begin() + i);
+                tensors.erase(tensors.begin() + j);
+                tensors.erase(tensors.begin() + i);
+                work.push_back(id);
+            }
+        }
+        return dag;
+    }
+
+    // LayoutPropagation implementation
+    std::vector<size_t> LayoutPropagation::storage_layout(const Tensor &tensor)
+    {
+        size_t rank = tensor.actual_rank();
+        std::vector<size_t> identity(rank);
+        for (size_t d = 0; d < rank; ++d)
+            identity[d] = d;
+        if (tensor.get_property("layout").empty())
+            return identity;
+
+        // "layout" lists, per memory dimension, the logical slot stored there
+        std::vector<size_t> result;
+        std::istringstream slots(tensor.get_property("layout"));
+        std::string slot;
+        while (std::getline(slots, slot, ','))
+            result.push_back(std::stoul(slot));
+        std::vector<size_t> sorted = result;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted == identity ? result : identity;
+    }
+
+    std::vector<std::string> LayoutPropagation::physical_order(const Tensor &tensor)
+    {
+        Labels result;
+        for (size_t slot : storage_layout(tensor))
+            result.push_back(tensor.indices()[slot].label());
+        return result;
+    }
+
+    Tensor LayoutPropagation::storage_view(const Tensor &tensor)
+    {
+        if (tensor.get_property("layout").empty())
+            return tensor;
+        IndexSet indices;
+        for (size_t slot : storage_layout(tensor))
+            indices.add_index(tensor.indices()[slot]);
+        Tensor result(tensor);
+        result.set_indices(indices);
+        result.set_property("layout", "");
+        return result;
+    }
+
+    Tensor LayoutPropagation::with_storage(const Tensor &tensor, const std::vector<std::string> &storage)
+    {
+        // Labels missing from the tensor leave it as it is
+        Labels logical = logical_order(tensor);
+        if (storage.size() != logical.size())
+            return tensor;
+        std::string layout;
+        bool identity = true;
+        for (size_t d = 0; d < storage.size(); ++d)
+        {
+            size_t slot = static_cast<size_t>(std::find(logical.begin(), logical.end(), storage[d]) - logical.begin());
+            if (slot == logical.size())
+                return tensor;
+            identity = identity && slot == d;
+            layout += (d ? "," : "") + std::to_string(slot);
+        }
+        if (identity && tensor.get_property("layout").empty())
+            return tensor;
+        Tensor result(tensor);
+        result.set_property("layout", identity ? "" : layout);
+        return result;
+    }
+
+    ContractionTerm LayoutPropagation::planned_term(const ContractionDag &dag, const LayoutPlan &plan, size_t node)
+    {
+        std::vector<Tensor> factors;
+        for (size_t operand : dag.node(node).inputs)
+            factors.push_back(with_storage(dag.node(operand).tensor, plan.storage[operand]));
+        return ContractionTerm(with_storage(dag.node(node).tensor, plan.storage[node]), factors,
+                               dag.node(node).prefactor);
+    }
+
+    LayoutPlan LayoutPropagation::plan(const ContractionDag &dag)
+    {
+        Planner planner(dag);
+        LayoutPlan result;
+
+        // Inputs and outputs keep their physical order
+        for (size_t id = 0; id < dag.size(); ++id)
+        {
+            if (!dag.node(id).intermediate)
+                planner.decide(id, physical_order(dag.node(id).tensor));
+        }
+
+        // Naive TTGT: intermediates in logical order, every operand permuted
+        // into (m,k) x (k,n) -> (m,n) with m, n in output order
+        for (size_t id = 0; id < dag.size(); ++id)
+        {
+            const auto &node = dag.node(id);
+            auto naive_storage = [&](size_t n)
+            {
+                return dag.node(n).intermediate ? logical_order(dag.node(n).tensor) : planner.storage(n);
+            };
+            if (node.inputs.size() == 1)
+            {
+                Labels sa = naive_storage(node.inputs[0]);
+                if (sa != naive_storage(id))
+                    result.naive_transposed_bytes += planner.bytes(sa);
+            }
+            else if (node.inputs.size() == 2)
+            {
+                Labels sa = naive_storage(node.inputs[0]), sb = naive_storage(node.inputs[1]);
+                Labels sc = naive_storage(id);
+                Groups groups = classify(logical_order(dag.node(node.inputs[0]).tensor),
+                                         logical_order(dag.node(node.inputs[1]).tensor), logical_order(node.tensor));
+                if (!groups.gemm)
+                    continue;
+                Labels m = subsequence(logical_order(node.tensor), groups.m);
+                Labels n = subsequence(logical_order(node.tensor), groups.n);
+                Labels k = subsequence(logical_order(dag.node(node.inputs[0]).tensor), groups.k);
+                if (sa != concat(m, k))
+                    result.naive_transposed_bytes += planner.bytes(sa);
+                if (sb != concat(k, n))
+                    result.naive_transposed_bytes += planner.bytes(sb);
+                if (sc != concat(m, n))
+                    result.naive_transposed_bytes += planner.bytes(sc);
+            }
+        }
+
+        // Intermediates in topological order: producer plus consumers
+        for (size_t id = 0; id < dag.size(); ++id)
+        {
+            if (!dag.node(id).intermediate)
+                continue;
+            Labels best;
+            double best_cost = std::numeric_limits<double>::max();
+            for (const auto &candidate : planner.candidates(id))
+            {
+                planner.decide(id, candidate);
+                double cost = planner.step_cost(id);
+                for (size_t consumer : dag.node(id).consumers)
+                    cost += planner.step_cost(consumer);
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best = candidate;
+                }
+            }
+            planner.decide(id, best);
+        }
+
+        // Steps with all layouts fixed
+        for (size_t id = 0; id < dag.size(); ++id)
+        {
+            result.storage.push_back(planner.storage(id));
+            const auto &node = dag.node(id);
+            if (node.inputs.empty())
+                continue;
+
+            LayoutStep step;
+            step.node = id;
+            step.c.storage = planner.storage(id);
+            step.a.storage = planner.storage(node.inputs[0]);
+            if (node.inputs.size() == 1)
+            {
+                step.kind = LayoutStep::Kind::COPY;
+                if (step.a.storage != step.c.storage)
+                {
+                    step.a.permutation = permutation_from(step.a.storage, step.c.storage);
+                    step.transposed_bytes = planner.bytes(step.a.storage);
+                }
+            }
+            else
+            {
+                step.b.storage = planner.storage(node.inputs[1]);
+                Labels la = logical_order(dag.node(node.inputs[0]).tensor);
+                Labels lb = logical_order(dag.node(node.inputs[1]).tensor);
+                Labels lc = logical_order(node.tensor);
+                Groups groups = classify(la, lb, lc);
+                step.kind = groups.gemm ? LayoutStep::Kind::GEMM : LayoutStep::Kind::LOOP;
+                if (groups.gemm)
+                {
+                    GemmChoice choice = planner.best_gemm(groups, &step.a.storage, &step.b.storage, &step.c.storage,
+                                                          la, lb);
+                    step.m = choice.m;
+                    step.n = choice.n;
+                    step.k = choice.k;
+
+                    int a_order = block_order(step.a.storage, step.m, step.k);
+                    int b_order = block_order(step.b.storage, step.k, step.n);
+                    int c_order = block_order(step.c.storage, step.m, step.n);
+                    step.a.transpose = a_order == 1;
+                    step.b.transpose = b_order == 1;
+                    step.swap_operands = c_order == 1;
+                    if (a_order < 0)
+                    {
+                        step.a.permutation = permutation_from(step.a.storage, concat(step.m, step.k));
+                        step.transposed_bytes += planner.bytes(step.a.storage);
+                    }
+                    if (b_order < 0)
+                    {
+                        step.b.permutation = permutation_from(step.b.storage, concat(step.k, step.n));
+                        step.transposed_bytes += planner.bytes(step.b.storage);
+                    }
+                    if (c_order < 0)
+                    {
+                        step.c.permutation = permutation_from(step.c.storage, concat(step.m, step.n));
+                        step.transposed_bytes += planner.bytes(step.c.storage);
+                    }
+                }
+            }
+            result.transposed_bytes += step.transposed_bytes;
+            result.steps.push_back(step);
+        }
+        return result;
+    }
+
+} // namespace qc
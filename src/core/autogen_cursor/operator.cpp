@@ -0,0 +1,214 @@
+#include "core/autogen_cursor/operator.h"
+#include <functional>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        // Spin-1/2 operator; the "pauli" property tells QubitMapping which
+        // Pauli combination it stands for, the "qubit" property where it acts
+        Operator spin_operator(const std::string &name, const std::string &pauli)
+        {
+            Operator op(name, IndexSet(), Operator::Type::GENERAL, Operator::Algebra::GENERAL);
+            op.set_property("pauli", pauli);
+            op.set_property("qubit", "0");
+            return op;
+        }
+
+        // Angular momentum operator on |j m>; WignerSymbols gives its matrix
+        // elements and the coupling coefficients
+        Operator angular_momentum_operator(const std::string &name, const std::string &component, const Index &j,
+                                           const Index &m)
+        {
+            Operator op(name, IndexSet(std::vector<Index>{j, m}), Operator::Type::GENERAL,
+                        Operator::Algebra::GENERAL);
+            op.set_property("angular_momentum", component);
+            return op;
+        }
+    }
+
+    // Operator implementation
+    Operator::Operator(const Symbol &symbol, const IndexSet &indices, Type type, Algebra algebra)
+        : symbol_(symbol.clone()), indices_(indices), type_(type), algebra_(algebra) {}
+
+    Operator::Operator(const std::string &name, const IndexSet &indices, Type type, Algebra algebra)
+        : symbol_(std::make_unique<Symbol>(name)), indices_(indices), type_(type), algebra_(algebra) {}
+
+    Operator::Operator(const Operator &other)
+        : symbol_(other.symbol_->clone()), indices_(other.indices_), type_(other.type_), algebra_(other.algebra_),
+          properties_(other.properties_) {}
+
+    Operator &Operator::operator=(const Operator &other)
+    {
+        if (this != &other)
+        {
+            symbol_ = other.symbol_->clone();
+            indices_ = other.indices_;
+            type_ = other.type_;
+            algebra_ = other.algebra_;
+            properties_ = other.properties_;
+        }
+        return *this;
+    }
+
+    void Operator::set_indices(const IndexSet &indices)
+    {
+        indices_ = indices;
+    }
+
+    void Operator::set_property(const std::string &key, const std::string &value)
+    {
+        properties_[key] = value;
+    }
+
+    std::string Operator::get_property(const std::string &key) const
+    {
+        auto it = properties_.find(key);
+        return (it != properties_.end()) ? it->second : "";
+    }
+
+    bool Operator::has_property(const std::string &key) const
+    {
+        return properties_.find(key) != properties_.end();
+    }
+
+    bool Operator::operator==(const Operator &other) const
+    {
+        if (*symbol_ != *other.symbol_ || type_ != other.type_ || algebra_ != other.algebra_ ||
+            indices_.size() != other.indices_.size())
+            return false;
+        for (size_t i = 0; i < indices_.size(); ++i)
+        {
+            if (indices_[i] != other.indices_[i])
+                return false;
+        }
+        return true;
+    }
+
+    bool Operator::operator!=(const Operator &other) const
+    {
+        return !(*this == other);
+    }
+
+    std::string Operator::to_string() const
+    {
+        std::string result = symbol_->to_string();
+        if (type_ == Type::CREATION)
+            result += "†";
+        if (!indices_.empty())
+            result += "_{" + indices_.to_string() + "}";
+        return result;
+    }
+
+    std::size_t Operator::hash() const
+    {
+        std::size_t seed = symbol_->hash() ^ (std::hash<int>{}(static_cast<int>(type_)) << 1);
+        for (const auto &idx : indices_)
+            seed ^= idx->hash() + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+
+    std::unique_ptr<Operator> Operator::clone() const
+    {
+        return std::make_unique<Operator>(*this);
+    }
+
+    Operator Operator::hermitian_conjugate() const
+    {
+        // Properties, and with them the field of the matrix elements, carry over
+        Operator result(*this);
+        if (is_creation())
+            result.set_type(Type::ANNIHILATION);
+        else if (is_annihilation())
+            result.set_type(Type::CREATION);
+        for (const char *key : {"pauli", "angular_momentum"})
+        {
+            const std::string component = get_property(key);
+            if (component == "+" || component == "-")
+                result.set_property(key, component == "+" ? "-" : "+");
+        }
+        return result;
+    }
+
+    // OperatorProduct implementation
+    OperatorProduct::OperatorProduct(double coefficient)
+        : coefficient_(coefficient), is_normal_ordered_(false) {}
+
+    OperatorProduct::OperatorProduct(const std::vector<Operator> &operators, double coefficient)
+        : operators_(operators), coefficient_(coefficient), is_normal_ordered_(false) {}
+
+    void OperatorProduct::add_operator(const Operator &op)
+    {
+        operators_.push_back(op);
+        is_normal_ordered_ = false;
+    }
+
+    bool OperatorProduct::operator==(const OperatorProduct &other) const
+    {
+        return coefficient_ == other.coefficient_ && operators_ == other.operators_;
+    }
+
+    bool OperatorProduct::operator!=(const OperatorProduct &other) const
+    {
+        return !(*this == other);
+    }
+
+    std::string OperatorProduct::to_string() const
+    {
+        std::ostringstream oss;
+        if (coefficient_ != 1.0 || operators_.empty())
+            oss << coefficient_;
+        for (size_t i = 0; i < operators_.size(); ++i)
+            oss << (i || coefficient_ != 1.0 ? " " : "") << operators_[i].to_string();
+        return oss.str();
+    }
+
+    std::unique_ptr<OperatorProduct> OperatorProduct::clone() const
+    {
+        return std::make_unique<OperatorProduct>(*this);
+    }
+
+    // OperatorFactory implementation
+    Operator OperatorFactory::angular_momentum_plus(const Index &j, const Index &m)
+    {
+        return angular_momentum_operator("J_+", "+", j, m);
+    }
+
+    Operator OperatorFactory::angular_momentum_minus(const Index &j, const Index &m)
+    {
+        return angular_momentum_operator("J_-", "-", j, m);
+    }
+
+    Operator OperatorFactory::angular_momentum_z(const Index &j, const Index &m)
+    {
+        return angular_momentum_operator("J_z", "z", j, m);
+    }
+
+    Operator OperatorFactory::spin_x()
+    {
+        return spin_operator("S_x", "X");
+    }
+
+    Operator OperatorFactory::spin_y()
+    {
+        return spin_operator("S_y", "Y");
+    }
+
+    Operator OperatorFactory::spin_z()
+    {
+        return spin_operator("S_z", "Z");
+    }
+
+    Operator OperatorFactory::spin_plus()
+    {
+        return spin_operator("S_+", "+");
+    }
+
+    Operator OperatorFactory::spin_minus()
+    {
+        return spin_operator("S_-", "-");
+    }
+
+} // namespace qc
@@ -0,0 +1,197 @@
+#include "core/autogen_cursor/orbital_space.h"
+#include <mutex>
+
+namespace qc
+{
+
+    // SpaceRegistry implementation
+    SpaceRegistry::SpaceRegistry()
+    {
+        register_space("gen");
+        register_space("occ", -1, "gen");
+        register_space("vir", -1, "gen");
+        register_space("core", -1, "occ");
+        register_space("active", -1, "gen");
+        register_space("aux");
+        set_disjoint("occ", "vir");
+        set_disjoint("gen", "aux");
+    }
+
+    SpaceRegistry &SpaceRegistry::global()
+    {
+        static SpaceRegistry registry;
+        return registry;
+    }
+
+    int SpaceRegistry::register_space(const std::string &name, long size, const std::string &parent)
+    {
+        // An existing space keeps its size: an unknown size can be filled
+        // in, a different known size is a conflict (use set_size)
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = by_name_.find(name);
+        if (it != by_name_.end())
+        {
+            OrbitalSpace &existing = spaces_[it->second];
+            if (size >= 0 && existing.size >= 0 && size != existing.size)
+                return -1;
+            if (size >= 0)
+                existing.size = size;
+            return it->second;
+        }
+
+        int id = static_cast<int>(spaces_.size());
+        spaces_.push_back({id, name, size, parent.empty() ? -1 : find(parent)});
+        by_name_[name] = id;
+        return id;
+    }
+
+    void SpaceRegistry::set_size(const std::string &name, long size)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        int space = find(name);
+        if (space >= 0)
+        {
+            spaces_[space].size = size;
+        }
+    }
+
+    void SpaceRegistry::set_disjoint(const std::string &a, const std::string &b)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        int id_a = find(a), id_b = find(b);
+        if (id_a >= 0 && id_b >= 0)
+        {
+            disjoint_.insert({id_a, id_b});
+            disjoint_.insert({id_b, id_a});
+        }
+    }
+
+    int SpaceRegistry::find(const std::string &name) const
+    {
+        auto it = by_name_.find(name);
+        return (it != by_name_.end()) ? it->second : -1;
+    }
+
+    bool SpaceRegistry::contains(int sub, int super) const
+    {
+        for (int s = sub; s >= 0; s = spaces_[s].parent)
+        {
+            if (s == super)
+                return true;
+        }
+        return false;
+    }
+
+    int SpaceRegistry::id(const std::string &name) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return find(name);
+    }
+
+    OrbitalSpace SpaceRegistry::space(int id) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return spaces_[id];
+    }
+
+    std::string SpaceRegistry::name(int id) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return spaces_[id].name;
+    }
+
+    size_t SpaceRegistry::num_spaces() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return spaces_.size();
+    }
+
+    long SpaceRegistry::size(int id) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (id < 0 || id >= static_cast<int>(spaces_.size()))
+            return -1;
+        return spaces_[id].size;
+    }
+
+    bool SpaceRegistry::is_subspace(int sub, int super) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return contains(sub, super);
+    }
+
+    bool SpaceRegistry::are_disjoint(int a, int b) const
+    {
+        // Disjointness is inherited by all subspaces
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (int s = a; s >= 0; s = spaces_[s].parent)
+        {
+            for (int t = b; t >= 0; t = spaces_[t].parent)
+            {
+                if (disjoint_.count({s, t}))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    int SpaceRegistry::intersection(int a, int b) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (contains(a, b))
+            return a;
+        if (contains(b, a))
+            return b;
+        return -1;
+    }
+
+    int SpaceRegistry::default_space(Index::Type type) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        switch (type)
+        {
+        case Index::Type::OCCUPIED:
+            return find("occ");
+        case Index::Type::VIRTUAL:
+            return find("vir");
+        default:
+            return find("gen");
+        }
+    }
+
+    int SpaceRegistry::space_of(const Index &idx) const
+    {
+        return idx.space_id() >= 0 ? idx.space_id() : default_space(idx.type());
+    }
+
+    long SpaceRegistry::dimension(const Index &idx) const
+    {
+        long registered = size(space_of(idx));
+        if (registered >= 0)
+            return registered;
+        if (idx.range_end() >= 0)
+            return idx.range_end() - idx.range_start();
+        return -1;
+    }
+
+    // IndexFactory extension
+    namespace IndexFactory
+    {
+        Index in_space(const std::string &label, const std::string &space)
+        {
+            const auto &registry = SpaceRegistry::global();
+            int space_id = registry.id(space);
+
+            Index::Type type = Index::Type::GENERAL;
+            if (space_id >= 0 && registry.is_subspace(space_id, registry.id("occ")))
+                type = Index::Type::OCCUPIED;
+            else if (space_id >= 0 && registry.is_subspace(space_id, registry.id("vir")))
+                type = Index::Type::VIRTUAL;
+
+            Index idx(label, type);
+            idx.set_space_id(space_id);
+            return idx;
+        }
+    }
+
+} // namespace qc
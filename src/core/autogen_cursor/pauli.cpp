@@ -0,0 +1,536 @@
+#include "core/autogen_cursor/pauli.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        const std::complex<double> kI(0.0, 1.0);
+
+        int popcount(std::uint64_t word)
+        {
+            return __builtin_popcountll(word);
+        }
+
+        std::complex<double> power_of_i(int k)
+        {
+            static const std::complex<double> powers[4] = {{1.0, 0.0}, {0.0, 1.0}, {-1.0, 0.0}, {0.0, -1.0}};
+            return powers[((k % 4) + 4) % 4];
+        }
+
+        using TermList = std::vector<std::pair<PauliString, std::complex<double>>>;
+
+        TermList term_list(const QubitOperator &op)
+        {
+            return TermList(op.terms().begin(), op.terms().end());
+        }
+
+        // Numeric label or property, -1 otherwise
+        int parse_number(const std::string &text)
+        {
+            if (text.empty() || !std::all_of(text.begin(), text.end(),
+                                             [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+                return -1;
+            return std::stoi(text);
+        }
+    }
+
+    // PauliString implementation
+    PauliString::PauliString(size_t n_qubits)
+        : n_qubits_(n_qubits), bits_(2 * ((n_qubits + 63) / 64), 0), phase_(0) {}
+
+    PauliString PauliString::from_string(const std::string &letters)
+    {
+        PauliString result(letters.size());
+        for (size_t q = 0; q < letters.size(); ++q)
+            result.set(q, letters[q]);
+        return result;
+    }
+
+    std::complex<double> PauliString::phase_factor() const
+    {
+        return power_of_i(phase_);
+    }
+
+    char PauliString::letter(size_t qubit) const
+    {
+        if (qubit >= n_qubits_)
+            return 'I';
+        bool x = (x_words()[qubit / 64] >> (qubit % 64)) & 1;
+        bool z = (z_words()[qubit / 64] >> (qubit % 64)) & 1;
+        return x ? (z ? 'Y' : 'X') : (z ? 'Z' : 'I');
+    }
+
+    size_t PauliString::weight() const
+    {
+        size_t result = 0;
+        for (size_t w = 0; w < num_words(); ++w)
+            result += popcount(x_words()[w] | z_words()[w]);
+        return result;
+    }
+
+    void PauliString::set(size_t qubit, char letter)
+    {
+        if (qubit >= n_qubits_)
+            return;
+        std::uint64_t mask = std::uint64_t(1) << (qubit % 64);
+        std::uint64_t &x = bits_[qubit / 64];
+        std::uint64_t &z = bits_[num_words() + qubit / 64];
+        letter = static_cast<char>(std::toupper(static_cast<unsigned char>(letter)));
+        x = (letter == 'X' || letter == 'Y') ? (x | mask) : (x & ~mask);
+        z = (letter == 'Z' || letter == 'Y') ? (z | mask) : (z & ~mask);
+    }
+
+    PauliString PauliString::operator*(const PauliString &other) const
+    {
+        // With Y = i X Z a string is i^(phase + |x & z|) X^x Z^z, and
+        // Z^z1 X^x2 = (-1)^|z1 & x2| X^x2 Z^z1
+        PauliString result(std::max(n_qubits_, other.n_qubits_));
+        int k = phase_ + other.phase_;
+        for (size_t w = 0; w < result.num_words(); ++w)
+        {
+            std::uint64_t x1 = w < num_words() ? x_words()[w] : 0, z1 = w < num_words() ? z_words()[w] : 0;
+            std::uint64_t x2 = w < other.num_words() ? other.x_words()[w] : 0;
+            std::uint64_t z2 = w < other.num_words() ? other.z_words()[w] : 0;
+            std::uint64_t x3 = x1 ^ x2, z3 = z1 ^ z2;
+            k += popcount(x1 & z1) + popcount(x2 & z2) + 2 * popcount(z1 & x2) - popcount(x3 & z3);
+            result.bits_[w] = x3;
+            result.bits_[result.num_words() + w] = z3;
+        }
+        result.set_phase(k);
+        return result;
+    }
+
+    bool PauliString::commutes_with(const PauliString &other) const
+    {
+        // Symplectic product x1.z2 + z1.x2 mod 2
+        int parity = 0;
+        for (size_t w = 0; w < std::min(num_words(), other.num_words()); ++w)
+            parity ^= popcount((x_words()[w] & other.z_words()[w]) ^ (z_words()[w] & other.x_words()[w])) & 1;
+        return parity == 0;
+    }
+
+    bool PauliString::qubitwise_commutes_with(const PauliString &other) const
+    {
+        // On every qubit the letters agree or one of them is I
+        for (size_t w = 0; w < std::min(num_words(), other.num_words()); ++w)
+        {
+            std::uint64_t x1 = x_words()[w], z1 = z_words()[w];
+            std::uint64_t x2 = other.x_words()[w], z2 = other.z_words()[w];
+            if ((x1 | z1) & (x2 | z2) & ((x1 ^ x2) | (z1 ^ z2)))
+                return false;
+        }
+        return true;
+    }
+
+    bool PauliString::same_letters(const PauliString &other) const
+    {
+        // Qubits beyond the shorter string are I
+        for (size_t w = 0; w < std::max(num_words(), other.num_words()); ++w)
+        {
+            std::uint64_t x1 = w < num_words() ? x_words()[w] : 0, z1 = w < num_words() ? z_words()[w] : 0;
+            std::uint64_t x2 = w < other.num_words() ? other.x_words()[w] : 0;
+            std::uint64_t z2 = w < other.num_words() ? other.z_words()[w] : 0;
+            if (x1 != x2 || z1 != z2)
+                return false;
+        }
+        return true;
+    }
+
+    bool PauliString::operator==(const PauliString &other) const
+    {
+        return phase_ == other.phase_ && same_letters(other);
+    }
+
+    std::size_t PauliString::hash() const
+    {
+        // Trailing identity words are skipped, so padded strings hash alike
+        size_t words = num_words();
+        while (words > 0 && !x_words()[words - 1] && !z_words()[words - 1])
+            --words;
+        std::size_t seed = 0;
+        for (size_t w = 0; w < words; ++w)
+        {
+            for (std::uint64_t word : {x_words()[w], z_words()[w]})
+                seed ^= std::hash<std::uint64_t>{}(word) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+
+    std::string PauliString::to_string() const
+    {
+        std::string result(n_qubits_, 'I');
+        for (size_t q = 0; q < n_qubits_; ++q)
+            result[q] = letter(q);
+        return result;
+    }
+
+    // QubitOperator implementation
+    QubitOperator::QubitOperator(size_t n_qubits) : n_qubits_(n_qubits) {}
+
+    QubitOperator::QubitOperator(const PauliString &string, std::complex<double> coefficient)
+        : n_qubits_(string.num_qubits())
+    {
+        add(string, coefficient);
+    }
+
+    QubitOperator QubitOperator::identity(size_t n_qubits, std::complex<double> coefficient)
+    {
+        return QubitOperator(PauliString(n_qubits), coefficient);
+    }
+
+    std::complex<double> QubitOperator::coefficient(const PauliString &string) const
+    {
+        auto it = terms_.find(string);
+        // Terms hold i^phase * coefficient, so the phase of `string` divides out
+        return it == terms_.end() ? 0.0 : it->second * std::conj(string.phase_factor());
+    }
+
+    double QubitOperator::norm() const
+    {
+        double result = 0.0;
+        for (const auto &term : terms_)
+            result += std::abs(term.second);
+        return result;
+    }
+
+    void QubitOperator::add(const PauliString &string, std::complex<double> coefficient)
+    {
+        n_qubits_ = std::max(n_qubits_, string.num_qubits());
+        if (string.phase() == 0)
+        {
+            terms_[string] += coefficient;
+            return;
+        }
+        PauliString key = string;
+        key.set_phase(0);
+        terms_[key] += coefficient * string.phase_factor();
+    }
+
+    void QubitOperator::simplify(double tolerance)
+    {
+        for (auto it = terms_.begin(); it != terms_.end();)
+        {
+            if (std::abs(it->second) <= tolerance)
+                it = terms_.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    QubitOperator &QubitOperator::operator+=(const QubitOperator &other)
+    {
+        for (const auto &term : other.terms_)
+            add(term.first, term.second);
+        return *this;
+    }
+
+    QubitOperator &QubitOperator::operator-=(const QubitOperator &other)
+    {
+        for (const auto &term : other.terms_)
+            add(term.first, -term.second);
+        return *this;
+    }
+
+    QubitOperator &QubitOperator::operator*=(std::complex<double> scalar)
+    {
+        for (auto &term : terms_)
+            term.second *= scalar;
+        return *this;
+    }
+
+    QubitOperator QubitOperator::operator+(const QubitOperator &other) const
+    {
+        QubitOperator result(*this);
+        result += other;
+        return result;
+    }
+
+    QubitOperator QubitOperator::operator-(const QubitOperator &other) const
+    {
+        QubitOperator result(*this);
+        result -= other;
+        return result;
+    }
+
+    QubitOperator QubitOperator::operator*(const QubitOperator &other) const
+    {
+        QubitOperator result(std::max(n_qubits_, other.n_qubits_));
+        result.reserve(terms_.size() * other.terms_.size());
+        for (const auto &a : terms_)
+        {
+            for (const auto &b : other.terms_)
+                result.add(a.first * b.first, a.second * b.second);
+        }
+        return result;
+    }
+
+    QubitOperator QubitOperator::operator*(std::complex<double> scalar) const
+    {
+        QubitOperator result(*this);
+        result *= scalar;
+        return result;
+    }
+
+    QubitOperator QubitOperator::adjoint() const
+    {
+        // Pauli strings are Hermitian and stored without phase
+        QubitOperator result(*this);
+        for (auto &term : result.terms_)
+            term.second = std::conj(term.second);
+        return result;
+    }
+
+    std::string QubitOperator::to_string() const
+    {
+        // Sorted by letters for a reproducible rendering
+        std::vector<std::pair<std::string, std::complex<double>>> sorted;
+        for (const auto &term : terms_)
+            sorted.push_back({term.first.to_string(), term.second});
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const std::pair<std::string, std::complex<double>> &a,
+                     const std::pair<std::string, std::complex<double>> &b) { return a.first < b.first; });
+
+        std::ostringstream oss;
+        for (size_t t = 0; t < sorted.size(); ++t)
+        {
+            const auto &c = sorted[t].second;
+            oss << (t ? " + " : "");
+            if (c.imag() == 0.0)
+                oss << c.real();
+            else
+                oss << "(" << c.real() << (c.imag() < 0 ? "-" : "+") << std::abs(c.imag()) << "i)";
+            oss << " " << sorted[t].first;
+        }
+        return sorted.empty() ? "0" : oss.str();
+    }
+
+    // QubitMapping implementation
+    QubitMapping::QubitMapping(Encoding encoding, size_t n_modes) : encoding_(encoding), n_qubits_(n_modes)
+    {
+        for (size_t j = 0; j < n_modes; ++j)
+        {
+            std::vector<size_t> update = update_set(j);
+            std::vector<size_t> parity = parity_set(j);
+            std::vector<size_t> occupation = occupation_set(j);
+
+            PauliString c(n_qubits_), d(n_qubits_);
+            for (size_t q : update)
+                c.set(q, 'X');
+            for (size_t q : parity)
+                c.set(q, 'Z');
+
+            std::vector<size_t> z_only;
+            std::set_symmetric_difference(parity.begin(), parity.end(), occupation.begin(), occupation.end(),
+                                          std::back_inserter(z_only));
+            for (size_t q : update)
+                d.set(q, 'X');
+            for (size_t q : z_only)
+                d.set(q, 'Z');
+            d.set(j, 'Y');
+
+            // a^dagger = (c - i d) / 2, a = (c + i d) / 2
+            QubitOperator create(c, 0.5), destroy(c, 0.5);
+            create.add(d, -0.5 * kI);
+            destroy.add(d, 0.5 * kI);
+            creation_.push_back(create);
+            annihilation_.push_back(destroy);
+        }
+    }
+
+    std::vector<size_t> QubitMapping::update_set(size_t j) const
+    {
+        std::vector<size_t> result;
+        if (encoding_ == Encoding::JORDAN_WIGNER)
+        {
+            result.push_back(j);
+        }
+        else if (encoding_ == Encoding::PARITY)
+        {
+            for (size_t q = j; q < n_qubits_; ++q)
+                result.push_back(q);
+        }
+        else
+        {
+            // Fenwick tree: the ancestors of j, j included
+            for (size_t k = j + 1; k <= n_qubits_; k += k & (~k + 1))
+                result.push_back(k - 1);
+        }
+        return result;
+    }
+
+    std::vector<size_t> QubitMapping::parity_set(size_t j) const
+    {
+        std::vector<size_t> result;
+        if (encoding_ == Encoding::JORDAN_WIGNER)
+        {
+            for (size_t q = 0; q < j; ++q)
+                result.push_back(q);
+        }
+        else if (encoding_ == Encoding::PARITY)
+        {
+            if (j > 0)
+                result.push_back(j - 1);
+        }
+        else
+        {
+            // Fenwick prefix of the modes below j
+            for (size_t k = j; k > 0; k &= k - 1)
+                result.push_back(k - 1);
+            std::reverse(result.begin(), result.end());
+        }
+        return result;
+    }
+
+    std::vector<size_t> QubitMapping::occupation_set(size_t j) const
+    {
+        std::vector<size_t> result;
+        if (encoding_ == Encoding::JORDAN_WIGNER)
+        {
+            result.push_back(j);
+        }
+        else if (encoding_ == Encoding::PARITY)
+        {
+            if (j > 0)
+                result.push_back(j - 1);
+            result.push_back(j);
+        }
+        else
+        {
+            // j and the children of j in the Fenwick tree
+            size_t k = j + 1;
+            size_t parent = k & (k - 1);
+            result.push_back(j);
+            for (--k; k != parent; k &= k - 1)
+                result.push_back(k - 1);
+            std::sort(result.begin(), result.end());
+        }
+        return result;
+    }
+
+    int QubitMapping::mode_of(const Operator &op)
+    {
+        if (op.has_property("mode"))
+            return parse_number(op.get_property("mode"));
+        if (op.indices().size() == 1)
+            return parse_number(op.indices()[0].label());
+        return -1;
+    }
+
+    int QubitMapping::qubit_of(const Operator &op)
+    {
+        if (op.has_property("qubit"))
+            return parse_number(op.get_property("qubit"));
+        if (op.indices().size() == 1)
+            return parse_number(op.indices()[0].label());
+        return -1;
+    }
+
+    bool QubitMapping::map_operator(const Operator &op, QubitOperator &result) const
+    {
+        if (op.has_property("pauli"))
+        {
+            // Spin-1/2 operators S = sigma / 2, S_+- = (X +- iY) / 2
+            int qubit = qubit_of(op);
+            std::string pauli = op.get_property("pauli");
+            if (qubit < 0 || static_cast<size_t>(qubit) >= n_qubits_)
+                return false;
+            PauliString x(n_qubits_), y(n_qubits_), z(n_qubits_);
+            x.set(qubit, 'X');
+            y.set(qubit, 'Y');
+            z.set(qubit, 'Z');
+            result = QubitOperator(n_qubits_);
+            if (pauli == "X" || pauli == "Y" || pauli == "Z")
+                result.add(pauli == "X" ? x : (pauli == "Y" ? y : z), 0.5);
+            else if (pauli == "+" || pauli == "-")
+            {
+                result.add(x, 0.5);
+                result.add(y, (pauli == "+" ? 0.5 : -0.5) * kI);
+            }
+            else
+                return false;
+            return true;
+        }
+
+        int mode = mode_of(op);
+        if (!op.is_fermionic() || mode < 0 || static_cast<size_t>(mode) >= n_qubits_)
+            return false;
+        if (op.is_creation())
+            result = creation_[mode];
+        else if (op.is_annihilation())
+            result = annihilation_[mode];
+        else if (op.is_number())
+            result = creation_[mode] * annihilation_[mode];
+        else
+            return false;
+        return true;
+    }
+
+    bool QubitMapping::map(const OperatorProduct &product, QubitOperator &result) const
+    {
+        // Expanded as plain lists; only the final strings are hashed
+        TermList expansion = {{PauliString(n_qubits_), product.coefficient()}};
+        for (const auto &op : product.operators())
+        {
+            QubitOperator mapped;
+            if (!map_operator(op, mapped))
+                return false;
+            TermList factors = term_list(mapped);
+            TermList next;
+            next.reserve(expansion.size() * factors.size());
+            for (const auto &a : expansion)
+            {
+                for (const auto &b : factors)
+                    next.push_back({a.first * b.first, a.second * b.second});
+            }
+            expansion.swap(next);
+        }
+
+        result = QubitOperator(n_qubits_);
+        result.reserve(expansion.size());
+        for (const auto &term : expansion)
+            result.add(term.first, term.second);
+        result.simplify(0.0);
+        return true;
+    }
+
+    bool QubitMapping::map(const std::vector<OperatorProduct> &products, QubitOperator &result) const
+    {
+        QubitOperator sum(n_qubits_);
+        bool ok = true;
+        const long n = static_cast<long>(products.size());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            // Per-thread partial sums, merged once at the end
+            QubitOperator local(n_qubits_);
+            bool local_ok = true;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256) nowait
+#endif
+            for (long t = 0; t < n; ++t)
+            {
+                QubitOperator term;
+                if (map(products[t], term))
+                    local += term;
+                else
+                    local_ok = false;
+            }
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            {
+                sum += local;
+                ok = ok && local_ok;
+            }
+        }
+        sum.simplify(0.0);
+        result = sum;
+        return ok;
+    }
+
+} // namespace qc
@@ -0,0 +1,534 @@
+#include "core/autogen_cursor/pauli_grouping.h"
+#include <algorithm>
+#include <cstdint>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace qc
+{
+
+    namespace
+    {
+        int thread_count(size_t requested)
+        {
+#ifdef _OPENMP
+            return requested > 0 ? static_cast<int>(requested) : omp_get_max_threads();
+#else
+            (void)requested;
+            return 1;
+#endif
+        }
+
+        // Branch-free edge test on one word per string, for the vectorized scans
+        template <PauliCommutation R>
+        inline bool conflict_word(std::uint64_t x1, std::uint64_t z1, std::uint64_t x2, std::uint64_t z2)
+        {
+            if (R == PauliCommutation::QUBITWISE)
+                return ((x1 | z1) & (x2 | z2) & ((x1 ^ x2) | (z1 ^ z2))) != 0;
+            return __builtin_parityll((x1 & z2) ^ (z1 & x2));
+        }
+
+        inline bool conflict_words(const std::uint64_t *x1, const std::uint64_t *z1, const std::uint64_t *x2,
+                                   const std::uint64_t *z2, size_t words, PauliCommutation relation)
+        {
+            if (relation == PauliCommutation::QUBITWISE)
+            {
+                for (size_t w = 0; w < words; ++w)
+                {
+                    if (conflict_word<PauliCommutation::QUBITWISE>(x1[w], z1[w], x2[w], z2[w]))
+                        return true;
+                }
+                return false;
+            }
+            // The parity of a sum of popcounts is the parity of the XOR of the words
+            std::uint64_t folded = 0;
+            for (size_t w = 0; w < words; ++w)
+                folded ^= (x1[w] & z2[w]) ^ (z1[w] & x2[w]);
+            return __builtin_parityll(folded);
+        }
+
+        // Strings ordered by the first and last qubit they touch, so that a
+        // tile of rows covers few qubits when the strings are local
+        std::vector<size_t> support_order(const std::vector<PauliString> &strings)
+        {
+            std::vector<std::pair<size_t, size_t>> span(strings.size(), {static_cast<size_t>(-1), 0});
+            for (size_t i = 0; i < strings.size(); ++i)
+            {
+                const PauliString &s = strings[i];
+                for (size_t w = 0; w < s.num_words(); ++w)
+                {
+                    const std::uint64_t touched = s.x_words()[w] | s.z_words()[w];
+                    if (!touched)
+                        continue;
+                    span[i].first = std::min(span[i].first, 64 * w + __builtin_ctzll(touched));
+                    span[i].second = 64 * w + 63 - __builtin_clzll(touched);
+                }
+            }
+            std::vector<size_t> order(strings.size());
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&span](size_t a, size_t b) { return span[a] < span[b]; });
+            return order;
+        }
+
+        // Strings with disjoint supports commute under both relations, so
+        // scans skip every tile of rows whose joint support misses a string
+        constexpr size_t kTile = 64;
+
+        // String i occupies words [i * words, (i + 1) * words) of x and z;
+        // support holds the qubits touched by each tile of kTile rows
+        struct PackedStrings
+        {
+            size_t n;
+            size_t words;
+            std::vector<std::uint64_t> x, z, support;
+
+            explicit PackedStrings(const std::vector<PauliString> &strings, const std::vector<size_t> &order)
+                : n(order.size()), words(1)
+            {
+                for (const auto &s : strings)
+                    words = std::max(words, s.num_words());
+                x.assign(n * words, 0);
+                z.assign(n * words, 0);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const PauliString &s = strings[order[i]];
+                    std::copy(s.x_words(), s.x_words() + s.num_words(), &x[i * words]);
+                    std::copy(s.z_words(), s.z_words() + s.num_words(), &z[i * words]);
+                }
+                index_tiles();
+            }
+
+            size_t num_tiles() const { return (n + kTile - 1) / kTile; }
+
+            void index_tiles()
+            {
+                support.assign(num_tiles() * words, 0);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    for (size_t w = 0; w < words; ++w)
+                        support[(i / kTile) * words + w] |= x[i * words + w] | z[i * words + w];
+                }
+            }
+
+            // True if some row of tile t shares a qubit with the string (xv, zv)
+            bool touches(size_t t, const std::uint64_t *xv, const std::uint64_t *zv) const
+            {
+                for (size_t w = 0; w < words; ++w)
+                {
+                    if ((xv[w] | zv[w]) & support[t * words + w])
+                        return true;
+                }
+                return false;
+            }
+
+            // Rows in the given order
+            PackedStrings select(const std::vector<size_t> &rows) const
+            {
+                PackedStrings result(*this, rows.size());
+                for (size_t r = 0; r < rows.size(); ++r)
+                {
+                    std::copy(&x[rows[r] * words], &x[rows[r] * words] + words, &result.x[r * words]);
+                    std::copy(&z[rows[r] * words], &z[rows[r] * words] + words, &result.z[r * words]);
+                }
+                result.index_tiles();
+                return result;
+            }
+
+            bool conflict(size_t i, size_t j, PauliCommutation relation) const
+            {
+                return conflict_words(&x[i * words], &z[i * words], &x[j * words], &z[j * words], words, relation);
+            }
+
+        private:
+            PackedStrings(const PackedStrings &shape, size_t rows)
+                : n(rows), words(shape.words), x(rows * shape.words, 0), z(rows * shape.words, 0) {}
+        };
+
+        template <PauliCommutation R>
+        long single_word_degree(const PackedStrings &p, size_t i, size_t begin, size_t end)
+        {
+            const std::uint64_t xi = p.x[i], zi = p.z[i];
+            const std::uint64_t *x = p.x.data(), *z = p.z.data();
+            long degree = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : degree)
+#endif
+            for (size_t j = begin; j < end; ++j)
+                degree += conflict_word<R>(xi, zi, x[j], z[j]);
+            return degree;
+        }
+
+        std::vector<long> degrees(const PackedStrings &p, PauliCommutation relation, int n_threads)
+        {
+            std::vector<long> result(p.n, 0);
+            const long n = static_cast<long>(p.n);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic, 64)
+#else
+            (void)n_threads;
+#endif
+            for (long i = 0; i < n; ++i)
+            {
+                for (size_t t = 0; t < p.num_tiles(); ++t)
+                {
+                    if (!p.touches(t, &p.x[i * p.words], &p.z[i * p.words]))
+                        continue;
+                    const size_t begin = t * kTile, end = std::min(p.n, begin + kTile);
+                    if (p.words == 1)
+                    {
+                        result[i] += relation == PauliCommutation::QUBITWISE
+                                         ? single_word_degree<PauliCommutation::QUBITWISE>(p, i, begin, end)
+                                         : single_word_degree<PauliCommutation::FULL>(p, i, begin, end);
+                        continue;
+                    }
+                    for (size_t j = begin; j < end; ++j)
+                        result[i] += p.conflict(i, j, relation);
+                }
+            }
+            return result;
+        }
+
+        // Colour classes under construction
+        class Groups
+        {
+        private:
+            const PackedStrings &p_;
+            PauliCommutation relation_;
+            std::vector<std::vector<size_t>> members_;
+            std::vector<std::uint64_t> x_, z_; // letters fixed by each qubitwise group
+
+        public:
+            Groups(const PackedStrings &p, PauliCommutation relation) : p_(p), relation_(relation) {}
+
+            size_t size() const { return members_.size(); }
+            PauliCommutation relation() const { return relation_; }
+            // Letters of qubitwise group g; an empty new group fixes none
+            std::uint64_t x_word(size_t g, size_t w) const { return g < size() ? x_[g * p_.words + w] : 0; }
+            std::uint64_t z_word(size_t g, size_t w) const { return g < size() ? z_[g * p_.words + w] : 0; }
+            std::vector<std::vector<size_t>> &members() { return members_; }
+
+            // True if v conflicts with some member of group g
+            bool adjacent(size_t v, size_t g) const
+            {
+                if (g >= members_.size())
+                    return false;
+                if (relation_ == PauliCommutation::QUBITWISE)
+                    return conflict_words(&p_.x[v * p_.words], &p_.z[v * p_.words], &x_[g * p_.words],
+                                          &z_[g * p_.words], p_.words, relation_);
+                // x_ and z_ also cover the qubits the members touch
+                bool overlap = false;
+                for (size_t w = 0; w < p_.words && !overlap; ++w)
+                    overlap = ((p_.x[v * p_.words + w] | p_.z[v * p_.words + w]) &
+                               (x_[g * p_.words + w] | z_[g * p_.words + w])) != 0;
+                if (!overlap)
+                    return false;
+                for (size_t u : members_[g])
+                {
+                    if (p_.conflict(u, v, relation_))
+                        return true;
+                }
+                return false;
+            }
+
+            size_t first_free(size_t v) const
+            {
+                size_t g = 0;
+                while (g < members_.size() && adjacent(v, g))
+                    ++g;
+                return g;
+            }
+
+            void add(size_t v, size_t g)
+            {
+                if (g == members_.size())
+                {
+                    members_.emplace_back();
+                    x_.resize(x_.size() + p_.words, 0);
+                    z_.resize(z_.size() + p_.words, 0);
+                }
+                members_[g].push_back(v);
+                for (size_t w = 0; w < p_.words; ++w)
+                {
+                    x_[g * p_.words + w] |= p_.x[v * p_.words + w];
+                    z_[g * p_.words + w] |= p_.z[v * p_.words + w];
+                }
+            }
+        };
+
+        void largest_first(const PackedStrings &p, Groups &groups, const std::vector<long> &degree)
+        {
+            std::vector<size_t> order(p.n);
+            for (size_t i = 0; i < p.n; ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(),
+                             [&degree](size_t a, size_t b) { return degree[a] > degree[b]; });
+            for (size_t v : order)
+                groups.add(v, groups.first_free(v));
+        }
+
+        // Single-word qubitwise update of rows [begin, end): a string that
+        // conflicts with v but not with the letters group g fixed so far
+        // becomes adjacent to g. Returns the largest key.
+        long long raise_qubitwise(const PackedStrings &active, std::uint64_t xv, std::uint64_t zv, std::uint64_t xg,
+                                  std::uint64_t zg, long long step, size_t begin, size_t end, long long *key)
+        {
+            const std::uint64_t *x = active.x.data(), *z = active.z.data();
+            long long top = -1;
+#ifdef _OPENMP
+#pragma omp simd reduction(max : top)
+#endif
+            for (size_t j = begin; j < end; ++j)
+            {
+                // Integer arithmetic rather than a select keeps the loop branch-free
+                const long long hit_v = conflict_word<PauliCommutation::QUBITWISE>(xv, zv, x[j], z[j]);
+                const long long hit_g = conflict_word<PauliCommutation::QUBITWISE>(xg, zg, x[j], z[j]);
+                key[j] += (hit_v & (hit_g ^ 1) & static_cast<long long>(key[j] >= 0)) * step;
+                top = std::max(top, key[j]);
+            }
+            return top;
+        }
+
+        // Groups each uncoloured string conflicts with, one bit per group.
+        // A string meets group g only when a conflicting string joins it, so
+        // the bits replace scans over the members of g. Strings are only
+        // marked from the thread that owns their row.
+        class AdjacentGroups
+        {
+        private:
+            std::vector<std::vector<std::uint64_t>> bits_;
+
+        public:
+            explicit AdjacentGroups(size_t n) : bits_(n) {}
+
+            // Records that string i conflicts with group g; false if known
+            bool mark(size_t i, size_t g)
+            {
+                auto &bits = bits_[i];
+                if (bits.size() <= g / 64)
+                    bits.resize(g / 64 + 1, 0);
+                const std::uint64_t bit = std::uint64_t(1) << (g % 64);
+                if (bits[g / 64] & bit)
+                    return false;
+                bits[g / 64] |= bit;
+                return true;
+            }
+
+            size_t first_free(size_t i) const
+            {
+                const auto &bits = bits_[i];
+                for (size_t w = 0; w < bits.size(); ++w)
+                {
+                    if (~bits[w])
+                        return 64 * w + __builtin_ctzll(~bits[w]);
+                }
+                return 64 * bits.size();
+            }
+        };
+
+        // General update of rows [begin, end): edges to v are found by a
+        // word-wise scan, adjacency to g is looked up only for those
+        long long raise_general(const PackedStrings &active, const std::vector<size_t> &origin,
+                                const PackedStrings &p, PauliCommutation relation, AdjacentGroups &adjacent,
+                                size_t v, size_t g, long long step, size_t begin, size_t end, long long *key)
+        {
+            const size_t words = p.words;
+            const std::uint64_t *xv = &p.x[v * words], *zv = &p.z[v * words];
+            long long top = -1;
+            for (size_t j = begin; j < end; ++j)
+            {
+                if (key[j] >= 0 &&
+                    conflict_words(xv, zv, &active.x[j * words], &active.z[j * words], words, relation) &&
+                    adjacent.mark(origin[j], g))
+                    key[j] += step;
+                top = std::max(top, key[j]);
+            }
+            return top;
+        }
+
+        // Row of the largest non-negative key in [begin, end), lowest first
+        size_t top_row(const std::vector<long long> &key, size_t begin, size_t end)
+        {
+            const size_t none = static_cast<size_t>(-1);
+            size_t best = none;
+            for (size_t j = begin; j < end; ++j)
+            {
+                if (key[j] >= 0 && (best == none || key[j] > key[best]))
+                    best = j;
+            }
+            return best;
+        }
+
+        void dsatur(const PackedStrings &p, Groups &groups, const std::vector<long> &degree, int n_threads)
+        {
+            // Priority saturation * (n + 1) + degree, -1 once coloured. Each
+            // tile keeps the row of its largest key, so picking the next
+            // string is a max over tiles, and a colouring step rescans only
+            // the tiles sharing a qubit with the coloured string; ties go to
+            // the lowest index. The uncoloured strings are compacted
+            // whenever half of them have been coloured.
+            const long long step = static_cast<long long>(p.n) + 1;
+            const size_t none = static_cast<size_t>(-1), chunk = 64; // tiles per thread block
+            const bool qubitwise = p.words == 1 && groups.relation() == PauliCommutation::QUBITWISE;
+
+            std::vector<size_t> origin(p.n);
+            for (size_t i = 0; i < p.n; ++i)
+                origin[i] = i;
+            PackedStrings active = p;
+            std::vector<long long> key(degree.begin(), degree.end());
+            AdjacentGroups adjacent(qubitwise ? 0 : p.n);
+            std::vector<size_t> best(active.num_tiles());
+            for (size_t t = 0; t < best.size(); ++t)
+                best[t] = top_row(key, t * kTile, std::min(active.n, (t + 1) * kTile));
+            size_t live = p.n;
+
+            size_t next = std::max_element(key.begin(), key.end()) - key.begin();
+            while (next != none)
+            {
+                const size_t v = origin[next];
+                const size_t g = qubitwise ? groups.first_free(v) : adjacent.first_free(v);
+                const std::uint64_t *xv = &p.x[v * p.words], *zv = &p.z[v * p.words];
+                size_t own = next / kTile; // rescanned even if v touches no qubit
+                key[next] = -1;
+                --live;
+
+                if (2 * live < active.n && active.n > chunk * kTile)
+                {
+                    std::vector<size_t> rows;
+                    for (size_t j = 0; j < active.n; ++j)
+                    {
+                        if (key[j] >= 0)
+                            rows.push_back(j);
+                    }
+                    active = active.select(rows);
+                    for (size_t r = 0; r < rows.size(); ++r)
+                    {
+                        origin[r] = origin[rows[r]];
+                        key[r] = key[rows[r]];
+                    }
+                    origin.resize(rows.size());
+                    key.resize(rows.size());
+                    best.resize(active.num_tiles());
+                    for (size_t t = 0; t < best.size(); ++t)
+                        best[t] = top_row(key, t * kTile, std::min(active.n, (t + 1) * kTile));
+                    own = none;
+                }
+
+                // Uncoloured neighbours of v see group g for the first time
+                // unless they already conflict with one of its members
+                const long n_chunks = static_cast<long>((active.num_tiles() + chunk - 1) / chunk);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_threads) schedule(static) if (n_chunks > 1)
+#else
+                (void)n_threads;
+#endif
+                for (long c = 0; c < n_chunks; ++c)
+                {
+                    const size_t last = std::min(active.num_tiles(), (c + 1) * chunk);
+                    for (size_t t = c * chunk; t < last; ++t)
+                    {
+                        const size_t begin = t * kTile, end = std::min(active.n, begin + kTile);
+                        if (!active.touches(t, xv, zv))
+                        {
+                            if (t == own)
+                                best[t] = top_row(key, begin, end);
+                            continue;
+                        }
+                        long long top = qubitwise ? raise_qubitwise(active, xv[0], zv[0], groups.x_word(g, 0),
+                                                                    groups.z_word(g, 0), step, begin, end, key.data())
+                                                  : raise_general(active, origin, p, groups.relation(), adjacent, v,
+                                                                  g, step, begin, end, key.data());
+                        best[t] = top >= 0 ? std::find(key.begin() + begin, key.begin() + end, top) - key.begin()
+                                           : none;
+                    }
+                }
+
+                groups.add(v, g);
+                next = none;
+                for (size_t b : best)
+                {
+                    if (b != none && (next == none || key[b] > key[next]))
+                        next = b;
+                }
+            }
+        }
+    }
+
+    // PauliGrouping implementation
+    bool PauliGrouping::conflicts(const PauliString &a, const PauliString &b, PauliCommutation relation)
+    {
+        return relation == PauliCommutation::QUBITWISE ? !a.qubitwise_commutes_with(b) : !a.commutes_with(b);
+    }
+
+    std::vector<std::vector<size_t>> PauliGrouping::partition(const std::vector<PauliString> &strings,
+                                                              const GroupingOptions &options)
+    {
+        if (strings.empty())
+            return {};
+        const int n_threads = thread_count(options.threads);
+        const std::vector<size_t> order = support_order(strings);
+        PackedStrings packed(strings, order);
+        Groups groups(packed, options.relation);
+        std::vector<long> degree = degrees(packed, options.relation, n_threads);
+
+        if (options.strategy == ColoringStrategy::LARGEST_FIRST)
+            largest_first(packed, groups, degree);
+        else
+            dsatur(packed, groups, degree, n_threads);
+
+        std::vector<std::vector<size_t>> result = std::move(groups.members());
+        for (auto &group : result)
+        {
+            for (auto &i : group)
+                i = order[i];
+            std::sort(group.begin(), group.end());
+        }
+        return result;
+    }
+
+    std::vector<QubitOperator> PauliGrouping::partition(const QubitOperator &op, const GroupingOptions &options)
+    {
+        std::vector<PauliString> strings;
+        std::vector<std::complex<double>> coefficients;
+        strings.reserve(op.size());
+        coefficients.reserve(op.size());
+        for (const auto &term : op.terms())
+        {
+            strings.push_back(term.first);
+            coefficients.push_back(term.second);
+        }
+
+        std::vector<QubitOperator> result;
+        for (const auto &group : partition(strings, options))
+        {
+            QubitOperator part(op.num_qubits());
+            part.reserve(group.size());
+            for (size_t i : group)
+                part.add(strings[i], coefficients[i]);
+            result.push_back(part);
+        }
+        return result;
+    }
+
+    bool PauliGrouping::is_valid(const std::vector<PauliString> &strings,
+                                 const std::vector<std::vector<size_t>> &groups, PauliCommutation relation)
+    {
+        std::vector<int> seen(strings.size(), 0);
+        for (const auto &group : groups)
+        {
+            for (size_t a = 0; a < group.size(); ++a)
+            {
+                if (group[a] >= strings.size() || seen[group[a]]++)
+                    return false;
+                for (size_t b = 0; b < a; ++b)
+                {
+                    if (conflicts(strings[group[a]], strings[group[b]], relation))
+                        return false;
+                }
+            }
+        }
+        return std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; });
+    }
+
+} // namespace qc
@@ -0,0 +1,720 @@
+#include "core/autogen_cursor/rdm_generator.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        // Labels: externals i, j, k, ... / a, b, c, ..., summed m1, m2, ... / e1, e2, ...
+        bool occupied(const std::string &label) { return label[0] >= 'i'; }
+
+        bool antisymmetric(const std::string &name) { return name == "t2" || name == "l2"; }
+
+        struct Factor
+        {
+            std::string name;
+            std::vector<std::string> labels;
+        };
+
+        struct RawTerm
+        {
+            double coefficient = 0.0;
+            std::vector<Factor> factors;
+        };
+
+        // Normal-ordered operator of one group, with its amplitude
+        struct Op
+        {
+            std::string label;
+            bool occupied;
+            bool dagger;
+            int group;
+        };
+
+        const int kDensityGroup = 0;
+
+        struct Group
+        {
+            Factor amplitude;
+            double coefficient;
+            std::vector<Op> ops;
+        };
+
+        class Labels
+        {
+        private:
+            int occ_ = 0, vir_ = 0;
+
+        public:
+            std::string occ() { return "m" + std::to_string(++occ_); }
+            std::string vir() { return "e" + std::to_string(++vir_); }
+        };
+
+        // t1 = t_i^a {a+ i}, t2 = 1/4 t_ij^ab {a+ b+ j i}
+        // l1 = l_a^i {i+ a}, l2 = 1/4 l_ab^ij {i+ j+ b a}
+        Group amplitude(const std::string &name, int group, Labels &labels)
+        {
+            Group result;
+            bool doubles = name[1] == '2';
+            bool excitation = name[0] == 't';
+            std::vector<std::string> I = {labels.occ()}, A = {labels.vir()};
+            if (doubles)
+            {
+                I.push_back(labels.occ());
+                A.push_back(labels.vir());
+            }
+            result.amplitude.name = name;
+            result.amplitude.labels = I;
+            result.amplitude.labels.insert(result.amplitude.labels.end(), A.begin(), A.end());
+            result.coefficient = doubles ? 0.25 : 1.0;
+            std::vector<std::string> creators = excitation ? A : I;
+            std::vector<std::string> annihilators = excitation ? I : A;
+            for (const auto &label : creators)
+                result.ops.push_back({label, occupied(label), true, group});
+            for (auto it = annihilators.rbegin(); it != annihilators.rend(); ++it)
+                result.ops.push_back({*it, occupied(*it), false, group});
+            return result;
+        }
+
+        // Full contractions over the Fermi vacuum; the density group is not
+        // normal ordered and may contract with itself
+        void contract(const std::vector<Op> &ops, std::vector<bool> &used, std::vector<std::pair<size_t, size_t>> &pairs,
+                      int sign, const std::function<void(int)> &visit)
+        {
+            size_t x = 0;
+            while (x < ops.size() && used[x])
+                ++x;
+            if (x == ops.size())
+            {
+                visit(sign);
+                return;
+            }
+            used[x] = true;
+            int between = 0;
+            for (size_t y = x + 1; y < ops.size(); ++y)
+            {
+                if (used[y])
+                    continue;
+                const Op &p = ops[x], &q = ops[y];
+                bool allowed = (p.group != q.group || p.group == kDensityGroup) && p.occupied == q.occupied &&
+                               (p.occupied ? p.dagger && !q.dagger : !p.dagger && q.dagger);
+                if (allowed)
+                {
+                    used[y] = true;
+                    pairs.emplace_back(x, y);
+                    contract(ops, used, pairs, between % 2 ? -sign : sign, visit);
+                    pairs.pop_back();
+                    used[y] = false;
+                }
+                ++between;
+            }
+            used[x] = false;
+        }
+
+        double factorial(int n) { return n <= 1 ? 1.0 : n * factorial(n - 1); }
+
+        // Terms of <0| (1 + L) (O e^T)_c |0> for the density operator `density`
+        std::vector<RawTerm> wick(const std::vector<Op> &density)
+        {
+            std::vector<RawTerm> result;
+            const int max_t = static_cast<int>(density.size()); // every T touches the operator
+            for (const char *lambda : {"", "l1", "l2"})
+            {
+                for (int n1 = 0; n1 <= max_t; ++n1)
+                {
+                    for (int n2 = 0; n1 + n2 <= max_t; ++n2)
+                    {
+                        Labels labels;
+                        std::vector<Group> groups;
+                        int g = 1;
+                        if (*lambda)
+                            groups.push_back(amplitude(lambda, g++, labels));
+                        for (int k = 0; k < n1; ++k)
+                            groups.push_back(amplitude("t1", g++, labels));
+                        for (int k = 0; k < n2; ++k)
+                            groups.push_back(amplitude("t2", g++, labels));
+
+                        // Operator string L O T ... T
+                        std::vector<Op> ops;
+                        size_t first_t = 0;
+                        if (*lambda)
+                        {
+                            ops = groups[0].ops;
+                            first_t = 1;
+                        }
+                        ops.insert(ops.end(), density.begin(), density.end());
+                        for (size_t k = first_t; k < groups.size(); ++k)
+                            ops.insert(ops.end(), groups[k].ops.begin(), groups[k].ops.end());
+
+                        int balance[2] = {0, 0};
+                        for (const auto &op : ops)
+                            balance[op.occupied] += op.dagger ? 1 : -1;
+                        if (balance[0] || balance[1])
+                            continue;
+
+                        double coefficient = 1.0 / (factorial(n1) * factorial(n2));
+                        for (const auto &group : groups)
+                            coefficient *= group.coefficient;
+
+                        std::vector<bool> used(ops.size(), false);
+                        std::vector<std::pair<size_t, size_t>> pairs;
+                        contract(ops, used, pairs, 1, [&](int sign)
+                                 {
+                            std::set<int> connected;
+                            for (const auto &pair : pairs)
+                            {
+                                int a = ops[pair.first].group, b = ops[pair.second].group;
+                                if (a == kDensityGroup)
+                                    connected.insert(b);
+                                if (b == kDensityGroup)
+                                    connected.insert(a);
+                            }
+                            for (size_t k = first_t; k < groups.size(); ++k)
+                            {
+                                if (!connected.count(static_cast<int>(k) + 1))
+                                    return;
+                            }
+
+                            // Each contraction identifies two labels; two externals give a delta
+                            RawTerm term;
+                            term.coefficient = sign * coefficient;
+                            std::map<std::string, std::string> rename;
+                            for (const auto &pair : pairs)
+                            {
+                                const Op &p = ops[pair.first], &q = ops[pair.second];
+                                if (p.group == kDensityGroup && q.group == kDensityGroup)
+                                    term.factors.push_back({"delta", {p.label, q.label}});
+                                else if (p.group == kDensityGroup)
+                                    rename[q.label] = p.label;
+                                else if (q.group == kDensityGroup)
+                                    rename[p.label] = q.label;
+                                else
+                                    rename[q.label] = p.label;
+                            }
+                            for (const auto &group : groups)
+                            {
+                                Factor factor = group.amplitude;
+                                for (auto &label : factor.labels)
+                                {
+                                    auto it = rename.find(label);
+                                    if (it != rename.end())
+                                        label = it->second;
+                                }
+                                term.factors.push_back(factor);
+                            }
+                            result.push_back(term); });
+                    }
+                }
+            }
+            return result;
+        }
+
+        // Canonical form: minimal key over factor orders within equal
+        // signatures and orientations of antisymmetric pairs, with summed
+        // labels renamed in order of appearance
+        std::string signature(const Factor &factor, const std::set<std::string> &external)
+        {
+            std::vector<std::string> slots;
+            for (const auto &label : factor.labels)
+                slots.push_back(external.count(label) ? label : occupied(label) ? "o" : "v");
+            if (antisymmetric(factor.name))
+            {
+                if (slots[1] < slots[0])
+                    std::swap(slots[0], slots[1]);
+                if (slots[3] < slots[2])
+                    std::swap(slots[2], slots[3]);
+            }
+            else if (factor.name == "delta" && slots[1] < slots[0])
+                std::swap(slots[0], slots[1]);
+            std::string result = factor.name + "(";
+            for (const auto &slot : slots)
+                result += slot + ",";
+            return result + ")";
+        }
+
+        std::string key_of(const std::vector<Factor> &factors, const std::set<std::string> &external)
+        {
+            std::map<std::string, std::string> rename;
+            int occ = 0, vir = 0;
+            std::string key;
+            for (const auto &factor : factors)
+            {
+                key += factor.name + "(";
+                for (const auto &label : factor.labels)
+                {
+                    if (!external.count(label) && !rename.count(label))
+                        rename[label] = occupied(label) ? "m" + std::to_string(++occ) : "e" + std::to_string(++vir);
+                    key += (external.count(label) ? label : rename[label]) + ",";
+                }
+                key += ")";
+            }
+            return key;
+        }
+
+        std::vector<Factor> relabel(const std::vector<Factor> &factors, const std::set<std::string> &external)
+        {
+            std::map<std::string, std::string> rename;
+            int occ = 0, vir = 0;
+            std::vector<Factor> result = factors;
+            for (auto &factor : result)
+            {
+                for (auto &label : factor.labels)
+                {
+                    if (external.count(label))
+                        continue;
+                    if (!rename.count(label))
+                        rename[label] = occupied(label) ? "m" + std::to_string(++occ) : "e" + std::to_string(++vir);
+                    label = rename[label];
+                }
+            }
+            return result;
+        }
+
+        // Returns the key; `term` is rewritten in canonical form
+        std::string canonicalize(RawTerm &term, const std::set<std::string> &external)
+        {
+            std::vector<std::pair<std::string, Factor>> keyed;
+            for (auto &factor : term.factors)
+            {
+                if (factor.name == "delta" && factor.labels[1] < factor.labels[0])
+                    std::swap(factor.labels[0], factor.labels[1]);
+                keyed.emplace_back(signature(factor, external), factor);
+            }
+            std::sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b)
+                      { return a.first < b.first; });
+            std::vector<Factor> factors;
+            for (const auto &entry : keyed)
+                factors.push_back(entry.second);
+
+            std::vector<size_t> swappable;
+            for (size_t f = 0; f < factors.size(); ++f)
+            {
+                if (antisymmetric(factors[f].name))
+                    swappable.push_back(f);
+            }
+
+            std::string best;
+            std::vector<Factor> best_factors;
+            int best_sign = 1;
+            std::vector<size_t> order(factors.size());
+            for (size_t f = 0; f < order.size(); ++f)
+                order[f] = f;
+            do
+            {
+                bool valid = true;
+                for (size_t f = 0; f < order.size() && valid; ++f)
+                    valid = keyed[order[f]].first == keyed[f].first;
+                if (!valid)
+                    continue;
+                for (size_t flips = 0; flips < (size_t(1) << (2 * swappable.size())); ++flips)
+                {
+                    std::vector<Factor> candidate = factors;
+                    int sign = 1;
+                    for (size_t s = 0; s < swappable.size(); ++s)
+                    {
+                        auto &labels = candidate[swappable[s]].labels;
+                        if (flips >> (2 * s) & 1)
+                        {
+                            std::swap(labels[0], labels[1]);
+                            sign = -sign;
+                        }
+                        if (flips >> (2 * s + 1) & 1)
+                        {
+                            std::swap(labels[2], labels[3]);
+                            sign = -sign;
+                        }
+                    }
+                    std::vector<Factor> ordered;
+                    for (size_t f : order)
+                        ordered.push_back(candidate[f]);
+                    std::string key = key_of(ordered, external);
+                    if (best.empty() || key < best)
+                    {
+                        best = key;
+                        best_factors = ordered;
+                        best_sign = sign;
+                    }
+                }
+            } while (std::next_permutation(order.begin(), order.end()));
+
+            term.factors = relabel(best_factors, external);
+            term.coefficient *= best_sign;
+            return best;
+        }
+
+        // Sum of like terms, in first-seen order
+        std::vector<RawTerm> combine(const std::vector<RawTerm> &terms, const std::set<std::string> &external)
+        {
+            std::map<std::string, size_t> position;
+            std::vector<RawTerm> result;
+            for (RawTerm term : terms)
+            {
+                std::string key = canonicalize(term, external);
+                auto it = position.find(key);
+                if (it == position.end())
+                {
+                    position[key] = result.size();
+                    result.push_back(term);
+                }
+                else
+                    result[it->second].coefficient += term.coefficient;
+            }
+            result.erase(std::remove_if(result.begin(), result.end(), [](const RawTerm &term)
+                                        { return std::abs(term.coefficient) < 1e-12; }),
+                         result.end());
+            return result;
+        }
+
+        Index make_index(const std::string &label)
+        {
+            return Index(label, occupied(label) ? Index::Type::OCCUPIED : Index::Type::VIRTUAL);
+        }
+
+        Tensor make_tensor(const Factor &factor)
+        {
+            std::vector<Index> indices;
+            for (const auto &label : factor.labels)
+                indices.push_back(make_index(label));
+            Tensor result(factor.name, IndexSet(indices));
+            if (antisymmetric(factor.name))
+                result.set_property("antisymmetric_groups", "0,1;2,3");
+            return result;
+        }
+
+        struct Block
+        {
+            std::string name;
+            Factor output;
+            std::vector<RawTerm> terms;
+        };
+
+        // Shared pairwise intermediates, greedily by number of using terms
+        class IntermediateSharing
+        {
+        private:
+            struct Candidate
+            {
+                std::string key;
+                std::vector<Factor> definition; // canonical labels
+                std::vector<std::string> externals;
+                std::vector<std::string> mapped; // labels of the using term, per external
+                int sign = 1;
+                size_t f = 0, g = 0;
+            };
+
+            std::vector<Block> &blocks_;
+            std::vector<std::pair<Factor, std::vector<Factor>>> intermediates_;
+
+            static bool outside(const std::string &label, const std::vector<Factor> &factors, size_t f, size_t g,
+                                const Factor &output)
+            {
+                if (std::count(output.labels.begin(), output.labels.end(), label))
+                    return true;
+                for (size_t h = 0; h < factors.size(); ++h)
+                {
+                    if (h != f && h != g &&
+                        std::count(factors[h].labels.begin(), factors[h].labels.end(), label))
+                        return true;
+                }
+                return false;
+            }
+
+            // Canonical key of factors f, g of a term; empty if nothing is contracted
+            static Candidate candidate(const std::vector<Factor> &factors, size_t f, size_t g, const Factor &output)
+            {
+                Candidate best;
+                for (int swap = 0; swap < 2; ++swap)
+                {
+                    Factor pair[2] = {factors[swap ? g : f], factors[swap ? f : g]};
+                    int flips_a = antisymmetric(pair[0].name) ? 4 : 1;
+                    int flips_b = antisymmetric(pair[1].name) ? 4 : 1;
+                    for (int flips = 0; flips < flips_a * flips_b; ++flips)
+                    {
+                        Factor oriented[2] = {pair[0], pair[1]};
+                        int sign = 1;
+                        int bits[2] = {flips % flips_a, flips / flips_a};
+                        for (int k = 0; k < 2; ++k)
+                        {
+                            if (bits[k] & 1)
+                            {
+                                std::swap(oriented[k].labels[0], oriented[k].labels[1]);
+                                sign = -sign;
+                            }
+                            if (bits[k] & 2)
+                            {
+                                std::swap(oriented[k].labels[2], oriented[k].labels[3]);
+                                sign = -sign;
+                            }
+                        }
+
+                        Candidate c;
+                        c.sign = sign;
+                        c.f = f;
+                        c.g = g;
+                        std::map<std::string, std::string> rename;
+                        const char *occ_pool[] = {"i", "j", "k", "l", "m", "n"};
+                        const char *vir_pool[] = {"a", "b", "c", "d", "e", "f"};
+                        int n_occ = 0, n_vir = 0, n_summed_occ = 0, n_summed_vir = 0;
+                        bool contracted = false, overflow = false;
+                        for (auto &factor : oriented)
+                        {
+                            for (auto &label : factor.labels)
+                            {
+                                if (!rename.count(label))
+                                {
+                                    bool is_occ = occupied(label);
+                                    if (outside(label, factors, f, g, output))
+                                    {
+                                        int &n = is_occ ? n_occ : n_vir;
+                                        if (n == 6)
+                                        {
+                                            overflow = true;
+                                            break;
+                                        }
+                                        rename[label] = is_occ ? occ_pool[n++] : vir_pool[n++];
+                                        c.externals.push_back(rename[label]);
+                                        c.mapped.push_back(label);
+                                    }
+                                    else
+                                    {
+                                        contracted = true;
+                                        rename[label] = is_occ ? "m" + std::to_string(++n_summed_occ)
+                                                               : "e" + std::to_string(++n_summed_vir);
+                                    }
+                                }
+                                label = rename[label];
+                            }
+                            c.key += factor.name + "(";
+                            for (const auto &label : factor.labels)
+                                c.key += label + ",";
+                            c.key += ")";
+                        }
+                        if (!contracted || overflow)
+                            return Candidate();
+                        c.definition = {oriented[0], oriented[1]};
+                        if (best.key.empty() || c.key < best.key)
+                            best = c;
+                    }
+                }
+                return best;
+            }
+
+            std::vector<Candidate> candidates(const RawTerm &term, const Factor &output) const
+            {
+                std::vector<Candidate> result;
+                if (term.factors.size() < 3)
+                    return result;
+                for (size_t f = 0; f < term.factors.size(); ++f)
+                {
+                    for (size_t g = f + 1; g < term.factors.size(); ++g)
+                    {
+                        if (term.factors[f].name == "delta" || term.factors[g].name == "delta")
+                            continue;
+                        Candidate c = candidate(term.factors, f, g, output);
+                        if (!c.key.empty())
+                            result.push_back(c);
+                    }
+                }
+                return result;
+            }
+
+        public:
+            explicit IntermediateSharing(std::vector<Block> &blocks) : blocks_(blocks) {}
+
+            const std::vector<std::pair<Factor, std::vector<Factor>>> &intermediates() const { return intermediates_; }
+
+            void run()
+            {
+                while (true)
+                {
+                    std::map<std::string, int> uses;
+                    for (const auto &block : blocks_)
+                    {
+                        for (const auto &term : block.terms)
+                        {
+                            std::set<std::string> keys;
+                            for (const auto &c : candidates(term, block.output))
+                                keys.insert(c.key);
+                            for (const auto &key : keys)
+                                ++uses[key];
+                        }
+                    }
+                    std::string chosen;
+                    int most = 1;
+                    for (const auto &entry : uses)
+                    {
+                        if (entry.second > most)
+                        {
+                            most = entry.second;
+                            chosen = entry.first;
+                        }
+                    }
+                    if (chosen.empty())
+                        return;
+
+                    Factor intermediate;
+                    intermediate.name = "I" + std::to_string(intermediates_.size() + 1);
+                    bool defined = false;
+                    for (auto &block : blocks_)
+                    {
+                        for (auto &term : block.terms)
+                        {
+                            for (const auto &c : candidates(term, block.output))
+                            {
+                                if (c.key != chosen)
+                                    continue;
+                                if (!defined)
+                                {
+                                    intermediate.labels = c.externals;
+                                    intermediates_.emplace_back(intermediate, c.definition);
+                                    defined = true;
+                                }
+                                Factor use{intermediate.name, c.mapped};
+                                term.factors.erase(term.factors.begin() + c.g);
+                                term.factors.erase(term.factors.begin() + c.f);
+                                term.factors.push_back(use);
+                                term.coefficient *= c.sign;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        };
+    }
+
+    RdmGenerator::RdmGenerator(const RdmOptions &options, const CodeGenOptions &codegen_options)
+        : options_(options), codegen_(codegen_options) {}
+
+    std::vector<std::string> RdmGenerator::unique_blocks(int order, bool hermitian)
+    {
+        if (order == 1)
+            return hermitian ? std::vector<std::string>{"oo", "ov", "vv"}
+                             : std::vector<std::string>{"oo", "ov", "vo", "vv"};
+        if (order != 2)
+            return {};
+        const char *pairs[] = {"oo", "ov", "vv"};
+        std::vector<std::string> result;
+        for (int pq = 0; pq < 3; ++pq)
+        {
+            for (int rs = hermitian ? pq : 0; rs < 3; ++rs)
+                result.push_back(std::string(pairs[pq]) + pairs[rs]);
+        }
+        return result;
+    }
+
+    Tensor RdmGenerator::block_tensor(const std::string &block)
+    {
+        const std::string occ = "ijkl", vir = "abcd";
+        size_t n_occ = 0, n_vir = 0;
+        std::vector<Index> indices;
+        for (char space : block)
+            indices.push_back(space == 'o' ? make_index(std::string(1, occ[n_occ++]))
+                                           : make_index(std::string(1, vir[n_vir++])));
+        Tensor result(std::string(block.size() == 2 ? "D1_" : "D2_") + block, IndexSet(indices));
+        if (block.size() == 4)
+        {
+            std::string groups;
+            if (block[0] == block[1])
+                groups = "0,1";
+            if (block[2] == block[3])
+                groups += std::string(groups.empty() ? "" : ";") + "2,3";
+            if (!groups.empty())
+                result.set_property("antisymmetric_groups", groups);
+        }
+        return result;
+    }
+
+    RdmEquations RdmGenerator::equations(int order) const
+    {
+        RdmEquations result;
+        std::vector<Block> blocks;
+        for (const auto &name : unique_blocks(order, options_.hermitian))
+        {
+            Block block;
+            block.name = name;
+            Tensor output = block_tensor(name);
+            for (const auto &idx : output.indices())
+                block.output.labels.push_back(idx->label());
+            block.output.name = output.symbol().name();
+
+            // p+ q and p+ q+ s r; the hermitian partners q+ p and r+ s+ q p
+            const auto &L = block.output.labels;
+            auto op = [](const std::string &label, bool dagger)
+            { return Op{label, occupied(label), dagger, kDensityGroup}; };
+            std::vector<std::vector<Op>> densities;
+            if (order == 1)
+            {
+                densities.push_back({op(L[0], true), op(L[1], false)});
+                if (options_.hermitian)
+                    densities.push_back({op(L[1], true), op(L[0], false)});
+            }
+            else
+            {
+                densities.push_back({op(L[0], true), op(L[1], true), op(L[3], false), op(L[2], false)});
+                if (options_.hermitian)
+                    densities.push_back({op(L[2], true), op(L[3], true), op(L[1], false), op(L[0], false)});
+            }
+
+            std::vector<RawTerm> terms;
+            for (const auto &density : densities)
+            {
+                for (RawTerm term : wick(density))
+                {
+                    term.coefficient /= densities.size();
+                    terms.push_back(term);
+                }
+            }
+            block.terms = combine(terms, std::set<std::string>(L.begin(), L.end()));
+            blocks.push_back(block);
+        }
+
+        if (options_.share_intermediates)
+        {
+            IntermediateSharing sharing(blocks);
+            sharing.run();
+            for (const auto &entry : sharing.intermediates())
+            {
+                std::vector<Tensor> factors;
+                for (const auto &factor : entry.second)
+                    factors.push_back(make_tensor(factor));
+                result.intermediates.emplace_back(make_tensor(entry.first), factors, 1.0);
+            }
+        }
+
+        for (const auto &block : blocks)
+        {
+            Tensor output = block_tensor(block.name);
+            std::vector<ContractionTerm> terms;
+            for (const auto &term : block.terms)
+            {
+                std::vector<Tensor> factors;
+                for (const auto &factor : term.factors)
+                    factors.push_back(make_tensor(factor));
+                terms.emplace_back(output, factors, term.coefficient);
+            }
+            result.blocks.emplace_back(block.name, terms);
+        }
+        return result;
+    }
+
+    std::string RdmGenerator::generate(const std::string &name, int order) const
+    {
+        RdmEquations eqs = equations(order);
+        std::ostringstream oss;
+        for (size_t i = 0; i < eqs.intermediates.size(); ++i)
+            oss << codegen_.generate(name + "_" + eqs.intermediates[i].output().symbol().name(),
+                                     eqs.intermediates[i])
+                << "\n";
+        for (const auto &block : eqs.blocks)
+            oss << codegen_.generate_fused(name + "_" + block.first, block.second) << "\n";
+        return oss.str();
+    }
+
+} // namespace qc
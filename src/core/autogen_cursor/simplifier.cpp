@@ -1,7 +1,14 @@
-#include "simplification/simplifier.h"
-#include "core/expression.h"
+#include "core/autogen_cursor/simplifier.h"
+#include "core/autogen_cursor/expression.h"
+#include "core/autogen_cursor/ac_matching.h"
+#include "core/autogen_cursor/delta_elimination.h"
+#include "core/autogen_cursor/horner.h"
+#include "core/autogen_cursor/kramers.h"
+#include "util/metrics.h"
 #include <algorithm>
+#include <map>
 #include <iostream>
+#include <set>
 
 namespace qc
 {
@@ -14,7 +21,18 @@ namespace qc
 
     std::unique_ptr<Expression> Simplifier::simplify(const Expression &expr) const
     {
-        auto result = expr.clone();
+        static auto &calls = MetaWaveCompiler::util::metrics().counter(
+            "qc_simplifier_calls_total", "Simplifier::simplify calls");
+        static auto &rewrites = MetaWaveCompiler::util::metrics().counter(
+            "qc_simplifier_rewrites_total", "Rule applications that changed an expression");
+        static auto &latency = MetaWaveCompiler::util::metrics().histogram(
+            "qc_simplifier_seconds", "Simplifier::simplify latency");
+        calls.inc();
+        MetaWaveCompiler::util::ScopedTimer timer(latency);
+
+        // Rules see one flattened, canonically ordered form whatever the
+        // association and operand order of the input
+        auto result = ACNormalizer::normalize(expr);
 
         // Apply simplification rules in order
         std::vector<RuleType> rule_order = {
@@ -29,6 +47,12 @@ namespace qc
         int iterations = 0;
         const int max_iterations = 10;
 
+        // Forms already reached. The default rules contain inverse pairs
+        // (distribute_multiplication and factor_common_terms): a rewrite back
+        // to a known form is taken only when it needs fewer operations, so
+        // expanded and factored inputs end in the same form instead of cycling
+        std::set<std::string> seen = {result->to_string()};
+
         while (changed && iterations < max_iterations)
         {
             changed = false;
@@ -40,10 +64,15 @@ namespace qc
                 if (it != rules_.end())
                 {
                     auto new_expr = apply_rules(*result, it->second);
-                    if (new_expr && new_expr->to_string() != result->to_string())
+                    if (new_expr)
+                        new_expr = ACNormalizer::normalize(*new_expr);
+                    if (new_expr && (seen.insert(new_expr->to_string()).second ||
+                                     HornerFactorization::count(*new_expr).total() <
+                                         HornerFactorization::count(*result).total()))
                     {
                         result = std::move(new_expr);
                         changed = true;
+                        rewrites.inc();
                         log_trace("Applied " + std::to_string(static_cast<int>(rule_type)) +
                                   " rule: " + old_result + " -> " + result->to_string());
                     }
@@ -55,6 +84,16 @@ namespace qc
         return result;
     }
 
+    std::unique_ptr<Expression> Simplifier::apply_algebraic_rules(const Expression &expr) const
+    {
+        auto it = rules_.find(RuleType::ALGEBRAIC);
+        if (it != rules_.end())
+        {
+            return apply_rules(expr, it->second);
+        }
+        return expr.clone();
+    }
+
     std::unique_ptr<Expression> Simplifier::apply_distributive_rules(const Expression &expr) const
     {
         auto it = rules_.find(RuleType::DISTRIBUTIVE);
@@ -65,6 +104,46 @@ namespace qc
         return expr.clone();
     }
 
+    std::unique_ptr<Expression> Simplifier::apply_commutator_rules(const Expression &expr) const
+    {
+        auto it = rules_.find(RuleType::COMMUTATOR);
+        if (it != rules_.end())
+        {
+            return apply_rules(expr, it->second);
+        }
+        return expr.clone();
+    }
+
+    std::unique_ptr<Expression> Simplifier::apply_tensor_rules(const Expression &expr) const
+    {
+        auto it = rules_.find(RuleType::TENSOR);
+        if (it != rules_.end())
+        {
+            return apply_rules(expr, it->second);
+        }
+        return expr.clone();
+    }
+
+    std::unique_ptr<Expression> Simplifier::apply_operator_rules(const Expression &expr) const
+    {
+        auto it = rules_.find(RuleType::OPERATOR);
+        if (it != rules_.end())
+        {
+            return apply_rules(expr, it->second);
+        }
+        return expr.clone();
+    }
+
+    std::unique_ptr<Expression> Simplifier::apply_symmetry_rules(const Expression &expr) const
+    {
+        auto it = rules_.find(RuleType::SYMMETRY);
+        if (it != rules_.end())
+        {
+            return apply_rules(expr, it->second);
+        }
+        return expr.clone();
+    }
+
     std::unique_ptr<Expression> Simplifier::apply_rules(const Expression &expr,
                                                         const std::vector<Rule> &rules) const
     {
@@ -79,6 +158,16 @@ namespace qc
         return nullptr;
     }
 
+    void Simplifier::add_rule(RuleType type, const Rule &rule)
+    {
+        rules_[type].push_back(rule);
+    }
+
+    void Simplifier::remove_rules(RuleType type)
+    {
+        rules_.erase(type);
+    }
+
     void Simplifier::log_trace(const std::string &message) const
     {
         if (enable_trace_)
@@ -108,104 +197,175 @@ namespace qc
         rules_[RuleType::COMMUTATOR].push_back(&CommutatorRules::antisymmetry);
         rules_[RuleType::COMMUTATOR].push_back(&CommutatorRules::zero_commutator);
         rules_[RuleType::COMMUTATOR].push_back(&CommutatorRules::expand_commutator);
+
+        // Add tensor rules
+        rules_[RuleType::TENSOR].push_back(&TensorRules::contract_kronecker_delta);
+
+        // Add symmetry rules
+        rules_[RuleType::SYMMETRY].push_back(&SymmetryRules::time_reversal_symmetry);
     }
 
     // DistributiveRules implementation
     std::unique_ptr<Expression> DistributiveRules::distribute_multiplication(const Expression &expr)
     {
-        // Pattern: (a+b)*(c+d) = ac + ad + bc + bd
-        if (expr.type() != Expression::Type::MULTIPLY || !expr.is_binary())
+        // Pattern: (a+b)*(c+d) = ac + ad + bc + bd, for products and sums of
+        // any length; factors keep their order
+        if (expr.type() != Expression::Type::MULTIPLY)
         {
             return nullptr;
         }
 
-        const auto &left = expr.child(0);
-        const auto &right = expr.child(1);
+        auto normal = ACNormalizer::normalize(expr);
+        if (normal->type() != Expression::Type::MULTIPLY)
+        {
+            return nullptr;
+        }
 
-        // Check if left side is a sum
-        if (left.type() == Expression::Type::ADD || left.type() == Expression::Type::SUM)
+        // Every factor of the flattened product as its list of (coefficient, term)
+        std::vector<std::vector<std::pair<double, const Expression *>>> choices;
+        bool has_sum = false;
+        for (size_t i = 0; i < normal->num_children(); ++i)
         {
-            // Check if right side is a sum
-            if (right.type() == Expression::Type::ADD || right.type() == Expression::Type::SUM)
+            const auto &factor = normal->child(i);
+            std::vector<std::pair<double, const Expression *>> terms;
+            if (const auto *sum = dynamic_cast<const SumExpression *>(&factor))
             {
-                // Both sides are sums - distribute fully
-                auto result = std::make_unique<SumExpression>();
-
-                // For binary addition, treat as 2-term sum
-                if (left.type() == Expression::Type::ADD && right.type() == Expression::Type::ADD)
-                {
-                    // (a+b)*(c+d) = ac + ad + bc + bd
-                    auto ac = ExpressionFactory::multiply(left.child(0).clone(), right.child(0).clone());
-                    auto ad = ExpressionFactory::multiply(left.child(0).clone(), right.child(1).clone());
-                    auto bc = ExpressionFactory::multiply(left.child(1).clone(), right.child(0).clone());
-                    auto bd = ExpressionFactory::multiply(left.child(1).clone(), right.child(1).clone());
-
-                    result->add_term(std::move(ac));
-                    result->add_term(std::move(ad));
-                    result->add_term(std::move(bc));
-                    result->add_term(std::move(bd));
-
-                    return std::move(result);
-                }
+                for (size_t t = 0; t < sum->num_terms(); ++t)
+                    terms.emplace_back(sum->coefficient(t), &sum->child(t));
+                has_sum = true;
             }
             else
             {
-                // Only left side is a sum: (a+b)*c = ac + bc
-                if (left.type() == Expression::Type::ADD)
-                {
-                    auto ac = ExpressionFactory::multiply(left.child(0).clone(), right.clone());
-                    auto bc = ExpressionFactory::multiply(left.child(1).clone(), right.clone());
-                    return ExpressionFactory::add(std::move(ac), std::move(bc));
-                }
+                terms.emplace_back(1.0, &factor);
             }
+            choices.push_back(std::move(terms));
+        }
+        if (!has_sum)
+        {
+            return nullptr;
         }
-        else if (right.type() == Expression::Type::ADD || right.type() == Expression::Type::SUM)
+
+        // One term per choice of a term from every factor
+        auto result = std::make_unique<SumExpression>();
+        std::vector<size_t> pick(choices.size(), 0);
+        while (true)
         {
-            // Only right side is a sum: a*(b+c) = ab + ac
-            if (right.type() == Expression::Type::ADD)
+            double coefficient = 1.0;
+            std::vector<std::unique_ptr<Expression>> factors;
+            for (size_t i = 0; i < choices.size(); ++i)
+            {
+                coefficient *= choices[i][pick[i]].first;
+                factors.push_back(choices[i][pick[i]].second->clone());
+            }
+            result->add_term(ExpressionFactory::product(std::move(factors)), coefficient);
+
+            size_t i = 0;
+            while (i < pick.size() && ++pick[i] == choices[i].size())
+            {
+                pick[i++] = 0;
+            }
+            if (i == pick.size())
             {
-                auto ab = ExpressionFactory::multiply(left.clone(), right.child(0).clone());
-                auto ac = ExpressionFactory::multiply(left.clone(), right.child(1).clone());
-                return ExpressionFactory::add(std::move(ab), std::move(ac));
+                break;
             }
         }
 
-        return nullptr;
+        return ACNormalizer::normalize(*result);
     }
 
     std::unique_ptr<Expression> DistributiveRules::factor_common_terms(const Expression &expr)
     {
-        // Pattern: ax + bx = (a+b)*x
-        if (expr.type() != Expression::Type::ADD || !expr.is_binary())
+        // Pattern: ax + by + cx = (a+c)*x + by, whatever the association and
+        // order of the terms; the factor shared by the most terms is pulled out
+        if (expr.type() != Expression::Type::ADD && expr.type() != Expression::Type::SUBTRACT &&
+            expr.type() != Expression::Type::SUM)
         {
             return nullptr;
         }
 
-        const auto &left = expr.child(0);
-        const auto &right = expr.child(1);
+        auto normal = ACNormalizer::normalize(expr);
+        const auto *sum = dynamic_cast<const SumExpression *>(normal.get());
+        if (!sum)
+        {
+            return nullptr;
+        }
 
-        // Look for common factors in multiplication terms
-        if (left.type() == Expression::Type::MULTIPLY && right.type() == Expression::Type::MULTIPLY)
+        auto factors_of = [](const Expression &term)
         {
-            if (left.is_binary() && right.is_binary())
+            std::vector<const Expression *> factors;
+            if (term.type() == Expression::Type::MULTIPLY)
             {
-                // Check if they share a common factor
-                if (left.child(1).equals(right.child(1)))
-                {
-                    // ax + bx = (a+b)*x
-                    auto sum = ExpressionFactory::add(left.child(0).clone(), right.child(0).clone());
-                    return ExpressionFactory::multiply(std::move(sum), left.child(1).clone());
-                }
-                else if (left.child(0).equals(right.child(0)))
-                {
-                    // xa + xb = x*(a+b)
-                    auto sum = ExpressionFactory::add(left.child(1).clone(), right.child(1).clone());
-                    return ExpressionFactory::multiply(left.child(0).clone(), std::move(sum));
-                }
+                for (size_t i = 0; i < term.num_children(); ++i)
+                    factors.push_back(&term.child(i));
+            }
+            else
+            {
+                factors.push_back(&term);
+            }
+            return factors;
+        };
+
+        // Terms containing each factor, in canonical factor order
+        auto canonical = [](const Expression *a, const Expression *b)
+        { return ACNormalizer::compare(*a, *b) < 0; };
+        std::map<const Expression *, std::vector<size_t>, decltype(canonical)> terms_with(canonical);
+        for (size_t t = 0; t < sum->num_terms(); ++t)
+        {
+            if (!ACNormalizer::is_commutative(sum->child(t)))
+                continue;
+            for (const auto *factor : factors_of(sum->child(t)))
+            {
+                auto &terms = terms_with[factor];
+                if (terms.empty() || terms.back() != t)
+                    terms.push_back(t);
             }
         }
 
-        return nullptr;
+        const Expression *common = nullptr;
+        size_t best = 1;
+        for (const auto &entry : terms_with)
+        {
+            if (entry.second.size() > best)
+            {
+                common = entry.first;
+                best = entry.second.size();
+            }
+        }
+        if (!common)
+        {
+            return nullptr;
+        }
+
+        auto result = std::make_unique<SumExpression>();
+        auto quotients = std::make_unique<SumExpression>();
+        std::set<size_t> sharing(terms_with[common].begin(), terms_with[common].end());
+        for (size_t t = 0; t < sum->num_terms(); ++t)
+        {
+            if (!sharing.count(t))
+            {
+                result->add_term(sum->child(t).clone(), sum->coefficient(t));
+                continue;
+            }
+
+            // The term with one occurrence of the common factor removed
+            std::vector<std::unique_ptr<Expression>> rest;
+            bool removed = false;
+            for (const auto *factor : factors_of(sum->child(t)))
+            {
+                if (!removed && ACNormalizer::compare(*factor, *common) == 0)
+                    removed = true;
+                else
+                    rest.push_back(factor->clone());
+            }
+            quotients->add_term(rest.empty() ? ExpressionFactory::one() : ExpressionFactory::product(std::move(rest)),
+                                sum->coefficient(t));
+        }
+
+        std::vector<std::unique_ptr<Expression>> factored;
+        factored.push_back(common->clone());
+        factored.push_back(std::move(quotients));
+        result->add_term(ExpressionFactory::product(std::move(factored)));
+        return ACNormalizer::normalize(*result);
     }
 
     std::unique_ptr<Expression> DistributiveRules::distribute_over_subtraction(const Expression &expr)
@@ -472,4 +632,120 @@ namespace qc
         return ExpressionFactory::subtract(std::move(AB), std::move(BA));
     }
 
-} // namespace qc
\ No newline at end of file
+    // TensorRules implementation
+    std::unique_ptr<Expression> TensorRules::contract_kronecker_delta(const Expression &expr)
+    {
+        // Product of tensors and scalars, summed over repeated labels:
+        // d_pq X_q -> X_p, and d_ia -> 0 for disjoint spaces
+        if (expr.type() != Expression::Type::MULTIPLY)
+        {
+            return nullptr;
+        }
+
+        std::vector<Tensor> factors;
+        std::vector<const Expression *> symbols; // index-free, kept as they are
+        double prefactor = 1.0;
+        bool has_delta = false;
+        bool product_only = true;
+        std::function<void(const Expression &)> flatten = [&](const Expression &e)
+        {
+            if (e.type() == Expression::Type::MULTIPLY)
+            {
+                for (size_t i = 0; i < e.num_children(); ++i)
+                    flatten(e.child(i));
+            }
+            else if (e.type() == Expression::Type::TENSOR)
+            {
+                const auto &tensor = static_cast<const TensorExpression &>(e).tensor();
+                has_delta = has_delta || KroneckerDeltaElimination::is_delta(tensor);
+                factors.push_back(tensor);
+            }
+            else if (e.type() == Expression::Type::SYMBOL)
+            {
+                auto *scalar = dynamic_cast<const ScalarSymbol *>(&static_cast<const SymbolExpression &>(e).symbol());
+                if (scalar)
+                    prefactor *= scalar->value();
+                else
+                    symbols.push_back(&e);
+            }
+            else
+            {
+                product_only = false;
+            }
+        };
+        flatten(expr);
+        if (!product_only || !has_delta)
+        {
+            return nullptr;
+        }
+
+        // Labels occurring once are free, the others are summed
+        std::map<std::string, int> counts;
+        IndexSet free_indices;
+        for (const auto &factor : factors)
+        {
+            for (const auto &idx : factor.indices())
+                counts[idx->label()]++;
+        }
+        for (const auto &factor : factors)
+        {
+            for (const auto &idx : factor.indices())
+            {
+                if (counts[idx->label()] == 1)
+                    free_indices.add_index(*idx);
+            }
+        }
+
+        ContractionTerm term(Tensor("out", free_indices), factors, prefactor);
+        auto status = KroneckerDeltaElimination::apply(term);
+        if (status == KroneckerDeltaElimination::Result::UNCHANGED)
+        {
+            return nullptr;
+        }
+        if (status == KroneckerDeltaElimination::Result::VANISHED)
+        {
+            return ExpressionFactory::zero();
+        }
+
+        std::unique_ptr<Expression> result;
+        if (term.prefactor() != 1.0 || (term.num_factors() == 0 && symbols.empty()))
+        {
+            result = ExpressionFactory::constant(term.prefactor());
+        }
+        for (const auto *symbol : symbols)
+        {
+            result = result ? ExpressionFactory::multiply(std::move(result), symbol->clone()) : symbol->clone();
+        }
+        for (const auto &factor : term.factors())
+        {
+            auto leaf = ExpressionFactory::tensor(factor);
+            result = result ? ExpressionFactory::multiply(std::move(result), std::move(leaf)) : std::move(leaf);
+        }
+        return result;
+    }
+
+    // SymmetryRules implementation
+    std::unique_ptr<Expression> SymmetryRules::time_reversal_symmetry(const Expression &expr)
+    {
+        // T[m] -> (-1)^|m| conj(T[~m]) for a block with a barred first index
+        if (expr.type() != Expression::Type::TENSOR)
+        {
+            return nullptr;
+        }
+
+        const auto &tensor = static_cast<const TensorExpression &>(expr).tensor();
+        if (!KramersSymmetry::is_symmetric(tensor) || KramersSymmetry::is_canonical(KramersSymmetry::pattern(tensor)))
+        {
+            return nullptr;
+        }
+
+        int sign = 1;
+        auto result = ExpressionFactory::tensor(KramersSymmetry::canonical(tensor, sign));
+        if (sign < 0)
+        {
+            result = ExpressionFactory::multiply(ExpressionFactory::constant(-1.0), std::move(result));
+        }
+        return result;
+    }
+
+} // namespace qc
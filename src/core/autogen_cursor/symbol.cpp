@@ -1,4 +1,4 @@
-#include "core/symbol.h"
+#include "core/autogen_cursor/symbol.h"
 #include <sstream>
 #include <functional>
 
@@ -0,0 +1,443 @@
+#include "core/autogen_cursor/tensor.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/autogen_cursor/layout.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace qc
+{
+
+    // Tensor implementation
+    Tensor::Tensor(const Symbol &symbol, const IndexSet &indices, Type type)
+        : symbol_(symbol.clone()), indices_(indices), type_(type), rank_(Rank::RANK_N) {}
+
+    Tensor::Tensor(const std::string &name, const IndexSet &indices, Type type)
+        : symbol_(std::make_unique<Symbol>(name)), indices_(indices), type_(type), rank_(Rank::RANK_N) {}
+
+    Tensor::Tensor(const Tensor &other)
+        : symbol_(other.symbol_->clone()), indices_(other.indices_), type_(other.type_), rank_(other.rank_),
+          properties_(other.properties_) {}
+
+    Tensor &Tensor::operator=(const Tensor &other)
+    {
+        if (this != &other)
+        {
+            symbol_ = other.symbol_->clone();
+            indices_ = other.indices_;
+            type_ = other.type_;
+            rank_ = other.rank_;
+            properties_ = other.properties_;
+        }
+        return *this;
+    }
+
+    void Tensor::set_indices(const IndexSet &indices)
+    {
+        indices_ = indices;
+    }
+
+    void Tensor::set_property(const std::string &key, const std::string &value)
+    {
+        properties_[key] = value;
+    }
+
+    std::string Tensor::get_property(const std::string &key) const
+    {
+        auto it = properties_.find(key);
+        return (it != properties_.end()) ? it->second : "";
+    }
+
+    bool Tensor::has_property(const std::string &key) const
+    {
+        return properties_.find(key) != properties_.end();
+    }
+
+    bool Tensor::has_symmetric_indices() const
+    {
+        for (const auto &idx : indices_)
+        {
+            if (idx->is_symmetric())
+                return true;
+        }
+        return false;
+    }
+
+    bool Tensor::has_antisymmetric_indices() const
+    {
+        for (const auto &idx : indices_)
+        {
+            if (idx->is_antisymmetric())
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<std::pair<size_t, size_t>> Tensor::get_symmetric_pairs() const
+    {
+        return indices_.find_symmetric_pairs();
+    }
+
+    bool Tensor::shares_indices(const Tensor &other) const
+    {
+        return !common_indices(other).empty();
+    }
+
+    IndexSet Tensor::common_indices(const Tensor &other) const
+    {
+        return indices_.find_common(other.indices_);
+    }
+
+    bool Tensor::can_contract_with(const Tensor &other) const
+    {
+        return shares_indices(other);
+    }
+
+    bool Tensor::operator==(const Tensor &other) const
+    {
+        if (*symbol_ != *other.symbol_ || type_ != other.type_ || indices_.size() != other.indices_.size())
+            return false;
+        for (size_t i = 0; i < indices_.size(); ++i)
+        {
+            if (indices_[i] != other.indices_[i])
+                return false;
+        }
+        return true;
+    }
+
+    bool Tensor::operator!=(const Tensor &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool Tensor::operator<(const Tensor &other) const
+    {
+        if (*symbol_ != *other.symbol_)
+            return *symbol_ < *other.symbol_;
+        return to_string() < other.to_string();
+    }
+
+    std::string Tensor::to_string() const
+    {
+        return symbol_->to_string() + "(" + indices_.to_string() + ")";
+    }
+
+    std::size_t Tensor::hash() const
+    {
+        std::size_t seed = symbol_->hash();
+        for (const auto &idx : indices_)
+            seed ^= idx->hash() + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+
+    std::unique_ptr<Tensor> Tensor::clone() const
+    {
+        return std::make_unique<Tensor>(*this);
+    }
+
+    // Tensor transpose operations: symbolic views over unchanged memory
+    Tensor Tensor::transpose() const
+    {
+        std::vector<size_t> permutation(actual_rank());
+        for (size_t i = 0; i < permutation.size(); ++i)
+            permutation[i] = permutation.size() - 1 - i;
+        return transpose(permutation);
+    }
+
+    Tensor Tensor::transpose(const std::vector<size_t> &permutation) const
+    {
+        // Slot k of the result is slot permutation[k] of this tensor
+        size_t rank = actual_rank();
+        std::vector<size_t> inverse(rank, rank);
+        for (size_t k = 0; k < permutation.size() && permutation.size() == rank; ++k)
+        {
+            if (permutation[k] < rank)
+                inverse[permutation[k]] = k;
+        }
+        if (std::find(inverse.begin(), inverse.end(), rank) != inverse.end())
+            return *this;
+
+        // Memory dimension d keeps holding the slot it held before
+        std::vector<size_t> layout = LayoutPropagation::storage_layout(*this);
+
+        IndexSet indices;
+        for (size_t k = 0; k < rank; ++k)
+            indices.add_index(indices_[permutation[k]]);
+        std::string new_layout;
+        for (size_t d = 0; d < rank; ++d)
+            new_layout += (d ? "," : "") + std::to_string(inverse[layout[d]]);
+
+        Tensor result(*this);
+        result.set_indices(indices);
+        result.set_property("layout", new_layout);
+        return result;
+    }
+
+    // TensorFactory implementation
+    Tensor TensorFactory::kronecker_delta(const Index &i, const Index &j)
+    {
+        Tensor delta("delta", IndexSet({i, j}), Tensor::Type::SYMMETRIC);
+        delta.set_property("kronecker_delta", "true");
+        return delta;
+    }
+
+    // TensorContraction implementation
+    double TensorContraction::estimate_contraction_cost(const Tensor &A, const Tensor &B,
+                                                        const IndexSet &contracted_indices)
+    {
+        // One multiply-add per point of the joint index space of A and B.
+        // Returns -1 if any dimension is unknown to the SpaceRegistry.
+        const auto &registry = SpaceRegistry::global();
+        std::map<std::string, long> dims;
+        for (const auto *indices : {&A.indices(), &B.indices(), &contracted_indices})
+        {
+            for (const auto &idx : *indices)
+            {
+                dims[idx->label()] = registry.dimension(*idx);
+            }
+        }
+
+        double cost = 2.0;
+        for (const auto &entry : dims)
+        {
+            if (entry.second < 0)
+                return -1.0;
+            cost *= static_cast<double>(entry.second);
+        }
+        return cost;
+    }
+
+    namespace
+    {
+        // Labels of a contraction, numbered in order of appearance
+        struct LabelTable
+        {
+            std::vector<Index> indices;
+            std::vector<double> dims; // -1 if unknown
+            std::map<std::string, size_t> ids;
+
+            size_t add(const Index &idx)
+            {
+                auto it = ids.find(idx.label());
+                if (it != ids.end())
+                    return it->second;
+                ids[idx.label()] = indices.size();
+                indices.push_back(idx);
+                dims.push_back(static_cast<double>(SpaceRegistry::global().dimension(idx)));
+                return indices.size() - 1;
+            }
+
+            double volume(const std::vector<size_t> &labels) const
+            {
+                double result = 1.0;
+                for (size_t l : labels)
+                    result *= dims[l];
+                return result;
+            }
+
+            IndexSet index_set(const std::vector<size_t> &labels) const
+            {
+                IndexSet result;
+                for (size_t l : labels)
+                    result.add_index(indices[l]);
+                return result;
+            }
+        };
+
+        std::vector<size_t> merged(const std::vector<size_t> &a, const std::vector<size_t> &b)
+        {
+            std::vector<size_t> result;
+            std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+            return result;
+        }
+
+        std::vector<size_t> without(const std::vector<size_t> &a, const std::vector<size_t> &b)
+        {
+            std::vector<size_t> result;
+            std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+            return result;
+        }
+
+        const size_t kExhaustiveLimit = 10;
+    }
+
+    TensorContraction::ContractionPath TensorContraction::optimize_contraction(const std::vector<Tensor> &tensors,
+                                                                               const IndexSet &output)
+    {
+        // Pairs follow the einsum_path convention: both operands are removed
+        // and the intermediate is appended to the end of the working list.
+        // A pair costs its flops plus the elements of the intermediate it
+        // writes; an index stays live while another operand or the output
+        // carries it.
+        ContractionPath path;
+        path.cost_estimate = 0.0;
+        if (tensors.size() < 2)
+            return path;
+
+        LabelTable table;
+        std::vector<std::vector<size_t>> operands;
+        for (const auto &tensor : tensors)
+        {
+            std::vector<size_t> labels;
+            for (const auto &idx : tensor.indices())
+                labels.push_back(table.add(*idx));
+            std::sort(labels.begin(), labels.end());
+            labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+            operands.push_back(labels);
+        }
+        std::vector<bool> in_output(table.indices.size(), false);
+        for (const auto &idx : output)
+        {
+            auto it = table.ids.find(idx->label());
+            if (it != table.ids.end())
+                in_output[it->second] = true;
+        }
+        bool unknown_size = std::find_if(table.dims.begin(), table.dims.end(),
+                                         [](double dim)
+                                         { return dim < 0; }) != table.dims.end();
+
+        // Labels of the union of operands i and j still needed afterwards
+        auto kept_after = [&](const std::vector<std::vector<size_t>> &work, size_t i, size_t j,
+                              const std::vector<size_t> &joint)
+        {
+            std::vector<size_t> kept;
+            for (size_t l : joint)
+            {
+                bool needed = in_output[l];
+                for (size_t k = 0; k < work.size() && !needed; ++k)
+                {
+                    if (k != i && k != j && std::binary_search(work[k].begin(), work[k].end(), l))
+                        needed = true;
+                }
+                if (needed)
+                    kept.push_back(l);
+            }
+            return kept;
+        };
+
+        auto record = [&](std::vector<std::vector<size_t>> &work, size_t i, size_t j)
+        {
+            auto joint = merged(work[i], work[j]);
+            auto kept = kept_after(work, i, j, joint);
+            path.tensor_pairs.push_back({i, j});
+            path.contracted_indices.push_back(table.index_set(without(joint, kept)));
+            path.cost_estimate += 2.0 * table.volume(joint);
+            work.erase(work.begin() + j);
+            work.erase(work.begin() + i);
+            work.push_back(kept);
+        };
+
+        std::vector<std::vector<size_t>> work = operands;
+        if (unknown_size)
+        {
+            // Unknown sizes: keep the input order
+            while (work.size() > 1)
+                record(work, 0, 1);
+            path.cost_estimate = -1.0;
+            return path;
+        }
+
+        if (tensors.size() > kExhaustiveLimit)
+        {
+            while (work.size() > 1)
+            {
+                size_t best_i = 0, best_j = 1;
+                double best_cost = std::numeric_limits<double>::max();
+                for (size_t i = 0; i < work.size(); ++i)
+                {
+                    for (size_t j = i + 1; j < work.size(); ++j)
+                    {
+                        auto joint = merged(work[i], work[j]);
+                        double cost = 2.0 * table.volume(joint) + table.volume(kept_after(work, i, j, joint));
+                        if (cost < best_cost)
+                        {
+                            best_cost = cost;
+                            best_i = i;
+                            best_j = j;
+                        }
+                    }
+                }
+                record(work, best_i, best_j);
+            }
+            return path;
+        }
+
+        // Exact search over subsets: best[S] is the cheapest way to contract
+        // the operands in S into one intermediate
+        size_t n = tensors.size();
+        unsigned full = (1u << n) - 1;
+        std::vector<unsigned> holders(table.indices.size(), 0);
+        for (size_t t = 0; t < n; ++t)
+        {
+            for (size_t l : operands[t])
+                holders[l] |= 1u << t;
+        }
+        std::vector<std::vector<size_t>> kept(full + 1);
+        for (unsigned subset = 1; subset <= full; ++subset)
+        {
+            for (size_t l = 0; l < holders.size(); ++l)
+            {
+                if ((holders[l] & subset) && (in_output[l] || (holders[l] & ~subset & full)))
+                    kept[subset].push_back(l);
+            }
+        }
+
+        std::vector<double> best(full + 1, std::numeric_limits<double>::max());
+        std::vector<unsigned> split(full + 1, 0);
+        for (unsigned subset = 1; subset <= full; ++subset)
+        {
+            if ((subset & (subset - 1)) == 0)
+            {
+                best[subset] = 0.0;
+                continue;
+            }
+            // Each split once: the left part holds the lowest operand
+            unsigned lowest = subset & (~subset + 1);
+            unsigned rest = subset & ~lowest;
+            for (unsigned part = rest;; part = (part - 1) & rest)
+            {
+                unsigned left = lowest | part;
+                unsigned right = subset & ~left;
+                if (right)
+                {
+                    double cost = best[left] + best[right] + 2.0 * table.volume(merged(kept[left], kept[right])) +
+                                  table.volume(kept[subset]);
+                    if (cost < best[subset])
+                    {
+                        best[subset] = cost;
+                        split[subset] = left;
+                    }
+                }
+                if (part == 0)
+                    break;
+            }
+        }
+
+        // Replay the optimal tree bottom-up on the working list
+        std::vector<unsigned> members;
+        for (size_t t = 0; t < n; ++t)
+            members.push_back(1u << t);
+        std::function<void(unsigned)> emit = [&](unsigned subset)
+        {
+            if ((subset & (subset - 1)) == 0)
+                return;
+            unsigned left = split[subset], right = subset & ~left;
+            emit(left);
+            emit(right);
+            size_t i = std::find(members.begin(), members.end(), left) - members.begin();
+            size_t j = std::find(members.begin(), members.end(), right) - members.begin();
+            if (i > j)
+                std::swap(i, j);
+            record(work, i, j);
+            members.erase(members.begin() + j);
+            members.erase(members.begin() + i);
+            members.push_back(subset);
+        };
+        emit(full);
+        return path;
+    }
+
+} // namespace qc
@@ -0,0 +1,93 @@
+#include "core/autogen_cursor/term_fusion.h"
+#include "core/autogen_cursor/antisymmetry.h"
+#include <set>
+#include <string>
+
+namespace qc
+{
+
+    namespace
+    {
+        bool reads(const ContractionTerm &term, const std::string &name)
+        {
+            for (const auto &factor : term.factors())
+            {
+                if (factor.symbol().name() == name)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    bool TermFusion::fusable(const ContractionTerm &a, const ContractionTerm &b)
+    {
+        const Tensor &x = a.output();
+        const Tensor &y = b.output();
+        if (x.symbol().name() != y.symbol().name() || x.actual_rank() != y.actual_rank() ||
+            x.get_property("layout") != y.get_property("layout"))
+            return false;
+        for (size_t d = 0; d < x.actual_rank(); ++d)
+        {
+            if (x.indices()[d].label() != y.indices()[d].label())
+                return false;
+        }
+
+        auto x_groups = AntisymmetryAnalysis::groups(x);
+        auto y_groups = AntisymmetryAnalysis::groups(y);
+        if (x_groups.size() != y_groups.size())
+            return false;
+        for (size_t g = 0; g < x_groups.size(); ++g)
+        {
+            if (x_groups[g].positions != y_groups[g].positions)
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<std::vector<ContractionTerm>> TermFusion::group(const std::vector<ContractionTerm> &terms)
+    {
+        std::vector<std::vector<size_t>> groups;
+        std::vector<int> group_of(terms.size(), -1);
+        for (size_t t = 0; t < terms.size(); ++t)
+        {
+            const ContractionTerm &term = terms[t];
+            const std::string &output = term.output().symbol().name();
+
+            // Latest compatible group; a term reading its own output stays alone
+            int target = -1;
+            for (size_t g = groups.size(); g-- > 0 && target < 0 && !reads(term, output);)
+            {
+                if (fusable(terms[groups[g][0]], term))
+                    target = static_cast<int>(g);
+            }
+
+            // The group runs at its first term: nothing in between may see
+            // this term's contribution or change its inputs
+            for (size_t u = target < 0 ? t : groups[target][0] + 1; u < t && target >= 0; ++u)
+            {
+                if (group_of[u] == target)
+                    continue;
+                if (reads(terms[u], output) || reads(term, terms[u].output().symbol().name()))
+                    target = -1;
+            }
+
+            if (target < 0)
+            {
+                target = static_cast<int>(groups.size());
+                groups.emplace_back();
+            }
+            groups[target].push_back(t);
+            group_of[t] = target;
+        }
+
+        std::vector<std::vector<ContractionTerm>> result;
+        for (const auto &members : groups)
+        {
+            result.emplace_back();
+            for (size_t t : members)
+                result.back().push_back(terms[t]);
+        }
+        return result;
+    }
+
+} // namespace qc
@@ -0,0 +1,244 @@
+#include "core/autogen_cursor/triples_generator.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/autogen_cursor/implicit_tensor.h"
+#include <array>
+#include <sstream>
+
+namespace qc
+{
+
+    namespace
+    {
+        // The six simultaneous permutations of the pairs (ia), (jb), (kc)
+        const std::array<std::array<int, 3>, 6> kPairPermutations = {{{0, 1, 2},
+                                                                      {0, 2, 1},
+                                                                      {1, 0, 2},
+                                                                      {1, 2, 0},
+                                                                      {2, 0, 1},
+                                                                      {2, 1, 0}}};
+
+        Index occ(const std::string &label) { return Index(label, Index::Type::OCCUPIED); }
+        Index vir(const std::string &label) { return Index(label, Index::Type::VIRTUAL); }
+
+        Tensor tensor(const std::string &name, const std::vector<Index> &indices)
+        {
+            return Tensor(name, IndexSet(indices));
+        }
+
+        std::string indent(size_t depth)
+        {
+            return std::string(4 * depth, ' ');
+        }
+    }
+
+    PerturbativeTriplesGenerator::PerturbativeTriplesGenerator(const TriplesOptions &options,
+                                                               const CodeGenOptions &codegen_options)
+        : options_(options), codegen_(codegen_options) {}
+
+    double PerturbativeTriplesGenerator::triple_weight(long i, long j, long k)
+    {
+        if (i == j && j == k)
+            return 0.0;
+        if (i == j || j == k || i == k)
+            return 3.0;
+        return 6.0;
+    }
+
+    std::vector<ContractionTerm> PerturbativeTriplesGenerator::connected_terms() const
+    {
+        const std::array<Index, 3> I = {occ("i"), occ("j"), occ("k")};
+        const std::array<Index, 3> A = {vir("a"), vir("b"), vir("c")};
+        Tensor W = tensor("W", {A[0], A[1], A[2]});
+
+        std::vector<ContractionTerm> terms;
+        for (const auto &p : kPairPermutations)
+        {
+            // sum_f (ia|fb) t_kj^cf
+            terms.emplace_back(W, std::vector<Tensor>{tensor("g_ovvv", {I[p[0]], A[p[0]], vir("f"), A[p[1]]}),
+                                                      tensor("t2", {I[p[2]], I[p[1]], A[p[2]], vir("f")})},
+                               1.0);
+            // - sum_m (ia|mj) t_mk^bc
+            terms.emplace_back(W, std::vector<Tensor>{tensor("g_ovoo", {I[p[0]], A[p[0]], occ("m"), I[p[1]]}),
+                                                      tensor("t2", {occ("m"), I[p[2]], A[p[1]], A[p[2]]})},
+                               -1.0);
+        }
+        return terms;
+    }
+
+    std::vector<ContractionTerm> PerturbativeTriplesGenerator::disconnected_terms() const
+    {
+        const std::array<Index, 3> I = {occ("i"), occ("j"), occ("k")};
+        const std::array<Index, 3> A = {vir("a"), vir("b"), vir("c")};
+        Tensor V = tensor("V", {A[0], A[1], A[2]});
+
+        std::vector<ContractionTerm> terms;
+        for (const auto &p : kPairPermutations)
+        {
+            // 1/2 (ia|jb) t_k^c
+            terms.emplace_back(V, std::vector<Tensor>{tensor("g_ovov", {I[p[0]], A[p[0]], I[p[1]], A[p[1]]}),
+                                                      tensor("t1", {I[p[2]], A[p[2]]})},
+                               0.5);
+            // 1/2 t_ij^ab f_kc
+            terms.emplace_back(V, std::vector<Tensor>{tensor("t2", {I[p[0]], I[p[1]], A[p[0]], A[p[1]]}),
+                                                      tensor("f_ov", {I[p[2]], A[p[2]]})},
+                               0.5);
+        }
+        return terms;
+    }
+
+    std::string PerturbativeTriplesGenerator::generate(const std::string &name) const
+    {
+        const auto &registry = SpaceRegistry::global();
+        const CodeGenOptions &cg = codegen_.options();
+        const std::string &S = cg.scalar_type;
+        const std::string &N = cg.index_type;
+        int occ_space = registry.id("occ"), vir_space = registry.id("vir");
+        std::string n_occ = CodeGenerator::dimension_name(occ_space);
+        std::string n_vir = CodeGenerator::dimension_name(vir_space);
+
+        std::ostringstream oss;
+        oss << "void " << name << "(const " << S << " *t1, const " << S << " *t2, const " << S << " *g_ovvv, const "
+            << S << " *g_ovoo, const " << S << " *g_ovov, const " << S << " *f_ov, const " << S
+            << " *" << ImplicitTensor::source_name(occ_space) << ", const " << S << " *"
+            << ImplicitTensor::source_name(vir_space);
+        bool fixed_occ = cg.fixed_dimensions && registry.size(occ_space) >= 0;
+        bool fixed_vir = cg.fixed_dimensions && registry.size(vir_space) >= 0;
+        if (!fixed_occ)
+            oss << ", " << N << " " << n_occ;
+        if (!fixed_vir)
+            oss << ", " << N << " " << n_vir;
+        oss << ", " << S << " *energy)\n{\n";
+        if (fixed_occ)
+            oss << indent(1) << "constexpr " << N << " " << n_occ << " = " << registry.size(occ_space) << ";\n";
+        if (fixed_vir)
+            oss << indent(1) << "constexpr " << N << " " << n_vir << " = " << registry.size(vir_space) << ";\n";
+
+        // Unique triples, flattened so that they can be scheduled dynamically
+        oss << indent(1) << "// Unique occupied triples i >= j >= k; i == j == k does not contribute\n"
+            << indent(1) << "std::vector<" << N << "> triples;\n"
+            << indent(1) << "for (" << N << " i = 0; i < " << n_occ << "; ++i)\n"
+            << indent(2) << "for (" << N << " j = 0; j <= i; ++j)\n"
+            << indent(3) << "for (" << N << " k = 0; k <= j; ++k)\n"
+            << indent(4) << "if (i != k)\n"
+            << indent(4) << "{\n"
+            << indent(5) << "triples.push_back(i);\n"
+            << indent(5) << "triples.push_back(j);\n"
+            << indent(5) << "triples.push_back(k);\n"
+            << indent(4) << "}\n"
+            << indent(1) << "const " << N << " n_triples = static_cast<" << N << ">(triples.size() / 3);\n"
+            << indent(1) << "const " << N << " tile = " << options_.virtual_tile << ";\n"
+            << indent(1) << "const " << N << " n_tiles = (" << n_vir << " + tile - 1) / tile;\n"
+            << indent(1) << "const " << N << " n_block = tile * tile * tile;\n"
+            << indent(1) << S << " e_t = 0.0;\n\n";
+
+        if (options_.openmp)
+            oss << "#pragma omp parallel reduction(+ : e_t)\n";
+        oss << indent(1) << "{\n"
+            << indent(2) << "// Per-thread W and V blocks of the distinct orderings of one tile triple\n"
+            << indent(2) << "std::vector<" << S << "> W_blocks(6 * n_block), V_blocks(6 * n_block);\n";
+        if (options_.openmp)
+            oss << "#pragma omp for schedule(dynamic)\n";
+        oss << indent(2) << "for (" << N << " t = 0; t < n_triples; ++t)\n"
+            << indent(2) << "{\n"
+            << indent(3) << "const " << N << " i = triples[3 * t], j = triples[3 * t + 1], k = triples[3 * t + 2];\n"
+            << indent(3) << "const " << S << " weight = (i == j || j == k) ? 3.0 : 6.0;\n"
+            << indent(3) << S << " e_ijk = 0.0;\n"
+            << indent(3) << "for (" << N << " ta = 0; ta < n_tiles; ++ta)\n"
+            << indent(4) << "for (" << N << " tb = 0; tb <= ta; ++tb)\n"
+            << indent(5) << "for (" << N << " tc = 0; tc <= tb; ++tc)\n"
+            << indent(5) << "{\n"
+            << indent(6) << "// Z at (a, b, c) reads W at the permuted virtuals, which lie in the\n"
+            << indent(6) << "// blocks of the permuted tile triple\n"
+            << indent(6) << N << " blocks[6][3];\n"
+            << indent(6) << "int n_blocks = 0;\n"
+            << indent(6) << "const " << N
+            << " order[6][3] = {{ta, tb, tc}, {ta, tc, tb}, {tb, ta, tc}, {tb, tc, ta}, {tc, ta, tb}, {tc, tb, ta}};\n"
+            << indent(6) << "auto block_of = [&](" << N << " x, " << N << " y, " << N << " z)\n"
+            << indent(6) << "{\n"
+            << indent(7) << "for (int q = 0; q < n_blocks; ++q)\n"
+            << indent(8) << "if (blocks[q][0] == x && blocks[q][1] == y && blocks[q][2] == z)\n"
+            << indent(9) << "return q;\n"
+            << indent(7) << "return -1;\n"
+            << indent(6) << "};\n"
+            << indent(6) << "for (const auto &o : order)\n"
+            << indent(7) << "if (block_of(o[0], o[1], o[2]) < 0)\n"
+            << indent(7) << "{\n"
+            << indent(8) << "blocks[n_blocks][0] = o[0];\n"
+            << indent(8) << "blocks[n_blocks][1] = o[1];\n"
+            << indent(8) << "blocks[n_blocks][2] = o[2];\n"
+            << indent(8) << "++n_blocks;\n"
+            << indent(7) << "}\n\n"
+            << indent(6) << "for (int q = 0; q < n_blocks; ++q)\n"
+            << indent(6) << "{\n"
+            << indent(7) << S << " *W = W_blocks.data() + q * n_block;\n"
+            << indent(7) << S << " *V = V_blocks.data() + q * n_block;\n"
+            << indent(7) << "std::fill(W, W + n_block, 0.0);\n"
+            << indent(7) << "std::fill(V, V + n_block, 0.0);\n";
+        for (const char *x : {"a", "b", "c"})
+        {
+            int slot = *x - 'a';
+            oss << indent(7) << "const " << N << " " << x << "_begin = blocks[q][" << slot << "] * tile, " << x
+                << "_end = std::min(" << x << "_begin + tile, " << n_vir << ");\n";
+        }
+
+        LoopBounds bounds;
+        bounds.fixed = {"i", "j", "k"};
+        for (const std::string x : {"a", "b", "c"})
+        {
+            bounds.ranges[x] = {x + "_begin", x + "_end"};
+            bounds.output_block[x] = {x + "_begin", "tile"};
+        }
+        // All permutations of a block accumulate in one pass over the tile
+        oss << codegen_.generate_fused_loops(connected_terms(), bounds, 7);
+        oss << codegen_.generate_fused_loops(disconnected_terms(), bounds, 7);
+        oss << indent(6) << "}\n\n";
+
+        // D_ijk^abc is evaluated in place from the orbital energies. Block
+        // (x, y, z) of W holds W at the virtuals (x, y, z) of this block,
+        // at the same offset within the tile.
+        ImplicitTensor denominator = ImplicitTensor::denominator(
+            tensor("D", {occ("i"), occ("j"), occ("k"), vir("a"), vir("b"), vir("c")}), false);
+        auto at = [](const std::string &x, const std::string &y, const std::string &z)
+        {
+            return "W_" + x + y + z + "[(" + x + "_l * tile + " + y + "_l) * tile + " + z + "_l]";
+        };
+        oss << indent(6) << "for (int q = 0; q < n_blocks; ++q)\n"
+            << indent(6) << "{\n"
+            << indent(7) << "const " << N << " *o = blocks[q];\n"
+            << indent(7) << "const " << S << " *V = V_blocks.data() + q * n_block;\n";
+        const char *orders[6][2] = {{"abc", "o[0], o[1], o[2]"}, {"bca", "o[1], o[2], o[0]"},
+                                    {"cab", "o[2], o[0], o[1]"}, {"cba", "o[2], o[1], o[0]"},
+                                    {"acb", "o[0], o[2], o[1]"}, {"bac", "o[1], o[0], o[2]"}};
+        for (const auto &order : orders)
+            oss << indent(7) << "const " << S << " *W_" << order[0] << " = W_blocks.data() + block_of("
+                << order[1] << ") * n_block;\n";
+        for (const char *x : {"a", "b", "c"})
+        {
+            int slot = *x - 'a';
+            oss << indent(7) << "const " << N << " " << x << "_begin = o[" << slot << "] * tile, " << x
+                << "_end = std::min(" << x << "_begin + tile, " << n_vir << ");\n";
+        }
+        oss << indent(7) << "for (" << N << " a = a_begin; a < a_end; ++a)\n"
+            << indent(8) << "for (" << N << " b = b_begin; b < b_end; ++b)\n"
+            << indent(9) << "for (" << N << " c = c_begin; c < c_end; ++c)\n"
+            << indent(9) << "{\n"
+            << indent(10) << "const " << N << " a_l = a - a_begin, b_l = b - b_begin, c_l = c - c_begin;\n"
+            << indent(10) << "const " << N << " abc = (a_l * tile + b_l) * tile + c_l;\n"
+            << indent(10) << "const " << S << " d = "
+            << denominator.element_expression({"i", "j", "k", "a", "b", "c"}) << ";\n"
+            << indent(10) << "const " << S << " z = (4.0 * W_abc[abc] + " << at("b", "c", "a") << " + "
+            << at("c", "a", "b") << " - 2.0 * " << at("c", "b", "a") << " - 2.0 * " << at("a", "c", "b")
+            << " - 2.0 * " << at("b", "a", "c") << ") / d;\n"
+            << indent(10) << "e_ijk += (W_abc[abc] + V[abc]) * z;\n"
+            << indent(9) << "}\n"
+            << indent(6) << "}\n"
+            << indent(5) << "}\n"
+            << indent(3) << "e_t += weight * e_ijk;\n"
+            << indent(2) << "}\n"
+            << indent(1) << "}\n"
+            << indent(1) << "*energy = e_t / 3.0;\n"
+            << "}\n";
+        return oss.str();
+    }
+
+} // namespace qc
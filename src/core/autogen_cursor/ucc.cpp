@@ -0,0 +1,197 @@
+#include "core/autogen_cursor/ucc.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace qc
+{
+
+    namespace
+    {
+        bool disjoint(const UnitaryCoupledCluster::ModeSet &a, const UnitaryCoupledCluster::ModeSet &b)
+        {
+            for (size_t w = 0; w < std::min(a.size(), b.size()); ++w)
+            {
+                if (a[w] & b[w])
+                    return false;
+            }
+            return true;
+        }
+
+        UnitaryCoupledCluster::ModeSet joint(const UnitaryCoupledCluster::ModeSet &a,
+                                             const UnitaryCoupledCluster::ModeSet &b)
+        {
+            UnitaryCoupledCluster::ModeSet result = a;
+            for (size_t w = 0; w < std::min(a.size(), b.size()); ++w)
+                result[w] |= b[w];
+            return result;
+        }
+    }
+
+    UnitaryCoupledCluster::UnitaryCoupledCluster(const QubitMapping &mapping, const UccOptions &options)
+        : mapping_(mapping), options_(options) {}
+
+    UnitaryCoupledCluster::ModeSet UnitaryCoupledCluster::modes_of(const OperatorProduct &product) const
+    {
+        const size_t words = (mapping_.num_qubits() + 63) / 64;
+        ModeSet all(words, ~std::uint64_t(0)), result(words, 0);
+        size_t fermions = 0;
+        for (const auto &op : product.operators())
+        {
+            int mode = QubitMapping::mode_of(op);
+            if (!op.is_fermionic() || mode < 0 || static_cast<size_t>(mode) >= mapping_.num_qubits())
+                return all;
+            result[mode / 64] |= std::uint64_t(1) << (mode % 64);
+            if (!op.is_number())
+                ++fermions;
+        }
+        return fermions % 2 ? all : result;
+    }
+
+    bool UnitaryCoupledCluster::add_excitation(const OperatorProduct &excitation)
+    {
+        QubitOperator tau;
+        if (!mapping_.map(excitation, tau))
+            return false;
+        QubitOperator generator = tau - tau.adjoint();
+        generator.simplify(options_.drop);
+        if (generator.size() == 0)
+            return true;
+        generators_.push_back({modes_of(excitation), generator, generator.norm()});
+        return true;
+    }
+
+    QubitOperator UnitaryCoupledCluster::commutator(const QubitOperator &a, const QubitOperator &b)
+    {
+        static auto &commutators = MetaWaveCompiler::util::metrics().counter(
+            "qc_operator_commutators_total", "Qubit operator commutators evaluated");
+        static auto &products = MetaWaveCompiler::util::metrics().counter(
+            "qc_operator_string_products_total", "Pauli string pairs multiplied in commutators");
+        commutators.inc();
+        products.inc(a.terms().size() * b.terms().size());
+
+        QubitOperator result(std::max(a.num_qubits(), b.num_qubits()));
+        for (const auto &x : a.terms())
+        {
+            for (const auto &y : b.terms())
+            {
+                if (!x.first.commutes_with(y.first))
+                    result.add(x.first * y.first, 2.0 * x.second * y.second);
+            }
+        }
+        result.simplify(0.0);
+        return result;
+    }
+
+    void UnitaryCoupledCluster::expand(Pieces &pieces, const std::vector<const Generator *> &generators,
+                                       double scale)
+    {
+        double generator_norm = 0.0;
+        for (const Generator *g : generators)
+            generator_norm += g->norm * std::abs(scale);
+
+        // term holds ad_A^k H / k!, one piece per set of touched modes
+        Pieces term = pieces;
+        double term_norm = 0.0;
+        for (const auto &piece : term)
+            term_norm += piece.second.norm();
+
+        for (int k = 1; k <= options_.max_order && !term.empty(); ++k)
+        {
+            if (2.0 * term_norm * generator_norm / k < options_.tolerance)
+                break;
+
+            Pieces next;
+            for (const auto &piece : term)
+            {
+                const double piece_norm = piece.second.norm();
+                for (const Generator *g : generators)
+                {
+                    if (disjoint(piece.first, g->modes))
+                    {
+                        ++stats_.screened;
+                        continue;
+                    }
+                    if (2.0 * piece_norm * g->norm * std::abs(scale) / k < options_.drop)
+                    {
+                        ++stats_.negligible;
+                        continue;
+                    }
+                    ++stats_.commutators;
+                    QubitOperator c = commutator(piece.second, g->op);
+                    if (c.size() == 0)
+                        continue;
+                    c *= scale / k;
+                    ModeSet modes = joint(piece.first, g->modes);
+                    auto it = next.find(modes);
+                    if (it == next.end())
+                        next.emplace(modes, c);
+                    else
+                        it->second += c;
+                }
+            }
+
+            term_norm = 0.0;
+            for (auto it = next.begin(); it != next.end();)
+            {
+                it->second.simplify(options_.drop);
+                if (it->second.size() == 0)
+                {
+                    it = next.erase(it);
+                    continue;
+                }
+                term_norm += it->second.norm();
+                auto target = pieces.find(it->first);
+                if (target == pieces.end())
+                    pieces.emplace(it->first, it->second);
+                else
+                    target->second += it->second;
+                ++it;
+            }
+            stats_.orders = std::max(stats_.orders, k);
+            term.swap(next);
+        }
+    }
+
+    bool UnitaryCoupledCluster::transform(const std::vector<OperatorProduct> &hamiltonian, QubitOperator &result)
+    {
+        static auto &latency = MetaWaveCompiler::util::metrics().histogram(
+            "qc_ucc_transform_seconds", "UnitaryCoupledCluster::transform latency");
+        MetaWaveCompiler::util::ScopedTimer timer(latency);
+
+        stats_ = UccStats();
+        Pieces pieces;
+        for (const auto &product : hamiltonian)
+        {
+            QubitOperator mapped;
+            if (!mapping_.map(product, mapped))
+                return false;
+            pieces[modes_of(product)] += mapped;
+        }
+
+        if (options_.trotter_steps > 0)
+        {
+            // U = (prod_k e^(A_k / n))^n, so the factors act in order
+            const double scale = 1.0 / options_.trotter_steps;
+            for (int step = 0; step < options_.trotter_steps; ++step)
+            {
+                for (const auto &g : generators_)
+                    expand(pieces, {&g}, scale);
+            }
+        }
+        else
+        {
+            std::vector<const Generator *> all;
+            for (const auto &g : generators_)
+                all.push_back(&g);
+            expand(pieces, all, 1.0);
+        }
+
+        result = QubitOperator(mapping_.num_qubits());
+        for (const auto &piece : pieces)
+            result += piece.second;
+        result.simplify(options_.drop);
+        return true;
+    }
+
+} // namespace qc
@@ -0,0 +1,800 @@
+#include "core/autogen_cursor/wigner.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+
+namespace qc
+{
+
+    namespace
+    {
+        enum SymbolKind
+        {
+            THREE_J = 3,
+            SIX_J = 6,
+            NINE_J = 9
+        };
+
+        // Signed integer of arbitrary size, enough for the Racah sums
+        class BigInt
+        {
+        public:
+            std::vector<std::uint32_t> limbs; // magnitude, least significant first
+            bool negative = false;
+
+            BigInt(long long v = 0) : negative(v < 0)
+            {
+                unsigned long long m = v < 0 ? 0ULL - static_cast<unsigned long long>(v) : v;
+                for (; m; m >>= 32)
+                    limbs.push_back(static_cast<std::uint32_t>(m));
+            }
+
+            bool is_zero() const { return limbs.empty(); }
+
+            void multiply(std::uint32_t factor)
+            {
+                std::uint64_t carry = 0;
+                for (auto &limb : limbs)
+                {
+                    carry += static_cast<std::uint64_t>(limb) * factor;
+                    limb = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+                if (carry)
+                    limbs.push_back(static_cast<std::uint32_t>(carry));
+                trim();
+            }
+
+            std::uint32_t remainder(std::uint32_t divisor) const
+            {
+                std::uint64_t rest = 0;
+                for (size_t i = limbs.size(); i-- > 0;)
+                    rest = ((rest << 32) | limbs[i]) % divisor;
+                return static_cast<std::uint32_t>(rest);
+            }
+
+            void divide(std::uint32_t divisor)
+            {
+                std::uint64_t rest = 0;
+                for (size_t i = limbs.size(); i-- > 0;)
+                {
+                    std::uint64_t current = (rest << 32) | limbs[i];
+                    limbs[i] = static_cast<std::uint32_t>(current / divisor);
+                    rest = current % divisor;
+                }
+                trim();
+            }
+
+            BigInt operator*(const BigInt &other) const
+            {
+                BigInt result;
+                if (is_zero() || other.is_zero())
+                    return result;
+                result.limbs.assign(limbs.size() + other.limbs.size(), 0);
+                for (size_t i = 0; i < limbs.size(); ++i)
+                {
+                    std::uint64_t carry = 0;
+                    for (size_t j = 0; j < other.limbs.size(); ++j)
+                    {
+                        carry += result.limbs[i + j] + static_cast<std::uint64_t>(limbs[i]) * other.limbs[j];
+                        result.limbs[i + j] = static_cast<std::uint32_t>(carry);
+                        carry >>= 32;
+                    }
+                    result.limbs[i + other.limbs.size()] = static_cast<std::uint32_t>(carry);
+                }
+                result.negative = negative != other.negative;
+                result.trim();
+                return result;
+            }
+
+            BigInt &operator+=(const BigInt &other)
+            {
+                if (negative == other.negative)
+                {
+                    add_magnitude(other.limbs);
+                }
+                else if (compare_magnitude(limbs, other.limbs) >= 0)
+                {
+                    subtract_magnitude(other.limbs);
+                }
+                else
+                {
+                    std::vector<std::uint32_t> mine = limbs;
+                    limbs = other.limbs;
+                    negative = other.negative;
+                    subtract_magnitude(mine);
+                }
+                trim();
+                return *this;
+            }
+
+            // Natural log of the magnitude
+            long double log_abs() const
+            {
+                long double top = 0.0L;
+                size_t first = limbs.size() > 3 ? limbs.size() - 3 : 0;
+                for (size_t i = limbs.size(); i-- > first;)
+                    top = top * 4294967296.0L + limbs[i];
+                return std::log(top) + static_cast<long double>(32 * first) * std::log(2.0L);
+            }
+
+            std::string to_string() const
+            {
+                if (is_zero())
+                    return "0";
+                BigInt rest = *this;
+                std::string digits;
+                while (!rest.is_zero())
+                {
+                    std::uint32_t chunk = rest.remainder(1000000000u);
+                    rest.divide(1000000000u);
+                    for (int d = 0; d < 9 && (chunk || !rest.is_zero()); ++d, chunk /= 10)
+                        digits.push_back(static_cast<char>('0' + chunk % 10));
+                }
+                if (negative)
+                    digits.push_back('-');
+                return std::string(digits.rbegin(), digits.rend());
+            }
+
+        private:
+            void trim()
+            {
+                while (!limbs.empty() && limbs.back() == 0)
+                    limbs.pop_back();
+                if (limbs.empty())
+                    negative = false;
+            }
+
+            static int compare_magnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b)
+            {
+                if (a.size() != b.size())
+                    return a.size() < b.size() ? -1 : 1;
+                for (size_t i = a.size(); i-- > 0;)
+                {
+                    if (a[i] != b[i])
+                        return a[i] < b[i] ? -1 : 1;
+                }
+                return 0;
+            }
+
+            void add_magnitude(const std::vector<std::uint32_t> &other)
+            {
+                limbs.resize(std::max(limbs.size(), other.size()) + 1, 0);
+                std::uint64_t carry = 0;
+                for (size_t i = 0; i < limbs.size(); ++i)
+                {
+                    carry += static_cast<std::uint64_t>(limbs[i]) + (i < other.size() ? other[i] : 0);
+                    limbs[i] = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+            }
+
+            // |this| -= |other|, with |this| >= |other|
+            void subtract_magnitude(const std::vector<std::uint32_t> &other)
+            {
+                std::int64_t borrow = 0;
+                for (size_t i = 0; i < limbs.size(); ++i)
+                {
+                    std::int64_t diff = static_cast<std::int64_t>(limbs[i]) - (i < other.size() ? other[i] : 0) - borrow;
+                    borrow = diff < 0;
+                    limbs[i] = static_cast<std::uint32_t>(diff + (borrow << 32));
+                }
+            }
+        };
+
+        std::vector<int> primes_up_to(int n)
+        {
+            std::vector<char> composite(std::max(n + 1, 2), 0);
+            std::vector<int> primes;
+            for (int p = 2; p <= n; ++p)
+            {
+                if (composite[p])
+                    continue;
+                primes.push_back(p);
+                for (long q = static_cast<long>(p) * p; q <= n; q += p)
+                    composite[q] = 1;
+            }
+            return primes;
+        }
+
+        std::vector<int> first_primes(size_t count)
+        {
+            std::vector<int> primes;
+            for (int bound = 64; primes.size() < count; bound *= 2)
+                primes = primes_up_to(bound);
+            primes.resize(count);
+            return primes;
+        }
+
+        // exponents += times * (exponents of n!), by Legendre's formula
+        void add_factorial(std::vector<int> &exponents, const std::vector<int> &primes, long n, int times)
+        {
+            for (size_t k = 0; k < primes.size() && primes[k] <= n; ++k)
+            {
+                long count = 0;
+                for (long power = primes[k]; power <= n; power *= primes[k])
+                    count += n / power;
+                exponents[k] += times * static_cast<int>(count);
+            }
+        }
+
+        // value = integer * prod_k p_k^(twice_k / 2)
+        struct Exact
+        {
+            BigInt integer;
+            std::vector<int> twice;
+        };
+
+        // Multiplies by p^power in as few limb passes as fit in 32 bits
+        void multiply_power(BigInt &value, std::uint32_t p, int power)
+        {
+            std::uint64_t factor = 1;
+            for (int r = 0; r < power; ++r)
+            {
+                if (factor * p > 0xffffffffULL)
+                {
+                    value.multiply(static_cast<std::uint32_t>(factor));
+                    factor = 1;
+                }
+                factor *= p;
+            }
+            if (factor > 1)
+                value.multiply(static_cast<std::uint32_t>(factor));
+        }
+
+        // Sum of sign_t * prod_k p_k^(e_tk), with the smallest power of each
+        // prime factored out so that the remaining sum is an integer
+        Exact racah_sum(const std::vector<int> &signs, const std::vector<std::vector<int>> &terms,
+                        const std::vector<int> &primes)
+        {
+            Exact result;
+            result.twice.assign(primes.size(), 0);
+            if (terms.empty())
+                return result;
+            std::vector<int> low(primes.size(), INT_MAX);
+            for (const auto &term : terms)
+            {
+                for (size_t k = 0; k < primes.size(); ++k)
+                    low[k] = std::min(low[k], term[k]);
+            }
+            for (size_t t = 0; t < terms.size(); ++t)
+            {
+                BigInt value(signs[t]);
+                for (size_t k = 0; k < primes.size(); ++k)
+                    multiply_power(value, primes[k], terms[t][k] - low[k]);
+                result.integer += value;
+            }
+            for (size_t k = 0; k < primes.size(); ++k)
+                result.twice[k] = 2 * low[k];
+            return result;
+        }
+
+        // Moves every listed prime out of the integer into the exponents
+        void normalize(Exact &value, const std::vector<int> &primes)
+        {
+            value.twice.resize(std::max(value.twice.size(), primes.size()), 0);
+            if (value.integer.is_zero())
+            {
+                std::fill(value.twice.begin(), value.twice.end(), 0);
+                return;
+            }
+            for (size_t k = 0; k < primes.size(); ++k)
+            {
+                while (value.integer.remainder(primes[k]) == 0)
+                {
+                    value.integer.divide(primes[k]);
+                    value.twice[k] += 2;
+                }
+            }
+        }
+
+        int parity_of(const std::array<int, 3> &perm)
+        {
+            int inversions = 0;
+            for (int a = 0; a < 3; ++a)
+                for (int b = a + 1; b < 3; ++b)
+                    inversions += perm[a] > perm[b];
+            return inversions & 1;
+        }
+
+        const std::vector<std::array<int, 3>> &permutations3()
+        {
+            static const std::vector<std::array<int, 3>> perms = {{{0, 1, 2}}, {{0, 2, 1}}, {{1, 0, 2}},
+                                                                  {{1, 2, 0}}, {{2, 0, 1}}, {{2, 1, 0}}};
+            return perms;
+        }
+
+        const std::vector<std::array<int, 4>> &permutations4()
+        {
+            static const std::vector<std::array<int, 4>> perms = []()
+            {
+                std::vector<std::array<int, 4>> result;
+                std::array<int, 4> perm = {{0, 1, 2, 3}};
+                do
+                    result.push_back(perm);
+                while (std::next_permutation(perm.begin(), perm.end()));
+                return result;
+            }();
+            return perms;
+        }
+
+        // Least arrangement of a 3x3 array under row and column permutations
+        // and transposition; odd is the parity of the permutations applied
+        std::array<int, 9> canonical_square(const std::array<int, 9> &a, int &odd)
+        {
+            std::array<int, 9> best = a;
+            odd = 0;
+            for (int transpose = 0; transpose < 2; ++transpose)
+            {
+                for (const auto &rows : permutations3())
+                {
+                    for (const auto &cols : permutations3())
+                    {
+                        std::array<int, 9> b;
+                        for (int r = 0; r < 3; ++r)
+                            for (int c = 0; c < 3; ++c)
+                                b[3 * r + c] = transpose ? a[3 * cols[c] + rows[r]] : a[3 * rows[r] + cols[c]];
+                        if (b < best)
+                        {
+                            best = b;
+                            odd = parity_of(rows) ^ parity_of(cols);
+                        }
+                    }
+                }
+            }
+            return best;
+        }
+
+        // Least arrangement of a 3x4 array under row and column permutations
+        std::array<int, 12> canonical_bargmann(const std::array<int, 12> &a)
+        {
+            std::array<int, 12> best = a;
+            for (const auto &rows : permutations3())
+            {
+                for (const auto &cols : permutations4())
+                {
+                    std::array<int, 12> b;
+                    for (int r = 0; r < 3; ++r)
+                        for (int c = 0; c < 4; ++c)
+                            b[4 * r + c] = a[4 * rows[r] + cols[c]];
+                    best = std::min(best, b);
+                }
+            }
+            return best;
+        }
+
+        // Triangle rule with an integer perimeter, on doubled momenta
+        bool triad(int a, int b, int c)
+        {
+            return a >= 0 && b >= 0 && c >= 0 && ((a + b + c) & 1) == 0 && c <= a + b && a <= b + c && b <= a + c;
+        }
+
+        long double log_value(const Exact &value, const std::vector<int> &primes)
+        {
+            long double log = value.integer.log_abs();
+            for (size_t k = 0; k < value.twice.size(); ++k)
+                log += 0.5L * value.twice[k] * std::log(static_cast<long double>(primes[k]));
+            return log;
+        }
+    }
+
+    // RecouplingValue implementation
+    std::string RecouplingValue::squared_numerator() const
+    {
+        if (sign_ == 0)
+            return "0";
+        BigInt n;
+        n.limbs = integer_;
+        BigInt result = n * n;
+        std::vector<int> primes = first_primes(exponents_.size());
+        for (size_t k = 0; k < exponents_.size(); ++k)
+            multiply_power(result, primes[k], std::max(0, exponents_[k]));
+        return result.to_string();
+    }
+
+    std::string RecouplingValue::squared_denominator() const
+    {
+        BigInt result(1);
+        std::vector<int> primes = first_primes(exponents_.size());
+        for (size_t k = 0; k < exponents_.size(); ++k)
+            multiply_power(result, primes[k], std::max(0, -exponents_[k]));
+        return result.to_string();
+    }
+
+    bool RecouplingValue::operator==(const RecouplingValue &other) const
+    {
+        if (sign_ != other.sign_ || integer_ != other.integer_)
+            return false;
+        for (size_t k = 0; k < std::max(exponents_.size(), other.exponents_.size()); ++k)
+        {
+            int a = k < exponents_.size() ? exponents_[k] : 0;
+            int b = k < other.exponents_.size() ? other.exponents_[k] : 0;
+            if (a != b)
+                return false;
+        }
+        return true;
+    }
+
+    std::string RecouplingValue::to_string() const
+    {
+        if (sign_ == 0)
+            return "0";
+        std::string num = squared_numerator(), den = squared_denominator();
+        std::string magnitude = den == "1" ? "sqrt(" + num + ")" : "sqrt(" + num + "/" + den + ")";
+        if (magnitude == "sqrt(1)")
+            magnitude = "1";
+        return (sign_ < 0 ? "-" : "") + magnitude;
+    }
+
+    // WignerSymbols implementation
+    std::size_t WignerSymbols::KeyHash::operator()(const Key &key) const
+    {
+        std::size_t seed = 0;
+        for (int entry : key)
+            seed ^= std::hash<int>{}(entry) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+
+    WignerSymbols &WignerSymbols::global()
+    {
+        static WignerSymbols symbols;
+        return symbols;
+    }
+
+    RecouplingValue WignerSymbols::three_j_exact(int two_j1, int two_j2, int two_j3, int two_m1, int two_m2,
+                                                 int two_m3)
+    {
+        const int j[3] = {two_j1, two_j2, two_j3}, m[3] = {two_m1, two_m2, two_m3};
+        if (two_m1 + two_m2 + two_m3 != 0 || !triad(two_j1, two_j2, two_j3))
+            return RecouplingValue();
+        for (int k = 0; k < 3; ++k)
+        {
+            if (std::abs(m[k]) > j[k] || ((j[k] - m[k]) & 1))
+                return RecouplingValue();
+        }
+
+        // Regge square: triangle defects, j - m, j + m (undoubled)
+        std::array<int, 9> square = {{(-j[0] + j[1] + j[2]) / 2, (j[0] - j[1] + j[2]) / 2, (j[0] + j[1] - j[2]) / 2,
+                                      (j[0] - m[0]) / 2, (j[1] - m[1]) / 2, (j[2] - m[2]) / 2,
+                                      (j[0] + m[0]) / 2, (j[1] + m[1]) / 2, (j[2] + m[2]) / 2}};
+        int odd = 0;
+        std::array<int, 9> canonical = canonical_square(square, odd);
+        Key key{};
+        key[0] = THREE_J;
+        std::copy(canonical.begin(), canonical.end(), key.begin() + 1);
+
+        // Odd permutations of rows or columns give (-1)^(j1 + j2 + j3)
+        RecouplingValue value = lookup(key);
+        if (odd && ((j[0] + j[1] + j[2]) / 2) % 2)
+        {
+            value.sign_ = -value.sign_;
+            value.value_ = -value.value_;
+        }
+        return value;
+    }
+
+    RecouplingValue WignerSymbols::six_j_exact(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5,
+                                               int two_j6)
+    {
+        const int a = two_j1, b = two_j2, c = two_j3, d = two_j4, e = two_j5, f = two_j6;
+        if (!triad(a, b, c) || !triad(a, e, f) || !triad(d, b, f) || !triad(d, e, c))
+            return RecouplingValue();
+
+        // Bargmann array beta_i - alpha_j over the triads alpha and the
+        // quadrangles beta (undoubled)
+        const int alpha[4] = {(a + b + c) / 2, (a + e + f) / 2, (d + b + f) / 2, (d + e + c) / 2};
+        const int beta[3] = {(a + b + d + e) / 2, (a + c + d + f) / 2, (b + c + e + f) / 2};
+        std::array<int, 12> array;
+        for (int r = 0; r < 3; ++r)
+            for (int s = 0; s < 4; ++s)
+                array[4 * r + s] = beta[r] - alpha[s];
+
+        std::array<int, 12> canonical = canonical_bargmann(array);
+        Key key{};
+        key[0] = SIX_J;
+        std::copy(canonical.begin(), canonical.end(), key.begin() + 1);
+        return lookup(key);
+    }
+
+    RecouplingValue WignerSymbols::nine_j_exact(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5,
+                                                int two_j6, int two_j7, int two_j8, int two_j9)
+    {
+        std::array<int, 9> square = {{two_j1, two_j2, two_j3, two_j4, two_j5, two_j6, two_j7, two_j8, two_j9}};
+        for (int k = 0; k < 3; ++k)
+        {
+            if (!triad(square[3 * k], square[3 * k + 1], square[3 * k + 2]) ||
+                !triad(square[k], square[k + 3], square[k + 6]))
+                return RecouplingValue();
+        }
+
+        int odd = 0;
+        std::array<int, 9> canonical = canonical_square(square, odd);
+        Key key{};
+        key[0] = NINE_J;
+        std::copy(canonical.begin(), canonical.end(), key.begin() + 1);
+
+        // Odd permutations of rows or columns give (-1)^(sum of all j)
+        RecouplingValue value = lookup(key);
+        int total = 0;
+        for (int j : square)
+            total += j;
+        if (odd && (total / 2) % 2)
+        {
+            value.sign_ = -value.sign_;
+            value.value_ = -value.value_;
+        }
+        return value;
+    }
+
+    RecouplingValue WignerSymbols::lookup(const Key &key)
+    {
+        static auto &hits = MetaWaveCompiler::util::metrics().counter(
+            "qc_cache_hits_total", "Lookups served from a cache", "cache=\"wigner\"");
+        static auto &misses = MetaWaveCompiler::util::metrics().counter(
+            "qc_cache_misses_total", "Lookups that computed their entry", "cache=\"wigner\"");
+        static auto &entries = MetaWaveCompiler::util::metrics().gauge(
+            "qc_cache_entries", "Entries held by a cache", "cache=\"wigner\"");
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = cache_.find(key);
+            if (it != cache_.end())
+            {
+                ++hits_;
+                hits.inc();
+                return it->second;
+            }
+        }
+        ++misses_;
+        misses.inc();
+        RecouplingValue value = compute(key);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto inserted = cache_.emplace(key, value);
+        if (inserted.second)
+            entries.add(1.0);
+        return inserted.first->second;
+    }
+
+    RecouplingValue WignerSymbols::compute(const Key &key)
+    {
+        Exact exact;
+        std::vector<int> primes;
+
+        if (key[0] == THREE_J)
+        {
+            // Racah formula on (j, m) recovered from the Regge square
+            int j[3], m[3], total = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                j[k] = key[1 + 3 + k] + key[1 + 6 + k]; // doubled
+                m[k] = key[1 + 6 + k] - key[1 + 3 + k];
+                total += key[1 + k];
+            }
+            primes = primes_up_to(total + 1);
+            std::vector<int> prefactor(primes.size(), 0);
+            for (int k = 0; k < 9; ++k)
+                add_factorial(prefactor, primes, key[1 + k], 1);
+            add_factorial(prefactor, primes, total + 1, -1);
+
+            const int p = (j[2] - j[1] + m[0]) / 2, q = (j[2] - j[0] - m[1]) / 2, r = (j[0] + j[1] - j[2]) / 2;
+            const int s = (j[0] - m[0]) / 2, t = (j[1] + m[1]) / 2;
+            std::vector<int> signs;
+            std::vector<std::vector<int>> terms;
+            for (int k = std::max({0, -p, -q}); k <= std::min({r, s, t}); ++k)
+            {
+                std::vector<int> term(primes.size(), 0);
+                for (int n : {k, p + k, q + k, r - k, s - k, t - k})
+                    add_factorial(term, primes, n, -1);
+                signs.push_back(k % 2 ? -1 : 1);
+                terms.push_back(term);
+            }
+            exact = racah_sum(signs, terms, primes);
+            for (size_t k = 0; k < primes.size(); ++k)
+                exact.twice[k] += prefactor[k];
+            if ((((j[0] - j[1] - m[2]) / 2) % 2 + 2) % 2)
+                exact.integer = exact.integer * BigInt(-1);
+        }
+        else if (key[0] == SIX_J)
+        {
+            // Racah formula on the Bargmann array R_ij = beta_i - alpha_j
+            int total = 0, first_row = 0;
+            for (int k = 0; k < 12; ++k)
+                total += key[1 + k];
+            for (int s = 0; s < 4; ++s)
+                first_row += key[1 + s];
+            int alpha[4], beta[3];
+            const int beta0 = (total + first_row) / 4;
+            for (int s = 0; s < 4; ++s)
+                alpha[s] = beta0 - key[1 + s];
+            for (int r = 0; r < 3; ++r)
+                beta[r] = key[1 + 4 * r] + alpha[0];
+
+            const int high = *std::max_element(beta, beta + 3);
+            primes = primes_up_to(high + 1);
+            std::vector<int> prefactor(primes.size(), 0);
+            for (int k = 0; k < 12; ++k)
+                add_factorial(prefactor, primes, key[1 + k], 1);
+            for (int s = 0; s < 4; ++s)
+                add_factorial(prefactor, primes, alpha[s] + 1, -1);
+
+            std::vector<int> signs;
+            std::vector<std::vector<int>> terms;
+            for (int t = *std::max_element(alpha, alpha + 4); t <= *std::min_element(beta, beta + 3); ++t)
+            {
+                std::vector<int> term(primes.size(), 0);
+                add_factorial(term, primes, t + 1, 1);
+                for (int s = 0; s < 4; ++s)
+                    add_factorial(term, primes, t - alpha[s], -1);
+                for (int r = 0; r < 3; ++r)
+                    add_factorial(term, primes, beta[r] - t, -1);
+                signs.push_back(t % 2 ? -1 : 1);
+                terms.push_back(term);
+            }
+            exact = racah_sum(signs, terms, primes);
+            for (size_t k = 0; k < primes.size(); ++k)
+                exact.twice[k] += prefactor[k];
+        }
+        else
+        {
+            // Sum over x of (-1)^2x (2x + 1) {a b c; f i x} {d e f; b x h} {g h i; x a d}
+            const int a = key[1], b = key[2], c = key[3], d = key[4], e = key[5], f = key[6], g = key[7],
+                      h = key[8], i = key[9];
+            int total = 0;
+            for (int k = 1; k <= 9; ++k)
+                total += key[k];
+            primes = primes_up_to(total + 2);
+
+            std::vector<Exact> parts;
+            std::vector<int> low(primes.size(), INT_MAX);
+            const int x_min = std::max({std::abs(a - i), std::abs(d - h), std::abs(b - f)});
+            const int x_max = std::min({a + i, d + h, b + f});
+            for (int x = x_min; x <= x_max; x += 2)
+            {
+                RecouplingValue factors[3] = {six_j_exact(a, b, c, f, i, x), six_j_exact(d, e, f, b, x, h),
+                                              six_j_exact(g, h, i, x, a, d)};
+                Exact part;
+                part.integer = BigInt(x % 2 ? -(x + 1) : (x + 1));
+                part.twice.assign(primes.size(), 0);
+                for (const auto &factor : factors)
+                {
+                    BigInt n;
+                    n.limbs = factor.integer_;
+                    n.negative = factor.sign_ < 0;
+                    part.integer = part.integer * n;
+                    for (size_t k = 0; k < factor.exponents_.size(); ++k)
+                        part.twice[k] += factor.exponents_[k];
+                }
+                if (part.integer.is_zero())
+                    continue;
+                for (size_t k = 0; k < primes.size(); ++k)
+                    low[k] = std::min(low[k], part.twice[k]);
+                parts.push_back(part);
+            }
+
+            // The terms share their irrational part, so the exponents
+            // differ by even amounts
+            exact.twice.assign(primes.size(), 0);
+            for (const auto &part : parts)
+            {
+                BigInt term = part.integer;
+                for (size_t k = 0; k < primes.size(); ++k)
+                    multiply_power(term, primes[k], (part.twice[k] - low[k]) / 2);
+                exact.integer += term;
+            }
+            for (size_t k = 0; k < primes.size() && !parts.empty(); ++k)
+                exact.twice[k] = low[k];
+        }
+
+        normalize(exact, primes);
+        RecouplingValue value;
+        if (exact.integer.is_zero())
+            return value;
+        value.sign_ = exact.integer.negative ? -1 : 1;
+        value.integer_ = exact.integer.limbs;
+        value.exponents_ = exact.twice;
+        while (!value.exponents_.empty() && value.exponents_.back() == 0)
+            value.exponents_.pop_back();
+        value.value_ = static_cast<double>(value.sign_ * std::exp(log_value(exact, primes)));
+        return value;
+    }
+
+    double WignerSymbols::three_j(int two_j1, int two_j2, int two_j3, int two_m1, int two_m2, int two_m3)
+    {
+        return three_j_exact(two_j1, two_j2, two_j3, two_m1, two_m2, two_m3).value();
+    }
+
+    double WignerSymbols::six_j(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5, int two_j6)
+    {
+        return six_j_exact(two_j1, two_j2, two_j3, two_j4, two_j5, two_j6).value();
+    }
+
+    double WignerSymbols::nine_j(int two_j1, int two_j2, int two_j3, int two_j4, int two_j5, int two_j6,
+                                 int two_j7, int two_j8, int two_j9)
+    {
+        return nine_j_exact(two_j1, two_j2, two_j3, two_j4, two_j5, two_j6, two_j7, two_j8, two_j9).value();
+    }
+
+    std::vector<double> WignerSymbols::three_j(const std::vector<std::array<int, 6>> &arguments)
+    {
+        std::vector<double> result(arguments.size());
+        const long n = static_cast<long>(arguments.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (long t = 0; t < n; ++t)
+        {
+            const auto &x = arguments[t];
+            result[t] = three_j(x[0], x[1], x[2], x[3], x[4], x[5]);
+        }
+        return result;
+    }
+
+    std::vector<double> WignerSymbols::six_j(const std::vector<std::array<int, 6>> &arguments)
+    {
+        std::vector<double> result(arguments.size());
+        const long n = static_cast<long>(arguments.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (long t = 0; t < n; ++t)
+        {
+            const auto &x = arguments[t];
+            result[t] = six_j(x[0], x[1], x[2], x[3], x[4], x[5]);
+        }
+        return result;
+    }
+
+    std::vector<double> WignerSymbols::nine_j(const std::vector<std::array<int, 9>> &arguments)
+    {
+        std::vector<double> result(arguments.size());
+        const long n = static_cast<long>(arguments.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for (long t = 0; t < n; ++t)
+        {
+            const auto &x = arguments[t];
+            result[t] = nine_j(x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7], x[8]);
+        }
+        return result;
+    }
+
+    double WignerSymbols::clebsch_gordan(int two_j1, int two_m1, int two_j2, int two_m2, int two_J, int two_M)
+    {
+        // (-1)^(j1 - j2 + M) sqrt(2J + 1) (j1 j2 J; m1 m2 -M)
+        double value = three_j(two_j1, two_j2, two_J, two_m1, two_m2, -two_M);
+        if (value == 0.0)
+            return 0.0;
+        int phase = ((two_j1 - two_j2 + two_M) / 2) % 2;
+        return (phase ? -1.0 : 1.0) * std::sqrt(two_J + 1.0) * value;
+    }
+
+    double WignerSymbols::ladder_element(int two_j, int two_m, int step)
+    {
+        // sqrt(j (j + 1) - m (m + step)) in doubled units
+        if (std::abs(two_m) > two_j || ((two_j - two_m) & 1) || std::abs(two_m + 2 * step) > two_j)
+            return 0.0;
+        return 0.5 * std::sqrt(static_cast<double>(two_j * (two_j + 2) - two_m * (two_m + 2 * step)));
+    }
+
+    size_t WignerSymbols::cache_size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return cache_.size();
+    }
+
+    void WignerSymbols::clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        MetaWaveCompiler::util::metrics()
+            .gauge("qc_cache_entries", "Entries held by a cache", "cache=\"wigner\"")
+            .add(-static_cast<double>(cache_.size()));
+        cache_.clear();
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+} // namespace qc
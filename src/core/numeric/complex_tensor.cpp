@@ -0,0 +1,35 @@
+#include "core/numeric/complex_tensor.h"
+
+namespace qc
+{
+
+    ComplexTensor::ComplexTensor(const std::vector<long> &shape, Field field) : field_(field), shape_(shape)
+    {
+        if (has_real())
+            real_ = DenseTensor(shape);
+        if (has_imag())
+            imag_ = DenseTensor(shape);
+    }
+
+    std::complex<double> ComplexTensor::operator()(const std::vector<long> &index) const
+    {
+        return {has_real() ? real_(index) : 0.0, has_imag() ? imag_(index) : 0.0};
+    }
+
+    void ComplexTensor::set(const std::vector<long> &index, std::complex<double> value)
+    {
+        if (has_real())
+            real_(index) = value.real();
+        if (has_imag())
+            imag_(index) = value.imag();
+    }
+
+    void ComplexTensor::fill(std::complex<double> value)
+    {
+        if (has_real())
+            real_.fill(value.real());
+        if (has_imag())
+            imag_.fill(value.imag());
+    }
+
+} // namespace qc
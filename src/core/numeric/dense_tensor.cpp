@@ -0,0 +1,47 @@
+#include "core/numeric/dense_tensor.h"
+#include <algorithm>
+
+namespace qc
+{
+
+    DenseTensor::DenseTensor(const std::vector<long> &shape, double value)
+        : shape_(shape), strides_(shape.size(), 1)
+    {
+        long size = 1;
+        for (size_t d = shape_.size(); d-- > 0;)
+        {
+            strides_[d] = size;
+            size *= shape_[d];
+        }
+        data_.assign(size, value);
+    }
+
+    DenseTensor DenseTensor::uninitialized(const std::vector<long> &shape)
+    {
+        DenseTensor result;
+        result.shape_ = shape;
+        result.strides_.assign(shape.size(), 1);
+        long size = 1;
+        for (size_t d = shape.size(); d-- > 0;)
+        {
+            result.strides_[d] = size;
+            size *= shape[d];
+        }
+        result.data_.resize(size);
+        return result;
+    }
+
+    long DenseTensor::offset(const std::vector<long> &index) const
+    {
+        long result = 0;
+        for (size_t d = 0; d < index.size() && d < strides_.size(); ++d)
+            result += index[d] * strides_[d];
+        return result;
+    }
+
+    void DenseTensor::fill(double value)
+    {
+        std::fill(data_.begin(), data_.end(), value);
+    }
+
+} // namespace qc
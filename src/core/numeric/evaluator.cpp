@@ -0,0 +1,466 @@
+#include "core/numeric/evaluator.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/autogen_cursor/delta_elimination.h"
+#include "core/autogen_cursor/layout.h"
+#include "core/autogen_cursor/kramers.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <map>
+
+namespace qc
+{
+
+    namespace
+    {
+        // Advances a multi-index over `extents`; false once it wraps around
+        bool next(std::vector<long> &values, const std::vector<long> &extents)
+        {
+            for (size_t d = values.size(); d-- > 0;)
+            {
+                if (++values[d] < extents[d])
+                    return true;
+                values[d] = 0;
+            }
+            return false;
+        }
+
+        long dot(const std::vector<long> &strides, const std::vector<long> &values)
+        {
+            long result = 0;
+            for (size_t d = 0; d < values.size(); ++d)
+                result += strides[d] * values[d];
+            return result;
+        }
+    }
+
+    void Evaluator::bind(const std::string &name, const DenseTensor &tensor)
+    {
+        complex_inputs_.erase(name);
+        inputs_[name] = &tensor;
+    }
+
+    void Evaluator::bind(const std::string &name, const ComplexTensor &tensor)
+    {
+        // Real tensors take the real kernels directly
+        if (tensor.field() == Field::REAL)
+        {
+            complex_inputs_.erase(name);
+            bind(name, tensor.real());
+            return;
+        }
+        inputs_.erase(name);
+        complex_inputs_[name] = &tensor;
+    }
+
+    void Evaluator::add_implicit(const ImplicitTensor &tensor)
+    {
+        implicit_.erase(tensor.name());
+        implicit_.emplace(tensor.name(), tensor);
+    }
+
+    void Evaluator::set_diagonal(int space, const DenseTensor &diagonal)
+    {
+        diagonals_[space] = diagonal.data();
+    }
+
+    bool Evaluator::is_bound(const std::string &name) const
+    {
+        return inputs_.count(name) > 0 || complex_inputs_.count(name) > 0;
+    }
+
+    const ImplicitTensor *Evaluator::find_implicit(const std::string &name) const
+    {
+        auto it = implicit_.find(name);
+        return it == implicit_.end() ? nullptr : &it->second;
+    }
+
+    // Loop structure and operand strides of one term against a given output
+    struct Evaluator::PreparedTerm
+    {
+        struct Operand
+        {
+            const DenseTensor *tensor = nullptr;
+            const ImplicitTensor *implicit = nullptr;
+            std::vector<std::string> labels;
+            bool external_only = true;
+        };
+
+        double prefactor = 1.0;
+        bool vanished = false; // no contribution at all
+        std::vector<std::string> external, summed;
+        std::vector<Operand> operands;
+        std::vector<std::vector<long>> external_strides, summed_strides;
+        std::vector<long> summed_extents;
+    };
+
+    bool Evaluator::prepare(const ContractionTerm &input, const DenseTensor &output, PreparedTerm &prepared,
+                            const std::vector<const DenseTensor *> *parts) const
+    {
+        // The output is bound in memory order, as inputs are, so a transposed
+        // output view loops over its storage order
+        ContractionTerm term = input;
+        term.set_output(LayoutPropagation::storage_view(input.output()));
+        if (KroneckerDeltaElimination::apply(term) == KroneckerDeltaElimination::Result::VANISHED)
+        {
+            prepared.vanished = true;
+            return true;
+        }
+        prepared.prefactor = term.prefactor();
+
+        // Loop labels: external (output memory order) then summed
+        std::vector<std::string> &external = prepared.external, &summed = prepared.summed;
+        for (const auto &idx : term.external_indices())
+            external.push_back(idx->label());
+        for (const auto &idx : term.summed_indices())
+            summed.push_back(idx->label());
+        if (output.rank() != external.size())
+            return false;
+
+        std::map<std::string, long> extents;
+        auto record = [&extents](const std::string &label, long extent)
+        {
+            auto it = extents.find(label);
+            if (it == extents.end())
+            {
+                extents[label] = extent;
+                return true;
+            }
+            return it->second == extent;
+        };
+        for (size_t d = 0; d < external.size(); ++d)
+        {
+            if (!record(external[d], output.extent(d)))
+                return false;
+        }
+
+        using Operand = PreparedTerm::Operand;
+        std::vector<Operand> &operands = prepared.operands;
+        for (size_t f = 0; f < term.num_factors(); ++f)
+        {
+            // Bound data is in memory order, which differs for transposed views
+            const Tensor &factor = term.factor(f);
+            Operand op;
+            op.implicit = find_implicit(factor.symbol().name());
+            Tensor stored = op.implicit ? factor : LayoutPropagation::storage_view(factor);
+            for (const auto &idx : stored.indices())
+            {
+                op.labels.push_back(idx->label());
+                if (term.is_summed(idx->label()))
+                    op.external_only = false;
+            }
+            if (op.implicit)
+            {
+                for (int space : op.implicit->source_spaces())
+                {
+                    if (!diagonals_.count(space))
+                        return false;
+                }
+            }
+            else
+            {
+                if (parts && f < parts->size() && (*parts)[f])
+                {
+                    op.tensor = (*parts)[f];
+                }
+                else
+                {
+                    auto it = inputs_.find(KramersSymmetry::storage_name(factor));
+                    if (it == inputs_.end())
+                        return false;
+                    op.tensor = it->second;
+                }
+                if (op.tensor->rank() != op.labels.size())
+                    return false;
+                for (size_t d = 0; d < op.labels.size(); ++d)
+                {
+                    if (!record(op.labels[d], op.tensor->extent(d)))
+                        return false;
+                }
+            }
+            operands.push_back(op);
+        }
+
+        // Labels carried by implicit factors alone take their registry size
+        const auto &registry = SpaceRegistry::global();
+        for (const auto &factor : term.factors())
+        {
+            for (const auto &idx : factor.indices())
+            {
+                if (!extents.count(idx->label()))
+                {
+                    long dim = registry.dimension(*idx);
+                    if (dim < 0)
+                        return false;
+                    extents[idx->label()] = dim;
+                }
+            }
+        }
+
+        // Per-operand strides over the external and summed loop labels; a
+        // repeated label (a diagonal) accumulates its strides
+        auto strides_over = [](const Operand &op, const std::vector<std::string> &labels)
+        {
+            std::vector<long> strides(labels.size(), 0);
+            if (!op.tensor)
+                return strides;
+            for (size_t d = 0; d < op.labels.size(); ++d)
+            {
+                for (size_t l = 0; l < labels.size(); ++l)
+                {
+                    if (labels[l] == op.labels[d])
+                        strides[l] += op.tensor->strides()[d];
+                }
+            }
+            return strides;
+        };
+        for (const auto &op : operands)
+        {
+            prepared.external_strides.push_back(strides_over(op, external));
+            prepared.summed_strides.push_back(strides_over(op, summed));
+        }
+
+        for (const auto &label : summed)
+        {
+            prepared.summed_extents.push_back(extents[label]);
+            if (extents[label] == 0)
+                prepared.vanished = true;
+        }
+        return true;
+    }
+
+    double Evaluator::contribution(const PreparedTerm &prepared, const std::vector<long> &ext_values,
+                                   std::vector<long> &sum_values) const
+    {
+        // Values of an implicit operand's slots at the current loop point
+        auto implicit_value = [&](const PreparedTerm::Operand &op)
+        {
+            std::vector<long> values;
+            for (const auto &label : op.labels)
+            {
+                long value = 0;
+                for (size_t l = 0; l < prepared.external.size(); ++l)
+                {
+                    if (prepared.external[l] == label)
+                        value = ext_values[l];
+                }
+                for (size_t l = 0; l < prepared.summed.size(); ++l)
+                {
+                    if (prepared.summed[l] == label)
+                        value = sum_values[l];
+                }
+                values.push_back(value);
+            }
+            return op.implicit->element(values, diagonals_);
+        };
+
+        // Epilogue: external-only implicit factors scale the finished sum
+        const auto &operands = prepared.operands;
+        double scale = prepared.prefactor;
+        std::vector<long> base(operands.size(), 0);
+        sum_values.assign(prepared.summed.size(), 0);
+        for (size_t f = 0; f < operands.size(); ++f)
+        {
+            if (operands[f].implicit && operands[f].external_only)
+                scale *= implicit_value(operands[f]);
+            base[f] = dot(prepared.external_strides[f], ext_values);
+        }
+
+        double acc = 0.0;
+        do
+        {
+            double product = 1.0;
+            for (size_t f = 0; f < operands.size(); ++f)
+            {
+                const auto &op = operands[f];
+                if (op.tensor)
+                    product *= op.tensor->data()[base[f] + dot(prepared.summed_strides[f], sum_values)];
+                else if (!op.external_only)
+                    product *= implicit_value(op);
+            }
+            acc += product;
+        } while (next(sum_values, prepared.summed_extents));
+        return scale * acc;
+    }
+
+    bool Evaluator::evaluate(const ContractionTerm &term, DenseTensor &output, size_t threads) const
+    {
+        return evaluate(std::vector<ContractionTerm>{term}, output, threads);
+    }
+
+    bool Evaluator::evaluate(const std::vector<ContractionTerm> &terms, DenseTensor &output, size_t threads) const
+    {
+        static auto &calls = MetaWaveCompiler::util::metrics().counter(
+            "qc_evaluate_terms_total", "Contraction terms evaluated numerically");
+        static auto &latency = MetaWaveCompiler::util::metrics().histogram(
+            "qc_evaluate_seconds", "Evaluator::evaluate latency");
+        calls.inc(terms.size());
+        MetaWaveCompiler::util::ScopedTimer timer(latency);
+
+        std::vector<PreparedTerm> prepared;
+        for (const auto &term : terms)
+        {
+            PreparedTerm p;
+            if (!prepare(term, output, p))
+                return false;
+            if (!p.vanished)
+                prepared.push_back(p);
+        }
+        run(prepared, output, threads);
+        return true;
+    }
+
+    void Evaluator::run(const std::vector<PreparedTerm> &prepared, DenseTensor &output, size_t threads) const
+    {
+        if (prepared.empty() || output.size() == 0)
+            return;
+
+        // Each sweep owns the output elements [begin, end) in row-major order
+        // and writes each of them once, after all terms have contributed
+        const std::vector<long> &shape = output.shape();
+        auto sweep = [&](long begin, long end)
+        {
+            std::vector<long> ext_values(shape.size(), 0);
+            std::vector<long> sum_values;
+            for (size_t d = shape.size(), rest = static_cast<size_t>(begin); d-- > 0;)
+            {
+                ext_values[d] = static_cast<long>(rest % shape[d]);
+                rest /= shape[d];
+            }
+            for (long e = begin; e < end; ++e, next(ext_values, shape))
+            {
+                double value = 0.0;
+                for (const auto &p : prepared)
+                    value += contribution(p, ext_values, sum_values);
+                output.data()[e] += value;
+            }
+        };
+
+        long total = output.size();
+        long n_threads = std::max(1L, std::min(static_cast<long>(threads), total));
+        if (placement_ != NumaPolicy::LOCAL && n_threads > 1)
+        {
+            NumaPlacement::parallel_for(output.data(), total, placement_, n_threads, sweep);
+            return;
+        }
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_threads) schedule(static) if (n_threads > 1)
+#endif
+        for (long t = 0; t < n_threads; ++t)
+            sweep(total * t / n_threads, total * (t + 1) / n_threads);
+    }
+
+    bool Evaluator::evaluate(const ContractionTerm &input, ComplexTensor &output, size_t threads) const
+    {
+        ContractionTerm term = input;
+        if (KroneckerDeltaElimination::apply(term) == KroneckerDeltaElimination::Result::VANISHED)
+            return true;
+
+        // Parts of the factors bound as complex or imaginary tensors
+        struct Parts
+        {
+            const DenseTensor *real = nullptr, *imag = nullptr;
+            double imag_sign = 1.0; // -1 for a conjugated factor
+        };
+        std::vector<Parts> parts(term.num_factors());
+        std::vector<size_t> complex_factors;
+        for (size_t f = 0; f < term.num_factors(); ++f)
+        {
+            const Tensor &factor = term.factor(f);
+            auto it = complex_inputs_.find(KramersSymmetry::storage_name(factor));
+            if (it == complex_inputs_.end() || find_implicit(factor.symbol().name()))
+                continue;
+            const ComplexTensor &tensor = *it->second;
+            parts[f].real = tensor.has_real() ? &tensor.real() : nullptr;
+            parts[f].imag = tensor.has_imag() ? &tensor.imag() : nullptr;
+            parts[f].imag_sign = factor.get_property("conjugate") == "true" ? -1.0 : 1.0;
+            complex_factors.push_back(f);
+        }
+
+        if (complex_factors.empty())
+            return output.has_real() && evaluate(term, output.real(), threads);
+        if (complex_factors.size() >= 31)
+            return false;
+
+        std::vector<const DenseTensor *> chosen(term.num_factors(), nullptr);
+        const size_t a = complex_factors[0], b = complex_factors.back();
+        bool three_m = complex_factors.size() == 2 && parts[a].real && parts[a].imag && parts[b].real &&
+                       parts[b].imag && output.has_real() && output.has_imag() && !term.summed_indices().empty();
+        if (three_m)
+        {
+            // (a + i b)(c + i d) = ac - bd + i ((a + b)(c + d) - ac - bd)
+            auto combined = [](const Parts &p)
+            {
+                DenseTensor result = DenseTensor::uninitialized(p.real->shape());
+                for (long e = 0; e < result.size(); ++e)
+                    result.data()[e] = p.real->data()[e] + p.imag_sign * p.imag->data()[e];
+                return result;
+            };
+            DenseTensor sum_a = combined(parts[a]), sum_b = combined(parts[b]);
+            DenseTensor ac(output.shape()), bd(output.shape());
+            PreparedTerm p_ac, p_bd, p_sum;
+            chosen[a] = parts[a].real, chosen[b] = parts[b].real;
+            if (!prepare(term, ac, p_ac, &chosen))
+                return false;
+            chosen[a] = parts[a].imag, chosen[b] = parts[b].imag;
+            if (!prepare(term, bd, p_bd, &chosen))
+                return false;
+            chosen[a] = &sum_a, chosen[b] = &sum_b;
+            if (!prepare(term, output.imag(), p_sum, &chosen))
+                return false;
+            if (p_ac.vanished)
+                return true;
+            p_bd.prefactor *= parts[a].imag_sign * parts[b].imag_sign;
+
+            run({p_ac}, ac, threads);
+            run({p_bd}, bd, threads);
+            run({p_sum}, output.imag(), threads);
+            double *re = output.real().data(), *im = output.imag().data();
+            for (long e = 0; e < ac.size(); ++e)
+            {
+                re[e] += ac.data()[e] - bd.data()[e];
+                im[e] -= ac.data()[e] + bd.data()[e];
+            }
+            return true;
+        }
+
+        // One real contraction per choice of parts; i^k sends odd k to the
+        // imaginary part of the output
+        std::vector<PreparedTerm> real_terms, imag_terms;
+        for (std::uint64_t mask = 0; mask < (std::uint64_t(1) << complex_factors.size()); ++mask)
+        {
+            bool present = true;
+            int units = 0;
+            double sign = 1.0;
+            for (size_t j = 0; j < complex_factors.size() && present; ++j)
+            {
+                const Parts &p = parts[complex_factors[j]];
+                bool imag = mask >> j & 1;
+                chosen[complex_factors[j]] = imag ? p.imag : p.real;
+                present = chosen[complex_factors[j]] != nullptr;
+                if (imag)
+                {
+                    ++units;
+                    sign *= p.imag_sign;
+                }
+            }
+            if (!present)
+                continue;
+            if (units % 4 >= 2)
+                sign = -sign;
+            bool to_imag = units % 2;
+            if (to_imag ? !output.has_imag() : !output.has_real())
+                return false;
+            PreparedTerm p;
+            if (!prepare(term, to_imag ? output.imag() : output.real(), p, &chosen))
+                return false;
+            if (p.vanished)
+                continue;
+            p.prefactor *= sign;
+            (to_imag ? imag_terms : real_terms).push_back(p);
+        }
+        run(real_terms, output.real(), threads);
+        run(imag_terms, output.imag(), threads);
+        return true;
+    }
+
+} // namespace qc
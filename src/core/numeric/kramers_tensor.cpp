@@ -0,0 +1,142 @@
+#include "core/numeric/kramers_tensor.h"
+#include "core/autogen_cursor/kramers.h"
+#include <limits>
+
+namespace qc
+{
+
+    namespace
+    {
+        bool next(std::vector<long> &values, const std::vector<long> &extents)
+        {
+            for (size_t d = values.size(); d-- > 0;)
+            {
+                if (++values[d] < extents[d])
+                    return true;
+                values[d] = 0;
+            }
+            return false;
+        }
+
+        // Index of the spinor tensor element (index, pattern)
+        std::vector<long> spinor_index(const std::vector<long> &index, std::uint64_t pattern,
+                                       const std::vector<long> &shape)
+        {
+            std::vector<long> result(index);
+            for (size_t d = 0; d < shape.size(); ++d)
+            {
+                if (pattern >> d & 1)
+                    result[d] += shape[d];
+            }
+            return result;
+        }
+
+        bool empty_shape(const std::vector<long> &shape)
+        {
+            for (long extent : shape)
+            {
+                if (extent <= 0)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    KramersTensor::KramersTensor(const std::vector<long> &shape) : shape_(shape)
+    {
+        blocks_.assign(KramersSymmetry::num_unique_blocks(shape.size()), ComplexTensor(shape));
+    }
+
+    bool KramersTensor::from_spinor(const ComplexTensor &spinor, KramersTensor &result)
+    {
+        std::vector<long> shape(spinor.shape());
+        for (auto &extent : shape)
+        {
+            if (extent % 2)
+                return false;
+            extent /= 2;
+        }
+        result = KramersTensor(shape);
+        if (empty_shape(shape))
+            return true;
+        for (size_t b = 0; b < result.blocks_.size(); ++b)
+        {
+            const std::uint64_t pattern = std::uint64_t(b) << 1;
+            ComplexTensor &block = result.blocks_[b];
+            std::vector<long> index(shape.size(), 0);
+            do
+            {
+                block.set(index, spinor(spinor_index(index, pattern, shape)));
+            } while (next(index, shape));
+        }
+        return true;
+    }
+
+    ComplexTensor KramersTensor::to_spinor() const
+    {
+        std::vector<long> full(shape_);
+        for (auto &extent : full)
+            extent *= 2;
+        ComplexTensor result(full);
+        if (empty_shape(shape_) || shape_.size() >= 64)
+            return result;
+        for (std::uint64_t pattern = 0; pattern < (std::uint64_t(1) << shape_.size()); ++pattern)
+        {
+            std::vector<long> index(shape_.size(), 0);
+            do
+            {
+                result.set(spinor_index(index, pattern, shape_), element(index, pattern));
+            } while (next(index, shape_));
+        }
+        return result;
+    }
+
+    long KramersTensor::size() const
+    {
+        long result = 0;
+        for (const auto &block : blocks_)
+            result += block.real().size();
+        return result;
+    }
+
+    ComplexTensor *KramersTensor::block(std::uint64_t pattern)
+    {
+        if (!KramersSymmetry::is_canonical(pattern) || !in_range(pattern))
+            return nullptr;
+        return &blocks_[pattern >> 1];
+    }
+
+    const ComplexTensor *KramersTensor::block(std::uint64_t pattern) const
+    {
+        if (!KramersSymmetry::is_canonical(pattern) || !in_range(pattern))
+            return nullptr;
+        return &blocks_[pattern >> 1];
+    }
+
+    std::complex<double> KramersTensor::element(const std::vector<long> &index, std::uint64_t pattern) const
+    {
+        if (!in_range(pattern))
+            return std::numeric_limits<double>::quiet_NaN();
+        if (KramersSymmetry::is_canonical(pattern))
+            return (*block(pattern))(index);
+
+        // T[m] = (-1)^|m| conj(T[~m])
+        const std::uint64_t all = rank() >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << rank()) - 1;
+        const std::uint64_t partner = ~pattern & all;
+        int bits = 0;
+        for (std::uint64_t m = pattern; m; m &= m - 1)
+            ++bits;
+        const std::complex<double> value = std::conj((*block(partner))(index));
+        return bits % 2 ? -value : value;
+    }
+
+    void KramersTensor::bind(Evaluator &evaluator, const std::string &name) const
+    {
+        for (size_t b = 0; b < blocks_.size(); ++b)
+        {
+            const std::string block = KramersSymmetry::block_label(std::uint64_t(b) << 1, rank());
+            evaluator.bind(KramersSymmetry::storage_name(name, block), blocks_[b]);
+        }
+    }
+
+} // namespace qc
@@ -0,0 +1,331 @@
+#include "core/numeric/numa.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace qc
+{
+
+    namespace
+    {
+        std::mutex stats_mutex;
+        NumaStats global_stats;
+
+        long page_bytes()
+        {
+#ifdef __linux__
+            static const long bytes = std::max(4096L, sysconf(_SC_PAGESIZE));
+#else
+            static const long bytes = 4096;
+#endif
+            return bytes;
+        }
+
+        // Pages spanned by an array, counted from the page holding data[0].
+        // An element belongs to the page holding its first byte.
+        struct PageSpan
+        {
+            std::uintptr_t address;
+            std::uintptr_t first_page;
+            long count;
+            long size;
+
+            PageSpan(const double *data, long n) : address(reinterpret_cast<std::uintptr_t>(data)), size(n)
+            {
+                std::uintptr_t mask = static_cast<std::uintptr_t>(page_bytes() - 1);
+                first_page = address & ~mask;
+                count = n > 0 ? static_cast<long>(((address + (n - 1) * sizeof(double)) & ~mask) - first_page) /
+                                        page_bytes() + 1
+                              : 0;
+            }
+
+            // First element on page p (size for p == count)
+            long begin(long p) const
+            {
+                if (p >= count)
+                    return size;
+                long offset = static_cast<long>(first_page + p * page_bytes()) - static_cast<long>(address);
+                return std::max(0L, offset / static_cast<long>(sizeof(double)));
+            }
+
+            long page_of(long index) const
+            {
+                return static_cast<long>(address + index * sizeof(double) - first_page) / page_bytes();
+            }
+        };
+
+        // First page of node d's block under PARTITIONED placement
+        long partition_begin(long pages, size_t nodes, size_t d)
+        {
+            return static_cast<long>((static_cast<long>(d) * pages + static_cast<long>(nodes) - 1) /
+                                     static_cast<long>(nodes));
+        }
+
+        std::string read_file(const std::string &path)
+        {
+            std::ifstream in(path);
+            std::string content;
+            std::getline(in, content);
+            return content;
+        }
+    }
+
+    // NumaTopology implementation
+    NumaTopology::NumaTopology()
+    {
+        std::vector<int> allowed;
+#ifdef __linux__
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &mask))
+                    allowed.push_back(cpu);
+            }
+        }
+#endif
+
+        // Domains without usable CPUs (memory-only nodes) cannot first-touch
+        for (int node : parse_cpu_list(read_file("/sys/devices/system/node/online")))
+        {
+            std::vector<int> cpus;
+            for (int cpu : parse_cpu_list(read_file("/sys/devices/system/node/node" + std::to_string(node) +
+                                                    "/cpulist")))
+            {
+                if (allowed.empty() || std::binary_search(allowed.begin(), allowed.end(), cpu))
+                    cpus.push_back(cpu);
+            }
+            if (!cpus.empty())
+                cpus_.push_back(cpus);
+        }
+
+        if (cpus_.empty())
+        {
+            std::vector<int> cpus = allowed;
+            for (int cpu = 0; cpus.empty() && cpu < static_cast<int>(std::thread::hardware_concurrency()); ++cpu)
+                cpus.push_back(cpu);
+            cpus_.push_back(cpus.empty() ? std::vector<int>{0} : cpus);
+        }
+    }
+
+    const NumaTopology &NumaTopology::system()
+    {
+        static const NumaTopology topology;
+        return topology;
+    }
+
+    int NumaTopology::node_of_cpu(int cpu) const
+    {
+        for (size_t node = 0; node < cpus_.size(); ++node)
+        {
+            if (std::find(cpus_[node].begin(), cpus_[node].end(), cpu) != cpus_[node].end())
+                return static_cast<int>(node);
+        }
+        return -1;
+    }
+
+    std::vector<int> NumaTopology::parse_cpu_list(const std::string &list)
+    {
+        std::vector<int> result;
+        std::istringstream ranges(list);
+        std::string range;
+        while (std::getline(ranges, range, ','))
+        {
+            size_t dash = range.find('-');
+            try
+            {
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu)
+                    result.push_back(cpu);
+            }
+            catch (...)
+            {
+                continue; // empty or malformed entry
+            }
+        }
+        return result;
+    }
+
+    // NumaPlacement implementation
+    DenseTensor NumaPlacement::allocate(const std::vector<long> &shape, NumaPolicy policy, double value)
+    {
+        DenseTensor result = DenseTensor::uninitialized(shape);
+        place(result.data(), result.size(), policy, value);
+        return result;
+    }
+
+    void NumaPlacement::place(double *data, long size, NumaPolicy policy, double value)
+    {
+        const auto &topology = NumaTopology::system();
+        parallel_for(data, size, policy, policy == NumaPolicy::LOCAL ? 1 : topology.num_nodes(),
+                     [data, value](long begin, long end) { std::fill(data + begin, data + end, value); });
+
+        // Bytes by owning domain, page by page
+        std::vector<double> bytes(topology.num_nodes(), 0.0);
+        PageSpan span(data, size);
+        for (long p = 0; p < span.count; ++p)
+        {
+            size_t node = std::min(owner(data, size, span.begin(p), policy), bytes.size() - 1);
+            bytes[node] += static_cast<double>((span.begin(p + 1) - span.begin(p)) * sizeof(double));
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        ++global_stats.allocations;
+        global_stats.bytes_per_node.resize(std::max(global_stats.bytes_per_node.size(), bytes.size()), 0.0);
+        for (size_t node = 0; node < bytes.size(); ++node)
+            global_stats.bytes_per_node[node] += bytes[node];
+    }
+
+    size_t NumaPlacement::owner(const double *data, long size, long index, NumaPolicy policy)
+    {
+        const size_t nodes = NumaTopology::system().num_nodes();
+        PageSpan span(data, size);
+        long page = span.page_of(index);
+        if (policy == NumaPolicy::INTERLEAVED)
+            return static_cast<size_t>(page) % nodes;
+        if (policy == NumaPolicy::PARTITIONED)
+            return static_cast<size_t>(page * static_cast<long>(nodes) / span.count);
+#ifdef __linux__
+        int node = NumaTopology::system().node_of_cpu(sched_getcpu());
+        return node < 0 ? 0 : static_cast<size_t>(node);
+#else
+        return 0;
+#endif
+    }
+
+    void NumaPlacement::parallel_for(const double *data, long size, NumaPolicy policy, size_t threads,
+                                     const std::function<void(long, long)> &body)
+    {
+        if (size <= 0)
+            return;
+        const auto &topology = NumaTopology::system();
+        const size_t nodes = topology.num_nodes();
+        threads = std::max<size_t>(1, threads);
+
+        std::vector<std::thread> workers;
+        if (policy == NumaPolicy::LOCAL || nodes == 1)
+        {
+            // No domains to respect: equal contiguous ranges
+            for (size_t t = 1; t < threads; ++t)
+            {
+                long begin = size * static_cast<long>(t) / static_cast<long>(threads);
+                long end = size * static_cast<long>(t + 1) / static_cast<long>(threads);
+                workers.emplace_back([&body, begin, end]() { body(begin, end); });
+            }
+            body(0, size / static_cast<long>(threads));
+            for (auto &worker : workers)
+                worker.join();
+            return;
+        }
+
+        PageSpan span(data, size);
+        const size_t per_node = std::max<size_t>(1, threads / nodes);
+        for (size_t d = 0; d < nodes; ++d)
+        {
+            for (size_t w = 0; w < per_node; ++w)
+            {
+                workers.emplace_back([&, d, w]()
+                {
+                    pin_current_thread(d);
+                    if (policy == NumaPolicy::PARTITIONED)
+                    {
+                        long first = span.begin(partition_begin(span.count, nodes, d));
+                        long last = span.begin(partition_begin(span.count, nodes, d + 1));
+                        long begin = first + (last - first) * static_cast<long>(w) / static_cast<long>(per_node);
+                        long end = first + (last - first) * static_cast<long>(w + 1) / static_cast<long>(per_node);
+                        if (begin < end)
+                            body(begin, end);
+                        return;
+                    }
+                    // INTERLEAVED: this domain's pages, dealt out to its threads
+                    for (long p = static_cast<long>(d + nodes * w); p < span.count;
+                         p += static_cast<long>(nodes * per_node))
+                    {
+                        if (span.begin(p) < span.begin(p + 1))
+                            body(span.begin(p), span.begin(p + 1));
+                    }
+                });
+            }
+        }
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    bool NumaPlacement::pin_current_thread(size_t node)
+    {
+        const auto &topology = NumaTopology::system();
+        bool pinned = false;
+#ifdef __linux__
+        if (node < topology.num_nodes())
+        {
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            for (int cpu : topology.cpus(node))
+            {
+                if (cpu >= 0 && cpu < CPU_SETSIZE)
+                    CPU_SET(cpu, &mask);
+            }
+            pinned = pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+        }
+#else
+        (void)node;
+        (void)topology;
+#endif
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        ++(pinned ? global_stats.pinned_threads : global_stats.failed_pins);
+        return pinned;
+    }
+
+    std::vector<long> NumaPlacement::resident_pages(const double *data, long size)
+    {
+        std::vector<long> result;
+#if defined(__linux__) && defined(SYS_move_pages)
+        PageSpan span(data, size);
+        std::vector<void *> pages(span.count);
+        for (long p = 0; p < span.count; ++p)
+            pages[p] = reinterpret_cast<void *>(span.first_page + p * page_bytes());
+        std::vector<int> status(span.count, -1);
+        // Without target nodes, move_pages only reports where each page lives
+        if (span.count == 0 ||
+            syscall(SYS_move_pages, 0, span.count, pages.data(), nullptr, status.data(), 0) != 0)
+            return result;
+        for (int node : status)
+        {
+            if (node < 0)
+                continue; // not yet touched
+            if (static_cast<size_t>(node) >= result.size())
+                result.resize(node + 1, 0);
+            ++result[node];
+        }
+#else
+        (void)data;
+        (void)size;
+#endif
+        return result;
+    }
+
+    NumaStats NumaPlacement::stats()
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        return global_stats;
+    }
+
+    void NumaPlacement::reset_stats()
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        global_stats = NumaStats();
+    }
+
+} // namespace qc
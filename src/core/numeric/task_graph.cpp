@@ -0,0 +1,345 @@
+#include "core/numeric/task_graph.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace qc
+{
+
+    TaskGraphRuntime::TaskGraphRuntime(const RuntimeOptions &options) : options_(options) {}
+
+    void TaskGraphRuntime::bind_input(const std::string &name, const DenseTensor &tensor)
+    {
+        inputs_[name] = &tensor;
+    }
+
+    void TaskGraphRuntime::bind_output(const std::string &name, DenseTensor &tensor)
+    {
+        outputs_[name] = &tensor;
+    }
+
+    size_t TaskGraphRuntime::slots() const
+    {
+        if (options_.threads > 0)
+            return options_.threads;
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::map<std::string, long>> TaskGraphRuntime::node_extents(const ContractionDag &dag) const
+    {
+        const auto &registry = SpaceRegistry::global();
+        std::vector<std::map<std::string, long>> extents(dag.size());
+        for (size_t i = 0; i < dag.size(); ++i)
+        {
+            const auto &node = dag.node(i);
+            const std::string &name = node.tensor.symbol().name();
+            auto input = inputs_.find(name);
+            if (node.inputs.empty() && input != inputs_.end())
+            {
+                auto labels = LayoutPropagation::physical_order(node.tensor);
+                for (size_t d = 0; d < labels.size() && d < input->second->rank(); ++d)
+                    extents[i][labels[d]] = input->second->extent(d);
+            }
+            for (size_t operand : node.inputs)
+                extents[i].insert(extents[operand].begin(), extents[operand].end());
+            for (const auto &idx : node.tensor.indices())
+            {
+                if (!extents[i].count(idx->label()) && registry.dimension(*idx) >= 0)
+                    extents[i][idx->label()] = registry.dimension(*idx);
+            }
+        }
+        return extents;
+    }
+
+    std::vector<double> TaskGraphRuntime::task_flops(const ContractionDag &dag) const
+    {
+        auto extents = node_extents(dag);
+        std::vector<double> flops(dag.size(), 0.0);
+        for (size_t i = 0; i < dag.size(); ++i)
+        {
+            const auto &node = dag.node(i);
+            if (node.inputs.empty())
+                continue;
+            flops[i] = 2.0 * static_cast<double>(node.inputs.size() > 1 ? node.inputs.size() - 1 : 1);
+            for (const auto &entry : extents[i])
+                flops[i] *= static_cast<double>(entry.second);
+        }
+        return flops;
+    }
+
+    std::vector<double> TaskGraphRuntime::critical_path(const ContractionDag &dag) const
+    {
+        // Nodes are topologically ordered, so consumers come later
+        std::vector<double> path = task_flops(dag);
+        for (size_t i = dag.size(); i-- > 0;)
+        {
+            double longest = 0.0;
+            for (size_t consumer : dag.node(i).consumers)
+                longest = std::max(longest, path[consumer]);
+            path[i] += longest;
+        }
+        return path;
+    }
+
+    size_t TaskGraphRuntime::thread_budget(double flops) const
+    {
+#ifndef _OPENMP
+        // Without OpenMP only NUMA sweeps split a task
+        if (options_.placement == NumaPolicy::LOCAL)
+            return 1;
+#endif
+        if (options_.flops_per_thread <= 0.0)
+            return slots();
+        double wanted = std::ceil(flops / options_.flops_per_thread);
+        return static_cast<size_t>(std::max(1.0, std::min(wanted, static_cast<double>(slots()))));
+    }
+
+    bool TaskGraphRuntime::run(const ContractionDag &dag)
+    {
+        static auto &ready_tasks = MetaWaveCompiler::util::metrics().gauge(
+            "qc_task_graph_ready_tasks", "Contractions waiting for a slot or memory");
+        static auto &running_tasks = MetaWaveCompiler::util::metrics().gauge(
+            "qc_task_graph_running_tasks", "Contractions in flight");
+        static auto &delays = MetaWaveCompiler::util::metrics().counter(
+            "qc_task_graph_delayed_total", "Contractions held back by the memory ceiling");
+        static auto &task_latency = MetaWaveCompiler::util::metrics().histogram(
+            "qc_task_graph_task_seconds", "Latency of one contraction task");
+
+        auto start = std::chrono::steady_clock::now();
+        stats_ = RuntimeStats();
+        const size_t n = dag.size();
+
+        // Every leaf must be bound or implicit, every result bound
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto &node = dag.node(i);
+            const std::string &name = node.tensor.symbol().name();
+            if (node.inputs.empty() && !inputs_.count(name) && !evaluator_.find_implicit(name))
+                return false;
+            if (!node.inputs.empty() && !node.intermediate && !outputs_.count(name))
+                return false;
+        }
+
+        auto extents = node_extents(dag);
+        std::vector<double> flops = task_flops(dag);
+        std::vector<double> priority = critical_path(dag);
+
+        // Storage shape and size of each intermediate, in the planned order
+        LayoutPlan layout = LayoutPropagation::plan(dag);
+        std::vector<std::vector<long>> shapes(n);
+        std::vector<double> bytes(n, 0.0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (!dag.node(i).intermediate || dag.node(i).inputs.empty())
+                continue;
+            bytes[i] = static_cast<double>(sizeof(double));
+            for (const auto &label : layout.storage[i])
+            {
+                auto it = extents[i].find(label);
+                if (it == extents[i].end())
+                    return false;
+                shapes[i].push_back(it->second);
+                bytes[i] *= static_cast<double>(it->second);
+            }
+        }
+
+        // Dependency state, owned by the scheduling thread
+        std::vector<std::unique_ptr<DenseTensor>> owned(n);
+        std::vector<size_t> missing(n, 0), pending_uses(n, 0);
+        std::vector<bool> delayed(n, false);
+        std::vector<size_t> ready;
+        size_t n_tasks = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto &node = dag.node(i);
+            pending_uses[i] = node.consumers.size();
+            if (node.inputs.empty())
+                continue;
+            ++n_tasks;
+            for (size_t operand : node.inputs)
+            {
+                if (!dag.node(operand).inputs.empty())
+                    ++missing[i];
+            }
+            if (missing[i] == 0)
+                ready.push_back(i);
+        }
+
+        // Worker pool; workers only touch the tensors of their own task
+        struct Job
+        {
+            size_t node;
+            size_t threads;
+        };
+        std::mutex mutex;
+        std::condition_variable work_available, work_done;
+        std::deque<Job> jobs;
+        std::vector<std::pair<size_t, bool>> finished;
+        bool stop = false;
+
+        auto execute = [&](const Job &job)
+        {
+            MetaWaveCompiler::util::ScopedTimer timer(task_latency);
+            const auto &node = dag.node(job.node);
+            Evaluator local = evaluator_;
+            local.set_placement(options_.placement);
+            for (size_t operand : node.inputs)
+            {
+                const std::string &name = dag.node(operand).tensor.symbol().name();
+                if (owned[operand])
+                    local.bind(name, *owned[operand]);
+                else if (inputs_.count(name))
+                    local.bind(name, *inputs_.at(name));
+            }
+            DenseTensor *target = node.intermediate ? owned[job.node].get()
+                                                    : outputs_.at(node.tensor.symbol().name());
+            ContractionTerm term = LayoutPropagation::planned_term(dag, layout, job.node);
+            return local.evaluate(term, *target, job.threads);
+        };
+
+        size_t n_workers = slots();
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < n_workers; ++w)
+        {
+            workers.emplace_back([&, w]()
+            {
+                if (options_.pin_threads)
+                    NumaPlacement::pin_current_thread(w % NumaTopology::system().num_nodes());
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true)
+                {
+                    work_available.wait(lock, [&]() { return stop || !jobs.empty(); });
+                    if (jobs.empty())
+                        return;
+                    Job job = jobs.front();
+                    jobs.pop_front();
+                    lock.unlock();
+                    bool ok = execute(job);
+                    lock.lock();
+                    finished.push_back({job.node, ok});
+                    work_done.notify_one();
+                }
+            });
+        }
+
+        size_t free_slots = n_workers, running = 0, completed = 0;
+        std::vector<size_t> budget(n, 0);
+        std::set<std::string> busy_outputs;
+        double live_bytes = 0.0;
+        bool failed = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!failed && completed < n_tasks)
+        {
+            // Start ready tasks by descending critical path while slots remain
+            std::sort(ready.begin(), ready.end(),
+                      [&priority](size_t x, size_t y) { return priority[x] > priority[y]; });
+            for (size_t r = 0; r < ready.size() && free_slots > 0;)
+            {
+                size_t i = ready[r];
+                const auto &node = dag.node(i);
+                const std::string &name = node.tensor.symbol().name();
+                if (!node.intermediate && busy_outputs.count(name))
+                {
+                    ++r;
+                    continue;
+                }
+                bool fits = options_.memory_limit <= 0.0 || running == 0 ||
+                            live_bytes + bytes[i] <= options_.memory_limit;
+                if (!fits)
+                {
+                    if (!delayed[i])
+                    {
+                        ++stats_.delayed;
+                        delays.inc();
+                    }
+                    delayed[i] = true;
+                    ++r;
+                    continue;
+                }
+
+                if (node.intermediate)
+                {
+                    owned[i].reset(new DenseTensor(NumaPlacement::allocate(shapes[i], options_.placement)));
+                    live_bytes += bytes[i];
+                    stats_.peak_memory = std::max(stats_.peak_memory, live_bytes);
+                }
+                else
+                {
+                    busy_outputs.insert(name);
+                }
+                budget[i] = std::min(thread_budget(flops[i]), free_slots);
+                free_slots -= budget[i];
+                ++running;
+                stats_.max_concurrent = std::max(stats_.max_concurrent, running);
+                jobs.push_back({i, budget[i]});
+                work_available.notify_one();
+                ready.erase(ready.begin() + r);
+            }
+            ready_tasks.set(static_cast<double>(ready.size()));
+            running_tasks.set(static_cast<double>(running));
+
+            if (running == 0)
+            {
+                failed = true; // nothing runnable: the DAG is malformed
+                break;
+            }
+            work_done.wait(lock, [&]() { return !finished.empty(); });
+
+            for (const auto &result : finished)
+            {
+                size_t i = result.first;
+                const auto &node = dag.node(i);
+                failed = failed || !result.second;
+                free_slots += budget[i];
+                --running;
+                ++completed;
+                if (!node.intermediate)
+                    busy_outputs.erase(node.tensor.symbol().name());
+
+                for (size_t operand : node.inputs)
+                {
+                    if (--pending_uses[operand] == 0 && owned[operand])
+                    {
+                        owned[operand].reset();
+                        live_bytes -= bytes[operand];
+                    }
+                }
+                for (size_t consumer : node.consumers)
+                {
+                    if (--missing[consumer] == 0)
+                        ready.push_back(consumer);
+                }
+            }
+            finished.clear();
+        }
+
+        // Drain tasks still in flight after a failure
+        while (running > 0)
+        {
+            work_done.wait(lock, [&]() { return !finished.empty(); });
+            running -= finished.size();
+            finished.clear();
+        }
+        stop = true;
+        work_available.notify_all();
+        lock.unlock();
+        for (auto &worker : workers)
+            worker.join();
+
+        ready_tasks.set(0.0);
+        running_tasks.set(0.0);
+        stats_.tasks = completed;
+        stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return !failed;
+    }
+
+} // namespace qc
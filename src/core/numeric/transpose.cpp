@@ -0,0 +1,400 @@
+#include "core/numeric/transpose.h"
+#include "util/metrics.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#if defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace qc
+{
+
+    namespace
+    {
+        const long kTile = 32;       // leaf of the cache-oblivious recursion (2 x 8 KiB)
+        const long kRowChunk = 256;  // rows of the output-fast dimension per task
+
+        // Plan cache
+        std::mutex cache_mutex;
+        std::map<std::pair<std::vector<long>, std::vector<size_t>>, std::shared_ptr<const TransposePlan>> plan_cache;
+
+        // Scalar fallback for edges and small blocks
+        template <bool Accumulate>
+        void scalar_block(const double *in, long ld_in, double *out, long ld_out, long nb, long na,
+                          double alpha, double beta)
+        {
+            for (long ia = 0; ia < na; ++ia)
+            {
+                for (long ib = 0; ib < nb; ++ib)
+                {
+                    double value = alpha * in[ib * ld_in + ia];
+                    double &target = out[ia * ld_out + ib];
+                    target = Accumulate ? value + beta * target : value;
+                }
+            }
+        }
+
+#if defined(__AVX512F__)
+        // In-register 8x8 transpose of doubles
+        template <bool Accumulate>
+        inline void micro_8x8(const double *in, long ld_in, double *out, long ld_out, double alpha, double beta)
+        {
+            __m512d r[8], t[8], u[8];
+            for (int q = 0; q < 8; ++q)
+                r[q] = _mm512_loadu_pd(in + q * ld_in);
+            for (int q = 0; q < 8; q += 2)
+            {
+                t[q] = _mm512_unpacklo_pd(r[q], r[q + 1]);
+                t[q + 1] = _mm512_unpackhi_pd(r[q], r[q + 1]);
+            }
+            const __m512i lo128 = _mm512_set_epi64(13, 12, 5, 4, 9, 8, 1, 0);
+            const __m512i hi128 = _mm512_set_epi64(15, 14, 7, 6, 11, 10, 3, 2);
+            for (int q = 0; q < 8; q += 4)
+            {
+                u[q] = _mm512_permutex2var_pd(t[q], lo128, t[q + 2]);
+                u[q + 1] = _mm512_permutex2var_pd(t[q + 1], lo128, t[q + 3]);
+                u[q + 2] = _mm512_permutex2var_pd(t[q], hi128, t[q + 2]);
+                u[q + 3] = _mm512_permutex2var_pd(t[q + 1], hi128, t[q + 3]);
+            }
+            const __m512i lo256 = _mm512_set_epi64(11, 10, 9, 8, 3, 2, 1, 0);
+            const __m512i hi256 = _mm512_set_epi64(15, 14, 13, 12, 7, 6, 5, 4);
+            const __m512d va = _mm512_set1_pd(alpha);
+            for (int q = 0; q < 4; ++q)
+            {
+                __m512d c[2] = {_mm512_permutex2var_pd(u[q], lo256, u[q + 4]),
+                                _mm512_permutex2var_pd(u[q], hi256, u[q + 4])};
+                for (int h = 0; h < 2; ++h)
+                {
+                    double *target = out + (q + 4 * h) * ld_out;
+                    __m512d value = _mm512_mul_pd(va, c[h]);
+                    if (Accumulate)
+                        value = _mm512_fmadd_pd(_mm512_set1_pd(beta), _mm512_loadu_pd(target), value);
+                    _mm512_storeu_pd(target, value);
+                }
+            }
+        }
+        const long kMicro = 8;
+#elif defined(__AVX__)
+        // In-register 4x4 transpose of doubles
+        template <bool Accumulate>
+        inline void micro_4x4(const double *in, long ld_in, double *out, long ld_out, double alpha, double beta)
+        {
+            __m256d r0 = _mm256_loadu_pd(in);
+            __m256d r1 = _mm256_loadu_pd(in + ld_in);
+            __m256d r2 = _mm256_loadu_pd(in + 2 * ld_in);
+            __m256d r3 = _mm256_loadu_pd(in + 3 * ld_in);
+            __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+            __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+            __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+            __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+            __m256d c[4] = {_mm256_permute2f128_pd(t0, t2, 0x20), _mm256_permute2f128_pd(t1, t3, 0x20),
+                            _mm256_permute2f128_pd(t0, t2, 0x31), _mm256_permute2f128_pd(t1, t3, 0x31)};
+            const __m256d va = _mm256_set1_pd(alpha);
+            for (int q = 0; q < 4; ++q)
+            {
+                double *target = out + q * ld_out;
+                __m256d value = _mm256_mul_pd(va, c[q]);
+                if (Accumulate)
+                    value = _mm256_add_pd(value, _mm256_mul_pd(_mm256_set1_pd(beta), _mm256_loadu_pd(target)));
+                _mm256_storeu_pd(target, value);
+            }
+        }
+        const long kMicro = 4;
+#endif
+
+        // Leaf block: SIMD micro-transposes over the interior, scalar edges
+        template <bool Accumulate>
+        void leaf_block(const double *in, long ld_in, double *out, long ld_out, long nb, long na,
+                        double alpha, double beta)
+        {
+#if defined(__AVX512F__) || defined(__AVX__)
+            long nb_main = nb - nb % kMicro;
+            long na_main = na - na % kMicro;
+            for (long ib = 0; ib < nb_main; ib += kMicro)
+            {
+                for (long ia = 0; ia < na_main; ia += kMicro)
+                {
+#if defined(__AVX512F__)
+                    micro_8x8<Accumulate>(in + ib * ld_in + ia, ld_in, out + ia * ld_out + ib, ld_out, alpha, beta);
+#else
+                    micro_4x4<Accumulate>(in + ib * ld_in + ia, ld_in, out + ia * ld_out + ib, ld_out, alpha, beta);
+#endif
+                }
+            }
+            if (na_main < na)
+                scalar_block<Accumulate>(in + na_main, ld_in, out + na_main * ld_out, ld_out, nb, na - na_main,
+                                         alpha, beta);
+            if (nb_main < nb)
+                scalar_block<Accumulate>(in + nb_main * ld_in, ld_in, out + nb_main, ld_out, nb - nb_main, na_main,
+                                         alpha, beta);
+#else
+            scalar_block<Accumulate>(in, ld_in, out, ld_out, nb, na, alpha, beta);
+#endif
+        }
+
+        // out[ia * ld_out + ib] = alpha * in[ib * ld_in + ia] (+ beta * out), halving
+        // the longer side until the block fits in cache
+        template <bool Accumulate>
+        void recursive_block(const double *in, long ld_in, double *out, long ld_out, long nb, long na,
+                             double alpha, double beta)
+        {
+            if (nb <= kTile && na <= kTile)
+            {
+                leaf_block<Accumulate>(in, ld_in, out, ld_out, nb, na, alpha, beta);
+                return;
+            }
+            if (nb >= na)
+            {
+                long half = std::max(8L, (nb / 2) & ~7L);
+                recursive_block<Accumulate>(in, ld_in, out, ld_out, half, na, alpha, beta);
+                recursive_block<Accumulate>(in + half * ld_in, ld_in, out + half, ld_out, nb - half, na, alpha, beta);
+            }
+            else
+            {
+                long half = std::max(8L, (na / 2) & ~7L);
+                recursive_block<Accumulate>(in, ld_in, out, ld_out, nb, half, alpha, beta);
+                recursive_block<Accumulate>(in + half, ld_in, out + half * ld_out, ld_out, nb, na - half, alpha, beta);
+            }
+        }
+
+        // Input and output offsets of the t-th combination of `dims`
+        void decode(const TransposePlan &plan, const std::vector<size_t> &dims, long t, long &in_offset,
+                    long &out_offset)
+        {
+            in_offset = 0;
+            out_offset = 0;
+            for (size_t d = dims.size(); d-- > 0;)
+            {
+                long extent = plan.shape[dims[d]];
+                long value = t % extent;
+                t /= extent;
+                in_offset += value * plan.in_strides[dims[d]];
+                out_offset += value * plan.out_strides[dims[d]];
+            }
+        }
+
+        template <bool Accumulate>
+        void run(const TransposePlan &plan, const double *in, double *out, double alpha, double beta)
+        {
+            size_t rank = plan.shape.size();
+            if (plan.kind == TransposePlan::Kind::COPY)
+            {
+#pragma omp parallel for schedule(static)
+                for (long i = 0; i < plan.size; ++i)
+                    out[i] = Accumulate ? alpha * in[i] + beta * out[i] : alpha * in[i];
+                return;
+            }
+
+            if (plan.kind == TransposePlan::Kind::ROWS)
+            {
+                std::vector<size_t> outer;
+                for (size_t d = 0; d + 1 < rank; ++d)
+                    outer.push_back(d);
+                long length = plan.shape[rank - 1];
+                long rows = plan.size / length;
+#pragma omp parallel for schedule(static)
+                for (long t = 0; t < rows; ++t)
+                {
+                    long in_offset, out_offset;
+                    decode(plan, outer, t, in_offset, out_offset);
+                    const double *src = in + in_offset;
+                    double *dst = out + out_offset;
+                    for (long i = 0; i < length; ++i)
+                        dst[i] = Accumulate ? alpha * src[i] + beta * dst[i] : alpha * src[i];
+                }
+                return;
+            }
+
+            // BLOCKED: a is contiguous in the input, b in the output
+            size_t a = rank - 1;
+            size_t b = plan.permutation[rank - 1];
+            std::vector<size_t> outer;
+            long n_outer = 1;
+            for (size_t d = 0; d < rank; ++d)
+            {
+                if (d != a && d != b)
+                {
+                    outer.push_back(d);
+                    n_outer *= plan.shape[d];
+                }
+            }
+            long nb = plan.shape[b];
+            long na = plan.shape[a];
+            long n_chunks = (nb + kRowChunk - 1) / kRowChunk;
+#pragma omp parallel for schedule(dynamic)
+            for (long task = 0; task < n_outer * n_chunks; ++task)
+            {
+                long t = task / n_chunks;
+                long b0 = (task % n_chunks) * kRowChunk;
+                long in_offset, out_offset;
+                decode(plan, outer, t, in_offset, out_offset);
+                recursive_block<Accumulate>(in + in_offset + b0 * plan.in_strides[b], plan.in_strides[b],
+                                            out + out_offset + b0, plan.out_strides[a],
+                                            std::min(kRowChunk, nb - b0), na, alpha, beta);
+            }
+        }
+    }
+
+    std::shared_ptr<const TransposePlan> TensorTranspose::plan(const std::vector<long> &shape,
+                                                               const std::vector<size_t> &permutation)
+    {
+        size_t rank = shape.size();
+        std::vector<size_t> sorted = permutation;
+        std::sort(sorted.begin(), sorted.end());
+        for (size_t d = 0; d < sorted.size(); ++d)
+        {
+            if (sorted.size() != rank || sorted[d] != d)
+                return nullptr;
+        }
+
+        static auto &hits = MetaWaveCompiler::util::metrics().counter(
+            "qc_cache_hits_total", "Lookups served from a cache", "cache=\"transpose_plan\"");
+        static auto &misses = MetaWaveCompiler::util::metrics().counter(
+            "qc_cache_misses_total", "Lookups that computed their entry", "cache=\"transpose_plan\"");
+        static auto &entries = MetaWaveCompiler::util::metrics().gauge(
+            "qc_cache_entries", "Entries held by a cache", "cache=\"transpose_plan\"");
+
+        auto key = std::make_pair(shape, permutation);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = plan_cache.find(key);
+            if (it != plan_cache.end())
+            {
+                hits.inc();
+                return it->second;
+            }
+        }
+        misses.inc();
+
+        // Fuse runs of output dimensions that are consecutive input
+        // dimensions; unit extents are dropped
+        std::vector<std::vector<size_t>> groups; // in output order
+        for (size_t d = 0; d < rank; ++d)
+        {
+            if (shape[permutation[d]] == 1)
+                continue;
+            if (!groups.empty() && groups.back().back() + 1 == permutation[d])
+                groups.back().push_back(permutation[d]);
+            else
+                groups.push_back({permutation[d]});
+        }
+        // Skipped unit dimensions can split a run; merge across them
+        for (size_t g = 0; g + 1 < groups.size();)
+        {
+            bool adjacent = true;
+            for (size_t q = groups[g].back() + 1; q < groups[g + 1].front(); ++q)
+                adjacent = adjacent && shape[q] == 1;
+            if (groups[g].back() < groups[g + 1].front() && adjacent)
+            {
+                groups[g].insert(groups[g].end(), groups[g + 1].begin(), groups[g + 1].end());
+                groups.erase(groups.begin() + g + 1);
+            }
+            else
+            {
+                ++g;
+            }
+        }
+
+        auto result = std::make_shared<TransposePlan>();
+        std::vector<size_t> by_input(groups.size());
+        for (size_t g = 0; g < groups.size(); ++g)
+            by_input[g] = g;
+        std::sort(by_input.begin(), by_input.end(),
+                  [&groups](size_t x, size_t y) { return groups[x].front() < groups[y].front(); });
+        std::vector<size_t> fused_of_group(groups.size());
+        for (size_t f = 0; f < by_input.size(); ++f)
+        {
+            fused_of_group[by_input[f]] = f;
+            long extent = 1;
+            for (size_t q : groups[by_input[f]])
+                extent *= shape[q];
+            result->shape.push_back(extent);
+        }
+        for (size_t g = 0; g < groups.size(); ++g)
+            result->permutation.push_back(fused_of_group[g]);
+
+        size_t fused_rank = result->shape.size();
+        result->in_strides.assign(fused_rank, 1);
+        result->out_strides.assign(fused_rank, 1);
+        result->size = 1;
+        for (size_t f = fused_rank; f-- > 0;)
+        {
+            result->in_strides[f] = result->size;
+            result->size *= result->shape[f];
+        }
+        long stride = 1;
+        for (size_t d = fused_rank; d-- > 0;)
+        {
+            result->out_strides[result->permutation[d]] = stride;
+            stride *= result->shape[result->permutation[d]];
+        }
+        if (fused_rank == 0)
+            result->size = 1;
+        for (size_t d = 0; d < rank; ++d)
+        {
+            if (shape[d] == 0)
+                result->size = 0;
+        }
+
+        if (fused_rank <= 1)
+            result->kind = TransposePlan::Kind::COPY;
+        else if (result->permutation[fused_rank - 1] == fused_rank - 1)
+            result->kind = TransposePlan::Kind::ROWS;
+        else
+            result->kind = TransposePlan::Kind::BLOCKED;
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto inserted = plan_cache.emplace(key, result);
+        if (inserted.second)
+            entries.add(1.0);
+        return inserted.first->second;
+    }
+
+    void TensorTranspose::execute(const TransposePlan &plan, const double *in, double *out,
+                                  double alpha, double beta)
+    {
+        if (plan.size == 0)
+            return;
+        if (beta == 0.0)
+            run<false>(plan, in, out, alpha, beta);
+        else
+            run<true>(plan, in, out, alpha, beta);
+    }
+
+    bool TensorTranspose::transpose(const double *in, double *out, const std::vector<long> &shape,
+                                    const std::vector<size_t> &permutation, double alpha, double beta)
+    {
+        auto p = plan(shape, permutation);
+        if (!p)
+            return false;
+        execute(*p, in, out, alpha, beta);
+        return true;
+    }
+
+    DenseTensor TensorTranspose::transpose(const DenseTensor &in, const std::vector<size_t> &permutation)
+    {
+        std::vector<long> shape;
+        for (size_t p : permutation)
+            shape.push_back(p < in.rank() ? in.extent(p) : 0);
+        DenseTensor out(shape);
+        transpose(in.data(), out.data(), in.shape(), permutation);
+        return out;
+    }
+
+    size_t TensorTranspose::cache_size()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return plan_cache.size();
+    }
+
+    void TensorTranspose::clear_cache()
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        MetaWaveCompiler::util::metrics()
+            .gauge("qc_cache_entries", "Entries held by a cache", "cache=\"transpose_plan\"")
+            .set(0.0);
+        plan_cache.clear();
+    }
+
+} // namespace qc
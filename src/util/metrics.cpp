@@ -0,0 +1,352 @@
+#include "../include/util/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef __unix__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace MetaWaveCompiler
+{
+    namespace util
+    {
+
+        namespace
+        {
+            atomic<size_t> nextShard{0};
+
+            int highestBit(uint64_t value)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return 63 - __builtin_clzll(value);
+#else
+                int bit = 0;
+                while (value >>= 1)
+                    ++bit;
+                return bit;
+#endif
+            }
+
+            void atomicMax(atomic<uint64_t> &target, uint64_t value)
+            {
+                uint64_t current = target.load(memory_order_relaxed);
+                while (current < value && !target.compare_exchange_weak(current, value, memory_order_relaxed))
+                {
+                }
+            }
+
+            string series(const string &name, const string &labels, const string &extra = "")
+            {
+                string all = labels.empty() ? extra : (extra.empty() ? labels : labels + "," + extra);
+                return all.empty() ? name : name + "{" + all + "}";
+            }
+
+            string seconds(uint64_t nanoseconds)
+            {
+                ostringstream os;
+                os << setprecision(9) << static_cast<double>(nanoseconds) * 1.0e-9;
+                return os.str();
+            }
+        }
+
+        size_t metricShard()
+        {
+            thread_local const size_t shard = nextShard.fetch_add(1, memory_order_relaxed);
+            return shard % kMetricShards;
+        }
+
+        // class Counter
+        uint64_t Counter::value() const
+        {
+            uint64_t total = 0;
+            for (const auto &shard : shards)
+                total += shard.value.load(memory_order_relaxed);
+            return total;
+        }
+
+        // class Gauge
+        void Gauge::add(double delta)
+        {
+            double expected = current.load(memory_order_relaxed);
+            while (!current.compare_exchange_weak(expected, expected + delta, memory_order_relaxed))
+            {
+            }
+        }
+
+        // class Histogram
+        size_t Histogram::bucketOf(uint64_t value)
+        {
+            if (value < kSubBuckets)
+                return static_cast<size_t>(value);
+            int bit = highestBit(value);
+            if (bit > 47)
+                return kBuckets - 1;
+            return static_cast<size_t>(bit - kSubBits + 1) * kSubBuckets +
+                   static_cast<size_t>((value >> (bit - kSubBits)) & (kSubBuckets - 1));
+        }
+
+        uint64_t Histogram::bucketUpper(size_t bucket)
+        {
+            if (bucket < kSubBuckets)
+                return bucket;
+            int bit = static_cast<int>(bucket / kSubBuckets) + kSubBits - 1;
+            uint64_t lower = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << (bit - kSubBits);
+            return lower + (uint64_t(1) << (bit - kSubBits)) - 1;
+        }
+
+        void Histogram::record(uint64_t value)
+        {
+            Shard &shard = shards[metricShard() % kShards];
+            shard.buckets[bucketOf(value)].fetch_add(1, memory_order_relaxed);
+            shard.count.fetch_add(1, memory_order_relaxed);
+            shard.sum.fetch_add(value, memory_order_relaxed);
+            atomicMax(shard.max, value);
+        }
+
+        uint64_t Histogram::count() const
+        {
+            uint64_t total = 0;
+            for (const auto &shard : shards)
+                total += shard.count.load(memory_order_relaxed);
+            return total;
+        }
+
+        uint64_t Histogram::sum() const
+        {
+            uint64_t total = 0;
+            for (const auto &shard : shards)
+                total += shard.sum.load(memory_order_relaxed);
+            return total;
+        }
+
+        uint64_t Histogram::max() const
+        {
+            uint64_t result = 0;
+            for (const auto &shard : shards)
+                result = std::max(result, shard.max.load(memory_order_relaxed));
+            return result;
+        }
+
+        array<uint64_t, Histogram::kBuckets> Histogram::merged() const
+        {
+            array<uint64_t, kBuckets> counts{};
+            for (const auto &shard : shards)
+            {
+                for (size_t b = 0; b < kBuckets; ++b)
+                    counts[b] += shard.buckets[b].load(memory_order_relaxed);
+            }
+            return counts;
+        }
+
+        uint64_t Histogram::quantile(double q) const
+        {
+            auto counts = merged();
+            uint64_t total = 0;
+            for (uint64_t c : counts)
+                total += c;
+            if (total == 0)
+                return 0;
+
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+            uint64_t seen = 0;
+            for (size_t b = 0; b < kBuckets; ++b)
+            {
+                seen += counts[b];
+                if (seen >= rank)
+                    return std::min(bucketUpper(b), max());
+            }
+            return max();
+        }
+
+        // class ScopedTimer
+        ScopedTimer::~ScopedTimer()
+        {
+            auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+            histogram.record(static_cast<uint64_t>(elapsed.count()));
+        }
+
+        // class MetricsRegistry
+        MetricsRegistry::~MetricsRegistry() { stopServing(); }
+
+        MetricsRegistry::Family &MetricsRegistry::family(const string &name, const string &help, Type type)
+        {
+            auto it = families.find(name);
+            if (it == families.end())
+            {
+                it = families.emplace(name, Family()).first;
+                it->second.type = type;
+                it->second.help = help;
+            }
+            return it->second;
+        }
+
+        // A series requested with another type than its family's works but is not exported
+        Counter &MetricsRegistry::counter(const string &name, const string &help, const string &labels)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            auto &slot = family(name, help, Type::Counter).counters[labels];
+            if (!slot)
+                slot.reset(new Counter());
+            return *slot;
+        }
+
+        Gauge &MetricsRegistry::gauge(const string &name, const string &help, const string &labels)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            auto &slot = family(name, help, Type::Gauge).gauges[labels];
+            if (!slot)
+                slot.reset(new Gauge());
+            return *slot;
+        }
+
+        Histogram &MetricsRegistry::histogram(const string &name, const string &help, const string &labels)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            auto &slot = family(name, help, Type::Histogram).histograms[labels];
+            if (!slot)
+                slot.reset(new Histogram());
+            return *slot;
+        }
+
+        string MetricsRegistry::exportText() const
+        {
+            static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+            lock_guard<mutex> lock(registryMutex);
+            ostringstream os;
+            for (const auto &entry : families)
+            {
+                const string &name = entry.first;
+                const Family &f = entry.second;
+                if (!f.help.empty())
+                    os << "# HELP " << name << " " << f.help << "\n";
+                switch (f.type)
+                {
+                case Type::Counter:
+                    os << "# TYPE " << name << " counter\n";
+                    for (const auto &c : f.counters)
+                        os << series(name, c.first) << " " << c.second->value() << "\n";
+                    break;
+                case Type::Gauge:
+                    os << "# TYPE " << name << " gauge\n";
+                    for (const auto &g : f.gauges)
+                        os << series(name, g.first) << " " << setprecision(17) << g.second->value() << "\n";
+                    break;
+                case Type::Histogram:
+                    os << "# TYPE " << name << " summary\n";
+                    for (const auto &h : f.histograms)
+                    {
+                        for (double q : quantiles)
+                        {
+                            ostringstream label;
+                            label << "quantile=\"" << q << "\"";
+                            os << series(name, h.first, label.str()) << " " << seconds(h.second->quantile(q)) << "\n";
+                        }
+                        os << series(name + "_sum", h.first) << " " << seconds(h.second->sum()) << "\n";
+                        os << series(name + "_count", h.first) << " " << h.second->count() << "\n";
+                    }
+                    break;
+                }
+            }
+            return os.str();
+        }
+
+        bool MetricsRegistry::writeText(const string &path) const
+        {
+            string temporary = path + ".tmp";
+            {
+                ofstream out(temporary);
+                out << exportText();
+                if (!out)
+                    return false;
+            }
+            return std::rename(temporary.c_str(), path.c_str()) == 0;
+        }
+
+        int MetricsRegistry::serve(int port)
+        {
+#ifdef __unix__
+            stopServing();
+
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0)
+                return -1;
+            int reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            socklen_t length = sizeof(address);
+            if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 16) != 0 ||
+                getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+            {
+                close(fd);
+                return -1;
+            }
+
+            listenFd = fd;
+            serving = true;
+            server = thread([this]()
+            {
+                while (serving)
+                {
+                    pollfd ready{listenFd, POLLIN, 0};
+                    if (poll(&ready, 1, 100) <= 0)
+                        continue;
+                    int client = accept(listenFd, nullptr, nullptr);
+                    if (client < 0)
+                        continue;
+
+                    // The request itself is irrelevant; read what has arrived
+                    char request[1024];
+                    pollfd incoming{client, POLLIN, 0};
+                    if (poll(&incoming, 1, 100) > 0)
+                        (void)!recv(client, request, sizeof(request), 0);
+
+                    string body = exportText();
+                    string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                      to_string(body.size()) + "\r\n\r\n" + body;
+                    for (size_t sent = 0; sent < response.size();)
+                    {
+                        ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                        if (n <= 0)
+                            break;
+                        sent += static_cast<size_t>(n);
+                    }
+                    close(client);
+                }
+            });
+            return ntohs(address.sin_port);
+#else
+            (void)port;
+            return -1;
+#endif
+        }
+
+        void MetricsRegistry::stopServing()
+        {
+            serving = false;
+            if (server.joinable())
+                server.join();
+#ifdef __unix__
+            if (listenFd >= 0)
+                close(listenFd);
+#endif
+            listenFd = -1;
+        }
+
+    } // namespace util
+} // namespace MetaWaveCompiler
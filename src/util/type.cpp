@@ -128,7 +128,7 @@ namespace MetaWaveCompiler
             case UInt128:
                 return 128;
             default:
-                taco_ierror << "Bits for data type not set: " << getKind();
+                metawave_ierror << "Bits for data type not set: " << getKind();
                 return -1;
             }
         }
@@ -237,7 +237,7 @@ namespace MetaWaveCompiler
             case 128:
                 return Datatype(Datatype::UInt128);
             default:
-                taco_ierror << bits << " bits not supported for datatype UInt";
+                metawave_ierror << bits << " bits not supported for datatype UInt";
                 return Datatype(Datatype::UInt32);
             }
         }
@@ -263,7 +263,7 @@ namespace MetaWaveCompiler
             case 128:
                 return Datatype(Datatype::Int128);
             default:
-                taco_ierror << bits << " bits not supported for datatype Int";
+                metawave_ierror << bits << " bits not supported for datatype Int";
                 return Datatype(Datatype::Int32);
             }
         }
@@ -283,7 +283,7 @@ namespace MetaWaveCompiler
             case 64:
                 return Datatype(Datatype::Float64);
             default:
-                taco_ierror << bits << " bits not supported for datatype Float";
+                metawave_ierror << bits << " bits not supported for datatype Float";
                 return Datatype(Datatype::Float64);
             }
         }
@@ -300,7 +300,7 @@ namespace MetaWaveCompiler
             case 128:
                 return Datatype(Datatype::Complex128);
             default:
-                taco_ierror << bits << " bits not supported for datatype Complex";
+                metawave_ierror << bits << " bits not supported for datatype Complex";
                 return Datatype(Datatype::Complex128);
             }
         }
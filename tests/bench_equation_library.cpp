@@ -0,0 +1,36 @@
+#include "core/autogen_cursor/equation_library.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace qc;
+
+// Lookup and materialization of the builtin sets against deriving them again
+int main()
+{
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point start) { return std::chrono::duration<double>(clock::now() - start).count(); };
+
+    auto start = clock::now();
+    std::vector<EquationSet> derived = EquationLibrary::derive_builtin();
+    std::printf("derive_builtin:        %10.3f ms\n", 1e3 * seconds(start));
+
+    start = clock::now();
+    EquationLibrary::builtin_names(); // first use derives when nothing is embedded
+    std::printf("first builtin lookup:  %10.3f ms\n", 1e3 * seconds(start));
+
+    const int repeats = 100000;
+    size_t found = 0;
+    start = clock::now();
+    for (int r = 0; r < repeats; ++r)
+        found += EquationLibrary::load_builtin(r % 2 ? "ccsd_d2" : "ccsd_t").valid();
+    std::printf("load_builtin:          %10.3f ns  (%zu found)\n", 1e9 * seconds(start) / repeats, found);
+
+    for (const auto &set : derived)
+    {
+        start = clock::now();
+        EquationSet loaded = EquationLibrary::load_builtin(set.name).materialize();
+        std::printf("materialize %-10s %10.3f ms  (%zu blocks)\n", set.name.c_str(), 1e3 * seconds(start),
+                    loaded.blocks.size());
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "core/autogen_cursor/expression_dsl.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace qc;
+
+// A three-term doubles residual built through the DSL and by hand
+int main()
+{
+    using namespace qc::dsl;
+    constexpr Occupied<'i'> i;
+    constexpr Occupied<'j'> j;
+    constexpr Occupied<'k'> k;
+    constexpr Virtual<'a'> a;
+    constexpr Virtual<'b'> b;
+    constexpr Virtual<'c'> c;
+    constexpr Virtual<'d'> d;
+    const TensorHandle<2> f("f");
+    const TensorHandle<4> r2("r2"), t2("t2"), v("v");
+
+    auto by_hand = []()
+    {
+        Index i("i", Index::Type::OCCUPIED), j("j", Index::Type::OCCUPIED), k("k", Index::Type::OCCUPIED);
+        Index a("a", Index::Type::VIRTUAL), b("b", Index::Type::VIRTUAL);
+        Index c("c", Index::Type::VIRTUAL), d("d", Index::Type::VIRTUAL);
+        Tensor r2("r2", IndexSet({i, j, a, b}));
+        std::vector<ContractionTerm> terms;
+        terms.emplace_back(r2, std::vector<Tensor>{Tensor("v", IndexSet({a, b, i, j}))});
+        terms.emplace_back(
+            r2, std::vector<Tensor>{Tensor("t2", IndexSet({i, j, c, d})), Tensor("v", IndexSet({c, d, a, b}))}, 0.5);
+        terms.emplace_back(
+            r2, std::vector<Tensor>{Tensor("t2", IndexSet({i, k, a, b})), Tensor("f", IndexSet({k, j}))}, -1.0);
+        return terms;
+    };
+    auto through_dsl = [&]()
+    {
+        return equation(r2(i, j, a, b),
+                        v(a, b, i, j) + 0.5 * t2(i, j, c, d) * v(c, d, a, b) - t2(i, k, a, b) * f(k, j));
+    };
+
+    using clock = std::chrono::steady_clock;
+    const int repeats = 20000;
+    size_t sink = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        auto start = clock::now();
+        for (int r = 0; r < repeats; ++r)
+            sink += through_dsl().size();
+        double dsl_us = 1e6 * std::chrono::duration<double>(clock::now() - start).count() / repeats;
+        start = clock::now();
+        for (int r = 0; r < repeats; ++r)
+            sink += by_hand().size();
+        double hand_us = 1e6 * std::chrono::duration<double>(clock::now() - start).count() / repeats;
+        if (pass == 1)
+            std::printf("doubles residual: %.2f us through the DSL, %.2f us by hand (%zu terms)\n", dsl_us, hand_us,
+                        sink / (4 * repeats));
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "core/autogen_cursor/laplace.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace qc;
+
+// Minimax accuracy and fit time, and the DF-MP2 operation count before and
+// after the Laplace rewrite at o = 50, v = 500, N_aux = 1500
+int main()
+{
+    using clock = std::chrono::steady_clock;
+    for (size_t n : {6, 8, 10, 12})
+    {
+        auto start = clock::now();
+        LaplaceQuadrature q = LaplaceFactorization::minimax(n, 1.0, 1000.0);
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        std::printf("minimax n=%2zu on [1,1000]: error %.3e  (%.3f s)\n", n, q.error, seconds);
+    }
+    for (double tolerance : {1e-6, 1e-10, 1e-14})
+    {
+        auto start = clock::now();
+        LaplaceQuadrature q = LaplaceFactorization::fit(1.0, 10.0, tolerance);
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        std::printf("fit [1,10] to %.0e: %zu points, error %.3e  (%.3f s)\n", tolerance, q.size(), q.error,
+                    seconds);
+    }
+
+    auto &registry = SpaceRegistry::global();
+    registry.set_size("occ", 50);
+    registry.set_size("vir", 500);
+    registry.register_space("aux", 1500);
+    Index i("i", Index::Type::OCCUPIED), j("j", Index::Type::OCCUPIED);
+    Index a("a", Index::Type::VIRTUAL), b("b", Index::Type::VIRTUAL);
+    Index P = IndexFactory::in_space("P", "aux"), Q = IndexFactory::in_space("Q", "aux");
+    auto tensor = [](const char *name, std::vector<Index> indices) { return Tensor(name, IndexSet(indices)); };
+    ImplicitTensor D = ImplicitTensor::denominator(tensor("D", {i, j, a, b}));
+    ContractionTerm term(Tensor("E", IndexSet(std::vector<Index>{})),
+                         {tensor("B", {i, a, P}), tensor("B", {j, b, P}), tensor("B", {i, a, Q}),
+                          tensor("B", {j, b, Q}), tensor("D", {i, j, a, b})},
+                         0.5);
+
+    const double before = LaplaceFactorization::direct_flop_count(term);
+    for (size_t n : {6, 8, 10})
+    {
+        LaplaceFactorization laplace(D, LaplaceFactorization::minimax(n, 1.0, 1000.0));
+        ContractionTerm rewritten = term;
+        if (!laplace.apply(rewritten))
+        {
+            std::printf("DF-MP2 n_z=%zu: rewrite refused\n", n);
+            continue;
+        }
+        std::printf("DF-MP2 n_z=%2zu: %.3e flops direct, %.3e factorized\n", n, before,
+                    laplace.flop_count(rewritten));
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "core/autogen_cursor/ac_matching.h"
+#include "core/autogen_cursor/simplifier.h"
+#include "test_check.h"
+
+using namespace qc;
+
+namespace
+{
+    using Ptr = std::unique_ptr<Expression>;
+
+    Ptr s(const std::string &name) { return ExpressionFactory::symbol(Symbol(name)); }
+    Ptr add(Ptr a, Ptr b) { return ExpressionFactory::add(std::move(a), std::move(b)); }
+    Ptr sub(Ptr a, Ptr b) { return ExpressionFactory::subtract(std::move(a), std::move(b)); }
+    Ptr mul(Ptr a, Ptr b) { return ExpressionFactory::multiply(std::move(a), std::move(b)); }
+    Ptr num(double value) { return ExpressionFactory::constant(value); }
+
+    std::string normal(const Expression &expr) { return ACNormalizer::normalize(expr)->to_string(); }
+}
+
+int main()
+{
+    // Normal forms do not depend on association or operand order
+    QC_CHECK(normal(*add(add(s("a"), s("b")), s("c"))) == normal(*add(s("c"), add(s("b"), s("a")))));
+    QC_CHECK(normal(*mul(s("x"), mul(num(2.0), s("y")))) == normal(*mul(mul(s("y"), s("x")), num(2.0))));
+    QC_CHECK(normal(*sub(add(s("a"), s("b")), s("a"))) == normal(*s("b")));
+    QC_CHECK(normal(*add(mul(num(2.0), s("a")), s("a"))) == normal(*mul(num(3.0), s("a"))));
+    QC_CHECK(ACNormalizer::compare(*s("a"), *s("b")) < 0 && ACNormalizer::compare(*s("b"), *s("a")) > 0);
+
+    // Single wildcards, repeated wildcards and sequence wildcards
+    ACMatcher::Bindings bindings;
+    QC_CHECK(ACMatcher::match(*mul(s("?x"), s("y")), *mul(s("y"), add(s("a"), s("b"))), bindings));
+    QC_CHECK(bindings.count("?x") && normal(*bindings["?x"]) == normal(*add(s("b"), s("a"))));
+    bindings.clear();
+    QC_CHECK(ACMatcher::match(*add(s("?x"), s("?x")), *add(s("c"), s("c")), bindings));
+    bindings.clear();
+    QC_CHECK(!ACMatcher::match(*add(mul(s("?x"), s("p")), mul(s("?x"), s("q"))),
+                               *add(mul(s("a"), s("p")), mul(s("b"), s("q"))), bindings));
+    bindings.clear();
+    Ptr subject = add(add(mul(s("b"), s("q")), s("r")), mul(s("a"), s("p")));
+    QC_CHECK(ACMatcher::match(*add(mul(s("?x"), s("p")), s("?rest*")), *subject, bindings));
+    QC_CHECK(normal(*bindings["?x"]) == "a");
+    QC_CHECK(normal(*bindings["?rest*"]) == normal(*add(s("r"), mul(s("q"), s("b")))));
+
+    // A rewrite rule: ?x*?y + ?x*?z -> ?x*(?y + ?z) in any order of terms and factors
+    Ptr pattern = add(mul(s("?x"), s("?y")), mul(s("?x"), s("?z")));
+    Ptr replacement = mul(s("?x"), add(s("?y"), s("?z")));
+    Ptr rewritten = ACMatcher::rewrite(*add(mul(s("b"), s("k")), mul(s("k"), s("a"))), *pattern, *replacement);
+    QC_CHECK(rewritten && rewritten->to_string() == normal(*mul(s("k"), add(s("a"), s("b")))));
+    QC_CHECK(!ACMatcher::rewrite(*add(s("a"), s("b")), *pattern, *replacement));
+
+    // Non-commuting factors keep their order
+    auto noncommuting = [](const std::string &name)
+    {
+        Symbol symbol(name);
+        symbol.set_property("commutative", "false");
+        return ExpressionFactory::symbol(symbol);
+    };
+    QC_CHECK(!ACNormalizer::is_commutative(*noncommuting("P")));
+    QC_CHECK(normal(*mul(noncommuting("P"), noncommuting("Q"))) != normal(*mul(noncommuting("Q"), noncommuting("P"))));
+    QC_CHECK(normal(*mul(noncommuting("P"), mul(s("z"), noncommuting("Q")))) ==
+             normal(*mul(s("z"), mul(noncommuting("P"), noncommuting("Q")))));
+
+    // Expanding and factored forms simplify to the same result
+    Simplifier simplifier;
+    auto simplified = [&simplifier](const Expression &expr) { return simplifier.simplify(expr)->to_string(); };
+    QC_CHECK(simplified(*mul(add(s("a"), s("b")), s("x"))) ==
+             simplified(*add(mul(s("a"), s("x")), mul(s("b"), s("x")))));
+    QC_CHECK(simplified(*mul(add(s("a"), s("b")), add(s("c"), s("d")))) ==
+             simplified(*add(add(mul(s("a"), s("c")), mul(s("d"), s("a"))),
+                             add(mul(s("b"), s("c")), mul(s("b"), s("d"))))));
+    QC_CHECK(simplified(*mul(s("x"), sub(s("a"), s("b")))) ==
+             simplified(*sub(mul(s("a"), s("x")), mul(s("x"), s("b")))));
+
+    // Common factors are pulled out of non-adjacent terms by default
+    QC_CHECK(simplified(*add(add(mul(s("a"), s("x")), mul(s("b"), s("y"))), mul(s("c"), s("x")))) ==
+             normal(*add(mul(add(s("a"), s("c")), s("x")), mul(s("b"), s("y")))));
+    QC_CHECK(simplified(*add(mul(s("a"), s("x")), mul(s("b"), s("x")))) == normal(*mul(add(s("a"), s("b")), s("x"))));
+
+    // Inverse rules added by hand stop instead of cycling
+    Simplifier both;
+    both.add_rule(Simplifier::RuleType::DISTRIBUTIVE, &DistributiveRules::factor_common_terms);
+    both.enable_trace();
+    both.simplify(*mul(add(s("a"), s("b")), s("x")));
+    QC_CHECK(both.get_trace().size() <= 2);
+
+    // AC rules registered through the simplifier
+    Simplifier custom;
+    custom.remove_rules(Simplifier::RuleType::DISTRIBUTIVE);
+    custom.add_rule(Simplifier::RuleType::DISTRIBUTIVE, ACMatcher::rule(*pattern, *replacement));
+    QC_CHECK(custom.simplify(*add(mul(s("x"), s("a")), mul(s("b"), s("x"))))->to_string() ==
+             normal(*mul(s("x"), add(s("a"), s("b")))));
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,49 @@
+#include "core/autogen_cursor/antisymmetry.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    // Packed storage of strictly ordered tuples
+    QC_CHECK(AntisymmetryAnalysis::packed_size(5, 2) == 10);
+    QC_CHECK(AntisymmetryAnalysis::packed_size(6, 3) == 20);
+    QC_CHECK(AntisymmetryAnalysis::packed_offset({0, 1}) == 0);
+    QC_CHECK(AntisymmetryAnalysis::packed_offset({0, 2}) == 1);
+    QC_CHECK(AntisymmetryAnalysis::packed_offset({1, 2}) == 2);
+    QC_CHECK(AntisymmetryAnalysis::packed_offset({0, 1, 3}) == 1);
+
+    std::vector<long> values{3, 1, 2};
+    QC_CHECK(AntisymmetryAnalysis::sort_with_sign(values) == 1);
+    QC_CHECK((values == std::vector<long>{1, 2, 3}));
+    values = {2, 1};
+    QC_CHECK(AntisymmetryAnalysis::sort_with_sign(values) == -1);
+    values = {4, 2, 4};
+    QC_CHECK(AntisymmetryAnalysis::sort_with_sign(values) == 0);
+
+    // r_ij^ab += 1/2 v_ab^cd t_ij^cd: unique output blocks i<j, a<b and a
+    // restricted c<d sum, which absorbs the factor 1/2
+    Index i("i", Index::Type::OCCUPIED), j("j", Index::Type::OCCUPIED);
+    Index a("a", Index::Type::VIRTUAL), b("b", Index::Type::VIRTUAL);
+    Index c("c", Index::Type::VIRTUAL), d("d", Index::Type::VIRTUAL);
+    Tensor r("r", IndexSet({i, j, a, b})), t("t", IndexSet({i, j, c, d})), v("v", IndexSet({a, b, c, d}));
+    for (Tensor *tensor : {&r, &t, &v})
+        tensor->set_property("antisymmetric_groups", "0,1;2,3");
+    QC_CHECK(AntisymmetryAnalysis::groups(t).size() == 2);
+
+    auto plan = RestrictedSummation::plan(ContractionTerm(r, {v, t}, 0.5));
+    QC_CHECK_NEAR(plan.prefactor, 1.0, 1e-15);
+    QC_CHECK_NEAR(plan.iteration_fraction, 0.125, 1e-15);
+    QC_CHECK(plan.external_groups.size() == 2);
+    QC_CHECK((plan.summed_groups == std::vector<std::vector<std::string>>{{"c", "d"}}));
+    QC_CHECK(RestrictedSummation::loop_group_of(plan, "c") >= 0);
+    QC_CHECK(RestrictedSummation::loop_group_of(plan, "c") == RestrictedSummation::loop_group_of(plan, "d"));
+
+    // Without the antisymmetry of t the c, d sum is unrestricted
+    Tensor plain("t", IndexSet({i, j, c, d}));
+    auto unrestricted = RestrictedSummation::plan(ContractionTerm(r, {v, plain}, 0.5));
+    QC_CHECK(unrestricted.summed_groups.empty());
+    QC_CHECK_NEAR(unrestricted.prefactor, 0.5, 1e-15);
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,82 @@
+#include "core/autogen_cursor/batch_compiler.h"
+#include "core/autogen_cursor/equation_library.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "test_check.h"
+#include <cstdio>
+
+using namespace qc;
+
+int main()
+{
+    const std::string manifest = "# triples and densities\n"
+                                 "default strategy=pairwise\n"
+                                 "t_conn builtin:ccsd_t/connected\n"
+                                 "t_disc builtin:ccsd_t/disconnected backend=float\n"
+                                 "d1 builtin:ccsd_d1\n"
+                                 "d2 builtin:ccsd_d2 memory=1G\n"
+                                 "d2_rdm rdm:2 strategy=direct\n"
+                                 "missing builtin:ccsd_d3\n";
+    std::vector<BatchJob> jobs;
+    std::string error;
+    QC_CHECK(BatchCompiler::parse_manifest(manifest, jobs, error));
+    QC_CHECK(jobs.size() == 6 && jobs[0].strategy == "pairwise" && jobs[4].strategy == "direct");
+    QC_CHECK(!BatchCompiler::parse_manifest("x builtin:ccsd_t memory=lots\n", jobs, error));
+    QC_CHECK(error.compare(0, 7, "line 1:") == 0);
+    QC_CHECK(BatchCompiler::parse_manifest(manifest, jobs, error));
+
+    // The output does not depend on the number of workers
+    BatchOptions serial_options;
+    serial_options.threads = 1;
+    BatchCompiler serial(serial_options);
+    QC_CHECK(!serial.run(jobs));
+    QC_CHECK(serial.stats().failed == 1 && !serial.results()[5].ok);
+    QC_CHECK(serial.results()[5].error.find("no builtin equation set 'ccsd_d3'") != std::string::npos);
+
+    // Spaces of builtin sets are registered before the workers start
+    for (const auto &space : EquationLibrary::load_builtin("ccsd_d2").spaces())
+        QC_CHECK(SpaceRegistry::global().id(space) >= 0);
+
+    BatchOptions parallel_options;
+    parallel_options.threads = 4;
+    parallel_options.memory_limit = 1.5 * 1024 * 1024 * 1024;
+    for (int repeat = 0; repeat < 5; ++repeat)
+    {
+        BatchCompiler parallel(parallel_options);
+        QC_CHECK(!parallel.run(jobs));
+        QC_CHECK(parallel.output() == serial.output());
+        for (size_t j = 0; j + 1 < jobs.size(); ++j)
+        {
+            QC_CHECK(parallel.results()[j].ok && parallel.results()[j].kernels > 0);
+            QC_CHECK(parallel.results()[j].code == serial.results()[j].code);
+        }
+        QC_CHECK(parallel.stats().peak_memory <= parallel_options.memory_limit);
+    }
+    QC_CHECK(serial.output().find("float") != std::string::npos);
+
+    // A second run with the cache reuses every phase that succeeded; a new
+    // backend regenerates the kernels of that job alone
+    const std::string cache = "test_batch_compiler.cache";
+    std::remove(cache.c_str());
+    BatchOptions cached_options = parallel_options;
+    cached_options.cache = cache;
+    BatchCompiler first(cached_options);
+    QC_CHECK(!first.run(jobs));
+    QC_CHECK(first.stats().cache_saved && first.stats().reused == 0 && first.output() == serial.output());
+    BatchCompiler second(cached_options);
+    QC_CHECK(!second.run(jobs));
+    QC_CHECK(second.stats().reused == kNumBatchPhases * (jobs.size() - 1));
+    QC_CHECK(second.output() == serial.output());
+    for (size_t j = 0; j + 1 < jobs.size(); ++j)
+    {
+        QC_CHECK(second.results()[j].terms == serial.results()[j].terms);
+        QC_CHECK(second.results()[j].kernels == serial.results()[j].kernels);
+    }
+    jobs[0].backend = "float";
+    BatchCompiler third(cached_options);
+    QC_CHECK(!third.run(jobs));
+    QC_CHECK(third.stats().reused == kNumBatchPhases * (jobs.size() - 1) - 1);
+    QC_CHECK(third.results()[0].code.find("float") != std::string::npos);
+    std::remove(cache.c_str());
+
+    return QC_TEST_RESULT();
+}
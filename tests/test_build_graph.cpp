@@ -0,0 +1,146 @@
+#include "core/autogen_cursor/build_graph.h"
+#include "test_check.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace qc;
+
+namespace
+{
+    // equation -> doubled (prefactor 2) -> signs (prefactor sign only) -> kernel
+    void make_graph(BuildGraph &graph, const std::vector<ContractionTerm> &terms, int &runs)
+    {
+        graph.add_equation("eq", terms);
+        graph.add_rule("codegen", "double");
+        graph.add_node("doubled", BuildGraph::Kind::TERMS, {0},
+                       [&runs](const std::vector<const BuildArtifact *> &inputs)
+                       {
+                           ++runs;
+                           BuildArtifact artifact;
+                           for (auto term : inputs[0]->terms)
+                           {
+                               term.set_prefactor(2.0 * term.prefactor());
+                               artifact.terms.push_back(term);
+                           }
+                           return artifact;
+                       });
+        graph.add_node("signs", BuildGraph::Kind::TERMS, {2},
+                       [&runs](const std::vector<const BuildArtifact *> &inputs)
+                       {
+                           ++runs;
+                           BuildArtifact artifact;
+                           for (auto term : inputs[0]->terms)
+                           {
+                               term.set_prefactor(term.prefactor() < 0 ? -1.0 : 1.0);
+                               artifact.terms.push_back(term);
+                           }
+                           return artifact;
+                       });
+        graph.add_node("kernel", BuildGraph::Kind::KERNEL, {3, 1},
+                       BuildGraph::fused_kernel("update", CodeGenerator()));
+    }
+}
+
+int main()
+{
+    Index i("i", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL);
+    ContractionTerm term(Tensor("r", IndexSet({i, a})), {Tensor("f", IndexSet({i, a}))}, 0.5);
+
+    int runs = 0;
+    BuildGraph graph;
+    make_graph(graph, {term}, runs);
+    QC_CHECK(graph.size() == 5);
+    QC_CHECK(graph.add_equation("eq", {term}) == -1);
+    QC_CHECK(graph.add_node("late", BuildGraph::Kind::TERMS, {7}, BuildGraph::fused_kernel("x", CodeGenerator())) == -1);
+    QC_CHECK(graph.add_node("source", BuildGraph::Kind::RULE, {0}, BuildGraph::fused_kernel("x", CodeGenerator())) == -1);
+    QC_CHECK((graph.affected("doubled") == std::vector<size_t>{2, 3, 4}));
+    QC_CHECK((graph.affected("codegen") == std::vector<size_t>{1, 4}));
+
+    graph.build();
+    QC_CHECK(graph.stats().recomputed == 3 && runs == 2);
+    QC_CHECK(graph.artifact(2).terms[0].prefactor() == 1.0);
+    const std::string kernel = graph.artifact(4).text;
+    QC_CHECK(kernel.find("void update(") != std::string::npos);
+
+    // Nothing changed: every node is reused
+    graph.build();
+    QC_CHECK(graph.stats().reused == 3 && runs == 2);
+
+    // A new prefactor with the same sign stops at "signs"
+    QC_CHECK(graph.set_equation("eq", {ContractionTerm(term.output(), term.factors(), 0.25)}));
+    QC_CHECK(!graph.set_equation("doubled", {term}) && !graph.set_rule("eq", "x"));
+    graph.build();
+    QC_CHECK(graph.stats().recomputed == 2 && graph.stats().unchanged == 1 && graph.stats().reused == 1);
+    QC_CHECK((graph.stats().recomputed_nodes == std::vector<std::string>{"doubled", "signs"}));
+    QC_CHECK(graph.artifact(4).text == kernel);
+
+    // A rule change reaches only the kernel
+    QC_CHECK(graph.set_rule("codegen", "float"));
+    graph.build();
+    QC_CHECK((graph.stats().recomputed_nodes == std::vector<std::string>{"kernel"}));
+    graph.build(true);
+    QC_CHECK(graph.stats().recomputed == 3);
+
+    // A fresh graph reuses the saved artifacts, bit for bit
+    const std::string path = "test_build_graph.cache";
+    QC_CHECK(graph.save(path));
+    int fresh_runs = 0;
+    BuildGraph fresh;
+    make_graph(fresh, {ContractionTerm(term.output(), term.factors(), 0.25)}, fresh_runs);
+    fresh.set_rule("codegen", "float");
+    QC_CHECK(fresh.load(path));
+    fresh.build();
+    QC_CHECK(fresh.stats().reused == 3 && fresh_runs == 0);
+    QC_CHECK(fresh.artifact(4).text == graph.artifact(4).text);
+    QC_CHECK(BuildGraph::content_hash(fresh.artifact(3)) == BuildGraph::content_hash(graph.artifact(3)));
+
+    // A cache entry built from other inputs is recomputed
+    BuildGraph edited;
+    make_graph(edited, {ContractionTerm(term.output(), term.factors(), -1.0)}, fresh_runs);
+    QC_CHECK(edited.load(path));
+    edited.build();
+    QC_CHECK(edited.stats().recomputed == 3 && fresh_runs == 2);
+
+    // Truncated cache files are refused
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary);
+        out << data.substr(0, data.size() - 3);
+    }
+    QC_CHECK(!fresh.load(path));
+    QC_CHECK(!fresh.load("missing.cache"));
+    std::remove(path.c_str());
+
+    // A failed transform fails its dependents, is not cached and is retried
+    bool reject = true;
+    BuildGraph failing;
+    failing.add_equation("eq", {term});
+    failing.add_node("checked", BuildGraph::Kind::TERMS, {0},
+                     [&reject](const std::vector<const BuildArtifact *> &inputs)
+                     {
+                         BuildArtifact artifact;
+                         if (reject)
+                             artifact.error = "rejected";
+                         else
+                             artifact.terms = inputs[0]->terms;
+                         return artifact;
+                     });
+    failing.add_node("kernel", BuildGraph::Kind::KERNEL, {1}, BuildGraph::fused_kernel("checked", CodeGenerator()));
+    failing.build();
+    QC_CHECK(failing.stats().failed == 2 && failing.stats().recomputed == 0);
+    QC_CHECK(failing.artifact(1).error == "rejected" && failing.artifact(2).error == "input 'checked' failed");
+    QC_CHECK(failing.save(path));
+    BuildGraph reloaded;
+    reloaded.add_equation("eq", {term});
+    QC_CHECK(reloaded.load(path));
+    std::remove(path.c_str());
+    reject = false;
+    QC_CHECK(failing.build_node(1) == BuildGraph::Outcome::RECOMPUTED);
+    QC_CHECK(failing.build_node(2) == BuildGraph::Outcome::RECOMPUTED);
+    QC_CHECK(failing.build_node(2) == BuildGraph::Outcome::REUSED);
+    failing.release(2);
+    QC_CHECK(failing.artifact(2).text.empty() && failing.build_node(2) == BuildGraph::Outcome::RECOMPUTED);
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal checks shared by the unit tests. A failed check is reported
+// with its location and counted; QC_TEST_RESULT() is the exit status.
+namespace qc_test
+{
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+}
+
+#define QC_CHECK(condition)                                                               \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++qc_test::failures();                                                        \
+        }                                                                                 \
+    } while (0)
+
+#define QC_CHECK_NEAR(actual, expected, tolerance)                                         \
+    do                                                                                    \
+    {                                                                                     \
+        double qc_actual_ = (actual), qc_expected_ = (expected);                          \
+        if (!(std::fabs(qc_actual_ - qc_expected_) <= (tolerance)))                       \
+        {                                                                                 \
+            std::fprintf(stderr, "%s:%d: check failed: %s = %.17g, expected %.17g\n",     \
+                         __FILE__, __LINE__, #actual, qc_actual_, qc_expected_);          \
+            ++qc_test::failures();                                                        \
+        }                                                                                 \
+    } while (0)
+
+#define QC_TEST_RESULT() (qc_test::failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
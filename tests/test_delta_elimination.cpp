@@ -0,0 +1,35 @@
+#include "core/autogen_cursor/delta_elimination.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    Index i("i", Index::Type::OCCUPIED), j("j", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL);
+    Index p("p"), q("q");
+    Tensor r("r", IndexSet({i, a}));
+
+    // r_ia += f_ip d_pj t_ja -> f_ij t_ja: p is summed and renamed away
+    ContractionTerm term(r, {Tensor("f", IndexSet({i, p})), TensorFactory::kronecker_delta(p, j),
+                             Tensor("t", IndexSet({j, a}))});
+    QC_CHECK(KroneckerDeltaElimination::apply(term) == KroneckerDeltaElimination::Result::SIMPLIFIED);
+    QC_CHECK(term.num_factors() == 2);
+    for (const auto &factor : term.factors())
+    {
+        QC_CHECK(!KroneckerDeltaElimination::is_delta(factor));
+        QC_CHECK(!factor.indices().get_labels().count("p"));
+    }
+
+    // A delta between occupied and virtual indices makes the term vanish
+    ContractionTerm vanishing(r, {TensorFactory::kronecker_delta(i, a)});
+    QC_CHECK(KroneckerDeltaElimination::apply(vanishing) == KroneckerDeltaElimination::Result::VANISHED);
+    QC_CHECK(vanishing.prefactor() == 0.0);
+    QC_CHECK(KroneckerDeltaElimination::apply(std::vector<ContractionTerm>{vanishing, term}).size() == 1);
+
+    // A delta between two external indices stays
+    ContractionTerm external(Tensor("s", IndexSet({p, q})), {TensorFactory::kronecker_delta(p, q)});
+    QC_CHECK(KroneckerDeltaElimination::apply(external) == KroneckerDeltaElimination::Result::UNCHANGED);
+    QC_CHECK(external.num_factors() == 1);
+
+    return QC_TEST_RESULT();
+}
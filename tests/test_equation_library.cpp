@@ -0,0 +1,62 @@
+#include "core/autogen_cursor/equation_library.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "test_check.h"
+#include <algorithm>
+
+using namespace qc;
+
+int main()
+{
+    // The builtin sets load whether they were embedded or derived at first use
+    std::vector<std::string> names = EquationLibrary::builtin_names();
+    QC_CHECK((names == std::vector<std::string>{"ccsd_t", "ccsd_d1", "ccsd_d2"}));
+    EquationSetView triples = EquationLibrary::load_builtin("ccsd_t");
+    QC_CHECK(triples.valid() && triples.num_blocks() == 2);
+    QC_CHECK(triples.block("connected").valid() && !triples.block("fourth").valid());
+    QC_CHECK(!EquationLibrary::load_builtin("ccsdt").valid());
+
+    // Round trip of a small library
+    Index i("i", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL);
+    Tensor f("f", IndexSet({i, a}));
+    f.set_property("symmetry", "none");
+    ContractionTerm term(Tensor("r", IndexSet({i, a})), {f, Tensor("t", IndexSet({a, i}))}, -0.5);
+    std::vector<unsigned char> blob = EquationLibrary::serialize({{"small", {{"singles", {term, term}}}}});
+    QC_CHECK(EquationLibrary::is_valid(blob.data(), blob.size()));
+    EquationSet set = EquationLibrary::find(blob.data(), blob.size(), "small").materialize();
+    QC_CHECK(set.blocks.size() == 1 && set.blocks[0].second.size() == 2);
+    const ContractionTerm &back = set.blocks[0].second[1];
+    QC_CHECK(back.prefactor() == -0.5 && back.num_factors() == 2);
+    QC_CHECK(back.factors()[0].get_property("symmetry") == "none");
+    QC_CHECK(back.output().indices()[1].label() == "a");
+
+    // Spaces named by a set, for callers that register them up front
+    SpaceRegistry::global().register_space("test_library_aux", 12);
+    Index P = IndexFactory::in_space("P", "test_library_aux");
+    ContractionTerm fitted(Tensor("r", IndexSet({i, a})), {Tensor("B", IndexSet({i, a, P}))});
+    std::vector<unsigned char> spaced = EquationLibrary::serialize({{"fitted", {{"b", {fitted}}}}});
+    EquationSetView fitted_view = EquationLibrary::find(spaced.data(), spaced.size(), "fitted");
+    QC_CHECK((fitted_view.spaces() == std::vector<std::string>{"test_library_aux"}));
+    TensorRecordView record = fitted_view.block(0).term(0).factor(0);
+    QC_CHECK(record.space(0).empty() && record.space(2) == "test_library_aux");
+
+    // Truncated blobs and out-of-range offsets are rejected before any view reads them
+    for (size_t size = 0; size < blob.size(); ++size)
+        QC_CHECK(!EquationLibrary::is_valid(blob.data(), size));
+    size_t accepted = 0;
+    for (size_t at = 4; at + 4 <= blob.size(); at += 4)
+    {
+        std::vector<unsigned char> corrupt = blob;
+        std::fill(corrupt.begin() + at, corrupt.begin() + at + 4, 0xf0);
+        if (!EquationLibrary::is_valid(corrupt.data(), corrupt.size()))
+            continue;
+        ++accepted; // string bytes, a prefactor or an index field; the records still resolve
+        std::vector<std::string> corrupt_names = EquationLibrary::names(corrupt.data(), corrupt.size());
+        QC_CHECK(corrupt_names.size() == 1);
+        EquationSetView view = EquationLibrary::find(corrupt.data(), corrupt.size(), corrupt_names[0]);
+        QC_CHECK(view.valid() && view.materialize().blocks.size() == 1);
+    }
+    QC_CHECK(accepted > 0);
+    QC_CHECK(EquationLibrary::names(blob.data(), blob.size() - 1).empty());
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,80 @@
+#include "core/autogen_cursor/expression_dsl.h"
+#include "test_check.h"
+#include <type_traits>
+
+using namespace qc;
+using namespace qc::dsl;
+
+namespace
+{
+    constexpr Occupied<'i'> i;
+    constexpr Occupied<'j'> j;
+    constexpr Occupied<'k'> k;
+    constexpr Virtual<'a'> a;
+    constexpr Virtual<'b'> b;
+    constexpr Virtual<'c'> c;
+    constexpr Virtual<'d'> d;
+
+    std::string labels(const Tensor &tensor)
+    {
+        std::string result;
+        for (const auto &idx : tensor.indices())
+            result += idx->label();
+        return result;
+    }
+}
+
+int main()
+{
+    const TensorHandle<2> f("f"), t1("t1"), r1("r1");
+    const TensorHandle<4> r2("r2"), t2("t2"), v("v");
+
+    // Index structure is part of the type
+    using Ladder = decltype(t2(i, j, c, d) * v(c, d, a, b));
+    static_assert(Ladder::Free::size == 4 && Ladder::Bound::size == 2, "ladder: ijab free, cd summed");
+    static_assert(Ladder::num_terms == 1 && Ladder::max_factors == 2, "ladder is one two-factor term");
+    using Trace = decltype(f(i, i));
+    static_assert(Trace::Free::size == 0 && Trace::Bound::size == 1, "a repeated index is summed");
+    using Expanded = decltype((f(i, k) + 2.0 * t1(i, c) * f(c, k)) * (t1(k, a) - f(k, a)));
+    static_assert(Expanded::num_terms == 4 && Expanded::max_factors == 3, "products of sums expand");
+    static_assert(std::is_same<Occupied<'i'>, std::decay_t<decltype(i)>>::value, "indices are empty types");
+
+    // Doubles residual: one term per product, prefactors folded in
+    std::vector<ContractionTerm> terms =
+        equation(r2(i, j, a, b), v(a, b, i, j) + 0.5 * t2(i, j, c, d) * v(c, d, a, b) - t2(i, k, a, b) * f(k, j));
+    QC_CHECK(terms.size() == 3);
+    QC_CHECK(terms[0].num_factors() == 1 && terms[0].prefactor() == 1.0);
+    QC_CHECK(terms[1].num_factors() == 2 && terms[1].prefactor() == 0.5);
+    QC_CHECK(terms[2].prefactor() == -1.0);
+    QC_CHECK(labels(terms[1].output()) == "ijab");
+    QC_CHECK(terms[1].factors()[0].symbol().name() == "t2" && labels(terms[1].factors()[0]) == "ijcd");
+    QC_CHECK(labels(terms[2].factors()[1]) == "kj");
+    QC_CHECK(terms[1].factors()[1].indices()[0].type() == Index::Type::VIRTUAL);
+
+    // Distribution over sums; scalars multiply through
+    terms = equation(r1(i, a), 2.0 * ((f(i, k) + 3.0 * t1(i, c) * f(c, k)) * (t1(k, a) - f(k, a))));
+    QC_CHECK(terms.size() == 4);
+    const double prefactors[] = {2.0, -2.0, 6.0, -6.0};
+    for (size_t t = 0; t < terms.size(); ++t)
+        QC_CHECK(terms[t].prefactor() == prefactors[t]);
+    QC_CHECK(terms[3].num_factors() == 3 && labels(terms[3].factors()[2]) == "ka");
+
+    // Appending keeps earlier terms
+    equation(terms, r1(i, a), f(i, a));
+    QC_CHECK(terms.size() == 5 && terms[4].factors()[0].symbol().name() == "f");
+
+    // Expression trees: sums flatten, shared indices contract
+    auto tree = expression(v(a, b, i, j) + 0.5 * (t2(i, j, c, d) * v(c, d, a, b)) - t2(i, k, a, b) * f(k, j));
+    const auto *sum = dynamic_cast<const SumExpression *>(tree.get());
+    QC_CHECK(sum != nullptr && sum->num_terms() == 3);
+    if (sum)
+    {
+        QC_CHECK(sum->coefficient(0) == 1.0 && sum->coefficient(1) == 0.5 && sum->coefficient(2) == -1.0);
+        const auto *ladder = dynamic_cast<const ContractionExpression *>(&sum->child(1));
+        QC_CHECK(ladder != nullptr && ladder->contracted_indices().size() == 2);
+    }
+    auto outer = expression(t1(i, a) * t1(j, b));
+    QC_CHECK(dynamic_cast<const ContractionExpression *>(outer.get()) == nullptr);
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,43 @@
+#include "core/autogen_cursor/code_generator.h"
+#include "core/autogen_cursor/field_inference.h"
+#include "core/autogen_cursor/term_fusion.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    QC_CHECK(FieldInference::product(Field::IMAGINARY, Field::IMAGINARY) == Field::REAL);
+    QC_CHECK(FieldInference::sum(Field::REAL, Field::IMAGINARY) == Field::COMPLEX);
+    QC_CHECK(FieldInference::parse("imaginary") == Field::IMAGINARY);
+
+    Index i("i", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL);
+    Tensor h("h", IndexSet({i, a}));
+    FieldInference::set(h, Field::IMAGINARY);
+
+    // i * i folds into a sign of a real term
+    TermField squared = FieldInference::of(ContractionTerm(Tensor("s", IndexSet({i, a})), {h, h}));
+    QC_CHECK(squared.field == Field::REAL && squared.sign == -1.0);
+
+    // A real and an imaginary term write r in different index orders, so
+    // they do not fuse; both kernels must still treat r as complex
+    ContractionTerm real_term(Tensor("r", IndexSet({i, a})), {Tensor("g", IndexSet({i, a}))});
+    ContractionTerm imag_term(Tensor("r", IndexSet({a, i})), {h});
+    QC_CHECK(!TermFusion::fusable(real_term, imag_term));
+
+    CodeGenerator codegen;
+    std::string fused = codegen.generate_fused("update", {real_term, imag_term});
+    QC_CHECK(fused.find("void update(std::complex<double> *r") != std::string::npos);
+    QC_CHECK(fused.find("std::complex<double>(0.0, ") != std::string::npos);
+
+    // Separate kernels agree once the outputs are annotated
+    std::vector<ContractionTerm> terms = {real_term, imag_term};
+    CodeGenerator::annotate_outputs(terms);
+    QC_CHECK(FieldInference::of(terms[0].output()) == Field::COMPLEX);
+    QC_CHECK(codegen.generate("first", terms[0]).find("void first(std::complex<double> *r") != std::string::npos);
+    std::string second = codegen.generate("second", terms[1]);
+    QC_CHECK(second.find("void second(std::complex<double> *r") != std::string::npos);
+    QC_CHECK(second.find("std::complex<double>(0.0, ") != std::string::npos);
+
+    return QC_TEST_RESULT();
+}
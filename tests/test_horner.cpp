@@ -0,0 +1,92 @@
+#include "core/autogen_cursor/horner.h"
+#include "core/autogen_cursor/ac_matching.h"
+#include "test_check.h"
+#include <cmath>
+#include <map>
+
+using namespace qc;
+
+namespace
+{
+    using Ptr = std::unique_ptr<Expression>;
+
+    Ptr s(const std::string &name) { return ExpressionFactory::symbol(Symbol(name)); }
+    Ptr num(double value) { return ExpressionFactory::constant(value); }
+    Ptr add(Ptr a, Ptr b) { return ExpressionFactory::add(std::move(a), std::move(b)); }
+    Ptr mul(Ptr a, Ptr b) { return ExpressionFactory::multiply(std::move(a), std::move(b)); }
+    Ptr pow(Ptr a, double k) { return ExpressionFactory::power(std::move(a), num(k)); }
+
+    // Value of a tree of symbols, constants, sums, products and powers
+    double value(const Expression &expr, const std::map<std::string, double> &at)
+    {
+        double constant;
+        if (ACNormalizer::constant_value(expr, constant))
+            return constant;
+        if (const auto *symbol = dynamic_cast<const SymbolExpression *>(&expr))
+            return at.at(symbol->symbol().name());
+        if (const auto *sum = dynamic_cast<const SumExpression *>(&expr))
+        {
+            double result = 0.0;
+            for (size_t t = 0; t < sum->num_terms(); ++t)
+                result += sum->coefficient(t) * value(sum->child(t), at);
+            return result;
+        }
+        switch (expr.type())
+        {
+        case Expression::Type::ADD:
+            return value(expr.child(0), at) + value(expr.child(1), at);
+        case Expression::Type::MULTIPLY:
+        {
+            double result = 1.0;
+            for (size_t i = 0; i < expr.num_children(); ++i)
+                result *= value(expr.child(i), at);
+            return result;
+        }
+        case Expression::Type::POWER:
+            return std::pow(value(expr.child(0), at), value(expr.child(1), at));
+        default:
+            return NAN;
+        }
+    }
+}
+
+int main()
+{
+    const std::map<std::string, double> at = {{"a", 0.7}, {"b", -1.3}, {"c", 2.1}, {"d", 0.4}, {"x", 1.9}, {"y", -0.6}};
+
+    // a*x^3 + b*x^2 + c*x + d written with powers: 8 operations, 6 in Horner form
+    Ptr cubic = add(add(add(mul(s("a"), pow(s("x"), 3)), mul(s("b"), pow(s("x"), 2))), mul(s("c"), s("x"))), s("d"));
+    HornerFactorization horner;
+    Ptr factored = horner.apply(*cubic);
+    QC_CHECK(horner.stats().before.total() == 8);
+    QC_CHECK(horner.stats().after.total() == 6);
+    QC_CHECK(horner.stats().factorizations >= 2);
+    QC_CHECK_NEAR(value(*factored, at), value(*cubic, at), 1e-12);
+
+    // The same polynomial written with repeated factors factors the same way
+    Ptr repeated = add(add(add(mul(s("a"), mul(s("x"), mul(s("x"), s("x")))), mul(mul(s("x"), s("b")), s("x"))),
+                           mul(s("c"), s("x"))),
+                       s("d"));
+    QC_CHECK(HornerFactorization().apply(*repeated)->to_string() == factored->to_string());
+
+    // Multivariate, with shared coefficients
+    Ptr mixed = add(add(mul(num(0.5), mul(pow(s("x"), 2), s("y"))), mul(num(0.5), mul(s("x"), s("y")))),
+                    mul(num(0.5), s("y")));
+    Ptr mixed_factored = horner.apply(*mixed);
+    QC_CHECK(horner.stats().after.total() < horner.stats().before.total());
+    QC_CHECK_NEAR(value(*mixed_factored, at), value(*mixed, at), 1e-12);
+
+    // Nothing to share: the powers are kept, no operation is added
+    Ptr separate = add(mul(s("a"), pow(s("x"), 12)), mul(s("b"), pow(s("y"), 2)));
+    Ptr kept = horner.apply(*separate);
+    QC_CHECK(horner.stats().after.total() == horner.stats().before.total() && horner.stats().factorizations == 0);
+    QC_CHECK_NEAR(value(*kept, at), value(*separate, at), 1e-9);
+
+    // Powers above x^16 or with fractional exponents stay opaque factors
+    Ptr high = add(mul(s("a"), pow(s("x"), 20)), mul(s("b"), pow(s("x"), 0.5)));
+    Ptr high_result = horner.apply(*high);
+    QC_CHECK(horner.stats().factorizations == 0);
+    QC_CHECK_NEAR(value(*high_result, at), value(*high, at), 1e-6);
+
+    return QC_TEST_RESULT();
+}
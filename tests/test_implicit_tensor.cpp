@@ -0,0 +1,44 @@
+#include "core/autogen_cursor/implicit_tensor.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/numeric/evaluator.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    auto &registry = SpaceRegistry::global();
+    int occ = registry.id("occ"), vir = registry.id("vir");
+    Index i("i", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL);
+
+    // 1 / (e_i - e_a)
+    ImplicitTensor denominator = ImplicitTensor::denominator(Tensor("D", IndexSet({i, a})));
+    QC_CHECK(denominator.element_expression({"i", "a"}) == "(1.0 / (e_occ[i] - e_vir[a]))");
+
+    const double e_occ[] = {-2.0, -1.0};
+    const double e_vir[] = {0.5, 1.5, 3.0};
+    QC_CHECK_NEAR(denominator.element({1, 2}, {{occ, e_occ}, {vir, e_vir}}), 1.0 / (-1.0 - 3.0), 1e-15);
+
+    // A missing diagonal or slot value gives NaN, never a partial sum
+    QC_CHECK(std::isnan(denominator.element({1, 2}, {{occ, e_occ}})));
+    QC_CHECK(std::isnan(denominator.element({1}, {{occ, e_occ}, {vir, e_vir}})));
+
+    // The evaluator refuses a term whose implicit factor lacks a diagonal
+    DenseTensor t({2, 3}, 1.0), r({2, 3}), d_occ({2}), d_vir({3});
+    for (long p = 0; p < 2; ++p)
+        d_occ({p}) = e_occ[p];
+    for (long p = 0; p < 3; ++p)
+        d_vir({p}) = e_vir[p];
+    Evaluator evaluator;
+    evaluator.bind("t", t);
+    evaluator.add_implicit(denominator);
+    evaluator.set_diagonal(occ, d_occ);
+    ContractionTerm term(Tensor("r", IndexSet({i, a})), {Tensor("t", IndexSet({i, a})), denominator.tensor()});
+    QC_CHECK(!evaluator.evaluate(term, r));
+
+    evaluator.set_diagonal(vir, d_vir);
+    QC_CHECK(evaluator.evaluate(term, r));
+    QC_CHECK_NEAR(r({0, 1}), 1.0 / (-2.0 - 1.5), 1e-15);
+
+    return QC_TEST_RESULT();
+}
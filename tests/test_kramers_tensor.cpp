@@ -0,0 +1,63 @@
+#include "core/numeric/kramers_tensor.h"
+#include "test_check.h"
+#include <cmath>
+
+using namespace qc;
+
+int main()
+{
+    // Complex unique blocks of a rank-2 tensor over 3 Kramers pairs
+    KramersTensor tensor({3, 3});
+    QC_CHECK(tensor.num_blocks() == 2);
+    for (std::uint64_t pattern : {0u, 2u})
+    {
+        ComplexTensor *block = tensor.block(pattern);
+        QC_CHECK(block != nullptr);
+        for (long p = 0; p < 3; ++p)
+        {
+            for (long q = 0; q < 3; ++q)
+                block->set({p, q}, {0.1 * p + q + pattern, 0.3 * q - p + 0.5 * pattern});
+        }
+    }
+    QC_CHECK(tensor.size() == 18);
+
+    // Barred-first patterns and bits beyond the rank are refused
+    QC_CHECK(tensor.block(1) == nullptr && tensor.block(3) == nullptr && tensor.block(4) == nullptr);
+    QC_CHECK(std::isnan(tensor.element({0, 0}, 4).real()));
+
+    // T[m] = (-1)^|m| conj(T[~m]) on the spinor tensor
+    ComplexTensor spinor = tensor.to_spinor();
+    QC_CHECK((spinor.shape() == std::vector<long>{6, 6}));
+    double worst = 0.0;
+    for (long p = 0; p < 3; ++p)
+    {
+        for (long q = 0; q < 3; ++q)
+        {
+            worst = std::max(worst, std::abs(spinor({p + 3, q + 3}) - std::conj(spinor({p, q}))));
+            worst = std::max(worst, std::abs(spinor({p + 3, q}) + std::conj(spinor({p, q + 3}))));
+            worst = std::max(worst, std::abs(tensor.element({p, q}, 1) + std::conj(tensor.element({p, q}, 2))));
+        }
+    }
+    QC_CHECK_NEAR(worst, 0.0, 1e-15);
+    QC_CHECK(std::abs(spinor({1, 2}).imag()) > 0.0);
+
+    // Round trip through the spinor tensor
+    KramersTensor back;
+    QC_CHECK(KramersTensor::from_spinor(spinor, back));
+    QC_CHECK((back.shape() == std::vector<long>{3, 3}));
+    worst = 0.0;
+    for (std::uint64_t pattern = 0; pattern < 4; ++pattern)
+    {
+        for (long p = 0; p < 3; ++p)
+        {
+            for (long q = 0; q < 3; ++q)
+                worst = std::max(worst, std::abs(back.element({p, q}, pattern) - tensor.element({p, q}, pattern)));
+        }
+    }
+    QC_CHECK_NEAR(worst, 0.0, 1e-15);
+
+    // Odd spinor extents have no Kramers pairing
+    QC_CHECK(!KramersTensor::from_spinor(ComplexTensor({6, 5}), back));
+
+    return QC_TEST_RESULT();
+}
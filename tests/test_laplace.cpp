@@ -0,0 +1,127 @@
+#include "core/autogen_cursor/laplace.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/numeric/evaluator.h"
+#include "test_check.h"
+#include <cmath>
+#include <random>
+
+using namespace qc;
+
+int main()
+{
+    // The minimax error falls with every point
+    double previous = 2.0;
+    for (size_t n = 1; n <= 18; ++n)
+    {
+        LaplaceQuadrature q = LaplaceFactorization::minimax(n, 0.5, 5000.0);
+        QC_CHECK(q.size() == n);
+        QC_CHECK(q.error < previous);
+        previous = q.error;
+    }
+    QC_CHECK(previous < 1e-6);
+
+    // The error bound holds between the grid points
+    LaplaceQuadrature q = LaplaceFactorization::fit(1.0, 1000.0, 1e-6);
+    QC_CHECK(q.error <= 1e-6 && q.size() <= 15);
+    std::mt19937 rng(5);
+    for (int s = 0; s < 1000; ++s)
+    {
+        double x = std::pow(1000.0, std::uniform_real_distribution<double>(0.0, 1.0)(rng));
+        QC_CHECK(std::abs(1.0 - x * q(x)) <= q.error * 1.001);
+    }
+
+    // Tolerances below rounding stop once the error no longer falls
+    LaplaceQuadrature tight = LaplaceFactorization::fit(1.0, 10.0, 1e-14);
+    QC_CHECK(tight.size() < 24 && tight.error < 1e-12);
+
+    // DF-MP2-like energy, 0.5 sum (ia|jb)^2 / D with (ia|jb) = B(ia,P) B(jb,P)
+    auto &registry = SpaceRegistry::global();
+    const long no = 3, nv = 5, nx = 6;
+    registry.set_size("occ", no);
+    registry.set_size("vir", nv);
+    registry.register_space("aux", nx);
+    Index i("i", Index::Type::OCCUPIED), j("j", Index::Type::OCCUPIED);
+    Index a("a", Index::Type::VIRTUAL), b("b", Index::Type::VIRTUAL);
+    Index P = IndexFactory::in_space("P", "aux"), Q = IndexFactory::in_space("Q", "aux");
+    auto tensor = [](const char *name, std::vector<Index> indices) { return Tensor(name, IndexSet(indices)); };
+    ImplicitTensor D = ImplicitTensor::denominator(tensor("D", {i, j, a, b}));
+    ContractionTerm term(Tensor("E", IndexSet(std::vector<Index>{})),
+                         {tensor("B", {i, a, P}), tensor("B", {j, b, P}), tensor("B", {i, a, Q}),
+                          tensor("B", {j, b, Q}), tensor("D", {i, j, a, b})},
+                         0.5);
+
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<double> eo(no), ev(nv);
+    for (auto &e : eo)
+        e = -1.5 + 0.5 * uniform(rng);
+    for (auto &e : ev)
+        e = 2.8 + 2.0 * uniform(rng);
+    std::map<int, std::vector<double>> diagonals = {{registry.id("occ"), eo}, {registry.id("vir"), ev}};
+    auto range = LaplaceFactorization::spectral_range(D, diagonals);
+    QC_CHECK(range.first > 0.0 && range.second > range.first);
+
+    LaplaceOptions options;
+    options.require_gain = false;
+    LaplaceFactorization laplace(D, LaplaceFactorization::fit(range.first, range.second, 1e-8), options);
+    ContractionTerm rewritten = term;
+    QC_CHECK(laplace.apply(rewritten));
+
+    DenseTensor B({no, nv, nx}), denominator({no, no, nv, nv});
+    for (long k = 0; k < B.size(); ++k)
+        B.data()[k] = uniform(rng);
+    for (long x = 0; x < no; ++x)
+        for (long y = 0; y < no; ++y)
+            for (long c = 0; c < nv; ++c)
+                for (long d = 0; d < nv; ++d)
+                    denominator({x, y, c, d}) = 1.0 / (eo[x] + eo[y] - ev[c] - ev[d]);
+    Evaluator direct;
+    direct.bind("B", B);
+    direct.bind("D", denominator);
+    DenseTensor exact(std::vector<long>{});
+    QC_CHECK(direct.evaluate(term, exact));
+
+    Evaluator factored;
+    factored.bind("B", B);
+    std::vector<DenseTensor> factors;
+    factors.reserve(rewritten.num_factors());
+    for (const auto &factor : rewritten.factors())
+    {
+        std::vector<double> values = laplace.factor(factor, diagonals);
+        if (values.empty())
+            continue;
+        factors.emplace_back(std::vector<long>{static_cast<long>(laplace.quadrature().size()),
+                                               registry.dimension(factor.indices()[1])});
+        std::copy(values.begin(), values.end(), factors.back().data());
+        factored.bind(factor.symbol().name(), factors.back());
+    }
+    DenseTensor energy(std::vector<long>{});
+    QC_CHECK(factored.evaluate(rewritten, energy));
+    QC_CHECK_NEAR(energy.data()[0] / exact.data()[0], 1.0, 1e-7);
+
+    // Each quadrature keeps its own point space
+    LaplaceFactorization other(D, LaplaceFactorization::minimax(3, range.first, range.second), options);
+    QC_CHECK(other.options().space != laplace.options().space);
+    QC_CHECK(registry.size(registry.id(laplace.options().space)) == static_cast<long>(laplace.quadrature().size()));
+    QC_CHECK(registry.size(registry.id(other.options().space)) == 3);
+
+    // The gain is judged against the best order of the term as written:
+    // 2 o^2 v^2 N_aux per pair of B before, n_z o v N_aux^2 after
+    registry.set_size("occ", 50);
+    registry.set_size("vir", 500);
+    registry.set_size("aux", 1500);
+    const double before = LaplaceFactorization::direct_flop_count(term);
+    QC_CHECK(before >= 2.0 * 2.0 * 50 * 50 * 500 * 500 * 1500.0 && before < 3.8e12);
+    LaplaceFactorization gated(D, LaplaceFactorization::minimax(8, 1.0, 100.0));
+    ContractionTerm large = term;
+    QC_CHECK(gated.apply(large));
+    QC_CHECK(gated.flop_count(large) < before);
+
+    // Few orbitals and many auxiliaries: the rewrite costs more and is refused
+    registry.set_size("occ", 5);
+    registry.set_size("vir", 10);
+    registry.set_size("aux", 1000);
+    ContractionTerm small = term;
+    QC_CHECK(!gated.apply(small));
+
+    return QC_TEST_RESULT();
+}
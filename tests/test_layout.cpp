@@ -0,0 +1,69 @@
+#include "core/autogen_cursor/code_generator.h"
+#include "core/autogen_cursor/layout.h"
+#include "core/numeric/evaluator.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    Index i("i", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL), j("j", Index::Type::OCCUPIED);
+
+    // A transposed view keeps its storage: memory order stays (i, a)
+    Tensor r("r", IndexSet({i, a}));
+    Tensor view = r.transpose();
+    QC_CHECK(view.indices()[0].label() == "a");
+    QC_CHECK((LayoutPropagation::physical_order(view) == std::vector<std::string>{"i", "a"}));
+    QC_CHECK(LayoutPropagation::storage_view(view).indices()[0].label() == "i");
+
+    // Writing through the view fills the (i, a) storage of the output
+    const long n_occ = 2, n_vir = 3;
+    DenseTensor x({n_vir, n_occ}), output({n_occ, n_vir});
+    for (long p = 0; p < n_vir; ++p)
+        for (long q = 0; q < n_occ; ++q)
+            x({p, q}) = 10.0 * p + q;
+    Evaluator evaluator;
+    evaluator.bind("x", x);
+    QC_CHECK(evaluator.evaluate(ContractionTerm(view, {Tensor("x", IndexSet({a, i}))}), output));
+    for (long q = 0; q < n_occ; ++q)
+        for (long p = 0; p < n_vir; ++p)
+            QC_CHECK_NEAR(output({q, p}), 10.0 * p + q, 0.0);
+
+    // Planned DAGs give every operand a physical order
+    std::vector<ContractionTerm> terms = {ContractionTerm(Tensor("s", IndexSet({i, j})),
+                                                          {Tensor("u", IndexSet({i, a})), Tensor("w", IndexSet({a, j}))})};
+    ContractionDag dag = ContractionDag::from_terms(terms);
+    QC_CHECK(dag.size() == 3);
+    LayoutPlan plan = LayoutPropagation::plan(dag);
+    QC_CHECK(plan.storage.size() == dag.size());
+    QC_CHECK((plan.storage[2] == std::vector<std::string>{"i", "j"}));
+    QC_CHECK(plan.transposed_bytes <= plan.naive_transposed_bytes);
+
+    // Planned steps become CBLAS calls with the trans flags of the plan
+    CodeGenOptions blas;
+    blas.blas = true;
+    QC_CHECK(plan.steps.size() == 1 && plan.steps[0].kind == LayoutStep::Kind::GEMM);
+    std::string gemm = CodeGenerator(blas).generate_step("k", dag, plan, plan.steps[0]);
+    QC_CHECK(gemm.find("cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n_occ, n_occ, n_vir, 1.0, u, n_vir, "
+                       "w, n_occ, 1.0, s, n_occ);") != std::string::npos);
+    QC_CHECK(CodeGenerator().generate_step("k", dag, plan, plan.steps[0]) == CodeGenerator().generate("k", terms[0]));
+
+    // An output stored as (j, i) swaps the operands: s^T = w^T u^T
+    std::vector<ContractionTerm> swapped = {
+        ContractionTerm(Tensor("s", IndexSet({j, i})).transpose(),
+                        {Tensor("u", IndexSet({i, a})), Tensor("w", IndexSet({a, j}))})};
+    ContractionDag swapped_dag = ContractionDag::from_terms(swapped);
+    LayoutPlan swapped_plan = LayoutPropagation::plan(swapped_dag);
+    QC_CHECK(swapped_plan.steps.size() == 1 && swapped_plan.steps[0].swap_operands);
+    gemm = CodeGenerator(blas).generate_step("k", swapped_dag, swapped_plan, swapped_plan.steps[0]);
+    QC_CHECK(gemm.find("cblas_dgemm(CblasRowMajor, CblasTrans, CblasTrans, n_occ, n_occ, n_vir, 1.0, w, n_occ, u, "
+                       "n_vir, 1.0, s, n_occ);") != std::string::npos);
+
+    // Intermediates are stored in their planned order
+    ContractionTerm step = LayoutPropagation::planned_term(dag, plan, 2);
+    QC_CHECK((LayoutPropagation::physical_order(step.output()) == plan.storage[2]));
+    Tensor stored = LayoutPropagation::with_storage(Tensor("t", IndexSet({i, a})), {"a", "i"});
+    QC_CHECK((LayoutPropagation::physical_order(stored) == std::vector<std::string>{"a", "i"}));
+
+    return QC_TEST_RESULT();
+}
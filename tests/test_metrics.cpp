@@ -0,0 +1,116 @@
+#include "util/metrics.h"
+#include "test_check.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef __unix__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace MetaWaveCompiler::util;
+
+int main()
+{
+    auto &registry = metrics();
+
+    // Sharded counters and gauges sum every thread's updates
+    Counter &counter = registry.counter("test_events_total", "Events seen by the test", "kind=\"a\"");
+    Gauge &gauge = registry.gauge("test_depth", "Depth seen by the test");
+    Histogram &histogram = registry.histogram("test_latency_seconds", "Latency seen by the test");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&]()
+        {
+            for (int k = 0; k < 10000; ++k)
+            {
+                counter.inc();
+                gauge.add(0.5);
+                histogram.record(static_cast<std::uint64_t>(k));
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    QC_CHECK(counter.value() == 80000);
+    QC_CHECK(gauge.value() == 40000.0);
+    QC_CHECK(histogram.count() == 80000 && histogram.max() == 9999);
+    QC_CHECK(histogram.sum() == 8ull * 9999 * 10000 / 2);
+    QC_CHECK(&registry.counter("test_events_total", "", "kind=\"a\"") == &counter);
+
+    // Buckets tile the integers, each within 1/16 of its lower end
+    for (size_t b = 1; b < Histogram::kBuckets; ++b)
+    {
+        QC_CHECK(Histogram::bucketOf(Histogram::bucketUpper(b - 1) + 1) == b);
+        QC_CHECK(Histogram::bucketOf(Histogram::bucketUpper(b)) == b);
+    }
+    for (std::uint64_t value : {0ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, (1ull << 47) + 5})
+    {
+        size_t b = Histogram::bucketOf(value);
+        QC_CHECK(value <= Histogram::bucketUpper(b) && (b == 0 || value > Histogram::bucketUpper(b - 1)));
+        QC_CHECK(Histogram::bucketUpper(b) - value <= value / 16);
+    }
+    QC_CHECK(Histogram::bucketOf(~0ull) == Histogram::kBuckets - 1);
+
+    // Quantiles are bucket upper bounds, so at most 1/16 above the exact value
+    for (double q : {0.5, 0.9, 0.99})
+    {
+        double exact = q * 9999.0, estimate = static_cast<double>(histogram.quantile(q));
+        QC_CHECK(estimate >= exact - 1.0 && estimate <= exact * (1.0 + 1.0 / 16) + 1.0);
+    }
+    QC_CHECK(histogram.quantile(1.0) == 9999);
+    QC_CHECK(Histogram().quantile(0.5) == 0);
+    {
+        Histogram timed;
+        {
+            ScopedTimer timer(timed);
+        }
+        QC_CHECK(timed.count() == 1);
+    }
+
+    // Prometheus text
+    std::string text = registry.exportText();
+    QC_CHECK(text.find("# HELP test_events_total Events seen by the test\n") != std::string::npos);
+    QC_CHECK(text.find("# TYPE test_events_total counter\ntest_events_total{kind=\"a\"} 80000\n") != std::string::npos);
+    QC_CHECK(text.find("test_depth 40000\n") != std::string::npos);
+    QC_CHECK(text.find("# TYPE test_latency_seconds summary\n") != std::string::npos);
+    QC_CHECK(text.find("test_latency_seconds{quantile=\"0.5\"} ") != std::string::npos);
+    QC_CHECK(text.find("test_latency_seconds_count 80000\n") != std::string::npos);
+
+    const std::string path = "test_metrics.prom";
+    QC_CHECK(registry.writeText(path));
+    std::ifstream in(path);
+    std::stringstream written;
+    written << in.rdbuf();
+    QC_CHECK(written.str().find("test_events_total{kind=\"a\"} 80000") != std::string::npos);
+    std::remove(path.c_str());
+
+#ifdef __unix__
+    // Scrape over HTTP
+    int port = registry.serve(0);
+    QC_CHECK(port > 0);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    QC_CHECK(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    const char request[] = "GET /metrics HTTP/1.0\r\n\r\n";
+    QC_CHECK(send(fd, request, sizeof(request) - 1, 0) > 0);
+    std::string response;
+    char buffer[4096];
+    for (ssize_t n; (n = recv(fd, buffer, sizeof(buffer), 0)) > 0;)
+        response.append(buffer, static_cast<size_t>(n));
+    close(fd);
+    registry.stopServing();
+    QC_CHECK(response.compare(0, 15, "HTTP/1.0 200 OK") == 0);
+    QC_CHECK(response.find("test_events_total{kind=\"a\"} 80000") != std::string::npos);
+#endif
+
+    return QC_TEST_RESULT();
+}
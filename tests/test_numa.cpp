@@ -0,0 +1,41 @@
+#include "core/numeric/numa.h"
+#include "test_check.h"
+#include <atomic>
+
+using namespace qc;
+
+int main()
+{
+    QC_CHECK((NumaTopology::parse_cpu_list("0-3,8-9") == std::vector<int>{0, 1, 2, 3, 8, 9}));
+    QC_CHECK((NumaTopology::parse_cpu_list("5") == std::vector<int>{5}));
+    QC_CHECK(NumaTopology::parse_cpu_list("").empty());
+
+    const NumaTopology &topology = NumaTopology::system();
+    QC_CHECK(topology.num_nodes() >= 1);
+    QC_CHECK(!topology.cpus(0).empty());
+
+    // Placement never changes values, whatever the domains
+    for (NumaPolicy policy : {NumaPolicy::LOCAL, NumaPolicy::INTERLEAVED, NumaPolicy::PARTITIONED})
+    {
+        DenseTensor tensor = NumaPlacement::allocate({64, 1024}, policy, 1.5);
+        QC_CHECK(tensor.size() == 64 * 1024);
+        QC_CHECK(tensor.data()[0] == 1.5 && tensor.data()[tensor.size() - 1] == 1.5);
+        QC_CHECK(NumaPlacement::owner(tensor.data(), tensor.size(), tensor.size() - 1, policy) <
+                 topology.num_nodes());
+
+        // parallel_for covers every element exactly once
+        std::vector<std::atomic<int>> hits(tensor.size());
+        NumaPlacement::parallel_for(tensor.data(), tensor.size(), policy, 4,
+                                    [&hits](long begin, long end)
+                                    {
+                                        for (long n = begin; n < end; ++n)
+                                            ++hits[n];
+                                    });
+        bool once = true;
+        for (const auto &hit : hits)
+            once = once && hit == 1;
+        QC_CHECK(once);
+    }
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+#include "core/autogen_cursor/contraction_term.h"
+#include "core/autogen_cursor/orbital_space.h"
+#include "core/autogen_cursor/tensor.h"
+#include "test_check.h"
+#include <atomic>
+#include <thread>
+
+using namespace qc;
+
+int main()
+{
+    auto &registry = SpaceRegistry::global();
+
+    // Registering an existing space never changes a known size
+    int space = registry.register_space("test_space");
+    QC_CHECK(space >= 0);
+    QC_CHECK(registry.register_space("test_space", 40) == space);
+    QC_CHECK(registry.size(space) == 40);
+    QC_CHECK(registry.register_space("test_space", 40) == space);
+    QC_CHECK(registry.register_space("test_space", 50) == -1);
+    QC_CHECK(registry.size(space) == 40);
+    registry.set_size("test_space", 50);
+    QC_CHECK(registry.size(space) == 50);
+    QC_CHECK(registry.is_subspace(registry.id("core"), registry.id("gen")));
+    QC_CHECK(registry.are_disjoint(registry.id("occ"), registry.id("vir")));
+
+    // Registration on one thread while others resolve names and sizes
+    std::atomic<bool> consistent{true};
+    std::vector<std::thread> workers;
+    workers.emplace_back([&registry]() {
+        for (int k = 0; k < 2000; ++k)
+            registry.register_space("concurrent" + std::to_string(k), k);
+    });
+    for (int t = 0; t < 3; ++t)
+    {
+        workers.emplace_back([&registry, &consistent]() {
+            for (int k = 0; k < 2000; ++k)
+            {
+                const std::string name = "concurrent" + std::to_string(k);
+                int found = registry.id(name);
+                if (found >= 0 && (registry.size(found) != k || registry.name(found) != name))
+                    consistent = false;
+                if (registry.id("occ") < 0)
+                    consistent = false;
+            }
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    QC_CHECK(consistent);
+    QC_CHECK(registry.size(registry.id("concurrent1999")) == 1999);
+
+    // Matrix chain 30x35 35x15 15x5 5x10 10x20 20x25: the best order takes
+    // 15125 multiply-adds, ((A1 (A2 A3)) ((A4 A5) A6))
+    const long dims[] = {30, 35, 15, 5, 10, 20, 25};
+    std::vector<Index> chain;
+    for (int k = 0; k < 7; ++k)
+    {
+        std::string name = "chain" + std::to_string(k);
+        registry.register_space(name, dims[k]);
+        chain.push_back(IndexFactory::in_space("p" + std::to_string(k), name));
+    }
+    std::vector<Tensor> matrices;
+    for (int k = 0; k < 6; ++k)
+        matrices.emplace_back("A" + std::to_string(k + 1), IndexSet({chain[k], chain[k + 1]}));
+    Tensor product("P", IndexSet({chain[0], chain[6]}));
+
+    auto path = TensorContraction::optimize_contraction(matrices, product.indices());
+    QC_CHECK(path.tensor_pairs.size() == 5);
+    QC_CHECK_NEAR(path.cost_estimate, 2.0 * 15125, 1e-9);
+    QC_CHECK_NEAR(ContractionTerm(product, matrices).optimized_flop_count(), 2.0 * 15125, 1e-9);
+
+    // Output indices stay live: an elementwise product sums over nothing
+    Index i = IndexFactory::in_space("i", "chain0"), a = IndexFactory::in_space("a", "chain1");
+    Tensor x("x", IndexSet({i, a})), y("y", IndexSet({i, a}));
+    auto hadamard = TensorContraction::optimize_contraction({x, y}, IndexSet({i, a}));
+    QC_CHECK(hadamard.contracted_indices.size() == 1 && hadamard.contracted_indices[0].empty());
+    auto dot = TensorContraction::optimize_contraction({x, y});
+    QC_CHECK(dot.contracted_indices[0].size() == 2);
+
+    // Unknown sizes keep the input order and report an unknown cost
+    Tensor u("u", IndexSet({Index("q"), Index("r")})), w("w", IndexSet({Index("r"), Index("s")}));
+    auto unknown = TensorContraction::optimize_contraction({u, w, u});
+    QC_CHECK(unknown.cost_estimate < 0);
+    QC_CHECK(unknown.tensor_pairs[0] == std::make_pair(size_t(0), size_t(1)));
+
+    return QC_TEST_RESULT();
+}
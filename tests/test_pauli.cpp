@@ -0,0 +1,50 @@
+#include "core/autogen_cursor/pauli.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    const std::complex<double> i(0.0, 1.0);
+
+    // X Y = i Z, and anticommuting strings do not commute
+    PauliString x = PauliString::from_string("X"), y = PauliString::from_string("Y");
+    PauliString xy = x * y;
+    QC_CHECK(xy.to_string() == "Z" && xy.phase() == 1);
+    QC_CHECK(!x.commutes_with(y));
+    QC_CHECK(PauliString::from_string("XX").commutes_with(PauliString::from_string("YY")));
+    QC_CHECK(!PauliString::from_string("XX").qubitwise_commutes_with(PauliString::from_string("YY")));
+
+    // The phase of the looked-up string divides out: Z = -i (iZ)
+    QubitOperator z(1);
+    z.add(PauliString::from_string("Z"), 1.0);
+    QC_CHECK_NEAR(std::abs(z.coefficient(xy) - (-i)), 0.0, 1e-15);
+    QC_CHECK_NEAR(std::abs(QubitOperator(xy).coefficient(PauliString::from_string("Z")) - i), 0.0, 1e-15);
+
+    // Strings differing only in trailing identities merge
+    QC_CHECK(x.same_letters(PauliString::from_string("XI")));
+    QC_CHECK(x.hash() == PauliString::from_string("XI").hash());
+    QC_CHECK(!x.same_letters(PauliString::from_string("XZ")));
+    QubitOperator sum(2);
+    sum.add(x, 1.0);
+    sum.add(PauliString::from_string("XI"), 2.0);
+    QC_CHECK(sum.size() == 1);
+    QC_CHECK_NEAR(std::abs(sum.coefficient(x) - 3.0), 0.0, 1e-15);
+
+    // a_1^dagger a_1 = (I - Z_1) / 2 under Jordan-Wigner
+    QubitMapping jw(QubitMapping::Encoding::JORDAN_WIGNER, 3);
+    QubitOperator number = jw.creation(1) * jw.annihilation(1);
+    number.simplify();
+    QC_CHECK(number.size() == 2);
+    QC_CHECK_NEAR(std::abs(number.coefficient(PauliString::from_string("III")) - 0.5), 0.0, 1e-15);
+    QC_CHECK_NEAR(std::abs(number.coefficient(PauliString::from_string("IZI")) + 0.5), 0.0, 1e-15);
+
+    // Operators without a mode or qubit are not mapped
+    Operator unnamed("S", IndexSet(), Operator::Type::GENERAL, Operator::Algebra::GENERAL);
+    QC_CHECK(QubitMapping::qubit_of(unnamed) == -1);
+    QC_CHECK(QubitMapping::mode_of(unnamed) == -1);
+    unnamed.set_property("qubit", "2");
+    QC_CHECK(QubitMapping::qubit_of(unnamed) == 2);
+
+    return QC_TEST_RESULT();
+}
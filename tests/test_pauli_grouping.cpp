@@ -0,0 +1,88 @@
+#include "core/autogen_cursor/pauli_grouping.h"
+#include "test_check.h"
+#include <complex>
+#include <random>
+
+using namespace qc;
+
+int main()
+{
+    PauliString xx = PauliString::from_string("XX"), yy = PauliString::from_string("YY");
+    PauliString xi = PauliString::from_string("XI"), zi = PauliString::from_string("ZI");
+    QC_CHECK(PauliGrouping::conflicts(xx, yy, PauliCommutation::QUBITWISE));
+    QC_CHECK(!PauliGrouping::conflicts(xx, yy, PauliCommutation::FULL));
+    QC_CHECK(!PauliGrouping::conflicts(xx, xi, PauliCommutation::QUBITWISE));
+    QC_CHECK(PauliGrouping::conflicts(xi, zi, PauliCommutation::FULL));
+
+    // Random strings over 70 qubits cross a word boundary
+    std::mt19937 rng(7);
+    const char *letters = "IXYZ";
+    std::vector<PauliString> strings;
+    for (int s = 0; s < 300; ++s)
+    {
+        std::string text;
+        for (int q = 0; q < 70; ++q)
+            text += letters[rng() % 4 == 0 ? rng() % 4 : 0];
+        strings.push_back(PauliString::from_string(text));
+    }
+
+    for (PauliCommutation relation : {PauliCommutation::QUBITWISE, PauliCommutation::FULL})
+    {
+        for (ColoringStrategy strategy : {ColoringStrategy::LARGEST_FIRST, ColoringStrategy::DSATUR})
+        {
+            GroupingOptions options;
+            options.relation = relation;
+            options.strategy = strategy;
+            auto groups = PauliGrouping::partition(strings, options);
+            QC_CHECK(PauliGrouping::is_valid(strings, groups, relation));
+            QC_CHECK(groups.size() < strings.size());
+        }
+    }
+
+    // Local strings on a 200-qubit chain, plus the identity: tiles that
+    // share no qubit with a string are skipped
+    std::vector<PauliString> local;
+    for (int s = 0; s < 5000; ++s)
+    {
+        std::string text(200, 'I');
+        const size_t start = rng() % 197;
+        for (size_t q = start; q < start + 1 + rng() % 3; ++q)
+            text[q] = letters[1 + rng() % 3];
+        local.push_back(PauliString::from_string(text));
+    }
+    local.push_back(PauliString::from_string(std::string(200, 'I')));
+    for (PauliCommutation relation : {PauliCommutation::QUBITWISE, PauliCommutation::FULL})
+    {
+        for (ColoringStrategy strategy : {ColoringStrategy::LARGEST_FIRST, ColoringStrategy::DSATUR})
+        {
+            GroupingOptions options;
+            options.relation = relation;
+            options.strategy = strategy;
+            auto groups = PauliGrouping::partition(local, options);
+            QC_CHECK(PauliGrouping::is_valid(local, groups, relation));
+            QC_CHECK(groups.size() < 100);
+        }
+    }
+
+    // Operator partition keeps every term and its coefficient
+    QubitOperator op(2);
+    op.add(xx, 1.0);
+    op.add(yy, 2.0);
+    op.add(xi, 3.0);
+    op.add(zi, 4.0);
+    auto parts = PauliGrouping::partition(op);
+    size_t terms = 0;
+    double norm = 0.0;
+    for (const auto &part : parts)
+    {
+        terms += part.size();
+        for (const auto &term : part.terms())
+            norm += std::abs(term.second);
+    }
+    QC_CHECK(terms == 4);
+    QC_CHECK_NEAR(norm, 10.0, 1e-12);
+    QC_CHECK(!PauliGrouping::is_valid({xx, yy}, {{0, 1}}, PauliCommutation::QUBITWISE));
+    QC_CHECK(!PauliGrouping::is_valid({xx, yy}, {{0}}, PauliCommutation::QUBITWISE));
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,193 @@
+#include "core/autogen_cursor/rdm_generator.h"
+#include "core/numeric/evaluator.h"
+#include "test_check.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace qc;
+
+namespace
+{
+    // Determinants over 3 occupied and 3 virtual spin orbitals, bit p = orbital p
+    const int no = 3, nv = 3, n = no + nv;
+    using State = std::vector<double>;
+
+    State apply_string(const std::vector<std::pair<int, bool>> &ops, State v) // rightmost first
+    {
+        for (auto it = ops.rbegin(); it != ops.rend(); ++it)
+        {
+            State w(v.size(), 0.0);
+            for (size_t s = 0; s < v.size(); ++s)
+            {
+                const int p = it->first;
+                if (v[s] == 0.0 || ((s >> p & 1) != 0) == it->second)
+                    continue;
+                int sign = __builtin_popcount(static_cast<unsigned>(s) & ((1u << p) - 1)) % 2 ? -1 : 1;
+                w[s ^ (1u << p)] += sign * v[s];
+            }
+            v = w;
+        }
+        return v;
+    }
+
+    // X |v> for X = x1 + x2 (excitation) or its adjoint
+    State excite(const State &v, const DenseTensor &x1, const DenseTensor &x2, bool adjoint)
+    {
+        State result(v.size(), 0.0);
+        auto add = [&](double c, std::vector<std::pair<int, bool>> ops)
+        {
+            if (adjoint)
+            {
+                std::reverse(ops.begin(), ops.end());
+                for (auto &op : ops)
+                    op.second = !op.second;
+            }
+            State w = apply_string(ops, v);
+            for (size_t s = 0; s < w.size(); ++s)
+                result[s] += c * w[s];
+        };
+        for (int i = 0; i < no; ++i)
+        {
+            for (int a = 0; a < nv; ++a)
+            {
+                add(x1({i, a}), {{no + a, true}, {i, false}});
+                for (int j = 0; j < no; ++j)
+                {
+                    for (int b = 0; b < nv; ++b)
+                        add(0.25 * x2({i, j, a, b}), {{no + a, true}, {no + b, true}, {j, false}, {i, false}});
+                }
+            }
+        }
+        return result;
+    }
+
+    State exponential(const State &v, const DenseTensor &x1, const DenseTensor &x2, bool adjoint, double sign)
+    {
+        State result = v, term = v;
+        for (int k = 1; k <= n; ++k)
+        {
+            term = excite(term, x1, x2, adjoint);
+            for (size_t s = 0; s < term.size(); ++s)
+                result[s] += (term[s] *= sign / k);
+        }
+        return result;
+    }
+
+    double dot(const State &a, const State &b)
+    {
+        double sum = 0.0;
+        for (size_t s = 0; s < a.size(); ++s)
+            sum += a[s] * b[s];
+        return sum;
+    }
+}
+
+int main()
+{
+    QC_CHECK((RdmGenerator::unique_blocks(1, true) == std::vector<std::string>{"oo", "ov", "vv"}));
+    QC_CHECK(RdmGenerator::unique_blocks(2, true).size() == 6);
+    QC_CHECK(RdmGenerator().equations(3).blocks.empty());
+    QC_CHECK(RdmGenerator().equations(2).intermediates.size() == 13);
+
+    // Random amplitudes, antisymmetric in both pairs
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> uniform(-0.3, 0.3);
+    DenseTensor t1({no, nv}), l1({no, nv}), t2({no, no, nv, nv}), l2({no, no, nv, nv}), delta({no, no});
+    for (DenseTensor *x : {&t1, &l1})
+    {
+        for (long k = 0; k < x->size(); ++k)
+            x->data()[k] = uniform(rng);
+    }
+    for (DenseTensor *x : {&t2, &l2})
+    {
+        for (long i = 0; i < no; ++i)
+            for (long j = 0; j < i; ++j)
+                for (long a = 0; a < nv; ++a)
+                    for (long b = 0; b < a; ++b)
+                    {
+                        double value = uniform(rng);
+                        (*x)({i, j, a, b}) = (*x)({j, i, b, a}) = value;
+                        (*x)({j, i, a, b}) = (*x)({i, j, b, a}) = -value;
+                    }
+    }
+    for (long i = 0; i < no; ++i)
+        delta({i, i}) = 1.0;
+
+    // <0| (1 + L) e^-T and e^T |0> in the determinant space
+    State reference(std::size_t(1) << n, 0.0);
+    reference[(1u << no) - 1] = 1.0;
+    State ket = exponential(reference, t1, t2, false, 1.0);
+    State bra = excite(reference, l1, l2, false);
+    for (size_t s = 0; s < bra.size(); ++s)
+        bra[s] += reference[s];
+    bra = exponential(bra, t1, t2, true, -1.0);
+
+    // Generated equations agree with the densities of the determinant
+    // expansion, symmetrized as the hermitian option promises
+    for (int order = 1; order <= 2; ++order)
+    {
+        RdmEquations equations = RdmGenerator().equations(order);
+        Evaluator evaluator;
+        evaluator.bind("t1", t1);
+        evaluator.bind("t2", t2);
+        evaluator.bind("l1", l1);
+        evaluator.bind("l2", l2);
+        evaluator.bind("delta", delta);
+        std::vector<DenseTensor> intermediates;
+        intermediates.reserve(equations.intermediates.size());
+        for (const auto &term : equations.intermediates)
+        {
+            std::vector<long> shape;
+            for (const auto &idx : term.output().indices())
+                shape.push_back(idx->type() == Index::Type::OCCUPIED ? no : nv);
+            intermediates.emplace_back(shape);
+            QC_CHECK(evaluator.evaluate(term, intermediates.back()));
+            evaluator.bind(term.output().symbol().name(), intermediates.back());
+        }
+
+        double worst = 0.0;
+        for (const auto &block : equations.blocks)
+        {
+            const std::string &label = block.first;
+            std::vector<long> shape;
+            for (char space : label)
+                shape.push_back(space == 'o' ? no : nv);
+            DenseTensor density(shape);
+            QC_CHECK(evaluator.evaluate(block.second, density));
+
+            auto orbital = [&label](size_t k, long value)
+            { return static_cast<int>(label[k] == 'o' ? value : no + value); };
+            std::vector<long> index(shape.size(), 0);
+            for (long element = 0; element < density.size(); ++element)
+            {
+                long rest = element;
+                for (size_t k = shape.size(); k-- > 0; rest /= shape[k])
+                    index[k] = rest % shape[k];
+                double expected;
+                if (order == 1)
+                {
+                    int p = orbital(0, index[0]), q = orbital(1, index[1]);
+                    expected = 0.5 * (dot(bra, apply_string({{p, true}, {q, false}}, ket)) +
+                                      dot(bra, apply_string({{q, true}, {p, false}}, ket)));
+                }
+                else
+                {
+                    int p = orbital(0, index[0]), q = orbital(1, index[1]);
+                    int r = orbital(2, index[2]), s = orbital(3, index[3]);
+                    expected = 0.5 * (dot(bra, apply_string({{p, true}, {q, true}, {s, false}, {r, false}}, ket)) +
+                                      dot(bra, apply_string({{r, true}, {s, true}, {q, false}, {p, false}}, ket)));
+                }
+                worst = std::max(worst, std::abs(density(index) - expected));
+            }
+        }
+        QC_CHECK_NEAR(worst, 0.0, 1e-12);
+    }
+
+    // One kernel per shared intermediate and per unique block
+    std::string code = RdmGenerator().generate("ccsd_d2", 2);
+    QC_CHECK(code.find("void ccsd_d2_I1(") != std::string::npos);
+    QC_CHECK(code.find("void ccsd_d2_vvvv(") != std::string::npos);
+
+    return QC_TEST_RESULT();
+}
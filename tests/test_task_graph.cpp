@@ -0,0 +1,57 @@
+#include "core/numeric/evaluator.h"
+#include "core/numeric/task_graph.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    const long n_occ = 3, n_vir = 4;
+    Index i("i", Index::Type::OCCUPIED), j("j", Index::Type::OCCUPIED);
+    Index a("a", Index::Type::VIRTUAL), b("b", Index::Type::VIRTUAL);
+
+    DenseTensor u({n_occ, n_vir}), v({n_vir, n_vir}), w({n_vir, n_occ});
+    for (DenseTensor *tensor : {&u, &v, &w})
+    {
+        for (long n = 0; n < tensor->size(); ++n)
+            tensor->data()[n] = 0.1 * static_cast<double>((n * 7) % 11) - 0.4;
+    }
+
+    // s_ij = u_ia v_ab w_bj + 2 u_ia w_aj, as a DAG with one intermediate
+    std::vector<ContractionTerm> terms = {
+        ContractionTerm(Tensor("s", IndexSet({i, j})),
+                        {Tensor("u", IndexSet({i, a})), Tensor("v", IndexSet({a, b})), Tensor("w", IndexSet({b, j}))}),
+        ContractionTerm(Tensor("s", IndexSet({i, j})), {Tensor("u", IndexSet({i, a})), Tensor("w", IndexSet({a, j}))},
+                        2.0)};
+    ContractionDag dag = ContractionDag::from_terms(terms);
+
+    RuntimeOptions options;
+    options.threads = 4;
+    TaskGraphRuntime runtime(options);
+    DenseTensor s({n_occ, n_occ});
+    runtime.bind_input("u", u);
+    runtime.bind_input("v", v);
+    runtime.bind_input("w", w);
+    runtime.bind_output("s", s);
+    QC_CHECK(runtime.run(dag));
+    QC_CHECK(runtime.stats().tasks == 3);
+
+    // Same terms through the reference evaluator
+    Evaluator evaluator;
+    evaluator.bind("u", u);
+    evaluator.bind("v", v);
+    evaluator.bind("w", w);
+    DenseTensor reference({n_occ, n_occ});
+    for (const auto &term : terms)
+        QC_CHECK(evaluator.evaluate(term, reference));
+    for (long n = 0; n < s.size(); ++n)
+        QC_CHECK_NEAR(s.data()[n], reference.data()[n], 1e-12);
+
+    // Unbound inputs fail instead of producing a partial result
+    TaskGraphRuntime unbound(options);
+    DenseTensor t({n_occ, n_occ});
+    unbound.bind_output("s", t);
+    QC_CHECK(!unbound.run(dag));
+
+    return QC_TEST_RESULT();
+}
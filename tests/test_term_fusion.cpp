@@ -0,0 +1,46 @@
+#include "core/autogen_cursor/code_generator.h"
+#include "core/autogen_cursor/term_fusion.h"
+#include "core/numeric/evaluator.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    Index i("i", Index::Type::OCCUPIED), a("a", Index::Type::VIRTUAL), b("b", Index::Type::VIRTUAL);
+    Tensor r("r", IndexSet({i, a}));
+    ContractionTerm first(r, {Tensor("f", IndexSet({a, b})), Tensor("t", IndexSet({i, b}))});
+    ContractionTerm second(r, {Tensor("g", IndexSet({i, a}))}, -0.5);
+    ContractionTerm other(Tensor("x", IndexSet({i, a})), {Tensor("r", IndexSet({i, a}))});
+
+    QC_CHECK(TermFusion::fusable(first, second));
+    QC_CHECK(!TermFusion::fusable(first, ContractionTerm(Tensor("r", IndexSet({a, i})), {})));
+
+    // x reads r, so the last r term cannot move before it
+    auto groups = TermFusion::group({first, second, other, first});
+    QC_CHECK(groups.size() == 3);
+    QC_CHECK(groups[0].size() == 2);
+
+    // One accumulator and one write of r per element
+    std::string code = CodeGenerator().generate_fused("update", {first, second});
+    QC_CHECK(code.find("double acc = 0.0;") != std::string::npos);
+    QC_CHECK(code.find("r[") == code.rfind("r["));
+
+    // The fused evaluation equals the terms applied one by one
+    DenseTensor f({2, 2}), t({3, 2}), g({3, 2}), fused({3, 2}), separate({3, 2});
+    for (DenseTensor *tensor : {&f, &t, &g})
+    {
+        for (long n = 0; n < tensor->size(); ++n)
+            tensor->data()[n] = 0.25 * static_cast<double>(n) - 0.5;
+    }
+    Evaluator evaluator;
+    evaluator.bind("f", f);
+    evaluator.bind("t", t);
+    evaluator.bind("g", g);
+    QC_CHECK(evaluator.evaluate(std::vector<ContractionTerm>{first, second}, fused));
+    QC_CHECK(evaluator.evaluate(first, separate) && evaluator.evaluate(second, separate));
+    for (long n = 0; n < fused.size(); ++n)
+        QC_CHECK_NEAR(fused.data()[n], separate.data()[n], 1e-14);
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,63 @@
+#include "core/numeric/transpose.h"
+#include "test_check.h"
+
+using namespace qc;
+
+namespace
+{
+    // Reference: output dimension d is input dimension permutation[d]
+    bool matches(const DenseTensor &in, const DenseTensor &out, const std::vector<size_t> &permutation)
+    {
+        std::vector<long> index(in.rank(), 0), permuted(in.rank());
+        for (long n = 0; n < in.size(); ++n)
+        {
+            for (size_t d = 0; d < permutation.size(); ++d)
+                permuted[d] = index[permutation[d]];
+            if (out(permuted) != in(index))
+                return false;
+            for (size_t d = in.rank(); d-- > 0;)
+            {
+                if (++index[d] < in.extent(d))
+                    break;
+                index[d] = 0;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    DenseTensor in({3, 5, 7, 4});
+    for (long n = 0; n < in.size(); ++n)
+        in.data()[n] = static_cast<double>(n);
+
+    const std::vector<std::vector<size_t>> permutations = {
+        {0, 1, 2, 3}, {1, 0, 2, 3}, {0, 2, 1, 3}, {2, 3, 0, 1}, {0, 1, 3, 2}, {1, 0, 3, 2}, {3, 2, 1, 0}};
+    for (const auto &permutation : permutations)
+        QC_CHECK(matches(in, TensorTranspose::transpose(in, permutation), permutation));
+
+    // Adjacent dimensions fuse before a kernel is chosen
+    QC_CHECK(TensorTranspose::plan({3, 5, 7, 4}, {0, 1, 2, 3})->kind == TransposePlan::Kind::COPY);
+    QC_CHECK(TensorTranspose::plan({3, 5, 7, 4}, {1, 0, 2, 3})->kind == TransposePlan::Kind::ROWS);
+    auto blocked = TensorTranspose::plan({3, 5, 7, 4}, {2, 3, 0, 1});
+    QC_CHECK(blocked->kind == TransposePlan::Kind::BLOCKED);
+    QC_CHECK(blocked->shape.size() == 2);
+
+    // out = alpha * permute(in) + beta * out
+    DenseTensor matrix({2, 3});
+    for (long n = 0; n < 6; ++n)
+        matrix.data()[n] = static_cast<double>(n + 1);
+    DenseTensor out({3, 2}, 1.0);
+    QC_CHECK(TensorTranspose::transpose(matrix.data(), out.data(), {2, 3}, {1, 0}, 2.0, 0.5));
+    QC_CHECK_NEAR(out({2, 1}), 2.0 * 6.0 + 0.5, 0.0);
+    QC_CHECK(!TensorTranspose::transpose(matrix.data(), out.data(), {2, 3}, {0, 0}));
+
+    // Plans are cached per shape and permutation
+    TensorTranspose::clear_cache();
+    TensorTranspose::plan({4, 4}, {1, 0});
+    TensorTranspose::plan({4, 4}, {1, 0});
+    QC_CHECK(TensorTranspose::cache_size() == 1);
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,30 @@
+#include "core/autogen_cursor/triples_generator.h"
+#include "test_check.h"
+
+using namespace qc;
+
+int main()
+{
+    QC_CHECK(PerturbativeTriplesGenerator::triple_weight(2, 1, 0) == 6.0);
+    QC_CHECK(PerturbativeTriplesGenerator::triple_weight(2, 2, 0) == 3.0);
+    QC_CHECK(PerturbativeTriplesGenerator::triple_weight(1, 1, 1) == 0.0);
+
+    TriplesOptions options;
+    options.virtual_tile = 8;
+    PerturbativeTriplesGenerator generator(options);
+    QC_CHECK(generator.connected_terms().size() == 12);
+    QC_CHECK(generator.disconnected_terms().size() == 12);
+
+    // Blocks are sized by the tile, not by n_vir^3
+    std::string code = generator.generate("ccsd_t");
+    QC_CHECK(code.find("void ccsd_t(") == 0);
+    QC_CHECK(code.find("const long tile = 8;") != std::string::npos);
+    QC_CHECK(code.find("n_block = tile * tile * tile;") != std::string::npos);
+    QC_CHECK(code.find("W_blocks(6 * n_block)") != std::string::npos);
+    QC_CHECK(code.find("n_vir * n_vir * n_vir") == std::string::npos);
+    QC_CHECK(code.find("W[(((a - a_begin)) * tile + (b - b_begin)) * tile + (c - c_begin)] += acc;") !=
+             std::string::npos);
+    QC_CHECK(code.find("#pragma omp for schedule(dynamic)") != std::string::npos);
+
+    return QC_TEST_RESULT();
+}
@@ -0,0 +1,73 @@
+#include "core/autogen_cursor/ucc.h"
+#include "test_check.h"
+#include <cmath>
+
+using namespace qc;
+
+namespace
+{
+    Operator fermion(int mode, bool creation)
+    {
+        return Operator("a", IndexSet(std::vector<Index>{Index(std::to_string(mode))}),
+                        creation ? Operator::Type::CREATION : Operator::Type::ANNIHILATION,
+                        Operator::Algebra::FERMION);
+    }
+
+    OperatorProduct number(int mode)
+    {
+        return OperatorProduct({fermion(mode, true), fermion(mode, false)});
+    }
+
+    double squared_norm(const QubitOperator &op)
+    {
+        double sum = 0.0;
+        for (const auto &term : op.terms())
+            sum += std::norm(term.second);
+        return sum;
+    }
+}
+
+int main()
+{
+    // [X, Y] = 2i Z
+    QubitOperator x(PauliString::from_string("X")), y(PauliString::from_string("Y"));
+    QubitOperator xy = UnitaryCoupledCluster::commutator(x, y);
+    QC_CHECK(xy.size() == 1);
+    QC_CHECK_NEAR(std::abs(xy.coefficient(PauliString::from_string("Z")) - std::complex<double>(0.0, 2.0)), 0.0,
+                  1e-15);
+    QC_CHECK(UnitaryCoupledCluster::commutator(x, x).size() == 0);
+
+    QubitMapping mapping(QubitMapping::Encoding::JORDAN_WIGNER, 4);
+    UccOptions options;
+    options.max_order = 30;
+    options.tolerance = 1e-14;
+    UnitaryCoupledCluster ucc(mapping, options);
+    QC_CHECK(ucc.add_excitation(OperatorProduct({fermion(1, true), fermion(0, false)}, 0.3)));
+    QC_CHECK(ucc.add_excitation(number(0))); // Hermitian, skipped
+    QC_CHECK(ucc.num_generators() == 1);
+    QC_CHECK(!ucc.add_excitation(OperatorProduct({fermion(9, true), fermion(0, false)}, 0.3)));
+
+    // The total number operator commutes with a particle-conserving A
+    QubitOperator mapped, result;
+    std::vector<OperatorProduct> total = {number(0), number(1)};
+    QC_CHECK(mapping.map(total, mapped));
+    QC_CHECK(ucc.transform(total, result));
+    QC_CHECK_NEAR(squared_norm(result - mapped), 0.0, 1e-24);
+
+    // e^(-A) n_1 e^A is unitarily equivalent: trace and Frobenius norm are kept
+    std::vector<OperatorProduct> single = {number(1)};
+    QC_CHECK(mapping.map(single, mapped));
+    QC_CHECK(ucc.transform(single, result));
+    QC_CHECK(result.size() > mapped.size());
+    QC_CHECK_NEAR(std::abs(result.coefficient(PauliString(4)) - 0.5), 0.0, 1e-13);
+    QC_CHECK_NEAR(squared_norm(result), squared_norm(mapped), 1e-12);
+
+    // Modes 2 and 3 are disjoint from the generator: screened and unchanged
+    std::vector<OperatorProduct> far = {number(2), OperatorProduct({fermion(3, true), fermion(2, false)})};
+    QC_CHECK(mapping.map(far, mapped));
+    QC_CHECK(ucc.transform(far, result));
+    QC_CHECK(ucc.stats().screened > 0);
+    QC_CHECK_NEAR(squared_norm(result - mapped), 0.0, 1e-24);
+
+    return QC_TEST_RESULT();
+}
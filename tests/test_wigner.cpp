@@ -0,0 +1,59 @@
+#include "core/autogen_cursor/wigner.h"
+#include "test_check.h"
+#include <cmath>
+
+using namespace qc;
+
+int main()
+{
+    WignerSymbols symbols;
+
+    // (1 1 0; 0 0 0) = -1/sqrt(3), exactly
+    QC_CHECK_NEAR(symbols.three_j(2, 2, 0, 0, 0, 0), -1.0 / std::sqrt(3.0), 1e-15);
+    RecouplingValue exact = symbols.three_j_exact(2, 2, 0, 0, 0, 0);
+    QC_CHECK(exact.sign() == -1);
+    QC_CHECK(exact.squared_numerator() == "1" && exact.squared_denominator() == "3");
+    QC_CHECK(symbols.three_j(2, 2, 0, 2, 2, 0) == 0.0); // m1 + m2 + m3 != 0
+    QC_CHECK(symbols.three_j(2, 2, 6, 0, 0, 0) == 0.0); // triangle
+
+    // Odd column permutation picks up (-1)^(j1 + j2 + j3) and hits the cache
+    size_t misses = symbols.misses();
+    double a = symbols.three_j(2, 4, 4, 2, 0, -2);
+    double b = symbols.three_j(4, 2, 4, 0, 2, -2);
+    QC_CHECK_NEAR(a, -b, 1e-15);
+    QC_CHECK(symbols.misses() == misses + 1);
+
+    // Orthogonality: sum over m1, m2 of (2 j3 + 1) (j1 j2 j3; m1 m2 m3)^2 = 1
+    const int two_j1 = 3, two_j2 = 4, two_j3 = 5, two_m3 = 1;
+    double norm = 0.0;
+    for (int two_m1 = -two_j1; two_m1 <= two_j1; two_m1 += 2)
+    {
+        double value = symbols.three_j(two_j1, two_j2, two_j3, two_m1, -two_m1 - two_m3, two_m3);
+        norm += (two_j3 + 1) * value * value;
+    }
+    QC_CHECK_NEAR(norm, 1.0, 1e-13);
+
+    // {a b c; b a 0} = (-1)^(a + b + c) / sqrt((2a + 1)(2b + 1))
+    QC_CHECK_NEAR(symbols.six_j(1, 1, 2, 1, 1, 0), 0.5, 1e-15);
+    QC_CHECK_NEAR(symbols.six_j(2, 4, 4, 4, 2, 0), -1.0 / std::sqrt(15.0), 1e-15);
+
+    // {a b e; c d e; f f 0} = (-1)^(b + c + e + f) {a b e; d c f} / sqrt((2e + 1)(2f + 1))
+    double nine = symbols.nine_j(2, 4, 4, 2, 2, 4, 2, 2, 0);
+    double six = symbols.six_j(2, 4, 4, 2, 2, 2);
+    QC_CHECK_NEAR(nine, six / std::sqrt(5.0 * 3.0), 1e-14);
+
+    // <1/2 1/2 1/2 -1/2 | 0 0> = 1/sqrt(2); J_+ |1/2 -1/2> = |1/2 1/2>
+    QC_CHECK_NEAR(symbols.clebsch_gordan(1, 1, 1, -1, 0, 0), 1.0 / std::sqrt(2.0), 1e-15);
+    QC_CHECK_NEAR(WignerSymbols::ladder_element(1, -1, 1), 1.0, 1e-15);
+
+    // Batches agree with single calls
+    std::vector<double> batch = symbols.six_j({{1, 1, 2, 1, 1, 0}, {2, 4, 4, 4, 2, 0}});
+    QC_CHECK(batch.size() == 2);
+    QC_CHECK_NEAR(batch[0], 0.5, 1e-15);
+    QC_CHECK_NEAR(batch[1], -1.0 / std::sqrt(15.0), 1e-15);
+
+    symbols.clear();
+    QC_CHECK(symbols.cache_size() == 0);
+
+    return QC_TEST_RESULT();
+}
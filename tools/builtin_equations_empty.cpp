@@ -0,0 +1,9 @@
+// Empty equation library, linked into qc_equation_builder and into builds
+// with QC_BUILTIN_EQUATIONS off
+#include <cstddef>
+
+namespace qc
+{
+    alignas(8) extern const unsigned char qc_builtin_equations[] = {0};
+    extern const std::size_t qc_builtin_equations_size = 0;
+}
@@ -0,0 +1,24 @@
+// Derives the builtin equation sets and writes the C++ source embedding them
+#include "core/autogen_cursor/equation_library.h"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: qc_equation_builder <output.cpp>" << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned char> blob = qc::EquationLibrary::serialize(qc::EquationLibrary::derive_builtin());
+    std::ofstream out(argv[1]);
+    out << qc::EquationLibrary::to_source(blob);
+    if (!out)
+    {
+        std::cerr << "qc_equation_builder: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Embedded " << blob.size() << " bytes of equations" << std::endl;
+    return 0;
+}
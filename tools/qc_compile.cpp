@@ -0,0 +1,124 @@
+// Batch compiler driver: compiles every equation of a manifest into one source file
+#include "core/autogen_cursor/batch_compiler.h"
+#include "util/metrics.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+namespace
+{
+    void usage()
+    {
+        std::cerr << "usage: qc_compile [-j threads] [-m memory] [-c cache] [-o output.cpp] [-M metrics.prom] manifest\n"
+                  << "  -j  worker threads (default: hardware concurrency)\n"
+                  << "  -m  memory ceiling for running jobs, e.g. 64G (default: physical memory)\n"
+                  << "  -c  build cache: phases whose inputs and options are unchanged are reused\n"
+                  << "  -o  generated source (default: stdout)\n"
+                  << "  -M  Prometheus text export of the compiler metrics\n";
+    }
+
+    double physical_memory()
+    {
+#ifdef __unix__
+        long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && page_size > 0)
+            return static_cast<double>(pages) * static_cast<double>(page_size);
+#endif
+        return 0.0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    qc::BatchOptions options;
+    options.memory_limit = physical_memory();
+    std::string manifest_path, output_path, metrics_path;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        std::string arg = argv[a];
+        if ((arg == "-j" || arg == "-m" || arg == "-c" || arg == "-o" || arg == "-M") && a + 1 < argc)
+        {
+            std::string value = argv[++a];
+            if (arg == "-j")
+                options.threads = static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10));
+            else if (arg == "-c")
+                options.cache = value;
+            else if (arg == "-o")
+                output_path = value;
+            else if (arg == "-M")
+                metrics_path = value;
+            else if (!qc::BatchCompiler::parse_bytes(value, options.memory_limit))
+            {
+                std::cerr << "qc_compile: invalid memory '" << value << "'\n";
+                return 1;
+            }
+        }
+        else if (manifest_path.empty() && !arg.empty() && arg[0] != '-')
+        {
+            manifest_path = arg;
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (manifest_path.empty())
+    {
+        usage();
+        return 1;
+    }
+
+    std::ifstream manifest(manifest_path);
+    if (!manifest)
+    {
+        std::cerr << "qc_compile: cannot read " << manifest_path << "\n";
+        return 1;
+    }
+    std::stringstream text;
+    text << manifest.rdbuf();
+
+    std::vector<qc::BatchJob> jobs;
+    std::string error;
+    if (!qc::BatchCompiler::parse_manifest(text.str(), jobs, error))
+    {
+        std::cerr << manifest_path << ": " << error << "\n";
+        return 1;
+    }
+
+    qc::BatchCompiler compiler(options);
+    bool ok = compiler.run(jobs);
+
+    if (output_path.empty())
+    {
+        std::cout << compiler.output();
+    }
+    else
+    {
+        std::ofstream out(output_path);
+        out << compiler.output();
+        if (!out)
+        {
+            std::cerr << "qc_compile: cannot write " << output_path << "\n";
+            return 1;
+        }
+    }
+    std::cerr << compiler.summary();
+    if (!options.cache.empty() && !compiler.stats().cache_saved)
+    {
+        std::cerr << "qc_compile: cannot write " << options.cache << "\n";
+        return 1;
+    }
+    if (!metrics_path.empty() && !MetaWaveCompiler::util::metrics().writeText(metrics_path))
+    {
+        std::cerr << "qc_compile: cannot write " << metrics_path << "\n";
+        return 1;
+    }
+    return ok ? 0 : 2;
+}